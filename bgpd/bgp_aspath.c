@@ -891,6 +891,34 @@ struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 	return find;
 }
 
+/* Same as aspath_parse(), but the AS path is neither looked up in nor
+   added to the AS path hash.  Only private state is touched, so this
+   may run outside of the main pthread; the result has its string
+   built and can be handed to aspath_intern() later.
+
+   On error NULL is returned.
+ */
+struct aspath *aspath_parse_detached(struct stream *s, size_t length,
+				     int use32bit,
+				     enum asnotation_mode asnotation)
+{
+	struct aspath *as;
+
+	if (length % AS16_VALUE_SIZE)
+		return NULL;
+
+	as = aspath_new(asnotation);
+	if (assegments_parse(s, length, &as->segments, use32bit) < 0) {
+		aspath_free(as);
+		return NULL;
+	}
+
+	as->count = aspath_count_hops_internal(as);
+	aspath_str_update(as, false);
+
+	return as;
+}
+
 /* Add specified AS to the rightmost of aspath. */
 static struct aspath *aspath_add_asns_rightmost(struct aspath *aspath, as_t asno, uint8_t type,
 						unsigned int num)
@@ -84,6 +84,9 @@ extern void aspath_finish(void);
 extern struct aspath *aspath_parse(struct stream *s, size_t length,
 				   int use32bit,
 				   enum asnotation_mode asnotation);
+extern struct aspath *aspath_parse_detached(struct stream *s, size_t length,
+					    int use32bit,
+					    enum asnotation_mode asnotation);
 
 extern struct aspath *aspath_dup(struct aspath *aspath);
 extern struct aspath *aspath_aggregate(struct aspath *as1, struct aspath *as2);
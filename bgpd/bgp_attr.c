@@ -29,6 +29,7 @@
 #include "bgpd/bgp_errors.h"
 #include "bgpd/bgp_label.h"
 #include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_ecommunity.h"
 #include "bgpd/bgp_lcommunity.h"
 #include "bgpd/bgp_updgrp.h"
@@ -987,12 +988,44 @@ static void transit_finish(void)
 	hash_clean_and_free(&transit_hash, (void (*)(void *))transit_free);
 }
 
-/* Attribute hash routines. */
-static struct hash *attrhash;
+/*
+ * Attribute hash routines.
+ *
+ * Interned attributes are spread over a fixed set of tables. When one of
+ * them grows, only its own share of the attributes is rehashed, so a
+ * table load no longer stalls on expanding a single table that holds
+ * millions of entries.
+ */
+#define ATTRHASH_SHARDS 64
+static struct hash *attrhash[ATTRHASH_SHARDS];
+
+/*
+ * Pick the table from a few fields that attrhash_cmp() requires to be
+ * equal; the sub-objects are compared by pointer since they are
+ * interned. This keeps equal attributes together without computing
+ * attrhash_key_make() twice.
+ */
+static struct hash *attrhash_shard(const struct attr *attr)
+{
+	uint32_t key;
+
+	key = jhash_3words(attr->nexthop.s_addr, attr->med, attr->local_pref,
+			   0);
+	key = jhash_2words((uintptr_t)attr->aspath,
+			   (uintptr_t)bgp_attr_get_community(attr), key);
+
+	return attrhash[key % ATTRHASH_SHARDS];
+}
 
 unsigned long int attr_count(void)
 {
-	return attrhash->count;
+	unsigned long int count = 0;
+	unsigned int i;
+
+	for (i = 0; i < ATTRHASH_SHARDS; i++)
+		count += attrhash[i]->count;
+
+	return count;
 }
 
 unsigned long int attr_unknown_count(void)
@@ -1113,8 +1146,11 @@ bool attrhash_cmp(const void *p1, const void *p2)
 
 static void attrhash_init(void)
 {
-	attrhash =
-		hash_create(attrhash_key_make, attrhash_cmp, "BGP Attributes");
+	unsigned int i;
+
+	for (i = 0; i < ATTRHASH_SHARDS; i++)
+		attrhash[i] = hash_create(attrhash_key_make, attrhash_cmp,
+					  "BGP Attributes");
 }
 
 /*
@@ -1127,7 +1163,10 @@ static void attr_vfree(void *attr)
 
 static void attrhash_finish(void)
 {
-	hash_clean_and_free(&attrhash, attr_vfree);
+	unsigned int i;
+
+	for (i = 0; i < ATTRHASH_SHARDS; i++)
+		hash_clean_and_free(&attrhash[i], attr_vfree);
 }
 
 static void attr_show_all_iterator(struct hash_bucket *bucket, void *args[])
@@ -1191,8 +1230,10 @@ void attr_show_all(struct vty *vty, bool summary)
 	args[1] = &counters;
 	args[2] = &summary;
 
-	hash_iterate(attrhash, (void (*)(struct hash_bucket *, void *))attr_show_all_iterator,
-		     args);
+	for (i = 0; i < ATTRHASH_SHARDS; i++)
+		hash_iterate(attrhash[i],
+			     (void (*)(struct hash_bucket *, void *))attr_show_all_iterator,
+			     args);
 
 	if (summary) {
 		const char *str;
@@ -1383,7 +1424,8 @@ struct attr *bgp_attr_intern(struct attr *attr)
 		find = reuse_anchor->attr_intern_reuse.interned;
 		find->refcnt++;
 	} else {
-		find = (struct attr *)hash_get(attrhash, attr, bgp_attr_hash_alloc);
+		find = (struct attr *)hash_get(attrhash_shard(attr), attr,
+					       bgp_attr_hash_alloc);
 		find->refcnt++;
 		/* Populate cache only for the unchanged-parsed-attr case */
 		if (reuse_anchor && reuse_anchor->attr_intern_reuse.parsed_attr &&
@@ -1625,7 +1667,7 @@ void bgp_attr_unintern(struct attr **pattr)
 
 	/* If reference becomes zero then free attribute object. */
 	if (attr->refcnt == 0) {
-		ret = hash_release(attrhash, attr);
+		ret = hash_release(attrhash_shard(attr), attr);
 		assert(ret != NULL);
 		XFREE(MTYPE_ATTR, attr);
 		*pattr = NULL;
@@ -2014,16 +2056,26 @@ static int bgp_attr_aspath(struct bgp_attr_parser_args *args)
 	struct peer *const peer = connection->peer;
 	const bgp_size_t length = args->length;
 	enum asnotation_mode asnotation;
+	struct aspath *aspath;
+	int use32bit;
 
 	asnotation = bgp_get_asnotation(peer->bgp);
 	/*
 	 * peer with AS4 => will get 4Byte ASnums
 	 * otherwise, will get 16 Bit
 	 */
-	attr->aspath = aspath_parse(connection->curr, length,
-				    CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV) &&
-					    CHECK_FLAG(peer->cap, PEER_CAP_AS4_ADV),
-				    asnotation);
+	use32bit = CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV) &&
+		   CHECK_FLAG(peer->cap, PEER_CAP_AS4_ADV);
+
+	/* Use the copy a parser pthread may have decoded already */
+	aspath = bgp_preparse_take_aspath(connection, length, use32bit,
+					  asnotation);
+	if (aspath) {
+		attr->aspath = aspath_intern(aspath);
+		stream_forward_getp(connection->curr, length);
+	} else
+		attr->aspath = aspath_parse(connection->curr, length, use32bit,
+					    asnotation);
 
 	/* In case of IBGP, length will be zero. */
 	if (!attr->aspath) {
@@ -639,7 +639,7 @@ static inline uint64_t bgp_aigp_metric_total(struct bgp_path_info *bpi)
 	if (bpi->peer == bpi->peer->bgp->peer_self)
 		return aigp;
 
-	return bpi->extra ? (aigp + bpi->extra->igpmetric) : aigp;
+	return aigp + bpi->igpmetric;
 }
 
 static inline void bgp_attr_set_med(struct attr *attr, uint32_t med)
@@ -6,6 +6,8 @@
 
 #include <zebra.h>
 
+#include <sys/ioctl.h>
+
 #include "log.h"
 #include "stream.h"
 #include "sockunion.h"
@@ -14,7 +16,7 @@
 #include "frrevent.h"
 #include "linklist.h"
 #include "queue.h"
-#include "pullwr.h"
+#include "frr_pthread.h"
 #include "memory.h"
 #include "network.h"
 #include "filter.h"
@@ -69,6 +71,7 @@ DEFINE_MTYPE_STATIC(BMP, BMP_ACLNAME,	"BMP access-list name");
 DEFINE_MTYPE_STATIC(BMP, BMP_QUEUE,	"BMP update queue item");
 DEFINE_MTYPE_STATIC(BMP, BMP,		"BMP instance state");
 DEFINE_MTYPE_STATIC(BMP, BMP_MIRRORQ,	"BMP route mirroring buffer");
+DEFINE_MTYPE_STATIC(BMP, BMP_OUTQ,	"BMP output queue item");
 DEFINE_MTYPE_STATIC(BMP, BMP_PEER,	"BMP per BGP peer data");
 DEFINE_MTYPE_STATIC(BMP, BMP_OPEN,	"BMP stored BGP OPEN message");
 DEFINE_MTYPE_STATIC(BMP, BMP_IMPORTED_BGP, "BMP imported BGP instance");
@@ -114,6 +117,12 @@ DECLARE_HASH(bmp_peerh, struct bmp_bgp_peer, bpi,
 struct bmp_peerh_head bmp_peerh;
 
 DECLARE_LIST(bmp_mirrorq, struct bmp_mirrorq, bmi);
+DECLARE_LIST(bmp_outq, struct bmp_outq_entry, boi);
+
+static struct frr_pthread *bmp_pth_io;
+
+/* mirrored packet whose stream still belongs to the packet processing loop */
+static struct bmp_mirrorq *bmp_mirror_borrowed;
 
 /* listener management */
 
@@ -233,6 +242,9 @@ static struct bmp *bmp_new(struct bmp_targets *bt, int bmp_sock)
 			? BMP_AFI_NEEDSYNC : BMP_AFI_INACTIVE;
 	}
 
+	pthread_mutex_init(&new->out_mtx, NULL);
+	bmp_outq_init(&new->outq);
+
 	bmp_session_add_tail(&bt->sessions, new);
 	return new;
 }
@@ -240,9 +252,220 @@ static struct bmp *bmp_new(struct bmp_targets *bt, int bmp_sock)
 static void bmp_free(struct bmp *bmp)
 {
 	bmp_session_del(&bmp->targets->sessions, bmp);
+	bmp_outq_fini(&bmp->outq);
+	pthread_mutex_destroy(&bmp->out_mtx);
 	XFREE(MTYPE_BMP_CONN, bmp);
 }
 
+/* started along with the first session, i.e. after the daemon has forked */
+static void bmp_io_start(void)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+
+	if (bmp_pth_io)
+		return;
+
+	bmp_pth_io = frr_pthread_new(&attr, "BMP I/O thread", "bgpd_bmp");
+	frr_pthread_run(bmp_pth_io, NULL);
+	frr_pthread_wait_running(bmp_pth_io);
+}
+
+static void bmp_mirrorq_unref(struct bmp_mirrorq *bmq)
+{
+	if (atomic_fetch_sub_explicit(&bmq->users, 1, memory_order_acq_rel) != 1)
+		return;
+
+	stream_free(bmq->pkt);
+	XFREE(MTYPE_BMP_MIRRORQ, bmq);
+}
+
+static uint8_t *bmp_outq_entry_data(struct bmp_outq_entry *boe, size_t *len)
+{
+	if (boe->bmq) {
+		*len = boe->bmq->len;
+		return STREAM_DATA(boe->bmq->pkt);
+	}
+
+	*len = stream_get_endp(boe->s);
+	return STREAM_DATA(boe->s);
+}
+
+static void bmp_outq_entry_free(struct bmp_outq_entry *boe)
+{
+	if (boe->bmq)
+		bmp_mirrorq_unref(boe->bmq);
+	stream_free(boe->s);
+	XFREE(MTYPE_BMP_OUTQ, boe);
+}
+
+static void bmp_fill(struct event *t);
+static void bmp_wrerr_event(struct event *t);
+
+/* BMP I/O pthread: one writev() per wakeup, like bgp_write() */
+#define BMP_WRITEV_MAX 64
+
+static void bmp_write(struct event *t)
+{
+	struct bmp *bmp = EVENT_ARG(t);
+	struct bmp_outq_head done;
+	struct bmp_outq_entry *boe;
+	struct iovec iov[BMP_WRITEV_MAX];
+	int iovcnt = 0;
+	size_t len, before, after;
+	ssize_t nwr, left;
+	bool more;
+
+	frr_with_mutex (&bmp->out_mtx) {
+		frr_each (bmp_outq, &bmp->outq, boe) {
+			if (iovcnt == BMP_WRITEV_MAX)
+				break;
+
+			iov[iovcnt].iov_base = bmp_outq_entry_data(boe, &len) +
+					       boe->pos;
+			iov[iovcnt].iov_len = len - boe->pos;
+			iovcnt++;
+		}
+	}
+
+	if (!iovcnt)
+		return;
+
+	nwr = writev(bmp->socket, iov, iovcnt);
+	if (nwr < 0 && ERRNO_IO_RETRY(errno)) {
+		event_add_write(bmp_pth_io->master, bmp_write, bmp, bmp->socket,
+				&bmp->t_write);
+		return;
+	}
+	if (nwr <= 0) {
+		bmp->out_errno = nwr < 0 ? errno : 0;
+		event_add_event(bm->master, bmp_wrerr_event, bmp, 0,
+				&bmp->t_wrerr);
+		return;
+	}
+
+	bmp_outq_init(&done);
+
+	frr_with_mutex (&bmp->out_mtx) {
+		before = bmp->out_pending;
+		bmp->out_pending -= nwr;
+		after = bmp->out_pending;
+
+		left = nwr;
+		while (left && (boe = bmp_outq_first(&bmp->outq))) {
+			bmp_outq_entry_data(boe, &len);
+			if ((size_t)left < len - boe->pos) {
+				boe->pos += left;
+				break;
+			}
+
+			left -= len - boe->pos;
+			bmp_outq_del(&bmp->outq, boe);
+			bmp_outq_add_tail(&done, boe);
+		}
+
+		more = bmp_outq_count(&bmp->outq) > 0;
+	}
+
+	atomic_fetch_add_explicit(&bmp->out_written, nwr, memory_order_relaxed);
+
+	if (before >= BMP_OUT_THRESH && after < BMP_OUT_THRESH)
+		event_add_event(bm->master, bmp_fill, bmp, 0, &bmp->t_fill);
+
+	/* a short write means the socket is full, wait for it to drain */
+	if (more)
+		event_add_write(bmp_pth_io->master, bmp_write, bmp, bmp->socket,
+				&bmp->t_write);
+
+	while ((boe = bmp_outq_pop(&done)))
+		bmp_outq_entry_free(boe);
+	bmp_outq_fini(&done);
+}
+
+static void bmp_writes_on(struct bmp *bmp)
+{
+	event_add_write(bmp_pth_io->master, bmp_write, bmp, bmp->socket,
+			&bmp->t_write);
+}
+
+static void bmp_writes_off(struct bmp *bmp)
+{
+	struct bmp_outq_entry *boe;
+
+	event_cancel_async(bmp_pth_io->master, &bmp->t_write, NULL);
+	event_cancel(&bmp->t_fill);
+	event_cancel(&bmp->t_wrerr);
+
+	frr_with_mutex (&bmp->out_mtx) {
+		while ((boe = bmp_outq_pop(&bmp->outq)))
+			bmp_outq_entry_free(boe);
+		bmp->out_pending = 0;
+	}
+}
+
+static void bmp_out_queue(struct bmp *bmp, struct bmp_outq_entry *boe,
+			  size_t len)
+{
+	frr_with_mutex (&bmp->out_mtx) {
+		bmp_outq_add_tail(&bmp->outq, boe);
+		bmp->out_pending += len;
+	}
+	bmp->out_seq++;
+
+	/* bmp_fill() kicks the writer once, after building its batch */
+	if (!bmp->in_fill)
+		bmp_writes_on(bmp);
+}
+
+/* queues a copy of s for sending; s stays with the caller */
+static void bmp_write_stream(struct bmp *bmp, struct stream *s)
+{
+	struct bmp_outq_entry *boe;
+	size_t len = stream_get_endp(s);
+
+	boe = XCALLOC(MTYPE_BMP_OUTQ, sizeof(*boe));
+	boe->s = stream_new(len);
+	stream_put(boe->s, STREAM_DATA(s), len);
+
+	bmp_out_queue(bmp, boe, len);
+}
+
+/* queues a mirrored packet for sending, without copying it */
+static void bmp_write_mirror(struct bmp *bmp, struct bmp_mirrorq *bmq)
+{
+	struct bmp_outq_entry *boe;
+
+	atomic_fetch_add_explicit(&bmq->users, 1, memory_order_relaxed);
+
+	boe = XCALLOC(MTYPE_BMP_OUTQ, sizeof(*boe));
+	boe->bmq = bmq;
+
+	bmp_out_queue(bmp, boe, bmq->len);
+}
+
+/* new data is available, have bmp_fill() pick it up */
+static void bmp_bump(struct bmp *bmp)
+{
+	event_add_event(bm->master, bmp_fill, bmp, 0, &bmp->t_fill);
+}
+
+static void bmp_out_stats(struct bmp *bmp, uint64_t *total_written,
+			  size_t *pending, size_t *kernel_pending)
+{
+	int tmp;
+
+	*total_written = atomic_load_explicit(&bmp->out_written,
+					      memory_order_relaxed);
+	frr_with_mutex (&bmp->out_mtx)
+		*pending = bmp->out_pending;
+
+	if (ioctl(bmp->socket, TIOCOUTQ, &tmp) != 0)
+		tmp = 0;
+	*kernel_pending = tmp;
+}
+
 #define BMP_PEER_TYPE_GLOBAL_INSTANCE 0
 #define BMP_PEER_TYPE_RD_INSTANCE 1
 #define BMP_PEER_TYPE_LOCAL_INSTANCE 2
@@ -430,7 +653,7 @@ static int bmp_send_initiation(struct bmp *bmp)
 	len = stream_get_endp(s);
 	stream_putl_at(s, BMP_LENGTH_POS, len); /* message length is set. */
 
-	pullwr_write_stream(bmp->pullwr, s);
+	bmp_write_stream(bmp, s);
 	stream_free(s);
 	return 0;
 }
@@ -612,7 +835,7 @@ static int bmp_send_peerup_per_instance(struct bmp *bmp, struct bgp *bgp)
 	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
 		s = bmp_peerstate(peer, false);
 		if (s) {
-			pullwr_write_stream(bmp->pullwr, s);
+			bmp_write_stream(bmp, s);
 			stream_free(s);
 		}
 	}
@@ -646,7 +869,7 @@ static void bmp_send_peerup_vrf_per_instance(struct bmp *bmp, enum bmp_vrf_state
 
 	s = bmp_peerstate(bgp->peer_self, *vrf_state == vrf_state_down);
 	if (s) {
-		pullwr_write_stream(bmp->pullwr, s);
+		bmp_write_stream(bmp, s);
 		stream_free(s);
 	}
 }
@@ -676,7 +899,7 @@ static void bmp_send_bt(struct bmp_targets *bt, struct stream *s)
 	struct bmp *bmp;
 
 	frr_each (bmp_session, &bt->sessions, bmp)
-		pullwr_write_stream(bmp->pullwr, s);
+		bmp_write_stream(bmp, s);
 }
 
 static void bmp_send_bt_safe(struct bmp_targets *bt, struct stream *s)
@@ -701,7 +924,6 @@ static void bmp_send_peerdown_vrf_per_instance(struct bmp_targets *bt, struct bg
 }
 
 /* send a stream to all bmp sessions configured in a bgp instance */
-/* XXX: kludge - filling the pullwr's buffer */
 static void bmp_send_all(struct bmp_bgp *bmpbgp, struct stream *s)
 {
 	struct bmp_targets *bt;
@@ -774,19 +996,35 @@ static void bmp_mirror_cull(struct bmp_bgp *bmpbgp)
 
 				while ((inner = bmp_pull_mirror(bmp))) {
 					if (!inner->refcount)
-						XFREE(MTYPE_BMP_MIRRORQ,
-								inner);
+						bmp_mirrorq_unref(inner);
 				}
 
 				zlog_warn("bmp[%s] lost mirror messages due to buffer size limit",
 						bmp->remote);
 				bmp->mirror_lost = true;
-				pullwr_bump(bmp->pullwr);
+				bmp_bump(bmp);
 			}
 		}
 	}
 }
 
+/* the packet is referenced, not copied, see bmp_mirror_packet_done() */
+static struct bmp_mirrorq *bmp_mirrorq_new(struct peer *peer, struct timeval *tv,
+					   bgp_size_t size, struct stream *packet)
+{
+	struct bmp_mirrorq *qitem;
+
+	qitem = XCALLOC(MTYPE_BMP_MIRRORQ, sizeof(*qitem));
+	qitem->peerid = peer->qobj_node.nid;
+	qitem->tv = *tv;
+	qitem->len = size;
+	qitem->pkt = packet;
+	qitem->users = 1;
+
+	bmp_mirror_borrowed = qitem;
+	return qitem;
+}
+
 static int bmp_mirror_packet(struct peer *peer, uint8_t type, bgp_size_t size,
 		struct stream *packet)
 {
@@ -812,13 +1050,7 @@ static int bmp_mirror_packet(struct peer *peer, uint8_t type, bgp_size_t size,
 		memcpy(bbpeer->open_rx, packet->data, size);
 	}
 
-
-	qitem = XCALLOC(MTYPE_BMP_MIRRORQ, sizeof(*qitem) + size);
-	qitem->peerid = peer->qobj_node.nid;
-	qitem->tv = tv;
-	qitem->len = size;
-	memcpy(qitem->data, packet->data, size);
-
+	/* only allocated once there is a session to mirror to */
 	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp_vrf)) {
 		bmpbgp = bmp_bgp_find(bgp_vrf);
 		if (!bmpbgp)
@@ -831,35 +1063,57 @@ static int bmp_mirror_packet(struct peer *peer, uint8_t type, bgp_size_t size,
 				continue;
 
 			frr_each (bmp_session, &bt->sessions, bmp) {
-				if (!qitem) {
-					qitem = XCALLOC(MTYPE_BMP_MIRRORQ, sizeof(*qitem) + size);
-					qitem->peerid = peer->qobj_node.nid;
-					qitem->tv = tv;
-					qitem->len = size;
-					memcpy(qitem->data, packet->data, size);
-				}
+				if (!qitem)
+					qitem = bmp_mirrorq_new(peer, &tv, size, packet);
 
 				qitem->refcount++;
 				if (!bmp->mirrorpos)
 					bmp->mirrorpos = qitem;
-				pullwr_bump(bmp->pullwr);
+				bmp_bump(bmp);
 			}
-			if (qitem->refcount == 0)
+			if (!qitem || qitem->refcount == 0)
 				continue;
 			bmpbgp->mirror_qsize += sizeof(*qitem) + size;
 			bmp_mirrorq_add_tail(&bmpbgp->mirrorq, qitem);
+			atomic_fetch_add_explicit(&qitem->users, 1,
+						  memory_order_relaxed);
 
 			bmp_mirror_cull(bmpbgp);
 
 			bmpbgp->mirror_qsizemax = MAX(bmpbgp->mirror_qsizemax, bmpbgp->mirror_qsize);
 		}
 	}
-	if (qitem && qitem->refcount == 0)
+	return 0;
+}
+
+/*
+ * bgpd is done processing a received packet.  If it is still queued for
+ * mirroring, take the stream over instead of copying the packet out of it.
+ * Anything else freeing a packet while it is processed (e.g. the session
+ * going down underneath) calls in here first, so this also comes for
+ * streams that were never borrowed; those are left alone.
+ */
+static int bmp_mirror_packet_done(struct peer *peer, struct stream **packet)
+{
+	struct bmp_mirrorq *qitem = bmp_mirror_borrowed;
+
+	if (!qitem || !*packet || qitem->pkt != *packet)
+		return 0;
+
+	bmp_mirror_borrowed = NULL;
+
+	/* only the main pthread takes references, so nobody can come late */
+	if (atomic_load_explicit(&qitem->users, memory_order_acquire) == 1) {
 		XFREE(MTYPE_BMP_MIRRORQ, qitem);
+		return 0;
+	}
+
+	*packet = NULL;
+	bmp_mirrorq_unref(qitem);
 	return 0;
 }
 
-static void bmp_wrmirror_lost(struct bmp *bmp, struct pullwr *pullwr)
+static void bmp_wrmirror_lost(struct bmp *bmp)
 {
 	struct stream *s;
 	struct timeval tv;
@@ -888,11 +1142,11 @@ static void bmp_wrmirror_lost(struct bmp *bmp, struct pullwr *pullwr)
 	stream_putl_at(s, BMP_LENGTH_POS, stream_get_endp(s));
 
 	bmp->cnt_mirror_overruns++;
-	pullwr_write_stream(bmp->pullwr, s);
+	bmp_write_stream(bmp, s);
 	stream_free(s);
 }
 
-static bool bmp_wrmirror(struct bmp *bmp, struct pullwr *pullwr)
+static bool bmp_wrmirror(struct bmp *bmp)
 {
 	struct bmp_mirrorq *bmq;
 	struct peer *peer;
@@ -901,7 +1155,7 @@ static bool bmp_wrmirror(struct bmp *bmp, struct pullwr *pullwr)
 	uint64_t peer_distinguisher = 0;
 
 	if (bmp->mirror_lost) {
-		bmp_wrmirror_lost(bmp, pullwr);
+		bmp_wrmirror_lost(bmp);
 		bmp->mirror_lost = false;
 		return true;
 	}
@@ -936,15 +1190,15 @@ static bool bmp_wrmirror(struct bmp *bmp, struct pullwr *pullwr)
 	stream_putl_at(s, BMP_LENGTH_POS, stream_get_endp(s) + bmq->len);
 
 	bmp->cnt_mirror++;
-	pullwr_write_stream(bmp->pullwr, s);
-	pullwr_write(bmp->pullwr, bmq->data, bmq->len);
+	bmp_write_stream(bmp, s);
+	bmp_write_mirror(bmp, bmq);
 
 	stream_free(s);
 	written = true;
 
 out:
 	if (!bmq->refcount)
-		XFREE(MTYPE_BMP_MIRRORQ, bmq);
+		bmp_mirrorq_unref(bmq);
 	return written;
 }
 
@@ -1087,8 +1341,8 @@ static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags, uint
 				stream_get_endp(s) + stream_get_endp(s2));
 
 		bmp->cnt_update++;
-		pullwr_write_stream(bmp->pullwr, s2);
-		pullwr_write_stream(bmp->pullwr, s);
+		bmp_write_stream(bmp, s2);
+		bmp_write_stream(bmp, s);
 		stream_free(s2);
 	}
 	stream_free(s);
@@ -1217,8 +1471,8 @@ static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
 			stream_get_endp(hdr) + stream_get_endp(msg));
 
 	bmp->cnt_update++;
-	pullwr_write_stream(bmp->pullwr, hdr);
-	pullwr_write_stream(bmp->pullwr, msg);
+	bmp_write_stream(bmp, hdr);
+	bmp_write_stream(bmp, msg);
 	stream_free(hdr);
 	stream_free(msg);
 }
@@ -1313,7 +1567,7 @@ static void bmp_eor_afi_safi(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t pe
 	bmp->sync_bgp = sync_bgp;
 }
 
-static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
+static bool bmp_wrsync(struct bmp *bmp)
 {
 	uint8_t bpi_num_labels, adjin_num_labels;
 	afi_t afi;
@@ -1557,7 +1811,7 @@ static inline struct bmp_queue_entry *bmp_pull_locrib(struct bmp *bmp)
 /* TODO BMP_MON_LOCRIB find a way to merge properly this function with
  * bmp_wrqueue or abstract it if possible
  */
-static bool bmp_wrqueue_locrib(struct bmp *bmp, struct pullwr *pullwr)
+static bool bmp_wrqueue_locrib(struct bmp *bmp)
 {
 
 	struct bmp_queue_entry *bqe;
@@ -1641,12 +1895,12 @@ out:
 		bgp_dest_unlock_node(bn);
 
 	if (!written && bmp->locrib_queuepos)
-		pullwr_bump(bmp->pullwr);
+		bmp_bump(bmp);
 
 	return written;
 }
 
-static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
+static bool bmp_wrqueue(struct bmp *bmp)
 {
 	struct bmp_queue_entry *bqe;
 	struct peer *peer;
@@ -1737,12 +1991,12 @@ out:
 		bgp_dest_unlock_node(bn);
 
 	if (!written && bmp->queuepos)
-		pullwr_bump(bmp->pullwr);
+		bmp_bump(bmp);
 
 	return written;
 }
 
-static void bmp_wrfill(struct bmp *bmp, struct pullwr *pullwr)
+static void bmp_wrfill(struct bmp *bmp)
 {
 	afi_t afi;
 	safi_t safi;
@@ -1757,30 +2011,75 @@ static void bmp_wrfill(struct bmp *bmp, struct pullwr *pullwr)
 		break;
 
 	case BMP_Run:
-		if (bmp_wrmirror(bmp, pullwr))
+		if (bmp_wrmirror(bmp))
 			break;
-		if (bmp_wrqueue(bmp, pullwr))
+		if (bmp_wrqueue(bmp))
 			break;
-		if (bmp_wrqueue_locrib(bmp, pullwr))
+		if (bmp_wrqueue_locrib(bmp))
 			break;
-		if (bmp_wrsync(bmp, pullwr))
+		if (bmp_wrsync(bmp))
 			break;
 		break;
 	}
 }
 
-static void bmp_wrerr(struct bmp *bmp, struct pullwr *pullwr, bool eof)
+/* err is 0 if the far end closed the session */
+static void bmp_wrerr(struct bmp *bmp, int err)
 {
-	if (eof)
+	if (!err)
 		zlog_info("bmp[%s] disconnected", bmp->remote);
 	else
 		flog_warn(EC_LIB_SYSTEM_CALL, "bmp[%s] connection error: %s",
-				bmp->remote, strerror(errno));
+				bmp->remote, strerror(err));
 
 	bmp_close(bmp);
 	bmp_free(bmp);
 }
 
+static void bmp_wrerr_event(struct event *t)
+{
+	struct bmp *bmp = EVENT_ARG(t);
+
+	bmp_wrerr(bmp, bmp->out_errno);
+}
+
+/*
+ * Main pthread: builds messages until enough are queued to keep the BMP
+ * I/O pthread busy, nothing is left to send, or the time is up.
+ */
+static void bmp_fill(struct event *t)
+{
+	struct bmp *bmp = EVENT_ARG(t);
+	uint64_t seq, seq_start = bmp->out_seq;
+	struct timeval t0;
+	size_t pending;
+
+	monotime(&t0);
+	bmp->in_fill = true;
+
+	while (true) {
+		frr_with_mutex (&bmp->out_mtx)
+			pending = bmp->out_pending;
+		if (pending >= BMP_OUT_THRESH)
+			break;
+
+		seq = bmp->out_seq;
+		bmp_wrfill(bmp);
+		if (bmp->out_seq == seq)
+			break;
+
+		if (monotime_since(&t0, NULL) >= BMP_OUT_MAXSPIN) {
+			bmp_bump(bmp);
+			break;
+		}
+	}
+
+	bmp->in_fill = false;
+
+	if (bmp->out_seq != seq_start)
+		bmp_writes_on(bmp);
+}
+
 static struct bmp_queue_entry *
 bmp_process_one(struct bmp_targets *bt, struct bmp_rbtree_head *updhash,
 		struct bmp_qlist_head *updlist, struct bgp *bgp, afi_t afi,
@@ -1872,7 +2171,7 @@ static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
 				if (!bmp->queuepos)
 					bmp->queuepos = last_item;
 
-				pullwr_bump(bmp->pullwr);
+				bmp_bump(bmp);
 			}
 		}
 	}
@@ -2006,11 +2305,11 @@ static void bmp_read(struct event *t)
 		zlog_info("bmp[%s]: unexpectedly received %zu bytes", bmp->remote, n);
 	} else if (n == 0) {
 		/* the TCP session was terminated by the far end */
-		bmp_wrerr(bmp, NULL, true);
+		bmp_wrerr(bmp, 0);
 		return;
 	} else if (!(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
 		/* the TCP session experienced a fatal error, likely a timeout */
-		bmp_wrerr(bmp, NULL, false);
+		bmp_wrerr(bmp, errno);
 		return;
 	}
 
@@ -2088,8 +2387,7 @@ static struct bmp *bmp_open(struct bmp_targets *bt, int bmp_sock)
 	strlcpy(bmp->remote, buf, sizeof(bmp->remote));
 
 	bmp->state = BMP_PeerUp;
-	bmp->pullwr = pullwr_new(bm->master, bmp_sock, bmp, bmp_wrfill,
-			bmp_wrerr);
+	bmp_io_start();
 	event_add_read(bm->master, bmp_read, bmp, bmp_sock, &bmp->t_read);
 	bmp_send_initiation(bmp);
 
@@ -2129,7 +2427,7 @@ static void bmp_close(struct bmp *bmp)
 
 	while ((bmq = bmp_pull_mirror(bmp)))
 		if (!bmq->refcount)
-			XFREE(MTYPE_BMP_MIRRORQ, bmq);
+			bmp_mirrorq_unref(bmq);
 	while ((bqe = bmp_pull(bmp)))
 		if (!bqe->refcount)
 			XFREE(MTYPE_BMP_QUEUE, bqe);
@@ -2138,7 +2436,7 @@ static void bmp_close(struct bmp *bmp)
 			XFREE(MTYPE_BMP_QUEUE, bqe);
 
 	event_cancel(&bmp->t_read);
-	pullwr_del(bmp->pullwr);
+	bmp_writes_off(bmp);
 	close(bmp->socket);
 }
 
@@ -3129,7 +3427,7 @@ DEFPY(bmp_mirror_cfg,
 
 		while ((bmq = bmp_pull_mirror(bmp)))
 			if (!bmq->refcount)
-				XFREE(MTYPE_BMP_MIRRORQ, bmq);
+				bmp_mirrorq_unref(bmq);
 	}
 	return CMD_SUCCESS;
 }
@@ -3295,7 +3593,7 @@ DEFPY(show_bmp,
 				uint64_t total;
 				size_t q, kq;
 
-				pullwr_stats(bmp->pullwr, &total, &q, &kq);
+				bmp_out_stats(bmp, &total, &q, &kq);
 
 				peer_uptime(bmp->t_up.tv_sec, uptime,
 					    sizeof(uptime), false, NULL);
@@ -3490,7 +3788,7 @@ static int bmp_route_update_bgpbmp(struct bmp_targets *bt, afi_t afi, safi_t saf
 		if (!bmp->locrib_queuepos)
 			bmp->locrib_queuepos = last_item;
 
-		pullwr_bump(bmp->pullwr);
+		bmp_bump(bmp);
 	};
 
 	return 0;
@@ -3676,6 +3974,7 @@ static int bmp_vrf_itf_state_changed(struct bgp *bgp, struct interface *itf)
 static int bgp_bmp_module_init(void)
 {
 	hook_register(bgp_packet_dump, bmp_mirror_packet);
+	hook_register(bgp_packet_processed, bmp_mirror_packet_done);
 	hook_register(bgp_packet_send, bmp_outgoing_packet);
 	hook_register(peer_status_changed, bmp_peer_status_changed);
 	hook_register(peer_backward_transition, bmp_peer_backward);
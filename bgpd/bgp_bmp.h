@@ -9,7 +9,7 @@
 
 #include "zebra.h"
 #include "typesafe.h"
-#include "pullwr.h"
+#include "frratomic.h"
 #include "qobj.h"
 #include "resolver.h"
 
@@ -77,6 +77,12 @@ struct bmp_queue_entry {
  *
  * There is *one* queue for each "struct bgp *" where we throw everything on,
  * with a size limit.  Refcount works the same as for monitoring above.
+ *
+ * The packet itself is not copied: pkt is the stream the packet was received
+ * in, which is handed over once bgpd is done processing it.  users counts
+ * who may still look at it - the queue, writes pending on the BMP I/O
+ * pthread, and the packet processing loop until the handover - and the last
+ * one to let go frees it.
  */
 
 PREDECL_LIST(bmp_mirrorq);
@@ -85,13 +91,35 @@ struct bmp_mirrorq {
 	struct bmp_mirrorq_item bmi;
 
 	size_t refcount;
+	_Atomic uint32_t users;
 	uint64_t peerid;
 	struct timeval tv;
 
+	struct stream *pkt;
 	size_t len;
-	uint8_t data[0];
 };
 
+/* Messages waiting to be written out on a BMP session.  Each entry either
+ * owns a stream or holds a reference on a mirrored packet.
+ */
+
+PREDECL_LIST(bmp_outq);
+
+struct bmp_outq_entry {
+	struct bmp_outq_item boi;
+
+	struct stream *s;
+	struct bmp_mirrorq *bmq;
+
+	/* bytes already written */
+	size_t pos;
+};
+
+/* the BMP I/O pthread asks for more messages below this many bytes queued */
+#define BMP_OUT_THRESH	16384
+/* max usec spent building messages before yielding the main pthread */
+#define BMP_OUT_MAXSPIN	2500
+
 enum bmp_afi_state {
 	BMP_AFI_INACTIVE = 0,
 	BMP_AFI_NEEDSYNC,
@@ -114,7 +142,26 @@ struct bmp {
 	char remote[SU_ADDRSTRLEN + 6];
 	struct event *t_read;
 
-	struct pullwr *pullwr;
+	/* Messages are built on the main pthread by bmp_fill() and written
+	 * out by bmp_write() on the BMP I/O pthread.  out_mtx protects outq
+	 * and out_pending; the writer schedules t_fill again once it drains
+	 * out_pending below BMP_OUT_THRESH, and t_wrerr when the socket
+	 * fails, with out_errno set (0 for EOF).
+	 */
+	pthread_mutex_t out_mtx;
+	struct bmp_outq_head outq;
+	size_t out_pending;
+	_Atomic uint64_t out_written;
+	int out_errno;
+	struct event *t_write;
+	struct event *t_fill;
+	struct event *t_wrerr;
+
+	/* main pthread only: messages queued so far, and whether bmp_fill()
+	 * is running, in which case it kicks the writer once done
+	 */
+	uint64_t out_seq;
+	bool in_fill;
 
 	int state;
 
@@ -16,6 +16,16 @@
 #include "queue.h"
 #include "memory.h"
 #include "filter.h"
+#include "frr_pthread.h"
+#include "frratomic.h"
+#include "monotime.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "bgpd/bgp_table.h"
 #include "bgpd/bgpd.h"
@@ -25,6 +35,8 @@
 #include "bgpd/bgp_errors.h"
 #include "bgpd/bgp_packet.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_DUMP_WRITER, "BGP table dump writer");
+
 enum bgp_dump_type {
 	BGP_DUMP_ALL,
 	BGP_DUMP_ALL_ET,
@@ -76,6 +88,87 @@ struct bgp_dump {
 static int bgp_dump_unset(struct bgp_dump *bgp_dump);
 static void bgp_dump_interval_func(struct event *);
 
+/*
+ * Table dumps are encoded on the main pthread a slice of dests at a time
+ * and written out, compressed if the file name asks for it, by the dump
+ * writer pthread.
+ */
+#define BGP_DUMP_SLICE_DESTS	1000
+/* records are handed to the writer in streams of this size */
+#define BGP_DUMP_BATCH_SIZE	65536
+/* slices wait while this much is queued for the writer */
+#define BGP_DUMP_QUEUE_MAX	(4 * 1024 * 1024)
+#define BGP_DUMP_BACKOFF_MSEC	10
+#define BGP_DUMP_CBUF_SIZE	65536
+
+enum bgp_dump_compress {
+	BGP_DUMP_COMPRESS_NONE,
+	BGP_DUMP_COMPRESS_GZIP,
+	BGP_DUMP_COMPRESS_ZSTD,
+};
+
+struct bgp_dump_writer {
+	FILE *fp;
+	enum bgp_dump_compress compress;
+#ifdef HAVE_ZLIB
+	z_stream gz;
+#endif
+#ifdef HAVE_ZSTD
+	ZSTD_CCtx *zstd;
+#endif
+	uint8_t *cbuf;
+
+	/* streams to write, and their total size */
+	struct stream_fifo *fifo;
+	_Atomic size_t queued;
+	/* set once the last stream has been queued */
+	_Atomic bool closing;
+
+	/* writer pthread until t_done is scheduled, main pthread after */
+	bool finished;
+	bool failed;
+	int errnum;
+	uint64_t bytes_in, bytes_out;
+
+	struct event *t_write;
+	struct event *t_done;
+};
+
+/* the table dump in progress */
+static struct bgp_dump_walk {
+	struct bgp_dump_writer *writer;
+
+	struct bgp *bgp;
+	afi_t afi;
+	/* next dest to dump, locked */
+	struct bgp_dest *dest;
+	unsigned int seq;
+	/* stamped on the peers in this dump's index table, never 0 */
+	unsigned int gen;
+	/* records not yet handed to the writer */
+	struct stream *batch;
+
+	struct timeval started;
+	int64_t main_usec;
+	unsigned int slices;
+	uint64_t records;
+
+	struct event *t_slice;
+} bgp_dump_walk;
+
+/* the last table dump that completed */
+static struct bgp_dump_walk_stats {
+	time_t finished;
+	int64_t duration_usec;
+	int64_t main_usec;
+	unsigned int slices;
+	uint64_t records;
+	uint64_t bytes, bytes_written;
+	bool failed;
+} bgp_dump_last;
+
+static struct frr_pthread *bgp_pth_dump;
+
 /* BGP packet dump output buffer. */
 struct stream *bgp_dump_obuf;
 
@@ -205,6 +298,218 @@ static void bgp_dump_set_size(struct stream *s, int type)
 	stream_putl_at(s, 8, stream_get_endp(s) - BGP_DUMP_HEADER_SIZE);
 }
 
+static enum bgp_dump_compress bgp_dump_compress_type(const char *filename)
+{
+	size_t len = strlen(filename);
+
+	if (len > 3 && strmatch(filename + len - 3, ".gz"))
+		return BGP_DUMP_COMPRESS_GZIP;
+	if (len > 4 && strmatch(filename + len - 4, ".zst"))
+		return BGP_DUMP_COMPRESS_ZSTD;
+	return BGP_DUMP_COMPRESS_NONE;
+}
+
+static struct bgp_dump_writer *bgp_dump_writer_new(FILE *fp,
+						   const char *filename)
+{
+	struct bgp_dump_writer *writer;
+
+	writer = XCALLOC(MTYPE_BGP_DUMP_WRITER, sizeof(*writer));
+	writer->fp = fp;
+	writer->fifo = stream_fifo_new();
+	writer->compress = bgp_dump_compress_type(filename);
+
+	switch (writer->compress) {
+	case BGP_DUMP_COMPRESS_NONE:
+		break;
+	case BGP_DUMP_COMPRESS_GZIP:
+#ifdef HAVE_ZLIB
+		/* 16 + max window bits selects the gzip format */
+		if (deflateInit2(&writer->gz, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+			break;
+#endif
+		flog_warn(EC_BGP_DUMP, "%s: cannot gzip %s, writing it uncompressed",
+			  __func__, filename);
+		writer->compress = BGP_DUMP_COMPRESS_NONE;
+		break;
+	case BGP_DUMP_COMPRESS_ZSTD:
+#ifdef HAVE_ZSTD
+		writer->zstd = ZSTD_createCCtx();
+		if (writer->zstd)
+			break;
+#endif
+		flog_warn(EC_BGP_DUMP, "%s: cannot zstd %s, writing it uncompressed",
+			  __func__, filename);
+		writer->compress = BGP_DUMP_COMPRESS_NONE;
+		break;
+	}
+
+	if (writer->compress != BGP_DUMP_COMPRESS_NONE)
+		writer->cbuf = XMALLOC(MTYPE_BGP_DUMP_WRITER, BGP_DUMP_CBUF_SIZE);
+
+	return writer;
+}
+
+static void bgp_dump_writer_free(struct bgp_dump_writer *writer)
+{
+#ifdef HAVE_ZLIB
+	if (writer->compress == BGP_DUMP_COMPRESS_GZIP)
+		deflateEnd(&writer->gz);
+#endif
+#ifdef HAVE_ZSTD
+	ZSTD_freeCCtx(writer->zstd);
+#endif
+	XFREE(MTYPE_BGP_DUMP_WRITER, writer->cbuf);
+	stream_fifo_free(writer->fifo);
+	XFREE(MTYPE_BGP_DUMP_WRITER, writer);
+}
+
+static void bgp_dump_writer_fwrite(struct bgp_dump_writer *writer,
+				   const void *data, size_t len)
+{
+	if (writer->failed || !len)
+		return;
+
+	if (fwrite(data, len, 1, writer->fp) != 1) {
+		writer->failed = true;
+		writer->errnum = errno;
+		return;
+	}
+	writer->bytes_out += len;
+}
+
+/* writer pthread; end flushes out whatever the compressor holds back */
+static void bgp_dump_writer_output(struct bgp_dump_writer *writer,
+				   const uint8_t *data, size_t len, bool end)
+{
+	writer->bytes_in += len;
+
+	switch (writer->compress) {
+	case BGP_DUMP_COMPRESS_NONE:
+		bgp_dump_writer_fwrite(writer, data, len);
+		break;
+	case BGP_DUMP_COMPRESS_GZIP:
+#ifdef HAVE_ZLIB
+		writer->gz.next_in = (Bytef *)data;
+		writer->gz.avail_in = len;
+		do {
+			writer->gz.next_out = writer->cbuf;
+			writer->gz.avail_out = BGP_DUMP_CBUF_SIZE;
+			if (deflate(&writer->gz, end ? Z_FINISH : Z_NO_FLUSH) ==
+			    Z_STREAM_ERROR) {
+				writer->failed = true;
+				writer->errnum = EIO;
+				return;
+			}
+			bgp_dump_writer_fwrite(writer, writer->cbuf,
+					       BGP_DUMP_CBUF_SIZE -
+						       writer->gz.avail_out);
+		} while (writer->gz.avail_out == 0);
+#endif
+		break;
+	case BGP_DUMP_COMPRESS_ZSTD:
+#ifdef HAVE_ZSTD
+	{
+		ZSTD_inBuffer in = { .src = data, .size = len };
+		ZSTD_outBuffer out;
+		size_t left;
+
+		do {
+			out.dst = writer->cbuf;
+			out.size = BGP_DUMP_CBUF_SIZE;
+			out.pos = 0;
+			left = ZSTD_compressStream2(writer->zstd, &out, &in,
+						    end ? ZSTD_e_end
+							: ZSTD_e_continue);
+			if (ZSTD_isError(left)) {
+				writer->failed = true;
+				writer->errnum = EIO;
+				return;
+			}
+			bgp_dump_writer_fwrite(writer, writer->cbuf, out.pos);
+		} while (end ? left != 0 : in.pos < in.size);
+	}
+#endif
+		break;
+	}
+}
+
+static void bgp_dump_writer_finish(struct bgp_dump_writer *writer)
+{
+	if (writer->compress != BGP_DUMP_COMPRESS_NONE)
+		bgp_dump_writer_output(writer, NULL, 0, true);
+
+	if (fclose(writer->fp) && !writer->failed) {
+		writer->failed = true;
+		writer->errnum = errno;
+	}
+	writer->fp = NULL;
+	writer->finished = true;
+}
+
+static void bgp_dump_walk_done(struct event *t);
+
+/* writer pthread */
+static void bgp_dump_writer_run(struct event *t)
+{
+	struct bgp_dump_writer *writer = EVENT_ARG(t);
+	struct stream *s;
+	size_t len;
+	bool closing;
+
+	/* whatever was queued before closing was set is on the fifo now */
+	closing = atomic_load_explicit(&writer->closing, memory_order_acquire);
+
+	while ((s = stream_fifo_pop_safe(writer->fifo))) {
+		len = stream_get_endp(s);
+		bgp_dump_writer_output(writer, STREAM_DATA(s), len, false);
+		atomic_fetch_sub_explicit(&writer->queued, len,
+					  memory_order_relaxed);
+		stream_free(s);
+	}
+
+	if (!closing)
+		return;
+
+	bgp_dump_writer_finish(writer);
+	event_add_event(bm->master, bgp_dump_walk_done, writer, 0,
+			&writer->t_done);
+}
+
+/* hands the records collected so far to the writer */
+static void bgp_dump_walk_flush(void)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	struct bgp_dump_writer *writer = walk->writer;
+
+	if (!walk->batch)
+		return;
+
+	atomic_fetch_add_explicit(&writer->queued,
+				  stream_get_endp(walk->batch),
+				  memory_order_relaxed);
+	stream_fifo_push_safe(writer->fifo, walk->batch);
+	walk->batch = NULL;
+
+	event_add_event(bgp_pth_dump->master, bgp_dump_writer_run, writer, 0,
+			&writer->t_write);
+}
+
+static void bgp_dump_walk_put(struct stream *obuf)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	size_t len = stream_get_endp(obuf);
+
+	if (walk->batch && STREAM_WRITEABLE(walk->batch) < len)
+		bgp_dump_walk_flush();
+	if (!walk->batch)
+		walk->batch = stream_new(MAX(len, BGP_DUMP_BATCH_SIZE));
+
+	stream_put(walk->batch, STREAM_DATA(obuf), len);
+	walk->records++;
+}
+
 static void bgp_dump_routes_index_table(struct bgp *bgp)
 {
 	struct peer *peer;
@@ -283,18 +588,23 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 
 		/* Store the peer number for this peer */
 		peer->table_dump_index = peerno;
+		peer->table_dump_gen = bgp_dump_walk.gen;
 		peerno++;
 	}
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
 
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
-	fflush(bgp_dump_routes.fp);
+	bgp_dump_walk_put(obuf);
 }
 
+/*
+ * Writes a RIB record for path and the ones after it, as many as fit, and
+ * returns the first one that didn't.  Paths of peers that are not in the
+ * index table, because they came up after it was written, are left out.
+ */
 static struct bgp_path_info *
 bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
-			   struct bgp_path_info *path, unsigned int seq)
+			   struct bgp_path_info *path, unsigned int *seq)
 {
 	struct stream *obuf;
 	size_t sizep;
@@ -326,7 +636,7 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 				BGP_DUMP_ROUTES);
 
 	/* Sequence number */
-	stream_putl(obuf, seq);
+	stream_putl(obuf, *seq);
 
 	/* Prefix length */
 	stream_putc(obuf, p->prefixlen);
@@ -357,6 +667,9 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 	for (; path; path = path->next) {
 		size_t cur_endp;
 
+		if (path->peer->table_dump_gen != bgp_dump_walk.gen)
+			continue;
+
 		/* Peer index */
 		stream_putw(obuf, path->peer->table_dump_index);
 
@@ -384,53 +697,184 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 		endp = cur_endp;
 	}
 
+	/* nothing but paths of peers that are not indexed */
+	if (!entry_count && !path)
+		return NULL;
+
 	/* Overwrite the entry count, now that we know the right number */
 	stream_putw_at(obuf, sizep, entry_count);
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
+	bgp_dump_walk_put(obuf);
+	(*seq)++;
 
 	return path;
 }
 
 
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
+static void bgp_dump_walk_slice(struct event *t)
 {
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
 	struct bgp_path_info *path;
-	struct bgp_dest *dest;
+	struct timeval t0;
+	unsigned int count = 0;
+
+	/* let the writer catch up rather than queueing the whole table */
+	if (atomic_load_explicit(&walk->writer->queued, memory_order_relaxed) >
+	    BGP_DUMP_QUEUE_MAX) {
+		event_add_timer_msec(bm->master, bgp_dump_walk_slice, NULL,
+				     BGP_DUMP_BACKOFF_MSEC, &walk->t_slice);
+		return;
+	}
+
+	monotime(&t0);
+	walk->slices++;
+
+	while (count < BGP_DUMP_SLICE_DESTS) {
+		if (!walk->dest) {
+			if (walk->afi == AFI_IP6)
+				break;
+
+			walk->afi = AFI_IP6;
+			walk->dest = bgp_table_top(
+				walk->bgp->rib[AFI_IP6][SAFI_UNICAST]);
+			continue;
+		}
+
+		path = bgp_dest_get_bgp_path_info(walk->dest);
+		while (path)
+			path = bgp_dump_route_node_record(walk->afi, walk->dest,
+							  path, &walk->seq);
+
+		walk->dest = bgp_route_next(walk->dest);
+		count++;
+	}
+
+	bgp_dump_walk_flush();
+	walk->main_usec += monotime_since(&t0, NULL);
+
+	if (walk->dest || walk->afi == AFI_IP) {
+		event_add_event(bm->master, bgp_dump_walk_slice, NULL, 0,
+				&walk->t_slice);
+		return;
+	}
+
+	bgp_unlock(walk->bgp);
+	walk->bgp = NULL;
+
+	atomic_store_explicit(&walk->writer->closing, true,
+			      memory_order_release);
+	event_add_event(bgp_pth_dump->master, bgp_dump_writer_run, walk->writer,
+			0, &walk->writer->t_write);
+}
+
+/*
+ * Starts dumping the default instance's unicast tables into the file just
+ * opened for bgp_dump_routes. Peers that come up while the dump is running
+ * are not in the index table; their routes are left out of the dump.
+ */
+static void bgp_dump_walk_start(void)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
 	struct bgp *bgp;
-	struct bgp_table *table;
 
 	bgp = bgp_get_default();
-	if (!bgp)
-		return seq;
-
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
-
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
-
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		path = bgp_dest_get_bgp_path_info(dest);
-		while (path) {
-			path = bgp_dump_route_node_record(afi, dest, path, seq);
-			seq++;
-		}
+	if (!bgp) {
+		fclose(bgp_dump_routes.fp);
+		bgp_dump_routes.fp = NULL;
+		return;
+	}
+
+	if (!bgp_pth_dump) {
+		struct frr_pthread_attr attr = {
+			.start = frr_pthread_attr_default.start,
+			.stop = frr_pthread_attr_default.stop,
+		};
+
+		bgp_pth_dump = frr_pthread_new(&attr, "BGP dump writer",
+					       "bgpd_dump");
+		frr_pthread_run(bgp_pth_dump, NULL);
+		frr_pthread_wait_running(bgp_pth_dump);
+	}
+
+	walk->writer = bgp_dump_writer_new(bgp_dump_routes.fp,
+					   bgp_dump_routes.filename);
+	bgp_dump_routes.fp = NULL;
+
+	monotime(&walk->started);
+	walk->main_usec = 0;
+	walk->slices = 0;
+	walk->records = 0;
+	walk->seq = 0;
+	if (!++walk->gen)
+		walk->gen++;
+
+	walk->bgp = bgp_lock(bgp);
+	walk->afi = AFI_IP;
+	walk->dest = bgp_table_top(bgp->rib[AFI_IP][SAFI_UNICAST]);
+
+	bgp_dump_routes_index_table(bgp);
+
+	event_add_event(bm->master, bgp_dump_walk_slice, NULL, 0,
+			&walk->t_slice);
+}
+
+/* main pthread, once the writer has closed the file */
+static void bgp_dump_walk_done(struct event *t)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	struct bgp_dump_writer *writer = EVENT_ARG(t);
+
+	assert(writer == walk->writer);
+
+	bgp_dump_last.finished = time(NULL);
+	bgp_dump_last.duration_usec = monotime_since(&walk->started, NULL);
+	bgp_dump_last.main_usec = walk->main_usec;
+	bgp_dump_last.slices = walk->slices;
+	bgp_dump_last.records = walk->records;
+	bgp_dump_last.bytes = writer->bytes_in;
+	bgp_dump_last.bytes_written = writer->bytes_out;
+	bgp_dump_last.failed = writer->failed;
+
+	if (writer->failed)
+		flog_warn(EC_BGP_DUMP, "%s: writing table dump failed: %s",
+			  __func__, safe_strerror(writer->errnum));
+
+	bgp_dump_writer_free(writer);
+	walk->writer = NULL;
+}
+
+/* drops the table dump in progress, if any */
+static void bgp_dump_walk_abort(void)
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	struct bgp_dump_writer *writer = walk->writer;
+
+	if (!writer)
+		return;
+
+	event_cancel(&walk->t_slice);
+	if (walk->dest) {
+		bgp_dest_unlock_node(walk->dest);
+		walk->dest = NULL;
+	}
+	if (walk->bgp) {
+		bgp_unlock(walk->bgp);
+		walk->bgp = NULL;
 	}
+	stream_free(walk->batch);
+	walk->batch = NULL;
 
-	fflush(bgp_dump_routes.fp);
+	/* the writer pthread is not looking at it anymore after this */
+	event_cancel_async(bgp_pth_dump->master, &writer->t_write, NULL);
+	event_cancel(&writer->t_done);
 
-	return seq;
+	stream_fifo_clean(writer->fifo);
+	if (!writer->finished)
+		bgp_dump_writer_finish(writer);
+
+	bgp_dump_writer_free(writer);
+	walk->writer = NULL;
 }
 
 static void bgp_dump_interval_func(struct event *t)
@@ -439,18 +883,18 @@ static void bgp_dump_interval_func(struct event *t)
 	bgp_dump = EVENT_ARG(t);
 
 	/* Reschedule dump even if file couldn't be opened this time... */
-	if (bgp_dump_open_file(bgp_dump) != NULL) {
-		/* In case of bgp_dump_routes, we need special route dump
-		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
-			fclose(bgp_dump->fp);
-			bgp_dump->fp = NULL;
-		}
+	if (bgp_dump->type == BGP_DUMP_ROUTES && bgp_dump_walk.writer) {
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous table dump still in progress, skipping this one",
+			  __func__);
+	} else if (bgp_dump_open_file(bgp_dump) != NULL) {
+		/* In case of bgp_dump_routes, the table dump takes the file
+		 * over and closes it once done. For a RIB dump there's no
+		 * point in leaving it open until the next scheduled dump
+		 * starts.
+		 */
+		if (bgp_dump->type == BGP_DUMP_ROUTES)
+			bgp_dump_walk_start();
 	}
 
 	/* if interval is set reschedule */
@@ -688,6 +1132,9 @@ static int bgp_dump_set(struct vty *vty, struct bgp_dump *bgp_dump,
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 {
+	if (bgp_dump == &bgp_dump_routes)
+		bgp_dump_walk_abort();
+
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
@@ -795,6 +1242,49 @@ DEFUN (no_dump_bgp_all,
 	return bgp_dump_unset(bgp_dump_struct);
 }
 
+DEFUN (show_bgp_mrt_dump,
+       show_bgp_mrt_dump_cmd,
+       "show bgp mrt-dump",
+       SHOW_STR
+       BGP_STR
+       "MRT table dump status\n")
+{
+	struct bgp_dump_walk *walk = &bgp_dump_walk;
+	struct tm tm;
+	char buf[64];
+
+	if (walk->writer)
+		vty_out(vty,
+			"Table dump in progress for %.3f s, main pthread busy %.3f s in %u slices, %" PRIu64
+			" records, %zu bytes waiting to be written\n",
+			monotime_since(&walk->started, NULL) / 1000000.0,
+			walk->main_usec / 1000000.0, walk->slices,
+			walk->records,
+			atomic_load_explicit(&walk->writer->queued,
+					     memory_order_relaxed));
+
+	if (!bgp_dump_last.finished) {
+		vty_out(vty, "No table dump completed yet\n");
+		return CMD_SUCCESS;
+	}
+
+	localtime_r(&bgp_dump_last.finished, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+
+	vty_out(vty, "Last table dump finished %s%s\n", buf,
+		bgp_dump_last.failed ? ", writing it failed" : "");
+	vty_out(vty, "  Took %.3f s, main pthread busy %.3f s in %u slices\n",
+		bgp_dump_last.duration_usec / 1000000.0,
+		bgp_dump_last.main_usec / 1000000.0, bgp_dump_last.slices);
+	vty_out(vty,
+		"  %" PRIu64 " records, %" PRIu64 " bytes, %" PRIu64
+		" bytes written\n",
+		bgp_dump_last.records, bgp_dump_last.bytes,
+		bgp_dump_last.bytes_written);
+
+	return CMD_SUCCESS;
+}
+
 static int config_write_bgp_dump(struct vty *vty);
 /* BGP node structure. */
 static struct cmd_node bgp_dump_node = {
@@ -858,6 +1348,7 @@ void bgp_dump_init(void)
 
 	install_element(CONFIG_NODE, &dump_bgp_all_cmd);
 	install_element(CONFIG_NODE, &no_dump_bgp_all_cmd);
+	install_element(VIEW_NODE, &show_bgp_mrt_dump_cmd);
 
 	hook_register(bgp_packet_dump, bgp_dump_packet);
 	hook_register(peer_status_changed, bgp_dump_state);
@@ -40,6 +40,7 @@
 #include "bgpd/bgp_memory.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_zebra.h"
 #include "bgpd/bgp_vty.h"
 #include "bgpd/bgp_trace.h"
@@ -119,6 +120,8 @@ static void peer_xfer_stats(struct peer *peer_dst, struct peer *peer_src)
 	peer_dst->notify_out += peer_src->notify_out;
 	peer_dst->dynamic_cap_in += peer_src->dynamic_cap_in;
 	peer_dst->dynamic_cap_out += peer_src->dynamic_cap_out;
+	peer_dst->write_calls += peer_src->write_calls;
+	peer_dst->write_blocked += peer_src->write_blocked;
 }
 
 static struct peer *peer_xfer_conn(struct peer *from_peer)
@@ -2084,13 +2087,13 @@ enum bgp_fsm_state_progress bgp_stop(struct peer_connection *connection)
 		if (connection->obuf)
 			stream_fifo_clean(connection->obuf);
 
+		bgp_preparse_flush(connection);
+
 		if (connection->ibuf_work)
 			ringbuf_wipe(connection->ibuf_work);
 
-		if (connection->curr) {
-			stream_free(connection->curr);
-			connection->curr = NULL;
-		}
+		if (connection->curr)
+			bgp_packet_curr_free(connection);
 	}
 
 	/* Close of file descriptor. */
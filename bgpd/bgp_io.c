@@ -24,12 +24,14 @@
 #include "bgpd/bgp_errors.h"	// for expanded error reference information
 #include "bgpd/bgp_fsm.h"	// for BGP_EVENT_ADD, bgp_event
 #include "bgpd/bgp_packet.h"	// for bgp_notify_io_invalid...
+#include "bgpd/bgp_preparse.h"	// for bgp_preparse_queue
 #include "bgpd/bgp_trace.h"	// for frrtraces
 #include "bgpd/bgpd.h"		// for peer, BGP_MARKER_SIZE, bgp_master, bm
 /* clang-format on */
 
 /* forward declarations */
-static uint16_t bgp_write(struct peer_connection *connection);
+static uint16_t bgp_write(struct peer_connection *connection,
+			  struct stream_fifo *sent);
 static uint16_t bgp_read(struct peer_connection *connection, int *code_p);
 static void bgp_process_writes(struct event *event);
 static void bgp_process_reads(struct event *event);
@@ -132,6 +134,7 @@ static void bgp_process_writes(struct event *event)
 	bool reschedule = false;
 	bool fatal = false;
 	struct frr_pthread *fpt = bgp_pth_io;
+	struct stream_fifo sent;
 
 	peer = connection->peer;
 
@@ -142,11 +145,16 @@ static void bgp_process_writes(struct event *event)
 	event_add_write(fpt->master, bgp_process_writes, connection, connection->fd,
 			&connection->t_write);
 
+	stream_fifo_init(&sent);
+
 	frr_with_mutex (&connection->io_mtx) {
-		status = bgp_write(connection);
+		status = bgp_write(connection, &sent);
 		reschedule = (stream_fifo_head(connection->obuf) != NULL);
 	}
 
+	/* written packets are freed once io_mtx is released */
+	stream_fifo_deinit(&sent);
+
 	/* no problem */
 	if (CHECK_FLAG(status, BGP_IO_TRANS_ERR)) {
 	}
@@ -220,6 +228,7 @@ static int read_ibuf_work(struct peer_connection *connection)
 	frrtrace(2, frr_bgp, packet_read, connection, pkt);
 	frr_with_mutex (&connection->io_mtx) {
 		stream_fifo_push(connection->ibuf, pkt);
+		bgp_preparse_queue(connection, pkt);
 	}
 
 	return pktsize;
@@ -329,12 +338,18 @@ done:
  * peer->wpkt_quanta and the number of packets on the output buffer, unless an
  * error occurs.
  *
+ * A single writev() is issued per call; if the socket takes less than
+ * everything, the remainder is left on the output buffer for the next time
+ * the socket becomes writable. Packets written in full are moved to sent,
+ * for the caller to free.
+ *
  * If write() returns an error, the appropriate FSM event is generated.
  *
  * The return value is equal to the number of packets written
  * (which may be zero).
  */
-static uint16_t bgp_write(struct peer_connection *connection)
+static uint16_t bgp_write(struct peer_connection *connection,
+			  struct stream_fifo *sent)
 {
 	struct peer *peer = connection->peer;
 	uint8_t type;
@@ -345,17 +360,14 @@ static uint16_t bgp_write(struct peer_connection *connection)
 	uint16_t status = 0;
 	uint32_t wpkt_quanta_old;
 
-	int writenum = 0;
-	int num;
+	ssize_t num;
 	unsigned int iovsz;
-	unsigned int strmsz;
 	unsigned int total_written;
 	time_t now;
 
 	wpkt_quanta_old = atomic_load_explicit(&peer->bgp->wpkt_quanta,
 					       memory_order_relaxed);
 	struct stream *ostreams[wpkt_quanta_old];
-	struct stream **streams = ostreams;
 	struct iovec iov[wpkt_quanta_old];
 
 	s = stream_fifo_head(connection->obuf);
@@ -368,62 +380,43 @@ static uint16_t bgp_write(struct peer_connection *connection)
 		ostreams[iovsz] = s;
 		iov[iovsz].iov_base = stream_pnt(s);
 		iov[iovsz].iov_len = STREAM_READABLE(s);
-		writenum += STREAM_READABLE(s);
 		s = s->next;
 		++iovsz;
 		++count;
 	}
 
-	strmsz = iovsz;
-	total_written = 0;
-
-	do {
-		num = writev(connection->fd, iov, iovsz);
-
-		if (num < 0) {
-			if (!ERRNO_IO_RETRY(errno)) {
-				BGP_EVENT_ADD(connection, TCP_fatal_error);
-				SET_FLAG(status, BGP_IO_FATAL_ERR);
-			} else {
-				SET_FLAG(status, BGP_IO_TRANS_ERR);
-			}
-
-			break;
-		} else if (num != writenum) {
-			unsigned int msg_written = 0;
-			unsigned int ic = iovsz;
-
-			for (unsigned int i = 0; i < ic; i++) {
-				size_t ss = iov[i].iov_len;
-
-				if (ss > (unsigned int) num)
-					break;
-
-				msg_written++;
-				iovsz--;
-				writenum -= ss;
-				num -= ss;
-			}
-
-			total_written += msg_written;
+	num = writev(connection->fd, iov, iovsz);
+	atomic_fetch_add_explicit(&peer->write_calls, 1, memory_order_relaxed);
 
-			assert(total_written < count);
-
-			memmove(&iov, &iov[msg_written],
-				sizeof(iov[0]) * iovsz);
-			streams = &streams[msg_written];
-			stream_forward_getp(streams[0], num);
-			iov[0].iov_base = stream_pnt(streams[0]);
-			iov[0].iov_len = STREAM_READABLE(streams[0]);
-
-			writenum -= num;
-			num = 0;
-			assert(writenum > 0);
+	if (num < 0) {
+		if (!ERRNO_IO_RETRY(errno)) {
+			BGP_EVENT_ADD(connection, TCP_fatal_error);
+			SET_FLAG(status, BGP_IO_FATAL_ERR);
 		} else {
-			total_written = strmsz;
+			atomic_fetch_add_explicit(&peer->write_blocked, 1,
+						  memory_order_relaxed);
+			SET_FLAG(status, BGP_IO_TRANS_ERR);
 		}
 
-	} while (num != writenum);
+		goto done;
+	}
+
+	/*
+	 * A short write means the socket buffer is full. Retrying right away
+	 * would only get EAGAIN, so the remainder waits for the next POLLOUT.
+	 */
+	total_written = 0;
+	while (total_written < iovsz &&
+	       (size_t)num >= iov[total_written].iov_len) {
+		num -= iov[total_written].iov_len;
+		total_written++;
+	}
+
+	if (total_written < iovsz) {
+		atomic_fetch_add_explicit(&peer->write_blocked, 1,
+					  memory_order_relaxed);
+		stream_forward_getp(ostreams[total_written], num);
+	}
 
 	/* Handle statistics */
 	for (unsigned int i = 0; i < total_written; i++) {
@@ -460,6 +453,7 @@ static uint16_t bgp_write(struct peer_connection *connection)
 			 * to Connect instead of Idle.
 			 */
 			BGP_EVENT_ADD(connection, BGP_Stop);
+			stream_fifo_push(sent, s);
 			goto done;
 
 		case BGP_MSG_KEEPALIVE:
@@ -477,7 +471,7 @@ static uint16_t bgp_write(struct peer_connection *connection)
 			break;
 		}
 
-		stream_free(s);
+		stream_fifo_push(sent, s);
 		ostreams[i] = NULL;
 		update_last_write = 1;
 	}
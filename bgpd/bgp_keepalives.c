@@ -7,13 +7,17 @@
 
 /* clang-format off */
 #include <zebra.h>
-#include <pthread.h>		// for pthread_mutex_lock, pthread_mutex_unlock
+#include <pthread.h>		// for pthread_join
 
+#include "atomlist.h"		// for DECLARE_ATOMLIST
 #include "frr_pthread.h"        // for frr_pthread
+#include "frratomic.h"		// for atomic_fetch_or_explicit...
 #include "hash.h"		// for hash, hash_clean, hash_create_size...
 #include "log.h"		// for zlog_debug
 #include "memory.h"		// for MTYPE_TMP, XFREE, XCALLOC, XMALLOC
 #include "monotime.h"		// for monotime, monotime_since
+#include "seqlock.h"		// for seqlock_bump, seqlock_timedwait...
+#include "typesafe.h"		// for DECLARE_HEAP
 
 #include "bgpd/bgpd.h"          // for peer, PEER_EVENT_KEEPALIVES_ON, peer...
 #include "bgpd/bgp_debug.h"	// for bgp_debug_neighbor_events
@@ -22,30 +26,71 @@
 /* clang-format on */
 
 DEFINE_MTYPE_STATIC(BGPD, BGP_PKAT, "Peer KeepAlive Timer");
-DEFINE_MTYPE_STATIC(BGPD, BGP_COND, "BGP Peer pthread Conditional");
-DEFINE_MTYPE_STATIC(BGPD, BGP_MUTEX, "BGP Peer pthread Mutex");
+
+PREDECL_HEAP(pkat_heap);
+PREDECL_ATOMLIST(pkat_handover);
 
 /*
  * Peer KeepAlive Timer.
- * Associates a peer with the time of its last keepalive.
+ * Associates a peer with the time its next keepalive is due.
+ *
+ * The main pthread creates it and hands it over on pkat_incoming; from
+ * then on only the keepalives pthread looks at the schedule, without
+ * locks. To stop, the main pthread sets PKAT_STOPPED and gives up its
+ * reference on the peer; the keepalives pthread never touches the peer of
+ * a stopped pkat. If a keepalive is being sent at that moment
+ * (PKAT_SENDING), the main pthread sleeps on pkat_sent_seq until it has
+ * gone out and frees the pkat itself; otherwise the keepalives pthread
+ * frees it once it comes up in the schedule.
  */
 struct pkat {
 	/* the peer to send keepalives to */
 	struct peer *peer;
-	/* absolute time of last keepalive sent */
-	struct timeval last;
+	/* absolute monotonic time of the next keepalive, in usec */
+	int64_t due;
+
+	_Atomic uint32_t state;
+#define PKAT_SENDING (1U << 0)
+#define PKAT_STOPPED (1U << 1)
+
+	struct pkat_heap_item heap_item;
+	struct pkat_handover_item handover_item;
 };
 
-/* List of peers we are sending keepalives for, and associated mutex. */
-static pthread_mutex_t *peerhash_mtx;
-static pthread_cond_t *peerhash_cond;
+static int pkat_cmp(const struct pkat *a, const struct pkat *b)
+{
+	return numcmp(a->due, b->due);
+}
+
+DECLARE_HEAP(pkat_heap, struct pkat, heap_item, pkat_cmp);
+DECLARE_ATOMLIST(pkat_handover, struct pkat, handover_item);
+
+/* Peers we are sending keepalives for; main pthread only. */
 static struct hash *peerhash;
 
+/* Peers handed to the keepalives pthread, and their schedule. */
+static struct pkat_handover_head pkat_incoming;
+static struct pkat_heap_head pkat_schedule;
+
+/* Bumped to wake the keepalives pthread up. */
+static struct seqlock pkat_seq;
+
+/* Bumped by the keepalives pthread once a stopped pkat is done sending. */
+static struct seqlock pkat_sent_seq;
+
+static int64_t pkat_now(void)
+{
+	struct timeval now;
+
+	monotime(&now);
+	return now.tv_sec * 1000000LL + now.tv_usec;
+}
+
 static struct pkat *pkat_new(struct peer *peer)
 {
-	struct pkat *pkat = XMALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	struct pkat *pkat = XCALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+
 	pkat->peer = peer;
-	monotime(&pkat->last);
 	return pkat;
 }
 
@@ -54,69 +99,56 @@ static void pkat_del(void *pkat)
 	XFREE(MTYPE_BGP_PKAT, pkat);
 }
 
-
 /*
- * Callback for hash_iterate. Determines if a peer needs a keepalive and if so,
- * generates and sends it.
- *
- * For any given peer, if the elapsed time since its last keepalive exceeds its
- * configured keepalive timer, a keepalive is sent to the peer and its
- * last-sent time is reset. Additionally, If the elapsed time does not exceed
- * the configured keepalive timer, but the time until the next keepalive is due
- * is within a hardcoded tolerance, a keepalive is sent as if the configured
- * timer was exceeded. Doing this helps alleviate nanosecond sleeps between
- * ticks by grouping together peers who are due for keepalives at roughly the
- * same time. This tolerance value is arbitrarily chosen to be 100ms.
+ * Sends a keepalive to a peer that is due and puts it back into the
+ * schedule.
  *
- * In addition, this function calculates the maximum amount of time that the
- * keepalive thread can sleep before another tick needs to take place. This is
- * equivalent to shortest time until a keepalive is due for any one peer.
- *
- * @return maximum time to wait until next update (0 if infinity)
+ * Peers that are due within a hardcoded tolerance are sent their keepalive
+ * along with those that are due now. Doing this helps alleviate nanosecond
+ * sleeps between ticks by grouping together peers who are due for
+ * keepalives at roughly the same time. This tolerance value is arbitrarily
+ * chosen to be 100ms.
  */
-static void peer_process(struct hash_bucket *hb, void *arg)
-{
-	struct pkat *pkat = hb->data;
-
-	struct timeval *next_update = arg;
-
-	static struct timeval elapsed;  // elapsed time since keepalive
-	static struct timeval ka = {0}; // peer->v_keepalive as a timeval
-	static struct timeval diff;     // ka - elapsed
-
-	static const struct timeval tolerance = {0, 100000};
-
-	uint32_t v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
-					     memory_order_relaxed);
+#define PKAT_TOLERANCE 100000
 
-	/* 0 keepalive timer means no keepalives */
-	if (v_ka == 0)
+static void peer_process(struct pkat *pkat, int64_t now)
+{
+	uint32_t expected = 0;
+	uint32_t v_ka;
+
+	if (!atomic_compare_exchange_strong_explicit(&pkat->state, &expected,
+						     PKAT_SENDING,
+						     memory_order_acq_rel,
+						     memory_order_acquire)) {
+		/* stopped, and the main pthread is done with it */
+		pkat_del(pkat);
 		return;
+	}
 
-	/* calculate elapsed time since last keepalive */
-	monotime_since(&pkat->last, &elapsed);
-
-	/* calculate difference between elapsed time and configured time */
-	ka.tv_sec = v_ka;
-	timersub(&ka, &elapsed, &diff);
-
-	int send_keepalive =
-		elapsed.tv_sec >= ka.tv_sec || timercmp(&diff, &tolerance, <);
+	v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
+				    memory_order_relaxed);
 
-	if (send_keepalive) {
+	/* 0 keepalive timer means no keepalives; look again in a second */
+	if (v_ka == 0) {
+		pkat->due = now + 1000000;
+	} else {
 		if (bgp_debug_keepalive(pkat->peer))
 			zlog_debug("%s [FSM] Timer (keepalive timer expire)",
 				   pkat->peer->host);
 
 		bgp_keepalive_send(pkat->peer->connection);
-		monotime(&pkat->last);
-		memset(&elapsed, 0, sizeof(elapsed));
-		diff = ka;
+		pkat->due = now + v_ka * 1000000LL;
+	}
+
+	if (atomic_fetch_and_explicit(&pkat->state, ~PKAT_SENDING,
+				      memory_order_acq_rel) &
+	    PKAT_STOPPED) {
+		/* the main pthread is waiting for us and frees it */
+		seqlock_bump(&pkat_sent_seq);
+		return;
 	}
 
-	/* if calculated next update for this peer < current delay, use it */
-	if (next_update->tv_sec < 0 || timercmp(&diff, next_update, <))
-		*next_update = diff;
+	pkat_heap_add(&pkat_schedule, pkat);
 }
 
 static bool peer_hash_cmp(const void *f, const void *s)
@@ -136,14 +168,16 @@ static unsigned int peer_hash_key(const void *arg)
 /* Cleanup handler / deinitializer. */
 static void bgp_keepalives_finish(void *arg)
 {
-	hash_clean_and_free(&peerhash, pkat_del);
+	struct pkat *pkat;
 
-	pthread_mutex_unlock(peerhash_mtx);
-	pthread_mutex_destroy(peerhash_mtx);
-	pthread_cond_destroy(peerhash_cond);
+	/* everything still around is on one of these, exactly once */
+	while ((pkat = pkat_handover_pop(&pkat_incoming)))
+		pkat_del(pkat);
+	while ((pkat = pkat_heap_pop(&pkat_schedule)))
+		pkat_del(pkat);
 
-	XFREE(MTYPE_BGP_MUTEX, peerhash_mtx);
-	XFREE(MTYPE_BGP_COND, peerhash_cond);
+	pkat_heap_fini(&pkat_schedule);
+	hash_clean_and_free(&peerhash, NULL);
 }
 
 /*
@@ -154,10 +188,10 @@ void *bgp_keepalives_start(void *arg)
 	struct frr_pthread *fpt = arg;
 	frr_event_loop_set_pthread_owner(fpt->master, pthread_self());
 
-	struct timeval currtime = {0, 0};
-	struct timeval aftertime = {0, 0};
-	struct timeval next_update = {0, 0};
 	struct timespec next_update_ts = {0, 0};
+	seqlock_val_t seen;
+	struct pkat *pkat;
+	int64_t now;
 
 	/*
 	 * The RCU mechanism for each pthread is initialized in a "locked"
@@ -168,18 +202,12 @@ void *bgp_keepalives_start(void *arg)
 	 */
 	rcu_read_unlock();
 
-	peerhash_mtx = XCALLOC(MTYPE_BGP_MUTEX, sizeof(pthread_mutex_t));
-	peerhash_cond = XCALLOC(MTYPE_BGP_COND, sizeof(pthread_cond_t));
-
-	/* initialize mutex */
-	pthread_mutex_init(peerhash_mtx, NULL);
-
-	/* use monotonic clock with condition variable */
-	pthread_condattr_t attrs;
-	pthread_condattr_init(&attrs);
-	pthread_condattr_setclock(&attrs, CLOCK_MONOTONIC);
-	pthread_cond_init(peerhash_cond, &attrs);
-	pthread_condattr_destroy(&attrs);
+	seqlock_init(&pkat_seq);
+	seqlock_acquire_val(&pkat_seq, SEQLOCK_STARTVAL);
+	seqlock_init(&pkat_sent_seq);
+	seqlock_acquire_val(&pkat_sent_seq, SEQLOCK_STARTVAL);
+	pkat_handover_init(&pkat_incoming);
+	pkat_heap_init(&pkat_schedule);
 
 	/*
 	 * We are not using normal FRR pthread mechanics and are
@@ -189,7 +217,6 @@ void *bgp_keepalives_start(void *arg)
 
 	/* initialize peer hashtable */
 	peerhash = hash_create_size(2048, peer_hash_key, peer_hash_cmp, NULL);
-	pthread_mutex_lock(peerhash_mtx);
 
 	/* register cleanup handler */
 	pthread_cleanup_push(&bgp_keepalives_finish, NULL);
@@ -198,27 +225,33 @@ void *bgp_keepalives_start(void *arg)
 	frr_pthread_notify_running(fpt);
 
 	while (atomic_load_explicit(&fpt->running, memory_order_relaxed)) {
-		if (peerhash->count > 0)
-			pthread_cond_timedwait(peerhash_cond, peerhash_mtx,
-					       &next_update_ts);
-		else
-			while (peerhash->count == 0
-			       && atomic_load_explicit(&fpt->running,
-						       memory_order_relaxed))
-				pthread_cond_wait(peerhash_cond, peerhash_mtx);
+		/* anything handed over after this wakes us up again */
+		seen = seqlock_cur(&pkat_seq);
 
-		monotime(&currtime);
+		now = pkat_now();
 
-		next_update.tv_sec = -1;
+		/* new peers come with their first keepalive scheduled */
+		while ((pkat = pkat_handover_pop(&pkat_incoming)))
+			pkat_heap_add(&pkat_schedule, pkat);
 
-		hash_iterate(peerhash, peer_process, &next_update);
-		if (next_update.tv_sec == -1)
-			memset(&next_update, 0, sizeof(next_update));
+		/* and only peers that are due are looked at */
+		while ((pkat = pkat_heap_first(&pkat_schedule)) &&
+		       pkat->due <= now + PKAT_TOLERANCE) {
+			pkat_heap_pop(&pkat_schedule);
+			peer_process(pkat, now);
+		}
+
+		pkat = pkat_heap_first(&pkat_schedule);
+		if (!pkat) {
+			seqlock_wait(&pkat_seq, seen);
+			continue;
+		}
 
-		monotime_since(&currtime, &aftertime);
+		/* monotime() and seqlock_timedwait() share CLOCK_MONOTONIC */
+		next_update_ts.tv_sec = pkat->due / 1000000;
+		next_update_ts.tv_nsec = (pkat->due % 1000000) * 1000;
 
-		timeradd(&currtime, &next_update, &next_update);
-		TIMEVAL_TO_TIMESPEC(&next_update, &next_update_ts);
+		seqlock_timedwait(&pkat_seq, seen, &next_update_ts);
 	}
 
 	/* clean up */
@@ -239,25 +272,30 @@ void bgp_keepalives_on(struct peer_connection *connection)
 	/* placeholder bucket data to use for fast key lookups */
 	static struct pkat holder = {0};
 
-	/*
-	 * We need to ensure that bgp_keepalives_init was called first
-	 */
-	assert(peerhash_mtx);
+	if (CHECK_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON))
+		return;
 
-	frr_with_mutex (peerhash_mtx) {
-		if (CHECK_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON))
-			return;
+	holder.peer = peer;
+	if (!hash_lookup(peerhash, &holder)) {
+		struct pkat *pkat = pkat_new(peer);
+		uint32_t v_ka = atomic_load_explicit(&peer->v_keepalive,
+						     memory_order_relaxed);
 
-		holder.peer = peer;
-		if (!hash_lookup(peerhash, &holder)) {
-			struct pkat *pkat = pkat_new(peer);
-			(void)hash_get(peerhash, pkat, hash_alloc_intern);
-			peer_lock(peer);
-		}
-		SET_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON);
-		/* Force the keepalive thread to wake up */
-		pthread_cond_signal(peerhash_cond);
+		/*
+		 * bgp_fsm_open() has just sent a keepalive, so the first
+		 * one from us is due an interval later; 0 means none, and
+		 * is looked at again in a second as in peer_process().
+		 */
+		pkat->due = pkat_now() + (v_ka ? v_ka : 1) * 1000000LL;
+
+		(void)hash_get(peerhash, pkat, hash_alloc_intern);
+		peer_lock(peer);
+
+		pkat_handover_add_tail(&pkat_incoming, pkat);
 	}
+	SET_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON);
+	/* Force the keepalive thread to wake up */
+	seqlock_bump(&pkat_seq);
 }
 
 void bgp_keepalives_off(struct peer_connection *connection)
@@ -270,34 +308,41 @@ void bgp_keepalives_off(struct peer_connection *connection)
 	/* placeholder bucket data to use for fast key lookups */
 	static struct pkat holder = {0};
 
-	/*
-	 * We need to ensure that bgp_keepalives_init was called first
-	 */
-	assert(peerhash_mtx);
-
-	frr_with_mutex (peerhash_mtx) {
-		if (!CHECK_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON))
-			return;
+	if (!CHECK_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON))
+		return;
 
-		holder.peer = peer;
-		struct pkat *res = hash_release(peerhash, &holder);
-		if (res) {
+	holder.peer = peer;
+	struct pkat *res = hash_release(peerhash, &holder);
+	if (res) {
+		/*
+		 * No keepalive may be queued once this returns: if one is
+		 * being sent right now, wait for it; that is a stream_new()
+		 * and a write scheduled on the I/O pthread. The keepalives
+		 * pthread only bumps pkat_sent_seq after it has seen
+		 * PKAT_STOPPED, so reading it first cannot miss that bump.
+		 */
+		seqlock_val_t seen = seqlock_cur(&pkat_sent_seq);
+
+		if (atomic_fetch_or_explicit(&res->state, PKAT_STOPPED,
+					     memory_order_acq_rel) &
+		    PKAT_SENDING) {
+			while (atomic_load_explicit(&res->state,
+						    memory_order_acquire) &
+			       PKAT_SENDING)
+				seqlock_wait(&pkat_sent_seq, seen);
 			pkat_del(res);
-			peer_unlock(peer);
 		}
-		UNSET_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON);
+		peer_unlock(peer);
 	}
+	UNSET_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON);
 }
 
 int bgp_keepalives_stop(struct frr_pthread *fpt, void **result)
 {
 	assert(fpt->running);
 
-	frr_with_mutex (peerhash_mtx) {
-		atomic_store_explicit(&fpt->running, false,
-				      memory_order_relaxed);
-		pthread_cond_signal(peerhash_cond);
-	}
+	atomic_store_explicit(&fpt->running, false, memory_order_relaxed);
+	seqlock_bump(&pkat_seq);
 
 	pthread_join(fpt->thread, result);
 	return 0;
@@ -49,8 +49,10 @@ extern void bgp_keepalives_init(void);
 /**
  * Entry function for keepalives pthread.
  *
- * This function loops over an internal list of peers, generating keepalives at
- * regular intervals as determined by each peer's keepalive timer.
+ * This function keeps peers in a schedule ordered by when their next
+ * keepalive is due, and on each tick only generates keepalives for those
+ * that are due, at intervals determined by each peer's keepalive timer.
+ * Peers are handed to it and woken up without taking any lock.
  *
  * See bgp_keepalives_on() for additional details.
  *
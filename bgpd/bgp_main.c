@@ -62,6 +62,8 @@ DEFINE_HOOK(bgp_hook_config_write_vrf, (struct vty *vty, struct vrf *vrf),
 DEFINE_HOOK(bgp_hook_vrf_update, (struct vrf *vrf, bool enabled),
 	    (vrf, enabled));
 
+#define OPTION_ZAPI_RING 2000
+
 /* bgpd options, we use GNU getopt library. */
 static const struct option longopts[] = { { "bgp_port", required_argument, NULL, 'p' },
 					  { "listenon", required_argument, NULL, 'l' },
@@ -72,6 +74,7 @@ static const struct option longopts[] = { { "bgp_port", required_argument, NULL,
 					  { "no_zebra", no_argument, NULL, 'Z' },
 					  { "socket_size", required_argument, NULL, 's' },
 					  { "v6-with-v4-nexthops", no_argument, NULL, 'x' },
+					  { "zapi-ring", required_argument, NULL, OPTION_ZAPI_RING },
 					  { 0 } };
 
 /* signal definitions */
@@ -415,6 +418,7 @@ int main(int argc, char **argv)
 	char *address;
 	struct listnode *node;
 	bool v6_with_v4_nexthops = false;
+	unsigned long zapi_ring_mb = 0;
 
 	addresses->cmp = (int (*)(void *, void *))strcmp;
 
@@ -428,7 +432,8 @@ int main(int argc, char **argv)
 		    "  -e, --ecmp               Specify ECMP to use.\n"
 		    "  -I, --int_num            Set instance number (label-manager)\n"
 		    "  -s, --socket_size        Set BGP peer socket send buffer size\n"
-		    "  -x, --v6-with-v4-nexthop Allow BGP to form v6 neighbors using v4 nexthops\n");
+		    "  -x, --v6-with-v4-nexthop Allow BGP to form v6 neighbors using v4 nexthops\n"
+		    "      --zapi-ring          Send to Zebra over a shared memory ring of this many MiB\n");
 
 	/* Command line argument treatment. */
 	while (1) {
@@ -494,6 +499,14 @@ int main(int argc, char **argv)
 		case 'x':
 			v6_with_v4_nexthops = true;
 			break;
+		case OPTION_ZAPI_RING:
+			zapi_ring_mb = strtoul(optarg, NULL, 10);
+			if (zapi_ring_mb < 1 || zapi_ring_mb > 256) {
+				fprintf(stderr,
+					"The ZAPI ring size must be between 1 and 256 MiB\n");
+				return 1;
+			}
+			break;
 		default:
 			frr_help_exit(1);
 		}
@@ -507,6 +520,7 @@ int main(int argc, char **argv)
 	bm->startup_time = monotime(NULL);
 	bm->port = bgp_port;
 	bm->v6_with_v4_nexthops = v6_with_v4_nexthops;
+	bm->zapi_ring_size = zapi_ring_mb * 1024 * 1024;
 	if (bgp_port == 0)
 		bgp_option_set(BGP_OPT_NO_LISTEN);
 	if (no_fib_flag || no_zebra_flag)
@@ -28,6 +28,7 @@ DEFINE_MTYPE(BGPD, PEER_PASSWORD, "Peer password string");
 DEFINE_MTYPE(BGPD, BGP_PEER_AF, "BGP peer af");
 DEFINE_MTYPE(BGPD, BGP_UPDGRP, "BGP update group");
 DEFINE_MTYPE(BGPD, BGP_UPD_SUBGRP, "BGP update subgroup");
+DEFINE_MTYPE(BGPD, BGP_UPDGRP_ATTR_ENC, "BGP update group encoded attributes");
 DEFINE_MTYPE(BGPD, BGP_PACKET, "BGP packet");
 DEFINE_MTYPE(BGPD, ATTR, "BGP attribute");
 DEFINE_MTYPE(BGPD, AS_PATH, "BGP aspath");
@@ -43,6 +44,7 @@ DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_EVPN, "BGP extra info for EVPN");
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_FS, "BGP extra info for flowspec");
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_VRFLEAK, "BGP extra info for vrf leaking");
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_VNC, "BGP extra info for vnc");
+DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_MPLSVPN, "BGP extra info for MPLS VPN labels");
 DEFINE_MTYPE(BGPD, BGP_CONN, "BGP connected");
 DEFINE_MTYPE(BGPD, BGP_STATIC, "BGP static");
 DEFINE_MTYPE(BGPD, BGP_ADVERTISE_ATTR, "BGP adv attr");
@@ -24,6 +24,7 @@ DECLARE_MTYPE(PEER_PASSWORD);
 DECLARE_MTYPE(BGP_PEER_AF);
 DECLARE_MTYPE(BGP_UPDGRP);
 DECLARE_MTYPE(BGP_UPD_SUBGRP);
+DECLARE_MTYPE(BGP_UPDGRP_ATTR_ENC);
 DECLARE_MTYPE(BGP_PACKET);
 DECLARE_MTYPE(ATTR);
 DECLARE_MTYPE(AS_PATH);
@@ -39,6 +40,7 @@ DECLARE_MTYPE(BGP_ROUTE_EXTRA_EVPN);
 DECLARE_MTYPE(BGP_ROUTE_EXTRA_FS);
 DECLARE_MTYPE(BGP_ROUTE_EXTRA_VRFLEAK);
 DECLARE_MTYPE(BGP_ROUTE_EXTRA_VNC);
+DECLARE_MTYPE(BGP_ROUTE_EXTRA_MPLSVPN);
 DECLARE_MTYPE(BGP_CONN);
 DECLARE_MTYPE(BGP_STATIC);
 DECLARE_MTYPE(BGP_ADVERTISE_ATTR);
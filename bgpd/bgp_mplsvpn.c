@@ -1459,6 +1459,18 @@ leak_update(struct bgp *to_bgp, struct bgp_dest *bn,
 	return new;
 }
 
+/* Get the MPLS VPN label state of a path, allocated if required */
+static union bgp_path_info_extra_mplsvpn *
+bgp_mplsvpn_path_info_get(struct bgp_path_info *pi)
+{
+	struct bgp_path_info_extra *extra = bgp_path_info_extra_get(pi);
+
+	if (!extra->mplsvpn)
+		extra->mplsvpn = XCALLOC(MTYPE_BGP_ROUTE_EXTRA_MPLSVPN,
+					 sizeof(union bgp_path_info_extra_mplsvpn));
+	return extra->mplsvpn;
+}
+
 void bgp_mplsvpn_path_nh_label_unlink(struct bgp_path_info *pi)
 {
 	struct bgp_label_per_nexthop_cache *blnc;
@@ -1466,17 +1478,18 @@ void bgp_mplsvpn_path_nh_label_unlink(struct bgp_path_info *pi)
 	if (!pi)
 		return;
 
-	if (!CHECK_FLAG(pi->flags, BGP_PATH_MPLSVPN_LABEL_NH))
+	if (!CHECK_FLAG(pi->flags, BGP_PATH_MPLSVPN_LABEL_NH) || !pi->extra ||
+	    !pi->extra->mplsvpn)
 		return;
 
-	blnc = pi->mplsvpn.blnc.label_nexthop_cache;
+	blnc = pi->extra->mplsvpn->blnc.label_nexthop_cache;
 
 	if (!blnc)
 		return;
 
-	LIST_REMOVE(pi, mplsvpn.blnc.label_nh_thread);
-	pi->mplsvpn.blnc.label_nexthop_cache->path_count--;
-	pi->mplsvpn.blnc.label_nexthop_cache = NULL;
+	LIST_REMOVE(pi, extra->mplsvpn->blnc.label_nh_thread);
+	blnc->path_count--;
+	pi->extra->mplsvpn->blnc.label_nexthop_cache = NULL;
 	UNSET_FLAG(pi->flags, BGP_PATH_MPLSVPN_LABEL_NH);
 
 	if (LIST_EMPTY(&(blnc->paths)))
@@ -1520,7 +1533,7 @@ static int bgp_mplsvpn_get_label_per_nexthop_cb(mpls_label_t label,
 					     blnc->nh->vrf_id, ZEBRA_LSP_BGP,
 					     &blnc->nexthop, 0, NULL);
 
-	LIST_FOREACH (pi, &(blnc->paths), mplsvpn.blnc.label_nh_thread) {
+	LIST_FOREACH (pi, &(blnc->paths), extra->mplsvpn->blnc.label_nh_thread) {
 		if (!pi->net)
 			continue;
 		table = bgp_dest_table(pi->net);
@@ -1545,6 +1558,7 @@ _vpn_leak_from_vrf_get_per_nexthop_label(struct bgp_path_info *pi,
 	struct bgp_nexthop_cache *bnc = pi->nexthop;
 	struct bgp_label_per_nexthop_cache *blnc;
 	struct bgp_label_per_nexthop_cache_head *tree;
+	union bgp_path_info_extra_mplsvpn *mplsvpn;
 	struct prefix *nh_pfx = NULL;
 	struct prefix nh_gate = {0};
 
@@ -1587,7 +1601,8 @@ _vpn_leak_from_vrf_get_per_nexthop_label(struct bgp_path_info *pi,
 			   bgp_mplsvpn_get_label_per_nexthop_cb);
 	}
 
-	if (pi->mplsvpn.blnc.label_nexthop_cache == blnc)
+	mplsvpn = bgp_mplsvpn_path_info_get(pi);
+	if (mplsvpn->blnc.label_nexthop_cache == blnc)
 		/* no change */
 		return blnc->label;
 
@@ -1596,9 +1611,9 @@ _vpn_leak_from_vrf_get_per_nexthop_label(struct bgp_path_info *pi,
 	bgp_mplsvpn_path_nh_label_unlink(pi);
 
 	/* updates NHT pi list reference */
-	LIST_INSERT_HEAD(&(blnc->paths), pi, mplsvpn.blnc.label_nh_thread);
-	pi->mplsvpn.blnc.label_nexthop_cache = blnc;
-	pi->mplsvpn.blnc.label_nexthop_cache->path_count++;
+	LIST_INSERT_HEAD(&(blnc->paths), pi, extra->mplsvpn->blnc.label_nh_thread);
+	mplsvpn->blnc.label_nexthop_cache = blnc;
+	blnc->path_count++;
 	SET_FLAG(pi->flags, BGP_PATH_MPLSVPN_LABEL_NH);
 	blnc->last_update = monotime(NULL);
 
@@ -4480,7 +4495,10 @@ mpls_label_t bgp_mplsvpn_nh_label_bind_get_label(struct bgp_path_info *pi)
 	mpls_label_t label;
 	struct bgp_mplsvpn_nh_label_bind_cache *bmnc;
 
-	bmnc = pi->mplsvpn.bmnc.nh_label_bind_cache;
+	if (!pi->extra || !pi->extra->mplsvpn)
+		return MPLS_INVALID_LABEL;
+
+	bmnc = pi->extra->mplsvpn->bmnc.nh_label_bind_cache;
 	if (!bmnc || bmnc->new_label == MPLS_INVALID_LABEL)
 		/* allocation in progress
 		 * or path not eligible for local label
@@ -4532,7 +4550,7 @@ static int bgp_mplsvpn_nh_label_bind_get_local_label_cb(mpls_label_t label,
 		bgp_mplsvpn_nh_label_bind_send_nexthop_label(
 			bmnc, ZEBRA_MPLS_LABELS_ADD);
 
-	LIST_FOREACH (pi, &(bmnc->paths), mplsvpn.bmnc.nh_label_bind_thread) {
+	LIST_FOREACH (pi, &(bmnc->paths), extra->mplsvpn->bmnc.nh_label_bind_thread) {
 		/* we can advertise it */
 		if (!pi->net)
 			continue;
@@ -4553,17 +4571,18 @@ void bgp_mplsvpn_path_nh_label_bind_unlink(struct bgp_path_info *pi)
 	if (!pi)
 		return;
 
-	if (!CHECK_FLAG(pi->flags, BGP_PATH_MPLSVPN_NH_LABEL_BIND))
+	if (!CHECK_FLAG(pi->flags, BGP_PATH_MPLSVPN_NH_LABEL_BIND) ||
+	    !pi->extra || !pi->extra->mplsvpn)
 		return;
 
-	bmnc = pi->mplsvpn.bmnc.nh_label_bind_cache;
+	bmnc = pi->extra->mplsvpn->bmnc.nh_label_bind_cache;
 
 	if (!bmnc)
 		return;
 
-	LIST_REMOVE(pi, mplsvpn.bmnc.nh_label_bind_thread);
-	pi->mplsvpn.bmnc.nh_label_bind_cache->path_count--;
-	pi->mplsvpn.bmnc.nh_label_bind_cache = NULL;
+	LIST_REMOVE(pi, extra->mplsvpn->bmnc.nh_label_bind_thread);
+	bmnc->path_count--;
+	pi->extra->mplsvpn->bmnc.nh_label_bind_cache = NULL;
 	SET_FLAG(pi->flags, BGP_PATH_MPLSVPN_NH_LABEL_BIND);
 
 	if (LIST_EMPTY(&(bmnc->paths)))
@@ -4576,6 +4595,7 @@ void bgp_mplsvpn_nh_label_bind_register_local_label(struct bgp *bgp,
 {
 	struct bgp_mplsvpn_nh_label_bind_cache *bmnc;
 	struct bgp_mplsvpn_nh_label_bind_cache_head *tree;
+	union bgp_path_info_extra_mplsvpn *mplsvpn;
 	mpls_label_t label;
 
 	label = BGP_PATH_INFO_NUM_LABELS(pi)
@@ -4593,16 +4613,17 @@ void bgp_mplsvpn_nh_label_bind_register_local_label(struct bgp *bgp,
 			   bgp_mplsvpn_nh_label_bind_get_local_label_cb);
 	}
 
-	if (pi->mplsvpn.bmnc.nh_label_bind_cache == bmnc)
+	mplsvpn = bgp_mplsvpn_path_info_get(pi);
+	if (mplsvpn->bmnc.nh_label_bind_cache == bmnc)
 		/* no change */
 		return;
 
 	bgp_mplsvpn_path_nh_label_bind_unlink(pi);
 
 	/* updates NHT pi list reference */
-	LIST_INSERT_HEAD(&(bmnc->paths), pi, mplsvpn.bmnc.nh_label_bind_thread);
-	pi->mplsvpn.bmnc.nh_label_bind_cache = bmnc;
-	pi->mplsvpn.bmnc.nh_label_bind_cache->path_count++;
+	LIST_INSERT_HEAD(&(bmnc->paths), pi, extra->mplsvpn->bmnc.nh_label_bind_thread);
+	mplsvpn->bmnc.nh_label_bind_cache = bmnc;
+	bmnc->path_count++;
 	SET_FLAG(pi->flags, BGP_PATH_MPLSVPN_NH_LABEL_BIND);
 	bmnc->last_update = monotime(NULL);
 
@@ -4652,7 +4673,7 @@ static void show_bgp_mplsvpn_nh_label_bind_internal(struct vty *vty,
 			continue;
 		vty_out(vty, "  Paths:\n");
 		LIST_FOREACH (path, &(iter->paths),
-			      mplsvpn.bmnc.nh_label_bind_thread) {
+			      extra->mplsvpn->bmnc.nh_label_bind_thread) {
 			dest = path->net;
 			table = bgp_dest_table(dest);
 			assert(dest && table);
@@ -498,10 +498,9 @@ int bgp_find_or_add_nexthop(struct bgp *bgp_route, struct bgp *bgp_nexthop, afi_
 			SET_FLAG(bnc->flags, BGP_NEXTHOP_ULTIMATE);
 
 		if (CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID) && bnc->metric)
-			(bgp_path_info_extra_get(bpi_ultimate))->igpmetric =
-				bnc->metric;
-		else if (bpi_ultimate->extra)
-			bpi_ultimate->extra->igpmetric = 0;
+			bpi_ultimate->igpmetric = bnc->metric;
+		else
+			bpi_ultimate->igpmetric = 0;
 	} else if (peer) {
 		/*
 		 * Let's not accidentally save the peer data for a peer
@@ -1453,10 +1452,9 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 		 * computation */
 		bpi_ultimate = bgp_get_imported_bpi_ultimate(path);
 		if (bgp_isvalid_nexthop(bnc) && bnc->metric)
-			(bgp_path_info_extra_get(bpi_ultimate))->igpmetric =
-				bnc->metric;
-		else if (bpi_ultimate->extra)
-			bpi_ultimate->extra->igpmetric = 0;
+			bpi_ultimate->igpmetric = bnc->metric;
+		else
+			bpi_ultimate->igpmetric = 0;
 
 		if (CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_METRIC_CHANGED) ||
 		    CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_CHANGED) ||
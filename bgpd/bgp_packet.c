@@ -47,6 +47,7 @@
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_label.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_trace.h"
@@ -57,6 +58,9 @@ DEFINE_HOOK(bgp_packet_dump,
 			struct stream *s),
 		(peer, type, size, s));
 
+DEFINE_HOOK(bgp_packet_processed, (struct peer *peer, struct stream **s),
+	    (peer, s));
+
 DEFINE_HOOK(bgp_packet_send,
 		(struct peer *peer, uint8_t type, bgp_size_t size,
 			struct stream *s),
@@ -4039,6 +4043,18 @@ int bgp_capability_receive(struct peer_connection *connection,
 	return bgp_capability_msg_parse(peer, pnt, size);
 }
 
+/*
+ * Frees the packet being processed on a connection, whether processing
+ * is done with it or it is dropped halfway through, e.g. by bgp_stop().
+ * bgp_packet_processed handlers see it first and may take it over.
+ */
+void bgp_packet_curr_free(struct peer_connection *connection)
+{
+	hook_call(bgp_packet_processed, connection->peer, &connection->curr);
+	stream_free(connection->curr);
+	connection->curr = NULL;
+}
+
 /**
  * Processes a peer's input buffer.
  *
@@ -4112,6 +4128,7 @@ void bgp_process_packet(struct event *event)
 		frr_with_mutex (&connection->io_mtx) {
 			rearm_reads = (bm->inq_limit && connection->ibuf->count >= bm->inq_limit);
 			connection->curr = stream_fifo_pop(connection->ibuf);
+			bgp_preparse_dequeue(connection);
 		}
 
 		if (rearm_reads)
@@ -4227,8 +4244,8 @@ void bgp_process_packet(struct event *event)
 		}
 
 		/* delete processed packet */
-		stream_free(connection->curr);
-		connection->curr = NULL;
+		bgp_preparse_release(connection);
+		bgp_packet_curr_free(connection);
 		processed++;
 		curr_connection_processed++;
 
@@ -19,6 +19,13 @@ DECLARE_HOOK(bgp_packet_dump,
 			struct stream *s),
 		(peer, type, size, s));
 
+/* called once a received packet has been processed, or is dropped halfway
+ * through, right before it is freed; a handler may keep the stream by
+ * setting *s to NULL
+ */
+DECLARE_HOOK(bgp_packet_processed, (struct peer *peer, struct stream **s),
+	     (peer, s));
+
 DECLARE_HOOK(bgp_packet_send,
 		(struct peer *peer, uint8_t type, bgp_size_t size,
 			struct stream *s),
@@ -78,6 +85,7 @@ extern void bgp_packet_set_size(struct stream *s);
 
 extern void bgp_generate_updgrp_packets(struct event *event);
 extern void bgp_process_packet(struct event *event);
+extern void bgp_packet_curr_free(struct peer_connection *connection);
 
 extern void bgp_send_delayed_eor(struct bgp *bgp);
 
@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parsing.
+ * Decodes parts of received UPDATEs on a pool of pthreads, ahead of
+ * their processing on the main pthread.
+ */
+
+/* clang-format off */
+#include <zebra.h>
+#include <pthread.h>
+
+#include "frr_pthread.h"
+#include "frratomic.h"
+#include "frrevent.h"
+#include "memory.h"
+#include "stream.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_preparse.h"
+/* clang-format on */
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_PREPARSE, "BGP UPDATE pre-parse");
+
+/*
+ * Life of a pre-parse: the I/O pthread creates it (PENDING) next to the
+ * packet on connection->preparse and hands it to a parser pthread. The
+ * parser pthread moves it to DONE once the result is stored; if the main
+ * pthread no longer wants it by then, the main pthread has moved it to
+ * ABANDONED instead, and the parser pthread frees it. Whichever side
+ * loses the race to change the state frees it.
+ */
+enum bgp_preparse_state {
+	BGP_PREPARSE_PENDING = 0,
+	BGP_PREPARSE_DONE,
+	BGP_PREPARSE_ABANDONED,
+};
+
+struct bgp_preparse {
+	struct bgp_preparse_fifo_item item;
+
+	/* the packet on connection->ibuf this belongs to; only compared */
+	const struct stream *pkt;
+
+	_Atomic uint32_t state;
+
+	/* inputs */
+	int use32bit;
+	enum asnotation_mode asnotation;
+	uint16_t length;
+
+	/* output, valid once DONE; NULL if malformed */
+	struct aspath *aspath;
+
+	/* AS_PATH attribute value */
+	uint8_t data[];
+};
+
+DECLARE_LIST(bgp_preparse_fifo, struct bgp_preparse, item);
+
+static struct frr_pthread *bgp_pth_parse[BGP_PREPARSE_THREADS_MAX];
+static unsigned int bgp_preparse_started;
+static bool bgp_preparse_running;
+/* number of parser pthreads the I/O pthread hands work to */
+static _Atomic uint32_t bgp_preparse_active;
+static uint32_t bgp_preparse_next;
+
+static void bgp_preparse_free(struct bgp_preparse *prep)
+{
+	aspath_free(prep->aspath);
+	XFREE(MTYPE_BGP_PREPARSE, prep);
+}
+
+/* Main pthread: give up on a pre-parse, whatever its state */
+static void bgp_preparse_abandon(struct bgp_preparse *prep)
+{
+	uint32_t expected = BGP_PREPARSE_PENDING;
+
+	if (atomic_compare_exchange_strong_explicit(&prep->state, &expected,
+						    BGP_PREPARSE_ABANDONED,
+						    memory_order_acq_rel,
+						    memory_order_acquire))
+		return;
+
+	bgp_preparse_free(prep);
+}
+
+/* Parser pthread */
+static void bgp_preparse_work(struct event *event)
+{
+	struct bgp_preparse *prep = EVENT_ARG(event);
+	uint32_t expected = BGP_PREPARSE_PENDING;
+	struct stream *s;
+
+	if (atomic_load_explicit(&prep->state, memory_order_acquire) ==
+	    BGP_PREPARSE_ABANDONED) {
+		bgp_preparse_free(prep);
+		return;
+	}
+
+	s = stream_new(prep->length);
+	stream_put(s, prep->data, prep->length);
+	prep->aspath = aspath_parse_detached(s, prep->length, prep->use32bit,
+					     prep->asnotation);
+	stream_free(s);
+
+	if (!atomic_compare_exchange_strong_explicit(&prep->state, &expected,
+						     BGP_PREPARSE_DONE,
+						     memory_order_acq_rel,
+						     memory_order_acquire))
+		bgp_preparse_free(prep);
+}
+
+static void bgp_preparse_start(unsigned int count)
+{
+	char name[32], os_name[OS_THREAD_NAMELEN];
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+
+	while (bgp_preparse_started < count) {
+		struct frr_pthread *fpt;
+
+		snprintf(name, sizeof(name), "BGP Parser thread %u",
+			 bgp_preparse_started);
+		snprintf(os_name, sizeof(os_name), "bgpd_parse%u",
+			 bgp_preparse_started);
+
+		fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(fpt, NULL);
+		frr_pthread_wait_running(fpt);
+
+		bgp_pth_parse[bgp_preparse_started++] = fpt;
+	}
+}
+
+void bgp_preparse_threads_set(unsigned int count)
+{
+	if (count > BGP_PREPARSE_THREADS_MAX)
+		count = BGP_PREPARSE_THREADS_MAX;
+
+	bm->update_parse_threads = count;
+
+	if (!bgp_preparse_running)
+		return;
+
+	bgp_preparse_start(count);
+	atomic_store_explicit(&bgp_preparse_active, count, memory_order_release);
+}
+
+void bgp_preparse_run(void)
+{
+	bgp_preparse_running = true;
+	bgp_preparse_threads_set(bm->update_parse_threads);
+}
+
+/*
+ * Find the AS_PATH attribute value in an UPDATE. Only lengths are
+ * looked at; everything else is left to bgp_attr_parse().
+ */
+static bool bgp_preparse_find_aspath(const struct stream *pkt,
+				     const uint8_t **value, uint16_t *length)
+{
+	const uint8_t *p = STREAM_DATA(pkt) + BGP_HEADER_SIZE;
+	const uint8_t *end = STREAM_DATA(pkt) + stream_get_endp(pkt);
+	size_t wlen, alen, hlen, vlen;
+
+	if (end - p < 2)
+		return false;
+	wlen = (p[0] << 8) | p[1];
+	p += 2;
+
+	if ((size_t)(end - p) < wlen + 2)
+		return false;
+	p += wlen;
+
+	alen = (p[0] << 8) | p[1];
+	p += 2;
+
+	if ((size_t)(end - p) < alen)
+		return false;
+	end = p + alen;
+
+	while (end - p >= 3) {
+		hlen = CHECK_FLAG(p[0], BGP_ATTR_FLAG_EXTLEN) ? 4 : 3;
+		if ((size_t)(end - p) < hlen)
+			return false;
+		vlen = hlen == 4 ? (p[2] << 8) | p[3] : p[2];
+
+		if ((size_t)(end - p) < hlen + vlen)
+			return false;
+
+		if (p[1] == BGP_ATTR_AS_PATH) {
+			*value = p + hlen;
+			*length = vlen;
+			return true;
+		}
+
+		p += hlen + vlen;
+	}
+
+	return false;
+}
+
+void bgp_preparse_connection_init(struct peer_connection *connection)
+{
+	bgp_preparse_fifo_init(&connection->preparse);
+	connection->curr_prep = NULL;
+}
+
+void bgp_preparse_queue(struct peer_connection *connection, struct stream *pkt)
+{
+	struct peer *peer = connection->peer;
+	struct bgp_preparse *prep;
+	const uint8_t *value;
+	uint16_t length;
+	uint32_t active;
+
+	active = atomic_load_explicit(&bgp_preparse_active,
+				      memory_order_acquire);
+	if (!active)
+		return;
+
+	if (stream_get_endp(pkt) <= BGP_HEADER_SIZE ||
+	    STREAM_DATA(pkt)[BGP_MARKER_SIZE + 2] != BGP_MSG_UPDATE)
+		return;
+
+	/* an empty AS_PATH is cheaper to parse than to hand off */
+	if (!bgp_preparse_find_aspath(pkt, &value, &length) || !length)
+		return;
+
+	prep = XCALLOC(MTYPE_BGP_PREPARSE, sizeof(*prep) + length);
+	prep->pkt = pkt;
+	prep->length = length;
+	memcpy(prep->data, value, length);
+	/*
+	 * Capabilities and the AS notation are settled long before UPDATEs
+	 * are exchanged; if they did change, the main pthread notices the
+	 * mismatch and parses the AS_PATH itself.
+	 */
+	prep->use32bit = CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV) &&
+			 CHECK_FLAG(peer->cap, PEER_CAP_AS4_ADV);
+	prep->asnotation = bgp_get_asnotation(peer->bgp);
+
+	bgp_preparse_fifo_add_tail(&connection->preparse, prep);
+
+	event_add_event(bgp_pth_parse[bgp_preparse_next++ % active]->master,
+			bgp_preparse_work, prep, 0, NULL);
+}
+
+void bgp_preparse_dequeue(struct peer_connection *connection)
+{
+	struct bgp_preparse *prep;
+
+	assert(!connection->curr_prep);
+
+	if (!connection->curr)
+		return;
+
+	/*
+	 * Pre-parses are kept in ibuf order and ibuf is only ever popped or
+	 * flushed here, so the head either belongs to curr or to a packet
+	 * still queued behind it.
+	 */
+	prep = bgp_preparse_fifo_first(&connection->preparse);
+	if (prep && prep->pkt == connection->curr)
+		connection->curr_prep = bgp_preparse_fifo_pop(&connection->preparse);
+}
+
+void bgp_preparse_release(struct peer_connection *connection)
+{
+	if (!connection->curr_prep)
+		return;
+
+	bgp_preparse_abandon(connection->curr_prep);
+	connection->curr_prep = NULL;
+}
+
+void bgp_preparse_flush(struct peer_connection *connection)
+{
+	struct bgp_preparse *prep;
+
+	while ((prep = bgp_preparse_fifo_pop(&connection->preparse)))
+		bgp_preparse_abandon(prep);
+
+	bgp_preparse_release(connection);
+}
+
+struct aspath *bgp_preparse_take_aspath(struct peer_connection *connection,
+					size_t length, int use32bit,
+					enum asnotation_mode asnotation)
+{
+	struct bgp_preparse *prep = connection->curr_prep;
+	struct aspath *aspath;
+
+	if (!prep)
+		return NULL;
+
+	/* not decoded yet; not worth waiting for */
+	if (atomic_load_explicit(&prep->state, memory_order_acquire) !=
+	    BGP_PREPARSE_DONE)
+		return NULL;
+
+	if (!prep->aspath || prep->use32bit != use32bit || prep->asnotation != asnotation)
+		return NULL;
+
+	/* make sure this is the attribute that was decoded */
+	if (prep->length != length ||
+	    STREAM_READABLE(connection->curr) < length ||
+	    memcmp(stream_pnt(connection->curr), prep->data, length))
+		return NULL;
+
+	aspath = prep->aspath;
+	prep->aspath = NULL;
+
+	return aspath;
+}
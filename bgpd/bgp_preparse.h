@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parsing.
+ * Decodes parts of received UPDATEs on a pool of pthreads, ahead of
+ * their processing on the main pthread.
+ */
+
+#ifndef _FRR_BGP_PREPARSE_H
+#define _FRR_BGP_PREPARSE_H
+
+#include "typesafe.h"
+#include "asn.h"
+
+#define BGP_PREPARSE_THREADS_MAX 64
+
+PREDECL_LIST(bgp_preparse_fifo);
+
+struct aspath;
+struct bgp_preparse;
+struct peer_connection;
+struct stream;
+
+/**
+ * Sets the number of parser pthreads; 0 turns pre-parsing off.
+ *
+ * Threads are started on demand and are kept until bgpd exits, lowering
+ * the count only stops handing work to the surplus ones. Before
+ * bgp_preparse_run() the count is only recorded.
+ */
+extern void bgp_preparse_threads_set(unsigned int count);
+
+/**
+ * Starts the configured parser pthreads. Called with the other bgpd
+ * pthreads, once the daemon has forked.
+ */
+extern void bgp_preparse_run(void);
+
+/**
+ * Sets up the pre-parse state of a new connection.
+ */
+extern void bgp_preparse_connection_init(struct peer_connection *connection);
+
+/**
+ * Hands a packet that was just framed to the parser pthreads.
+ *
+ * Called on the I/O pthread with connection->io_mtx held, right after
+ * pkt has been appended to connection->ibuf. Only UPDATEs carrying an
+ * AS_PATH are queued; the packet itself is not touched after this
+ * returns.
+ */
+extern void bgp_preparse_queue(struct peer_connection *connection,
+			       struct stream *pkt);
+
+/**
+ * Picks up the pre-parse work for connection->curr, the packet just
+ * taken off connection->ibuf. Called on the main pthread with
+ * connection->io_mtx held.
+ */
+extern void bgp_preparse_dequeue(struct peer_connection *connection);
+
+/**
+ * Drops the pre-parse work for connection->curr once it has been
+ * processed. Main pthread only.
+ */
+extern void bgp_preparse_release(struct peer_connection *connection);
+
+/**
+ * Drops all pre-parse work for a connection whose input queue is being
+ * emptied. Called on the main pthread with connection->io_mtx held.
+ */
+extern void bgp_preparse_flush(struct peer_connection *connection);
+
+/**
+ * Returns the AS_PATH decoded off-thread for the attribute at the
+ * current read position of connection->curr, or NULL if it is not ready
+ * or was decoded with other parameters. The caller owns the result; it
+ * is not interned, but has its string form built so that it can be
+ * passed straight to aspath_intern().
+ *
+ * The read position is not moved.
+ */
+extern struct aspath *bgp_preparse_take_aspath(struct peer_connection *connection,
+					       size_t length, int use32bit,
+					       enum asnotation_mode asnotation);
+
+#endif /* _FRR_BGP_PREPARSE_H */
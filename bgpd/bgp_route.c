@@ -381,6 +381,8 @@ void bgp_path_info_extra_free(struct bgp_path_info_extra **extra)
 		XFREE(MTYPE_BGP_ROUTE_EXTRA_FS, e->flowspec);
 	if (e->vrfleak)
 		XFREE(MTYPE_BGP_ROUTE_EXTRA_VRFLEAK, e->vrfleak);
+	if (e->mplsvpn)
+		XFREE(MTYPE_BGP_ROUTE_EXTRA_MPLSVPN, e->mplsvpn);
 #ifdef ENABLE_BGP_VNC
 	if (e->vnc)
 		XFREE(MTYPE_BGP_ROUTE_EXTRA_VNC, e->vnc);
@@ -1520,10 +1522,8 @@ int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	/* 8. IGP metric check. */
 	newm = existm = 0;
 
-	if (new->extra)
-		newm = new->extra->igpmetric;
-	if (exist->extra)
-		existm = exist->extra->igpmetric;
+	newm = new->igpmetric;
+	existm = exist->igpmetric;
 
 	if (newm < existm) {
 		if (debug && peer_sort_ret < 0)
@@ -2481,7 +2481,8 @@ bool subgroup_announce_check(struct bgp_dest *dest, struct bgp_path_info *pi,
 		}
 	} else if (safi == SAFI_MPLS_VPN &&
 		   CHECK_FLAG(pi->flags, BGP_PATH_MPLSVPN_NH_LABEL_BIND) &&
-		   pi->mplsvpn.bmnc.nh_label_bind_cache && peer &&
+		   pi->extra && pi->extra->mplsvpn &&
+		   pi->extra->mplsvpn->bmnc.nh_label_bind_cache && peer &&
 		   pi->peer != peer && pi->sub_type != BGP_ROUTE_IMPORTED &&
 		   pi->sub_type != BGP_ROUTE_STATIC &&
 		   bgp_mplsvpn_path_uses_valid_mpls_label(pi) &&
@@ -4815,19 +4816,133 @@ static void process_eoiu_marker(struct bgp_dest *dest)
 	XFREE(MTYPE_BGP_NODE, dest);
 }
 
+/* Dests per batch, and the time a batch should fit in, in usec */
+#define BGP_PROCESS_BATCH_MIN 1
+#define BGP_PROCESS_BATCH_MAX 1024
+#define BGP_PROCESS_BATCH_INITIAL 64
+#define BGP_PROCESS_BATCH_TIME 5000
+
+static void bgp_process_hist_add(struct bgp_process_hist *hist, uint32_t value)
+{
+	unsigned int b = value ? 32 - __builtin_clz(value) : 0;
+
+	hist->bucket[b]++;
+	hist->count++;
+	hist->sum += value;
+	if (value > hist->max)
+		hist->max = value;
+}
+
+/* upper bound of the bucket holding the pct'th percentile sample */
+static uint64_t bgp_process_hist_pct(const struct bgp_process_hist *hist,
+				     unsigned int pct)
+{
+	uint64_t want = (hist->count * pct + 99) / 100;
+	uint64_t seen = 0;
+	unsigned int b;
+
+	for (b = 0; b < BGP_PROCESS_HIST_BUCKETS; b++) {
+		seen += hist->bucket[b];
+		if (seen >= want)
+			return MIN((1ULL << b) - 1, hist->max);
+	}
+
+	return hist->max;
+}
+
+static void meta_queue_dest_afi_safi(struct bgp_dest *dest,
+				     enum meta_queue_indexes qindex,
+				     afi_t *afi, safi_t *safi)
+{
+	struct bgp_table *table;
+
+	*afi = AFI_UNSPEC;
+	*safi = SAFI_UNSPEC;
+
+	if (qindex == META_QUEUE_EOIU_MARKER)
+		return;
+
+	table = bgp_dest_table(dest);
+	*afi = table->afi;
+	*safi = table->safi;
+}
+
+static uint32_t meta_queue_weight(const struct bgp *bgp, afi_t afi, safi_t safi)
+{
+	if (!bgp || afi == AFI_UNSPEC || !bgp->process_weight[afi][safi])
+		return BGP_PROCESS_WEIGHT_DEFAULT;
+
+	return bgp->process_weight[afi][safi];
+}
+
+/*
+ * Pick the FIFO of a sub-queue whose turn it is: the current one while it
+ * has credit left, otherwise the next non-empty one.
+ */
+static struct bgp_dest_queue *meta_queue_subq_next(struct meta_queue *mq,
+						   struct bgp *bgp,
+						   enum meta_queue_indexes qindex)
+{
+	afi_t afi = mq->rr[qindex].afi;
+	safi_t safi = mq->rr[qindex].safi;
+	unsigned int i;
+
+	if (!mq->subq_size[qindex])
+		return NULL;
+
+	if (mq->rr[qindex].credit && !STAILQ_EMPTY(&mq->subq[qindex][afi][safi])) {
+		mq->rr[qindex].credit--;
+		return &mq->subq[qindex][afi][safi];
+	}
+
+	for (i = 0; i < AFI_MAX * SAFI_MAX; i++) {
+		if (++safi == SAFI_MAX) {
+			safi = SAFI_UNSPEC;
+			if (++afi == AFI_MAX)
+				afi = AFI_UNSPEC;
+		}
+
+		if (STAILQ_EMPTY(&mq->subq[qindex][afi][safi]))
+			continue;
+
+		mq->rr[qindex].afi = afi;
+		mq->rr[qindex].safi = safi;
+		mq->rr[qindex].credit = meta_queue_weight(bgp, afi, safi) - 1;
+		return &mq->subq[qindex][afi][safi];
+	}
+
+	/* subq_size is off */
+	assert(0);
+	return NULL;
+}
+
 /*
  * Examine the specified subqueue; process one entry and return 1 if
  * there is a node, return 0 otherwise.
  */
-static unsigned int process_subq(struct bgp_dest_queue *subq, enum meta_queue_indexes qindex)
+static unsigned int process_subq(struct meta_queue *mq, struct bgp *bgp,
+				 enum meta_queue_indexes qindex)
 {
-	struct bgp_dest *dest = STAILQ_FIRST(subq);
+	struct bgp_dest_queue *subq = meta_queue_subq_next(mq, bgp, qindex);
+	struct bgp_dest *dest;
+	afi_t afi;
+	safi_t safi;
 
-	if (!dest)
+	if (!subq)
 		return 0;
 
+	dest = STAILQ_FIRST(subq);
 	STAILQ_REMOVE_HEAD(subq, pq);
 	STAILQ_NEXT(dest, pq) = NULL; /* complete unlink */
+	mq->subq_size[qindex]--;
+
+	meta_queue_dest_afi_safi(dest, qindex, &afi, &safi);
+	if (mq->probe[afi][safi] == dest) {
+		bgp_process_hist_add(&mq->latency[afi][safi],
+				     monotime_since(&mq->probe_start[afi][safi],
+						    NULL));
+		mq->probe[afi][safi] = NULL;
+	}
 
 	switch (qindex) {
 	case META_QUEUE_EARLY_ROUTE:
@@ -4843,15 +4958,19 @@ static unsigned int process_subq(struct bgp_dest_queue *subq, enum meta_queue_in
 	return 1;
 }
 
-/* Dispatch the meta queue by picking and processing the next node from
- * a non-empty sub-queue with lowest priority. wq is equal to bgp->process_queue and
- * data is pointed to the meta queue structure.
+/* Dispatch the meta queue by processing a batch of nodes, each picked from
+ * a non-empty sub-queue with lowest priority. wq is equal to bgp->process_queue,
+ * whose spec.data is the bgp instance, and data is pointed to the meta queue
+ * structure.
  */
-static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
+static wq_item_status meta_queue_process(struct work_queue *wq, void *data)
 {
 	struct meta_queue *mq = data;
-	uint32_t i;
+	struct bgp *bgp = wq->spec.data;
+	struct timeval start;
+	uint32_t i, n;
 	uint32_t peers_on_fifo;
+	bool timed = false;
 	static uint32_t total_runs = 0;
 
 	total_runs++;
@@ -4869,15 +4988,58 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 	if (peers_on_fifo > 10 && total_runs % 10 != 0)
 		return WQ_QUEUE_BLOCKED;
 
-	for (i = 0; i < MQ_SIZE; i++)
-		if (process_subq(mq->subq[i], i)) {
-			mq->size--;
+	bgp_process_hist_add(&mq->depth, mq->size);
+	mq->batches++;
+	monotime(&start);
+
+	for (n = 0; n < mq->batch && mq->size; n++) {
+		for (i = 0; i < MQ_SIZE; i++)
+			if (process_subq(mq, bgp, i)) {
+				mq->size--;
+				break;
+			}
+
+		if (monotime_since(&start, NULL) >= BGP_PROCESS_BATCH_TIME) {
+			timed = true;
+			n++;
 			break;
 		}
+	}
+
+	/*
+	 * Shrink the batch quickly when it ran over its time, grow it slowly
+	 * when a full batch took less than half of it.
+	 */
+	if (timed) {
+		mq->batches_timed++;
+		mq->batch = MAX(n / 2, BGP_PROCESS_BATCH_MIN);
+	} else if (n == mq->batch &&
+		   monotime_since(&start, NULL) < BGP_PROCESS_BATCH_TIME / 2)
+		mq->batch = MIN(mq->batch + mq->batch / 4 + 1,
+				BGP_PROCESS_BATCH_MAX);
 
 	return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
+static void meta_queue_add(struct meta_queue *mq, struct bgp_dest *dest,
+			   enum meta_queue_indexes qindex)
+{
+	afi_t afi;
+	safi_t safi;
+
+	meta_queue_dest_afi_safi(dest, qindex, &afi, &safi);
+
+	assert(STAILQ_NEXT(dest, pq) == NULL);
+	STAILQ_INSERT_TAIL(&mq->subq[qindex][afi][safi], dest, pq);
+	mq->subq_size[qindex]++;
+	mq->size++;
+
+	if (!mq->probe[afi][safi]) {
+		mq->probe[afi][safi] = dest;
+		monotime(&mq->probe_start[afi][safi]);
+	}
+}
+
 static int early_route_meta_queue_add(struct meta_queue *mq, void *data)
 {
 	enum meta_queue_indexes qindex = META_QUEUE_EARLY_ROUTE;
@@ -4887,9 +5049,7 @@ static int early_route_meta_queue_add(struct meta_queue *mq, void *data)
 		zlog_debug("%s queued into sub-queue %s", bgp_dest_get_prefix_str(dest),
 			   subqueue2str(qindex));
 
-	assert(STAILQ_NEXT(dest, pq) == NULL);
-	STAILQ_INSERT_TAIL(mq->subq[qindex], dest, pq);
-	mq->size++;
+	meta_queue_add(mq, dest, qindex);
 	return 0;
 }
 
@@ -4902,9 +5062,7 @@ static int other_route_meta_queue_add(struct meta_queue *mq, void *data)
 		zlog_debug("%s queued into sub-queue %s", bgp_dest_get_prefix_str(dest),
 			   subqueue2str(qindex));
 
-	assert(STAILQ_NEXT(dest, pq) == NULL);
-	STAILQ_INSERT_TAIL(mq->subq[qindex], dest, pq);
-	mq->size++;
+	meta_queue_add(mq, dest, qindex);
 	return 0;
 }
 
@@ -4916,9 +5074,7 @@ static int eoiu_marker_meta_queue_add(struct meta_queue *mq, void *data)
 	if (BGP_DEBUG(update, UPDATE_IN))
 		zlog_debug("EOIU Marker queued into sub-queue %s", subqueue2str(qindex));
 
-	assert(STAILQ_NEXT(dest, pq) == NULL);
-	STAILQ_INSERT_TAIL(mq->subq[qindex], dest, pq);
-	mq->size++;
+	meta_queue_add(mq, dest, qindex);
 	return 0;
 }
 
@@ -4973,14 +5129,17 @@ static struct meta_queue *meta_queue_new(void)
 {
 	struct meta_queue *new;
 	uint32_t i;
+	afi_t afi;
+	safi_t safi;
 
 	new = XCALLOC(MTYPE_BGP_METAQ, sizeof(struct meta_queue));
 
-	for (i = 0; i < MQ_SIZE; i++) {
-		new->subq[i] = XCALLOC(MTYPE_BGP_METAQ, sizeof(*(new->subq[i])));
-		assert(new->subq[i]);
-		STAILQ_INIT(new->subq[i]);
-	}
+	for (i = 0; i < MQ_SIZE; i++)
+		for (afi = AFI_UNSPEC; afi < AFI_MAX; afi++)
+			for (safi = SAFI_UNSPEC; safi < SAFI_MAX; safi++)
+				STAILQ_INIT(&new->subq[i][afi][safi]);
+
+	new->batch = BGP_PROCESS_BATCH_INITIAL;
 
 	return new;
 }
@@ -4999,6 +5158,7 @@ static void early_meta_queue_free(struct meta_queue *mq, struct bgp_dest_queue *
 
 		table = bgp_dest_table(dest);
 		bgp_table_unlock(table);
+		mq->subq_size[META_QUEUE_EARLY_ROUTE]--;
 		mq->size--;
 	}
 }
@@ -5017,6 +5177,7 @@ static void other_meta_queue_free(struct meta_queue *mq, struct bgp_dest_queue *
 
 		table = bgp_dest_table(dest);
 		bgp_table_unlock(table);
+		mq->subq_size[META_QUEUE_OTHER_ROUTE]--;
 		mq->size--;
 	}
 }
@@ -5032,6 +5193,7 @@ static void eoiu_marker_queue_free(struct meta_queue *mq, struct bgp_dest_queue
 		STAILQ_REMOVE_HEAD(l, pq);
 		STAILQ_NEXT(dest, pq) = NULL; /* complete unlink */
 		XFREE(MTYPE_BGP_NODE, dest);
+		mq->subq_size[META_QUEUE_EOIU_MARKER]--;
 		mq->size--;
 	}
 }
@@ -5039,21 +5201,25 @@ static void eoiu_marker_queue_free(struct meta_queue *mq, struct bgp_dest_queue
 void bgp_meta_queue_free(struct meta_queue *mq)
 {
 	enum meta_queue_indexes i;
+	afi_t afi;
+	safi_t safi;
 
 	for (i = 0; i < MQ_SIZE; i++) {
-		switch (i) {
-		case META_QUEUE_EARLY_ROUTE:
-			early_meta_queue_free(mq, mq->subq[i]);
-			break;
-		case META_QUEUE_OTHER_ROUTE:
-			other_meta_queue_free(mq, mq->subq[i]);
-			break;
-		case META_QUEUE_EOIU_MARKER:
-			eoiu_marker_queue_free(mq, mq->subq[i]);
-			break;
+		for (afi = AFI_UNSPEC; afi < AFI_MAX; afi++) {
+			for (safi = SAFI_UNSPEC; safi < SAFI_MAX; safi++) {
+				switch (i) {
+				case META_QUEUE_EARLY_ROUTE:
+					early_meta_queue_free(mq, &mq->subq[i][afi][safi]);
+					break;
+				case META_QUEUE_OTHER_ROUTE:
+					other_meta_queue_free(mq, &mq->subq[i][afi][safi]);
+					break;
+				case META_QUEUE_EOIU_MARKER:
+					eoiu_marker_queue_free(mq, &mq->subq[i][afi][safi]);
+					break;
+				}
+			}
 		}
-
-		XFREE(MTYPE_BGP_METAQ, mq->subq[i]);
 	}
 
 	XFREE(MTYPE_BGP_METAQ, mq);
@@ -5069,6 +5235,7 @@ void bgp_process_queue_init(struct bgp *bgp)
 	}
 
 	bgp->process_queue->spec.workfunc = &meta_queue_process;
+	bgp->process_queue->spec.data = bgp;
 	bgp->process_queue->spec.max_retries = 0;
 	bgp->process_queue->spec.hold = 50;
 	/* Use a higher yield value of 50ms for main queue processing */
@@ -9098,6 +9265,35 @@ DEFUN (no_bgp_table_map,
 				   argv[idx_word]->arg);
 }
 
+void bgp_config_write_process_queue(struct vty *vty, struct bgp *bgp,
+				    afi_t afi, safi_t safi)
+{
+	if (bgp->process_weight[afi][safi])
+		vty_out(vty, "  bgp process-queue weight %u\n",
+			bgp->process_weight[afi][safi]);
+}
+
+DEFPY (bgp_process_queue_weight,
+       bgp_process_queue_weight_cmd,
+       "[no$no] bgp process-queue weight ![(1-100)$weight]",
+       NO_STR
+       BGP_STR
+       "Route processing queue\n"
+       "Dests processed per round-robin turn of this address family\n"
+       "Weight\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+	afi_t afi = bgp_node_afi(vty);
+	safi_t safi = bgp_node_safi(vty);
+
+	if (no || weight == BGP_PROCESS_WEIGHT_DEFAULT)
+		bgp->process_weight[afi][safi] = 0;
+	else
+		bgp->process_weight[afi][safi] = weight;
+
+	return CMD_SUCCESS;
+}
+
 DEFPY(bgp_network,
 	bgp_network_cmd,
 	"[no] network \
@@ -12584,14 +12780,14 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				import ? ", import-check enabled" : "");
 		}
 	} else {
-		if (bpi_ultimate->extra && bpi_ultimate->extra->igpmetric) {
+		if (bpi_ultimate->igpmetric) {
 			if (json_paths)
 				json_object_int_add(
 					json_nexthop_global, "metric",
-					bpi_ultimate->extra->igpmetric);
+					bpi_ultimate->igpmetric);
 			else
 				vty_out(vty, " (metric %u)",
-					bpi_ultimate->extra->igpmetric);
+					bpi_ultimate->igpmetric);
 		}
 
 		/* IGP cost is 0, display this only for json */
@@ -14986,6 +15182,117 @@ DEFUN(show_ip_bgp_afi_safi_statistics, show_ip_bgp_afi_safi_statistics_cmd,
 	return ret;
 }
 
+static void bgp_process_hist_show(struct vty *vty, const char *name,
+				  const struct bgp_process_hist *hist,
+				  json_object *json)
+{
+	json_object *json_hist, *json_buckets;
+	unsigned int b;
+
+	if (json) {
+		json_hist = json_object_new_object();
+		json_object_int_add(json_hist, "samples", hist->count);
+		json_object_int_add(json_hist, "average",
+				    hist->count ? hist->sum / hist->count : 0);
+		json_object_int_add(json_hist, "p50", bgp_process_hist_pct(hist, 50));
+		json_object_int_add(json_hist, "p90", bgp_process_hist_pct(hist, 90));
+		json_object_int_add(json_hist, "p99", bgp_process_hist_pct(hist, 99));
+		json_object_int_add(json_hist, "max", hist->max);
+
+		/* element b counts the samples below 2^b */
+		json_buckets = json_object_new_array();
+		for (b = 0; b < BGP_PROCESS_HIST_BUCKETS; b++)
+			json_object_array_add(json_buckets,
+					      json_object_new_int64(hist->bucket[b]));
+		json_object_object_add(json_hist, "buckets", json_buckets);
+
+		json_object_object_add(json, name, json_hist);
+		return;
+	}
+
+	vty_out(vty, "    %-24s %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+		" %10" PRIu64 " %10" PRIu64 " %10u\n",
+		name, hist->count, hist->count ? hist->sum / hist->count : 0,
+		bgp_process_hist_pct(hist, 50), bgp_process_hist_pct(hist, 90),
+		bgp_process_hist_pct(hist, 99), hist->max);
+}
+
+static void bgp_process_queue_show(struct vty *vty, struct bgp *bgp,
+				   json_object *json)
+{
+	struct meta_queue *mq = bgp->mq;
+	json_object *json_latency = NULL;
+	afi_t afi;
+	safi_t safi;
+
+	if (json) {
+		json_object_int_add(json, "queued", mq->size);
+		json_object_int_add(json, "batchSize", mq->batch);
+		json_object_int_add(json, "batches", mq->batches);
+		json_object_int_add(json, "batchesTimeLimited", mq->batches_timed);
+		bgp_process_hist_show(vty, "depth", &mq->depth, json);
+		json_latency = json_object_new_object();
+	} else {
+		vty_out(vty, "Route processing queue for %s\n", bgp->name_pretty);
+		vty_out(vty, "  %u dests queued, batch size %u\n", mq->size,
+			mq->batch);
+		vty_out(vty, "  %" PRIu64 " batches, %" PRIu64
+			" cut short by their time limit\n\n",
+			mq->batches, mq->batches_timed);
+		vty_out(vty, "    %-24s %10s %10s %10s %10s %10s %10s\n", "",
+			"Samples", "Avg", "p50", "p90", "p99", "Max");
+		bgp_process_hist_show(vty, "Depth at batch start", &mq->depth,
+				      NULL);
+		vty_out(vty, "\n  Delay before processing, usec:\n");
+	}
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		if (!mq->latency[afi][safi].count)
+			continue;
+
+		bgp_process_hist_show(vty, get_afi_safi_str(afi, safi, !!json),
+				      &mq->latency[afi][safi], json_latency);
+	}
+
+	if (json)
+		json_object_object_add(json, "latency", json_latency);
+}
+
+DEFPY(show_bgp_process_queue, show_bgp_process_queue_cmd,
+      "show bgp [<view|vrf> VIEWVRFNAME$vrf_name] process-queue [json$uj]",
+      SHOW_STR
+      BGP_STR
+      BGP_INSTANCE_HELP_STR
+      "Route processing queue statistics\n"
+      JSON_STR)
+{
+	struct bgp *bgp;
+	json_object *json = NULL;
+
+	if (vrf_name && !strmatch(vrf_name, VRF_DEFAULT_NAME))
+		bgp = bgp_lookup_by_name(vrf_name);
+	else
+		bgp = bgp_get_default();
+
+	if (!bgp || IS_BGP_INSTANCE_HIDDEN(bgp) || !bgp->mq) {
+		if (uj)
+			vty_json_empty(vty, NULL);
+		else
+			vty_out(vty, "%% No BGP process is configured\n");
+		return CMD_WARNING;
+	}
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_process_queue_show(vty, bgp, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY(show_ip_bgp_dampening_params, show_ip_bgp_dampening_params_cmd,
       "show [ip] bgp [<view|vrf> VIEWVRFNAME] [" BGP_AFI_CMD_STR
       " [" BGP_SAFI_WITH_LABEL_CMD_STR
@@ -18488,6 +18795,7 @@ void bgp_route_init(void)
 	install_element(BGP_NODE, &bgp_table_map_cmd);
 	install_element(BGP_NODE, &bgp_network_cmd);
 	install_element(BGP_NODE, &no_bgp_table_map_cmd);
+	install_element(BGP_NODE, &bgp_process_queue_weight_cmd);
 
 	install_element(BGP_NODE, &aggregate_addressv4_cmd);
 
@@ -18495,6 +18803,7 @@ void bgp_route_init(void)
 	install_element(BGP_IPV4_NODE, &bgp_table_map_cmd);
 	install_element(BGP_IPV4_NODE, &bgp_network_cmd);
 	install_element(BGP_IPV4_NODE, &no_bgp_table_map_cmd);
+	install_element(BGP_IPV4_NODE, &bgp_process_queue_weight_cmd);
 
 	install_element(BGP_IPV4_NODE, &aggregate_addressv4_cmd);
 
@@ -18502,16 +18811,19 @@ void bgp_route_init(void)
 	install_element(BGP_IPV4M_NODE, &bgp_table_map_cmd);
 	install_element(BGP_IPV4M_NODE, &bgp_network_cmd);
 	install_element(BGP_IPV4M_NODE, &no_bgp_table_map_cmd);
+	install_element(BGP_IPV4M_NODE, &bgp_process_queue_weight_cmd);
 	install_element(BGP_IPV4M_NODE, &aggregate_addressv4_cmd);
 
 	/* IPv4 labeled-unicast configuration.  */
 	install_element(BGP_IPV4L_NODE, &bgp_network_cmd);
 	install_element(BGP_IPV4L_NODE, &aggregate_addressv4_cmd);
+	install_element(BGP_IPV4L_NODE, &bgp_process_queue_weight_cmd);
 
 	install_element(VIEW_NODE, &show_ip_bgp_instance_all_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_afi_safi_statistics_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_l2vpn_evpn_statistics_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_dampening_params_cmd);
+	install_element(VIEW_NODE, &show_bgp_process_queue_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_route_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_regexp_cmd);
@@ -18551,14 +18863,21 @@ void bgp_route_init(void)
 	install_element(BGP_IPV6_NODE, &bgp_table_map_cmd);
 	install_element(BGP_IPV6_NODE, &ipv6_bgp_network_cmd);
 	install_element(BGP_IPV6_NODE, &no_bgp_table_map_cmd);
+	install_element(BGP_IPV6_NODE, &bgp_process_queue_weight_cmd);
 
 	install_element(BGP_IPV6_NODE, &aggregate_addressv6_cmd);
 
 	install_element(BGP_IPV6M_NODE, &ipv6_bgp_network_cmd);
+	install_element(BGP_IPV6M_NODE, &bgp_process_queue_weight_cmd);
 
 	/* IPv6 labeled unicast address family. */
 	install_element(BGP_IPV6L_NODE, &ipv6_bgp_network_cmd);
 	install_element(BGP_IPV6L_NODE, &aggregate_addressv6_cmd);
+	install_element(BGP_IPV6L_NODE, &bgp_process_queue_weight_cmd);
+
+	install_element(BGP_VPNV4_NODE, &bgp_process_queue_weight_cmd);
+	install_element(BGP_VPNV6_NODE, &bgp_process_queue_weight_cmd);
+	install_element(BGP_EVPN_NODE, &bgp_process_queue_weight_cmd);
 
 	install_element(BGP_NODE, &bgp_distance_cmd);
 	install_element(BGP_NODE, &no_bgp_distance_cmd);
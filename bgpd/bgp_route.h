@@ -231,6 +231,30 @@ struct bgp_path_info_extra_vnc {
 };
 #endif
 
+struct bgp_mplsvpn_label_nh {
+	/* For nexthop per label linked list */
+	LIST_ENTRY(bgp_path_info) label_nh_thread;
+
+	/* Back pointer to the bgp label per nexthop structure */
+	struct bgp_label_per_nexthop_cache *label_nexthop_cache;
+};
+
+struct bgp_mplsvpn_nh_label_bind {
+	/* For mplsvpn nexthop label bind linked list */
+	LIST_ENTRY(bgp_path_info) nh_label_bind_thread;
+
+	/* Back pointer to the bgp mplsvpn nexthop label bind structure */
+	struct bgp_mplsvpn_nh_label_bind_cache *nh_label_bind_cache;
+};
+
+/* For MPLS VPN label per nexthop or nexthop label binding, telling which
+ * one by BGP_PATH_MPLSVPN_LABEL_NH and BGP_PATH_MPLSVPN_NH_LABEL_BIND.
+ */
+union bgp_path_info_extra_mplsvpn {
+	struct bgp_mplsvpn_label_nh blnc;
+	struct bgp_mplsvpn_nh_label_bind bmnc;
+};
+
 /* Ancillary information to struct bgp_path_info,
  * used for uncommonly used data (aggregation, MPLS, etc.)
  * and lazily allocated to save memory.
@@ -242,9 +266,6 @@ struct bgp_path_info_extra {
 	/** List of aggregations that suppress this path. */
 	struct list *aggr_suppressors;
 
-	/* Nexthop reachability check.  */
-	uint32_t igpmetric;
-
 	/* MPLS label(s) - VNI(s) for EVPN-VxLAN  */
 	struct bgp_labels *labels;
 
@@ -263,22 +284,9 @@ struct bgp_path_info_extra {
 
 	/* For vrf leaking*/
 	struct bgp_path_info_extra_vrfleak *vrfleak;
-};
 
-struct bgp_mplsvpn_label_nh {
-	/* For nexthop per label linked list */
-	LIST_ENTRY(bgp_path_info) label_nh_thread;
-
-	/* Back pointer to the bgp label per nexthop structure */
-	struct bgp_label_per_nexthop_cache *label_nexthop_cache;
-};
-
-struct bgp_mplsvpn_nh_label_bind {
-	/* For mplsvpn nexthop label bind linked list */
-	LIST_ENTRY(bgp_path_info) nh_label_bind_thread;
-
-	/* Back pointer to the bgp mplsvpn nexthop label bind structure */
-	struct bgp_mplsvpn_nh_label_bind_cache *nh_label_bind_cache;
+	/* For MPLS VPN label allocation */
+	union bgp_path_info_extra_mplsvpn *mplsvpn;
 };
 
 struct bgp_path_info {
@@ -372,14 +380,12 @@ struct bgp_path_info {
 
 	enum bgp_path_selection_reason reason;
 
+	/* Nexthop reachability check.  */
+	uint32_t igpmetric;
+
 	/* Addpath identifiers */
 	uint32_t addpath_rx_id;
 	struct bgp_addpath_info_data tx_addpath;
-
-	union {
-		struct bgp_mplsvpn_label_nh blnc;
-		struct bgp_mplsvpn_nh_label_bind bmnc;
-	} mplsvpn;
 };
 
 /* Structure used in BGP path selection */
@@ -607,9 +613,56 @@ enum bgp_path_type {
 /* For checking that an object has already queued in some sub-queue */
 #define MQ_BIT_MASK ((1 << MQ_SIZE) - 1)
 
+/* Share of an AFI/SAFI in route processing, see meta_queue */
+#define BGP_PROCESS_WEIGHT_DEFAULT 1
+#define BGP_PROCESS_WEIGHT_MAX 100
+
+/* log2 histogram: bucket b counts samples below 2^b */
+#define BGP_PROCESS_HIST_BUCKETS 33
+
+struct bgp_process_hist {
+	uint64_t count;
+	uint64_t sum;
+	uint32_t max;
+	uint64_t bucket[BGP_PROCESS_HIST_BUCKETS];
+};
+
+/*
+ * Each sub-queue holds one FIFO per AFI/SAFI; EOIU markers use the
+ * AFI_UNSPEC/SAFI_UNSPEC one. Sub-queues are served in priority order,
+ * and within a sub-queue the FIFOs are served weighted round-robin, each
+ * taking up to its weight in dests per turn. That way churn in one
+ * address family does not hold up best path selection in the others.
+ *
+ * Dests are processed in batches, one per call of the work queue
+ * function. The size of a batch adapts so that a batch stays within a
+ * time budget.
+ */
 struct meta_queue {
-	STAILQ_HEAD(bgp_dest_queue, bgp_dest) * subq[MQ_SIZE];
+	STAILQ_HEAD(bgp_dest_queue, bgp_dest) subq[MQ_SIZE][AFI_MAX][SAFI_MAX];
+	uint32_t subq_size[MQ_SIZE];
 	uint32_t size; /* sum of lengths of all subqueues */
+
+	/* Round-robin position of each sub-queue, and what is left of its turn */
+	struct {
+		afi_t afi;
+		safi_t safi;
+		uint32_t credit;
+	} rr[MQ_SIZE];
+
+	/* Dests per batch */
+	uint32_t batch;
+
+	/* Statistics */
+	uint64_t batches;
+	uint64_t batches_timed;
+	/* Queued dests at the start of each batch */
+	struct bgp_process_hist depth;
+	/* Time from queueing to processing, in usec */
+	struct bgp_process_hist latency[AFI_MAX][SAFI_MAX];
+	/* The one dest per AFI/SAFI currently being timed, and since when */
+	struct bgp_dest *probe[AFI_MAX][SAFI_MAX];
+	struct timeval probe_start[AFI_MAX][SAFI_MAX];
 };
 
 /*
@@ -681,6 +734,7 @@ static inline void prep_for_rmap_apply(struct bgp_path_info *dst_pi,
 		dst_pi->flags = src_pi->flags;
 		dst_pi->type = src_pi->type;
 		dst_pi->sub_type = src_pi->sub_type;
+		dst_pi->igpmetric = src_pi->igpmetric;
 		if (src_pi->extra) {
 			memcpy(dst_pie, src_pi->extra, sizeof(struct bgp_path_info_extra));
 			dst_pi->extra = dst_pie;
@@ -903,6 +957,8 @@ extern void bgp_process_early(struct bgp *bgp, struct bgp_dest *dest,
  */
 extern void bgp_add_eoiu_mark(struct bgp *bgp);
 extern void bgp_config_write_table_map(struct vty *vty, struct bgp *bgp, afi_t afi, safi_t safi);
+extern void bgp_config_write_process_queue(struct vty *vty, struct bgp *bgp,
+					   afi_t afi, safi_t safi);
 extern void bgp_config_write_network(struct vty *vty, struct bgp *bgp, afi_t afi, safi_t safi);
 extern void bgp_config_write_distance(struct vty *vty, struct bgp *bgp, afi_t afi, safi_t safi);
 
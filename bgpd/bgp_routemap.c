@@ -145,7 +145,7 @@ static uint32_t route_value_adjust(struct rmap_value *rv, uint32_t current,
 		value = peer->rtt;
 		break;
 	case RMAP_VALUE_TYPE_IGP:
-		value = bpi->extra ? bpi->extra->igpmetric : 0;
+		value = bpi->igpmetric;
 		break;
 	case RMAP_VALUE_TYPE_AIGP:
 		value = MIN(bpi->attr->aigp_metric, UINT32_MAX);
@@ -88,16 +88,27 @@ struct bgp_dest {
 	struct zebra_announce_item zai;
 	struct bgp_path_info *za_bgp_pi;
 	struct bgpevpn *za_vpn;
-	bool za_is_sync;
 
 	uint64_t version;
 
-	mpls_label_t local_label;
-
 	struct bgp_ls_nlri *ls_nlri;
 
 	struct bgp_attr_srv6_l3service *srv6_unicast;
 
+	struct bgp_addpath_node_data tx_addpath;
+
+	/* Multipath information */
+	struct bgp_path_info_mpath *mpath;
+
+	/* Small members last, so that there is one tail of padding per
+	 * destination rather than one after each.
+	 */
+	mpls_label_t local_label;
+
+	enum bgp_path_selection_reason reason;
+
+	bool za_is_sync;
+
 	uint16_t flags;
 #define BGP_NODE_PROCESS_SCHEDULED	(1 << 0)
 #define BGP_NODE_USER_CLEAR             (1 << 1)
@@ -112,13 +123,6 @@ struct bgp_dest {
 #define BGP_NODE_SCHEDULE_FOR_INSTALL	(1 << 10)
 #define BGP_NODE_SCHEDULE_FOR_DELETE	(1 << 11)
 #define BGP_NODE_NHT_RESOLVED_NODE	(1 << 12)
-
-	struct bgp_addpath_node_data tx_addpath;
-
-	enum bgp_path_selection_reason reason;
-
-	/* Multipath information */
-	struct bgp_path_info_mpath *mpath;
 };
 
 DECLARE_LIST(zebra_announce, struct bgp_dest, zai);
@@ -285,6 +285,7 @@ static void *updgrp_hash_alloc(void *p)
 	updgrp->conf->connection = XCALLOC(MTYPE_BGP_PEER_CONNECTION,
 					   sizeof(struct peer_connection));
 	conf_copy(updgrp->conf, in->conf, in->afi, in->safi);
+	update_group_attr_cache_init(updgrp);
 	return updgrp;
 }
 
@@ -1121,6 +1122,7 @@ static void update_group_delete(struct update_group *updgrp)
 	UPDGRP_GLOBAL_STAT(updgrp, updgrps_deleted) += 1;
 
 	hash_release(updgrp->bgp->update_groups[updgrp->afid], updgrp);
+	update_group_attr_cache_fini(updgrp);
 	conf_release(updgrp->conf, updgrp->afi, updgrp->safi);
 
 	XFREE(MTYPE_BGP_PEER_HOST, updgrp->conf->host);
@@ -2032,6 +2034,10 @@ void update_group_show_stats(struct bgp *bgp, struct vty *vty)
 		bgp->update_group_stats.peer_refreshes_combined);
 	vty_out(vty, "Merge checks triggered: %u\n",
 		bgp->update_group_stats.merge_checks_triggered);
+	vty_out(vty, "Attribute encodings: %u\n",
+		bgp->update_group_stats.attr_encodings);
+	vty_out(vty, "Attribute encodings reused: %u\n",
+		bgp->update_group_stats.attr_encodings_reused);
 }
 
 /*
@@ -100,6 +100,15 @@ struct bpacket_queue {
 	unsigned int max_count_reached_count;
 };
 
+/*
+ * Attributes recently encoded for an update group, so that subgroups
+ * sending the same attr do not each encode it again.
+ */
+#define UPDGRP_ATTR_CACHE_MAX 4096
+
+PREDECL_HASH(updgrp_attr_cache);
+PREDECL_DLIST(updgrp_attr_lru);
+
 struct update_group {
 	/* back pointer to the BGP instance */
 	struct bgp *bgp;
@@ -131,6 +140,10 @@ struct update_group {
 	uint32_t subgrps_deleted;
 
 	uint32_t num_dbg_en_peers;
+
+	/* encoded attributes, most recently used first */
+	struct updgrp_attr_cache_head attr_cache;
+	struct updgrp_attr_lru_head attr_lru;
 };
 
 /*
@@ -395,6 +408,8 @@ unsigned int bpacket_queue_virtual_length(struct peer_af *paf);
 extern void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty);
 bool subgroup_packets_to_build(struct update_subgroup *subgrp);
 extern struct bpacket *subgroup_update_packet(struct update_subgroup *s);
+extern void update_group_attr_cache_init(struct update_group *updgrp);
+extern void update_group_attr_cache_fini(struct update_group *updgrp);
 extern struct bpacket *subgroup_withdraw_packet(struct update_subgroup *s);
 extern struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 						struct peer_af *paf);
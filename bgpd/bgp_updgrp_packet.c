@@ -26,6 +26,7 @@
 #include "linklist.h"
 #include "workqueue.h"
 #include "hash.h"
+#include "jhash.h"
 #include "queue.h"
 #include "mpls.h"
 
@@ -44,6 +45,7 @@
 #include "bgpd/bgp_addpath.h"
 #include "bgpd/bgp_trace.h"
 #include "bgpd/bgp_ls_nlri.h"
+#include "bgpd/bgp_vty.h"
 
 /********************
  * PRIVATE FUNCTIONS
@@ -655,6 +657,212 @@ bool subgroup_packets_to_build(struct update_subgroup *subgrp)
 	return false;
 }
 
+/*
+ * Everything bgp_packet_attribute() looks at when encoding an attr for
+ * an update group, other than the group's own (fixed) configuration.
+ */
+struct updgrp_attr_enc_key {
+	const struct attr *attr;
+
+	/* the peer the path was learned from */
+	struct in_addr from_remote_id;
+	uint8_t from_sort;
+	bool from_enhe;
+
+	/* instance wide settings */
+	bool maxmed_active;
+	bool confed;
+	bool confed_peer;
+	uint32_t maxmed_value;
+	struct in_addr cluster_id;
+	as_t confed_id;
+	as_t local_as;
+};
+
+struct updgrp_attr_enc {
+	struct updgrp_attr_cache_item hitem;
+	struct updgrp_attr_lru_item litem;
+
+	struct updgrp_attr_enc_key key;
+	uint32_t hash;
+
+	/* where the encoding started in the work stream */
+	size_t start;
+	struct bpacket_attr_vec_arr vecarr;
+
+	bgp_size_t length;
+	uint8_t data[];
+};
+
+static int updgrp_attr_enc_cmp(const struct updgrp_attr_enc *a,
+			       const struct updgrp_attr_enc *b)
+{
+	if (a->hash != b->hash)
+		return numcmp(a->hash, b->hash);
+
+	return memcmp(&a->key, &b->key, sizeof(a->key));
+}
+
+static uint32_t updgrp_attr_enc_hash(const struct updgrp_attr_enc *enc)
+{
+	return enc->hash;
+}
+
+DECLARE_HASH(updgrp_attr_cache, struct updgrp_attr_enc, hitem,
+	     updgrp_attr_enc_cmp, updgrp_attr_enc_hash);
+DECLARE_DLIST(updgrp_attr_lru, struct updgrp_attr_enc, litem);
+
+static void updgrp_attr_enc_free(struct update_group *updgrp,
+				 struct updgrp_attr_enc *enc)
+{
+	struct attr *attr = (struct attr *)enc->key.attr;
+
+	updgrp_attr_cache_del(&updgrp->attr_cache, enc);
+	updgrp_attr_lru_del(&updgrp->attr_lru, enc);
+	bgp_attr_unintern(&attr);
+	XFREE(MTYPE_BGP_UPDGRP_ATTR_ENC, enc);
+}
+
+void update_group_attr_cache_init(struct update_group *updgrp)
+{
+	updgrp_attr_cache_init(&updgrp->attr_cache);
+	updgrp_attr_lru_init(&updgrp->attr_lru);
+}
+
+void update_group_attr_cache_fini(struct update_group *updgrp)
+{
+	struct updgrp_attr_enc *enc;
+
+	while ((enc = updgrp_attr_lru_first(&updgrp->attr_lru)))
+		updgrp_attr_enc_free(updgrp, enc);
+
+	updgrp_attr_cache_fini(&updgrp->attr_cache);
+	updgrp_attr_lru_fini(&updgrp->attr_lru);
+}
+
+static void updgrp_attr_enc_key_make(struct peer *peer, afi_t afi,
+				     safi_t safi, const struct attr *attr,
+				     struct peer *from,
+				     struct updgrp_attr_enc_key *key)
+{
+	struct bgp *bgp = peer->bgp;
+
+	/* compared with memcmp(), so the padding must be clear as well */
+	memset(key, 0, sizeof(*key));
+
+	key->attr = attr;
+	if (from) {
+		key->from_remote_id = from->remote_id;
+		key->from_sort = from->sort;
+		key->from_enhe = !!peer_cap_enhe(from, afi, safi);
+	}
+
+	key->maxmed_active = !!bgp->maxmed_active;
+	if (bgp->maxmed_active)
+		key->maxmed_value = bgp->maxmed_value;
+	if (CHECK_FLAG(bgp->config, BGP_CONFIG_CLUSTER_ID))
+		key->cluster_id = bgp->cluster_id;
+	else
+		key->cluster_id = bgp->router_id;
+	if (CHECK_FLAG(bgp->config, BGP_CONFIG_CONFEDERATION)) {
+		key->confed = true;
+		key->confed_id = bgp->confed_id;
+		key->confed_peer = bgp_confederation_peers_check(bgp, peer->as);
+	}
+	key->local_as = peer->local_as;
+}
+
+static bool updgrp_attr_enc_shareable(struct update_subgroup *subgrp,
+				      struct bgp_dest *dest)
+{
+	struct update_group *updgrp = subgrp->update_group;
+
+	/* encodings that depend on the path or the prefix are not shared */
+	if (dest->srv6_unicast || SUBGRP_AFI(subgrp) == AFI_BGP_LS ||
+	    peergroup_flag_check(SUBGRP_PEER(subgrp),
+				 PEER_FLAG_SEND_NHC_ATTRIBUTE))
+		return false;
+
+	/* nobody to share with */
+	if (!updgrp_attr_cache_count(&updgrp->attr_cache) &&
+	    LIST_FIRST(&updgrp->subgrps) == subgrp &&
+	    !LIST_NEXT(subgrp, updgrp_train))
+		return false;
+
+	return true;
+}
+
+/*
+ * Encode the attributes of an UPDATE for a subgroup. Peers in all
+ * subgroups of an update group share their outbound configuration, so
+ * when several subgroups send the same attr (typically while peers come
+ * up at different times), it is only encoded once and the bytes are
+ * copied for the others.
+ */
+static bgp_size_t subgroup_packet_attribute(struct update_subgroup *subgrp,
+					    struct stream *s, struct attr *attr,
+					    struct bpacket_attr_vec_arr *vecarr,
+					    struct peer *from,
+					    struct bgp_dest *dest,
+					    struct bgp_path_info *path)
+{
+	struct update_group *updgrp = subgrp->update_group;
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	afi_t afi = SUBGRP_AFI(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+	struct updgrp_attr_enc *enc, ref;
+	bgp_size_t length;
+	size_t start;
+
+	if (!updgrp_attr_enc_shareable(subgrp, dest))
+		return bgp_packet_attribute(NULL, peer, s, attr, vecarr, NULL,
+					    afi, safi, from, NULL, NULL, 0,
+					    dest->srv6_unicast, 0, 0, path,
+					    NULL);
+
+	start = stream_get_endp(s);
+
+	updgrp_attr_enc_key_make(peer, afi, safi, attr, from, &ref.key);
+	ref.hash = jhash(&ref.key, sizeof(ref.key), 0);
+
+	enc = updgrp_attr_cache_find(&updgrp->attr_cache, &ref);
+	if (enc && enc->start == start) {
+		UPDGRP_GLOBAL_STAT(updgrp, attr_encodings_reused) += 1;
+		stream_put(s, enc->data, enc->length);
+		*vecarr = enc->vecarr;
+
+		updgrp_attr_lru_del(&updgrp->attr_lru, enc);
+		updgrp_attr_lru_add_head(&updgrp->attr_lru, enc);
+		return enc->length;
+	}
+
+	UPDGRP_GLOBAL_STAT(updgrp, attr_encodings) += 1;
+	length = bgp_packet_attribute(NULL, peer, s, attr, vecarr, NULL, afi,
+				      safi, from, NULL, NULL, 0, NULL, 0, 0,
+				      path, NULL);
+
+	if (enc)
+		updgrp_attr_enc_free(updgrp, enc);
+	if (updgrp_attr_cache_count(&updgrp->attr_cache) >=
+	    UPDGRP_ATTR_CACHE_MAX)
+		updgrp_attr_enc_free(updgrp,
+				     updgrp_attr_lru_last(&updgrp->attr_lru));
+
+	enc = XMALLOC(MTYPE_BGP_UPDGRP_ATTR_ENC, sizeof(*enc) + length);
+	enc->key = ref.key;
+	enc->key.attr = bgp_attr_intern(attr);
+	enc->hash = ref.hash;
+	enc->start = start;
+	enc->vecarr = *vecarr;
+	enc->length = length;
+	memcpy(enc->data, STREAM_DATA(s) + start, length);
+
+	updgrp_attr_cache_add(&updgrp->attr_cache, enc);
+	updgrp_attr_lru_add_head(&updgrp->attr_lru, enc);
+
+	return length;
+}
+
 /* Make BGP update packet.  */
 struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 {
@@ -759,10 +967,10 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 			/* 5: Encode all the attributes, except MP_REACH_NLRI
 			 * attr. */
-			total_attr_len = bgp_packet_attribute(NULL, peer, s, adv->baa->attr,
-							      &vecarr, NULL, afi, safi, from, NULL,
-							      NULL, 0, dest->srv6_unicast, 0, 0,
-							      path, NULL);
+			total_attr_len = subgroup_packet_attribute(subgrp, s,
+								   adv->baa->attr,
+								   &vecarr, from,
+								   dest, path);
 			space_remaining =
 				STREAM_CONCAT_REMAIN(s, snlri, STREAM_SIZE(s))
 				- BGP_MAX_PACKET_SIZE_OVERFLOW;
@@ -813,7 +1021,8 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 			} else if (safi == SAFI_MPLS_VPN && path &&
 				   CHECK_FLAG(path->flags,
 					      BGP_PATH_MPLSVPN_NH_LABEL_BIND) &&
-				   path->mplsvpn.bmnc.nh_label_bind_cache &&
+				   path->extra && path->extra->mplsvpn &&
+				   path->extra->mplsvpn->bmnc.nh_label_bind_cache &&
 				   path->peer && path->peer != peer &&
 				   path->sub_type != BGP_ROUTE_IMPORTED &&
 				   path->sub_type != BGP_ROUTE_STATIC &&
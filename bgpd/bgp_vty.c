@@ -59,6 +59,7 @@
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_bfd.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_evpn.h"
 #include "bgpd/bgp_evpn_vty.h"
 #include "bgpd/bgp_evpn_mh.h"
@@ -12476,6 +12477,8 @@ DEFPY(show_bgp_router,
 	if (uj) {
 		json_object_int_add(json, "bgpInputQueueLimit", bm->inq_limit);
 		json_object_int_add(json, "bgpOutputQueueLimit", bm->outq_limit);
+		json_object_int_add(json, "bgpUpdateParseThreads",
+				    bm->update_parse_threads);
 		json_object_int_add(json, "bgpUpdateDelayTime", bm->v_update_delay);
 		json_object_int_add(json, "bgpEstablishWaitTime", bm->v_establish_wait);
 		json_object_int_add(json, "bgpRmapDelayTimer", bm->rmap_update_timer);
@@ -12485,6 +12488,8 @@ DEFPY(show_bgp_router,
 	} else {
 		vty_out(vty, "BGP Input Queue Limit: %d\n", bm->inq_limit);
 		vty_out(vty, "BGP Output Queue Limit: %d\n", bm->outq_limit);
+		vty_out(vty, "BGP Update Parse Threads: %u\n",
+			bm->update_parse_threads);
 
 		vty_out(vty, "BGP Global Update Delay Timers:\n");
 		vty_out(vty, "  Update Delay Time: %ds\n", bm->v_update_delay);
@@ -12925,6 +12930,14 @@ DEFUN (show_bgp_memory,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
 				     count * sizeof(struct bgp_path_info_extra_vrfleak)));
 
+	count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA_MPLSVPN);
+	if (count)
+		vty_out(vty,
+			"%ld BGP extra info for MPLS VPN labels, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(union bgp_path_info_extra_mplsvpn)));
+
 	if ((count = mtype_stats_alloc(MTYPE_BGP_STATIC)))
 		vty_out(vty, "%ld Static routes, using %s of memory\n", count,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
@@ -17014,6 +17027,12 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, uint16_t sh_flags, bo
 							 memory_order_relaxed));
 		json_object_int_add(json_stat, "totalSent", PEER_TOTAL_TX(p));
 		json_object_int_add(json_stat, "totalRecv", PEER_TOTAL_RX(p));
+		json_object_int_add(json_stat, "writeSyscalls",
+				    atomic_load_explicit(&p->write_calls,
+							 memory_order_relaxed));
+		json_object_int_add(json_stat, "writeSyscallsBlocked",
+				    atomic_load_explicit(&p->write_blocked,
+							 memory_order_relaxed));
 		json_object_object_add(json_neigh, "messageStats", json_stat);
 
 		/* Prefix statistics */
@@ -17029,7 +17048,8 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, uint16_t sh_flags, bo
 		atomic_size_t outq_count, inq_count, open_out, open_in,
 			notify_out, notify_in, update_out, update_in,
 			keepalive_out, keepalive_in, refresh_out, refresh_in,
-			dynamic_cap_out, dynamic_cap_in;
+			dynamic_cap_out, dynamic_cap_in, write_calls,
+			write_blocked;
 		outq_count = atomic_load_explicit(&p->connection->obuf->count,
 						  memory_order_relaxed);
 		inq_count = atomic_load_explicit(&p->connection->ibuf->count,
@@ -17058,6 +17078,10 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, uint16_t sh_flags, bo
 						       memory_order_relaxed);
 		dynamic_cap_in = atomic_load_explicit(&p->dynamic_cap_in,
 						      memory_order_relaxed);
+		write_calls = atomic_load_explicit(&p->write_calls,
+						   memory_order_relaxed);
+		write_blocked = atomic_load_explicit(&p->write_blocked,
+						     memory_order_relaxed);
 
 		/* Packet counts. */
 		vty_out(vty, "  Message statistics:\n");
@@ -17076,8 +17100,12 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, uint16_t sh_flags, bo
 			refresh_in);
 		vty_out(vty, "    Capability:    %10zu %10zu\n",
 			dynamic_cap_out, dynamic_cap_in);
-		vty_out(vty, "    Total:         %10u %10u\n\n", (uint32_t)PEER_TOTAL_TX(p),
+		vty_out(vty, "    Total:         %10u %10u\n", (uint32_t)PEER_TOTAL_TX(p),
 			(uint32_t)PEER_TOTAL_RX(p));
+		vty_out(vty, "    Write syscalls: %zu (%.1f messages each), %zu blocked\n\n",
+			write_calls,
+			write_calls ? (double)PEER_TOTAL_TX(p) / write_calls : 0.0,
+			write_blocked);
 
 		/* Prefix statistics */
 		vty_out(vty, "  Prefix statistics:\n");
@@ -20736,6 +20764,7 @@ static void bgp_config_write_family(struct vty *vty, struct bgp *bgp, afi_t afi,
 
 	bgp_config_write_maxpaths(vty, bgp, afi, safi);
 	bgp_config_write_table_map(vty, bgp, afi, safi);
+	bgp_config_write_process_queue(vty, bgp, afi, safi);
 
 	if (safi == SAFI_EVPN)
 		bgp_config_write_evpn_info(vty, bgp, afi, safi);
@@ -20861,6 +20890,10 @@ int bgp_config_write(struct vty *vty)
 	if (bm->outq_limit != BM_DEFAULT_Q_LIMIT)
 		vty_out(vty, "bgp output-queue-limit %u\n", bm->outq_limit);
 
+	if (bm->update_parse_threads)
+		vty_out(vty, "bgp update-parse-threads %u\n",
+			bm->update_parse_threads);
+
 	vty_out(vty, "!\n");
 
 	/* BGP configuration. */
@@ -21786,6 +21819,31 @@ DEFPY (no_bgp_outq_limit,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_update_parse_threads,
+       bgp_update_parse_threads_cmd,
+       "bgp update-parse-threads (1-64)$count",
+       BGP_STR
+       "Decode received UPDATEs ahead of processing on a pool of pthreads\n"
+       "Number of pthreads\n")
+{
+	bgp_preparse_threads_set(count);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_update_parse_threads,
+       no_bgp_update_parse_threads_cmd,
+       "no bgp update-parse-threads [(1-64)$count]",
+       NO_STR
+       BGP_STR
+       "Decode received UPDATEs ahead of processing on a pool of pthreads\n"
+       "Number of pthreads\n")
+{
+	bgp_preparse_threads_set(0);
+
+	return CMD_SUCCESS;
+}
+
 
 /* Initialization of BGP interface. */
 static void bgp_vty_if_init(void)
@@ -21845,6 +21903,8 @@ void bgp_vty_init(void)
 	install_element(CONFIG_NODE, &no_bgp_inq_limit_cmd);
 	install_element(CONFIG_NODE, &bgp_outq_limit_cmd);
 	install_element(CONFIG_NODE, &no_bgp_outq_limit_cmd);
+	install_element(CONFIG_NODE, &bgp_update_parse_threads_cmd);
+	install_element(CONFIG_NODE, &no_bgp_update_parse_threads_cmd);
 
 	/* "bgp local-mac" hidden commands. */
 	install_element(CONFIG_NODE, &bgp_local_mac_cmd);
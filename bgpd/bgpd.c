@@ -70,6 +70,7 @@
 #include "bgpd/bgp_evpn_vty.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_ecommunity.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_labelpool.h"
@@ -1253,6 +1254,8 @@ void bgp_peer_connection_buffers_free(struct peer_connection *connection)
 			connection->ibuf = NULL;
 		}
 
+		bgp_preparse_flush(connection);
+
 		if (connection->obuf) {
 			stream_fifo_free(connection->obuf);
 			connection->obuf = NULL;
@@ -1264,10 +1267,8 @@ void bgp_peer_connection_buffers_free(struct peer_connection *connection)
 		}
 	}
 
-	if (connection->curr) {
-		stream_free(connection->curr);
-		connection->curr = NULL;
-	}
+	if (connection->curr)
+		bgp_packet_curr_free(connection);
 }
 
 void bgp_peer_connection_free(struct peer_connection **connection)
@@ -1316,6 +1317,7 @@ struct peer_connection *bgp_peer_connection_new(struct peer *peer, const union s
 
 	connection->ibuf = stream_fifo_new();
 	connection->obuf = stream_fifo_new();
+	bgp_preparse_connection_init(connection);
 	pthread_mutex_init(&connection->io_mtx, NULL);
 
 	/* We use a larger buffer for peer->obuf_work in the event that:
@@ -8843,6 +8845,10 @@ static void peer_reset_message_stats(struct peer *peer)
 				      memory_order_relaxed);
 		atomic_store_explicit(&peer->dynamic_cap_out, 0,
 				      memory_order_relaxed);
+		atomic_store_explicit(&peer->write_calls, 0,
+				      memory_order_relaxed);
+		atomic_store_explicit(&peer->write_blocked, 0,
+				      memory_order_relaxed);
 	}
 }
 
@@ -9176,6 +9182,8 @@ void bgp_pthreads_run(void)
 	/* Wait until threads are ready. */
 	frr_pthread_wait_running(bgp_pth_io);
 	frr_pthread_wait_running(bgp_pth_ka);
+
+	bgp_preparse_run();
 }
 
 void bgp_pthreads_finish(void)
@@ -34,6 +34,7 @@ PREDECL_LIST(zebra_l2_vni);
 #include "bgp_addpath_types.h"
 #include "bgp_nexthop.h"
 #include "bgp_io.h"
+#include "bgp_preparse.h"
 #include "bgp_damp.h"
 
 #include "lib/bfd.h"
@@ -210,6 +211,12 @@ struct bgp_master {
 	uint32_t inq_limit;
 	uint32_t outq_limit;
 
+	/* pthreads decoding UPDATEs ahead of the main pthread, 0 = off */
+	uint32_t update_parse_threads;
+
+	/* shared-memory ring offered to zebra, in bytes, 0 = off */
+	size_t zapi_ring_size;
+
 	struct event *t_bgp_sync_label_manager;
 	struct event *t_bgp_start_label_manager;
 
@@ -604,6 +611,8 @@ struct bgp {
 		uint32_t peer_refreshes_combined;
 		uint32_t adj_count;
 		uint32_t merge_checks_triggered;
+		uint32_t attr_encodings;
+		uint32_t attr_encodings_reused;
 
 		uint32_t updgrps_created;
 		uint32_t updgrps_deleted;
@@ -1040,6 +1049,9 @@ struct bgp {
 	/* Meta Queue Information */
 	struct meta_queue *mq;
 
+	/* Round-robin weight of each AFI/SAFI in the meta queue, 0 for default */
+	uint8_t process_weight[AFI_MAX][SAFI_MAX];
+
 	bool fast_convergence;
 
 	/* BGP Conditional advertisement */
@@ -1472,6 +1484,7 @@ struct peer_connection {
 	struct stream_fifo *obuf; // packets waiting to be written
 
 	struct ringbuf *ibuf_work; // WiP buffer used by bgp_read() only
+	struct bgp_preparse_fifo_head preparse; // guarded by io_mtx
 
 	struct event *t_read;
 	struct event *t_write;
@@ -1510,6 +1523,7 @@ struct peer_connection {
 	struct peer_connection_fifo_item fifo_item;
 
 	struct stream *curr;
+	struct bgp_preparse *curr_prep; // pre-parse work for curr
 
 	/*
 	 * Timestamp of the last outgoing messge to the peer.
@@ -1590,8 +1604,12 @@ struct peer {
 	enum bgp_fsm_events last_event;
 	enum bgp_fsm_events last_major_event;
 
-	/* Peer index, used for dumping TABLE_DUMP_V2 format */
+	/*
+	 * Peer index, used for dumping TABLE_DUMP_V2 format; only valid
+	 * while table_dump_gen matches the dump in progress
+	 */
 	uint16_t table_dump_index;
+	unsigned int table_dump_gen;
 
 	/* Peer information */
 
@@ -2013,6 +2031,8 @@ struct peer {
 	_Atomic uint32_t refresh_out;     /* Route Refresh output count */
 	_Atomic uint32_t dynamic_cap_in;  /* Dynamic Capability input count.  */
 	_Atomic uint32_t dynamic_cap_out; /* Dynamic Capability output count. */
+	_Atomic uint32_t write_calls;     /* writev() calls on the socket */
+	_Atomic uint32_t write_blocked;   /* writev() calls cut short */
 
 	uint32_t stat_pfx_filter;
 	uint32_t stat_pfx_aspath_loop;
@@ -52,6 +52,7 @@ DEFINE_MTYPE(RFAPI, RFAPI_MONITOR_ENCAP, "RFAPI Monitor Encap");
 DEFINE_MTYPE(RFAPI, RFAPI_NEXTHOP, "RFAPI Next Hop");
 DEFINE_MTYPE(RFAPI, RFAPI_VN_OPTION, "RFAPI VN Option");
 DEFINE_MTYPE(RFAPI, RFAPI_UN_OPTION, "RFAPI UN Option");
+DEFINE_MTYPE(RFAPI, RFAPI_OPTION_CHAIN, "RFAPI Shared Option Chain");
 DEFINE_MTYPE(RFAPI, RFAPI_WITHDRAW, "RFAPI Withdraw");
 DEFINE_MTYPE(RFAPI, RFAPI_RFG_NAME, "RFAPI RFGName");
 DEFINE_MTYPE(RFAPI, RFAPI_ADB, "RFAPI Advertisement Data");
@@ -66,6 +67,7 @@ DEFINE_MTYPE(RFAPI, RFAPI_RECENT_DELETE, "RFAPI Recently Deleted Route");
 DEFINE_MTYPE(RFAPI, RFAPI_L2ADDR_OPT, "RFAPI L2 Address Option");
 DEFINE_MTYPE(RFAPI, RFAPI_AP, "RFAPI Advertised Prefix");
 DEFINE_MTYPE(RFAPI, RFAPI_MONITOR_ETH, "RFAPI Monitor Ethernet");
+DEFINE_MTYPE(RFAPI, RFAPI_RT_INDEX, "RFAPI RT Import Index");
 
 DEFINE_QOBJ_TYPE(rfapi_nve_group_cfg);
 DEFINE_QOBJ_TYPE(rfapi_l2_group_cfg);
@@ -3805,6 +3807,8 @@ struct rfapi_cfg *bgp_rfapi_cfg_new(struct rfapi_rfp_cfg *cfg)
 			RFAPI_RFP_CFG_DEFAULT_HOLDDOWN_FACTOR;
 		h->rfp_cfg.use_updated_response = 0;
 		h->rfp_cfg.use_removes = 0;
+		h->rfp_cfg.response_coalesce_msec = 0;
+		h->rfp_cfg.response_coalesce_max = 0;
 	} else {
 		h->rfp_cfg.download_type = cfg->download_type;
 		h->rfp_cfg.ftd_advertisement_interval =
@@ -3812,6 +3816,9 @@ struct rfapi_cfg *bgp_rfapi_cfg_new(struct rfapi_rfp_cfg *cfg)
 		h->rfp_cfg.holddown_factor = cfg->holddown_factor;
 		h->rfp_cfg.use_updated_response = cfg->use_updated_response;
 		h->rfp_cfg.use_removes = cfg->use_removes;
+		h->rfp_cfg.response_coalesce_msec =
+			cfg->response_coalesce_msec;
+		h->rfp_cfg.response_coalesce_max = cfg->response_coalesce_max;
 		if (cfg->use_updated_response)
 			h->flags &= ~BGP_VNC_CONFIG_CALLBACK_DISABLE;
 		else
@@ -4584,6 +4591,19 @@ void bgp_rfapi_show_summary(struct bgp *bgp, struct vty *vty)
 	vty_out(vty, "%-39s %-19s %s\n", "RFP Removal responses:",
 		(hc->rfp_cfg.use_removes == 0 ? "Off" : "On"),
 		(hc->rfp_cfg.use_removes == 0 ? "(default)" : ""));
+	if (hc->rfp_cfg.response_coalesce_msec) {
+		snprintf(tmp, sizeof(tmp), "%u msec",
+			 hc->rfp_cfg.response_coalesce_msec);
+		vty_out(vty, "%-39s %-19s\n", "RFP Response coalescing:", tmp);
+		if (hc->rfp_cfg.response_coalesce_max) {
+			snprintf(tmp, sizeof(tmp), "%u updates",
+				 hc->rfp_cfg.response_coalesce_max);
+			vty_out(vty, "%-39s %-19s\n", "    Flush Threshold:",
+				tmp);
+		}
+	} else
+		vty_out(vty, "%-39s %-19s %s\n", "RFP Response coalescing:",
+			"Off", "(default)");
 	vty_out(vty, "%-39s %-19s %s\n", "RFP Full table download:",
 		(hc->rfp_cfg.download_type == RFAPI_RFP_DOWNLOAD_FULL ? "On"
 								      : "Off"),
@@ -17,6 +17,8 @@
 #include "lib/stream.h"
 #include "lib/ringbuf.h"
 #include "lib/lib_errors.h"
+#include "lib/jhash.h"
+#include "lib/typesafe.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_ecommunity.h"
@@ -488,33 +490,227 @@ void rfapi_nexthop_free(void *p)
 	XFREE(MTYPE_RFAPI_NEXTHOP, goner);
 }
 
-struct rfapi_vn_option *rfapi_vn_options_dup(struct rfapi_vn_option *existing)
+/*
+ * Option chains in next hop lists and in NVE RIB entries are interned.
+ * Each distinct chain is stored once and is read-only. All the lists
+ * and RIB entries that hold it share it, and a reference count tracks
+ * them, so NVEs querying the same popular prefixes do not each hold a
+ * copy. The elements of an interned chain sit in one block after the
+ * rfapi_opt_chain header and are linked in order through their next
+ * pointers, as consumers of the chains expect.
+ *
+ * Chains built elsewhere, e.g. by the RFP or by the vty code, are plain
+ * linked lists. The free functions below tell the two kinds apart by
+ * looking the head up in rfapi_opt_chains_byptr.
+ */
+enum rfapi_opt_kind {
+	RFAPI_OPT_VN,
+	RFAPI_OPT_UN,
+};
+
+PREDECL_HASH(rfapi_opt_chains);
+PREDECL_HASH(rfapi_opt_chains_byptr);
+
+struct rfapi_opt_chain {
+	struct rfapi_opt_chains_item item;
+	struct rfapi_opt_chains_byptr_item ptr_item;
+	uint32_t refcnt;
+	uint32_t hash;
+	uint16_t count;
+	uint8_t kind;
+	void *head; /* first element, follows this header */
+};
+
+static size_t rfapi_opt_size(uint8_t kind)
 {
-	struct rfapi_vn_option *p;
-	struct rfapi_vn_option *head = NULL;
-	struct rfapi_vn_option *tail = NULL;
+	return kind == RFAPI_OPT_VN ? sizeof(struct rfapi_vn_option)
+				    : sizeof(struct rfapi_un_option);
+}
 
-	for (p = existing; p; p = p->next) {
-		struct rfapi_vn_option *new;
+/* everything after the next pointer is content */
+static size_t rfapi_opt_skip(uint8_t kind)
+{
+	return kind == RFAPI_OPT_VN ? offsetof(struct rfapi_vn_option, type)
+				    : offsetof(struct rfapi_un_option, type);
+}
 
-		new = XCALLOC(MTYPE_RFAPI_VN_OPTION,
-			      sizeof(struct rfapi_vn_option));
-		*new = *p;
-		new->next = NULL;
-		if (tail)
-			(tail)->next = new;
-		tail = new;
-		if (!head) {
-			head = new;
-		}
+static const void *rfapi_opt_next(uint8_t kind, const void *opt)
+{
+	if (kind == RFAPI_OPT_VN)
+		return ((const struct rfapi_vn_option *)opt)->next;
+	return ((const struct rfapi_un_option *)opt)->next;
+}
+
+static void rfapi_opt_set_next(uint8_t kind, void *opt, void *next)
+{
+	if (kind == RFAPI_OPT_VN)
+		((struct rfapi_vn_option *)opt)->next = next;
+	else
+		((struct rfapi_un_option *)opt)->next = next;
+}
+
+static int rfapi_opt_chains_cmp(const struct rfapi_opt_chain *a,
+				const struct rfapi_opt_chain *b)
+{
+	size_t skip = rfapi_opt_skip(a->kind);
+	size_t len = rfapi_opt_size(a->kind) - skip;
+	const void *oa, *ob;
+	int rc;
+
+	if (a->kind != b->kind)
+		return numcmp(a->kind, b->kind);
+	if (a->count != b->count)
+		return numcmp(a->count, b->count);
+
+	for (oa = a->head, ob = b->head; oa && ob;
+	     oa = rfapi_opt_next(a->kind, oa),
+	     ob = rfapi_opt_next(b->kind, ob)) {
+		rc = memcmp((const char *)oa + skip, (const char *)ob + skip,
+			    len);
+		if (rc)
+			return rc;
 	}
-	return head;
+	return 0;
+}
+
+static uint32_t rfapi_opt_chains_hash(const struct rfapi_opt_chain *oc)
+{
+	return oc->hash;
+}
+
+DECLARE_HASH(rfapi_opt_chains, struct rfapi_opt_chain, item,
+	     rfapi_opt_chains_cmp, rfapi_opt_chains_hash);
+
+static int rfapi_opt_chains_byptr_cmp(const struct rfapi_opt_chain *a,
+				      const struct rfapi_opt_chain *b)
+{
+	return numcmp((uintptr_t)a->head, (uintptr_t)b->head);
+}
+
+static uint32_t rfapi_opt_chains_byptr_hash(const struct rfapi_opt_chain *oc)
+{
+	return jhash(&oc->head, sizeof(oc->head), 0);
+}
+
+DECLARE_HASH(rfapi_opt_chains_byptr, struct rfapi_opt_chain, ptr_item,
+	     rfapi_opt_chains_byptr_cmp, rfapi_opt_chains_byptr_hash);
+
+static struct rfapi_opt_chains_head rfapi_opt_chains[1] = {
+	INIT_HASH(rfapi_opt_chains[0]),
+};
+static struct rfapi_opt_chains_byptr_head rfapi_opt_chains_byptr[1] = {
+	INIT_HASH(rfapi_opt_chains_byptr[0]),
+};
+
+static struct rfapi_opt_chain *rfapi_opt_chain_lookup_ptr(const void *head)
+{
+	struct rfapi_opt_chain key = { .head = (void *)head };
+
+	return rfapi_opt_chains_byptr_find(rfapi_opt_chains_byptr, &key);
+}
+
+static void *rfapi_opt_chain_intern(uint8_t kind, const void *chain)
+{
+	struct rfapi_opt_chain key = {};
+	struct rfapi_opt_chain *oc;
+	size_t size = rfapi_opt_size(kind);
+	size_t skip = rfapi_opt_skip(kind);
+	const void *opt;
+	char *dst;
+
+	if (!chain)
+		return NULL;
+
+	key.kind = kind;
+	key.head = (void *)chain;
+	key.hash = kind;
+	for (opt = chain; opt; opt = rfapi_opt_next(kind, opt)) {
+		key.hash = jhash((const char *)opt + skip, size - skip,
+				 key.hash);
+		key.count++;
+	}
+
+	oc = rfapi_opt_chains_find(rfapi_opt_chains, &key);
+	if (oc) {
+		oc->refcnt++;
+		return oc->head;
+	}
+
+	oc = XCALLOC(MTYPE_RFAPI_OPTION_CHAIN, sizeof(*oc) + key.count * size);
+	oc->kind = kind;
+	oc->hash = key.hash;
+	oc->count = key.count;
+	oc->refcnt = 1;
+	oc->head = oc + 1;
+
+	dst = oc->head;
+	for (opt = chain; opt; opt = rfapi_opt_next(kind, opt)) {
+		memcpy(dst, opt, size);
+		rfapi_opt_set_next(kind, dst,
+				   rfapi_opt_next(kind, opt) ? dst + size
+							     : NULL);
+		dst += size;
+	}
+
+	rfapi_opt_chains_add(rfapi_opt_chains, oc);
+	rfapi_opt_chains_byptr_add(rfapi_opt_chains_byptr, oc);
+	return oc->head;
+}
+
+/* another reference to an interned chain, or an interned copy */
+static void *rfapi_opt_chain_ref(uint8_t kind, const void *chain)
+{
+	struct rfapi_opt_chain *oc;
+
+	if (!chain)
+		return NULL;
+
+	oc = rfapi_opt_chain_lookup_ptr(chain);
+	if (!oc)
+		return rfapi_opt_chain_intern(kind, chain);
+	oc->refcnt++;
+	return oc->head;
+}
+
+/* returns false if chain is not interned */
+static bool rfapi_opt_chain_unref(const void *chain)
+{
+	struct rfapi_opt_chain *oc;
+
+	oc = rfapi_opt_chain_lookup_ptr(chain);
+	if (!oc)
+		return false;
+
+	if (--oc->refcnt == 0) {
+		rfapi_opt_chains_del(rfapi_opt_chains, oc);
+		rfapi_opt_chains_byptr_del(rfapi_opt_chains_byptr, oc);
+		XFREE(MTYPE_RFAPI_OPTION_CHAIN, oc);
+	}
+	return true;
+}
+
+struct rfapi_vn_option *rfapiVnOptionsIntern(const struct rfapi_vn_option *orig)
+{
+	return rfapi_opt_chain_intern(RFAPI_OPT_VN, orig);
+}
+
+struct rfapi_un_option *rfapiUnOptionsIntern(const struct rfapi_un_option *orig)
+{
+	return rfapi_opt_chain_intern(RFAPI_OPT_UN, orig);
+}
+
+struct rfapi_vn_option *rfapi_vn_options_dup(struct rfapi_vn_option *existing)
+{
+	return rfapi_opt_chain_ref(RFAPI_OPT_VN, existing);
 }
 
 void rfapi_un_options_free(struct rfapi_un_option *p)
 {
 	struct rfapi_un_option *next;
 
+	if (!p || rfapi_opt_chain_unref(p))
+		return;
+
 	while (p) {
 		next = p->next;
 		XFREE(MTYPE_RFAPI_UN_OPTION, p);
@@ -526,6 +722,9 @@ void rfapi_vn_options_free(struct rfapi_vn_option *p)
 {
 	struct rfapi_vn_option *next;
 
+	if (!p || rfapi_opt_chain_unref(p))
+		return;
+
 	while (p) {
 		next = p->next;
 		XFREE(MTYPE_RFAPI_VN_OPTION, p);
@@ -1135,6 +1334,8 @@ int rfapi_rfp_set_configuration(void *rfp_start_val, struct rfapi_rfp_cfg *new)
 	rcfg->download_type = new->download_type;
 	rcfg->ftd_advertisement_interval = new->ftd_advertisement_interval;
 	rcfg->holddown_factor = new->holddown_factor;
+	rcfg->response_coalesce_msec = new->response_coalesce_msec;
+	rcfg->response_coalesce_max = new->response_coalesce_max;
 
 	if (rcfg->use_updated_response != new->use_updated_response) {
 		rcfg->use_updated_response = new->use_updated_response;
@@ -1347,48 +1548,12 @@ int rfapi_init_and_open(struct bgp *bgp, struct rfapi_descriptor *rfd,
 
 struct rfapi_vn_option *rfapiVnOptionsDup(struct rfapi_vn_option *orig)
 {
-	struct rfapi_vn_option *head = NULL;
-	struct rfapi_vn_option *tail = NULL;
-	struct rfapi_vn_option *vo = NULL;
-
-	for (vo = orig; vo; vo = vo->next) {
-		struct rfapi_vn_option *new;
-
-		new = XCALLOC(MTYPE_RFAPI_VN_OPTION,
-			      sizeof(struct rfapi_vn_option));
-		memcpy(new, vo, sizeof(struct rfapi_vn_option));
-		new->next = NULL;
-
-		if (tail) {
-			tail->next = new;
-		} else {
-			head = tail = new;
-		}
-	}
-	return head;
+	return rfapi_opt_chain_ref(RFAPI_OPT_VN, orig);
 }
 
 struct rfapi_un_option *rfapiUnOptionsDup(struct rfapi_un_option *orig)
 {
-	struct rfapi_un_option *head = NULL;
-	struct rfapi_un_option *tail = NULL;
-	struct rfapi_un_option *uo = NULL;
-
-	for (uo = orig; uo; uo = uo->next) {
-		struct rfapi_un_option *new;
-
-		new = XCALLOC(MTYPE_RFAPI_UN_OPTION,
-			      sizeof(struct rfapi_un_option));
-		memcpy(new, uo, sizeof(struct rfapi_un_option));
-		new->next = NULL;
-
-		if (tail) {
-			tail->next = new;
-		} else {
-			head = tail = new;
-		}
-	}
-	return head;
+	return rfapi_opt_chain_ref(RFAPI_OPT_UN, orig);
 }
 
 struct bgp_tea_options *rfapiOptionsDup(struct bgp_tea_options *orig)
@@ -1437,22 +1602,14 @@ void rfapiAdbFree(struct rfapi_adb *adb)
 	XFREE(MTYPE_RFAPI_ADB, adb);
 }
 
-static int
-rfapi_query_inner(void *handle, struct rfapi_ip_addr *target,
-		  struct rfapi_l2address_option *l2o, /* may be NULL */
-		  struct rfapi_next_hop_entry **ppNextHopEntry)
+/*
+ * Checks common to every query on a descriptor. Split out of
+ * rfapi_query_inner() so that rfapi_query_batch() can run them once
+ * for the whole batch.
+ */
+static int rfapi_query_check(struct rfapi_descriptor *rfd)
 {
-	afi_t afi;
-	struct prefix p;
-	struct prefix p_original;
-	struct agg_node *rn;
-	struct rfapi_descriptor *rfd = (struct rfapi_descriptor *)handle;
 	struct bgp *bgp = rfd->bgp;
-	struct rfapi_next_hop_entry *pNHE = NULL;
-	struct rfapi_ip_addr *self_vn_addr = NULL;
-	int eth_is_0 = 0;
-	int use_eth_resolution = 0;
-	struct rfapi_next_hop_entry *i_nhe;
 
 	/* preemptive */
 	if (!bgp) {
@@ -1478,21 +1635,65 @@ rfapi_query_inner(void *handle, struct rfapi_ip_addr *target,
 		return EBADF;
 	}
 
+	if (VNC_DEBUG(VERBOSE)) {
+		char *s;
+
+		s = ecommunity_ecom2str(rfd->import_table->rt_import_list,
+					ECOMMUNITY_FORMAT_ROUTE_MAP, 0);
+		zlog_debug(
+			"%s rfd->import_table=%p, rfd->import_table->rt_import_list: %s",
+			__func__, rfd->import_table, s);
+		XFREE(MTYPE_ECOMMUNITY_STR, s);
+	}
+
+	return 0;
+}
+
+/*
+ * Whether <l2o> makes a query L2-based rather than IP-based
+ */
+static bool rfapi_query_l2o_used(const struct rfapi_l2address_option *l2o)
+{
+	if (!l2o)
+		return false;
+
+	/* per t/c Paul/Lou 151022 */
+	return memcmp(l2o->macaddr.octet, rfapi_ethaddr0.octet, ETH_ALEN) ||
+	       l2o->logical_net_id;
+}
+
+/*
+ * Resolve one target. Caller must have validated rfd via
+ * rfapi_query_check(). <now> is passed in so that a batch of
+ * queries does not read the clock once per target.
+ */
+static int
+rfapi_query_lookup(struct rfapi_descriptor *rfd, struct rfapi_ip_addr *target,
+		   struct rfapi_l2address_option *l2o, /* may be NULL */
+		   struct rfapi_next_hop_entry **ppNextHopEntry, time_t now)
+{
+	afi_t afi;
+	struct prefix p;
+	struct prefix p_original;
+	struct agg_node *rn;
+	struct bgp *bgp = rfd->bgp;
+	struct rfapi_next_hop_entry *pNHE = NULL;
+	struct rfapi_ip_addr *self_vn_addr = NULL;
+	int eth_is_0 = 0;
+	int use_eth_resolution = 0;
+	struct rfapi_next_hop_entry *i_nhe;
+
 	rfd->rsp_counter++;		  /* dedup: identify this generation */
-	rfd->rsp_time = monotime(NULL);	  /* response content dedup */
+	rfd->rsp_time = now;		  /* response content dedup */
 	rfd->ftd_last_allowed_time =
-		monotime(NULL) -
-		bgp->rfapi_cfg->rfp_cfg.ftd_advertisement_interval;
+		now - bgp->rfapi_cfg->rfp_cfg.ftd_advertisement_interval;
 
 	if (l2o) {
 		if (!memcmp(l2o->macaddr.octet, rfapi_ethaddr0.octet,
 			    ETH_ALEN)) {
 			eth_is_0 = 1;
 		}
-		/* per t/c Paul/Lou 151022 */
-		if (!eth_is_0 || l2o->logical_net_id) {
-			use_eth_resolution = 1;
-		}
+		use_eth_resolution = rfapi_query_l2o_used(l2o);
 	}
 
 	if (ppNextHopEntry)
@@ -1512,19 +1713,8 @@ rfapi_query_inner(void *handle, struct rfapi_ip_addr *target,
 		p = p_original;
 	}
 
-	{
-		char *s;
-
-		vnc_zlog_debug_verbose("%s(rfd=%p, target=%pFX, ppNextHop=%p)",
-				       __func__, rfd, &p, ppNextHopEntry);
-
-		s = ecommunity_ecom2str(rfd->import_table->rt_import_list,
-					ECOMMUNITY_FORMAT_ROUTE_MAP, 0);
-		vnc_zlog_debug_verbose(
-			"%s rfd->import_table=%p, rfd->import_table->rt_import_list: %s",
-			__func__, rfd->import_table, s);
-		XFREE(MTYPE_ECOMMUNITY_STR, s);
-	}
+	vnc_zlog_debug_verbose("%s(rfd=%p, target=%pFX, ppNextHop=%p)",
+			       __func__, rfd, &p, ppNextHopEntry);
 
 	afi = family2afi(p.family);
 	assert(afi);
@@ -1697,6 +1887,22 @@ done:
 	return 0;
 }
 
+static int
+rfapi_query_inner(void *handle, struct rfapi_ip_addr *target,
+		  struct rfapi_l2address_option *l2o, /* may be NULL */
+		  struct rfapi_next_hop_entry **ppNextHopEntry)
+{
+	struct rfapi_descriptor *rfd = (struct rfapi_descriptor *)handle;
+	int rc;
+
+	rc = rfapi_query_check(rfd);
+	if (rc)
+		return rc;
+
+	return rfapi_query_lookup(rfd, target, l2o, ppNextHopEntry,
+				  monotime(NULL));
+}
+
 /*
  * support on-the-fly reassignment of an already-open nve to a new
  * nve-group in the event that its original nve-group is
@@ -2252,14 +2458,20 @@ int rfapi_reopen(struct rfapi_descriptor *rfd, struct bgp *bgp)
  ***********************************************************************/
 /*
  * Announce reachability to this prefix via the NVE
+ *
+ * If <defer_tunnel> is non-NULL, a needed tunnel route (re)announcement
+ * is not made here; instead *defer_tunnel is set and the caller is
+ * responsible for calling rfapiTunnelRouteAnnounce() once it has
+ * finished registering its prefixes.
  */
-int rfapi_register(void *handle, struct rfapi_ip_prefix *prefix,
-		   uint32_t lifetime, /* host byte order */
-		   struct rfapi_un_option *options_un,
-		   struct rfapi_vn_option *options_vn,
-		   rfapi_register_action action)
+static int rfapi_register_inner(struct rfapi_descriptor *rfd,
+				struct rfapi_ip_prefix *prefix,
+				uint32_t lifetime, /* host byte order */
+				struct rfapi_un_option *options_un,
+				struct rfapi_vn_option *options_vn,
+				rfapi_register_action action,
+				int *defer_tunnel)
 {
-	struct rfapi_descriptor *rfd = (struct rfapi_descriptor *)handle;
 	struct bgp *bgp;
 	struct prefix p;
 	struct prefix *pfx_ip = NULL;
@@ -2495,7 +2707,9 @@ int rfapi_register(void *handle, struct rfapi_ip_prefix *prefix,
 
 		if (0 == rfapiApDelete(bgp, rfd, &p, pfx_mac, &prd,
 				       &adv_tunnel)) {
-			if (adv_tunnel)
+			if (adv_tunnel && defer_tunnel)
+				*defer_tunnel = 1;
+			else if (adv_tunnel)
 				rfapiTunnelRouteAnnounce(
 					bgp, rfd, &rfd->max_prefix_lifetime);
 		}
@@ -2522,7 +2736,9 @@ int rfapi_register(void *handle, struct rfapi_ip_prefix *prefix,
 
 		vnc_zlog_debug_verbose("%s: adv_tunnel = %d", __func__,
 				       adv_tunnel);
-		if (adv_tunnel) {
+		if (adv_tunnel && defer_tunnel) {
+			*defer_tunnel = 1;
+		} else if (adv_tunnel) {
 			vnc_zlog_debug_verbose("%s: announcing tunnel route",
 					       __func__);
 			rfapiTunnelRouteAnnounce(bgp, rfd,
@@ -2618,6 +2834,55 @@ int rfapi_register(void *handle, struct rfapi_ip_prefix *prefix,
 	return 0;
 }
 
+int rfapi_register(void *handle, struct rfapi_ip_prefix *prefix,
+		   uint32_t lifetime, /* host byte order */
+		   struct rfapi_un_option *options_un,
+		   struct rfapi_vn_option *options_vn,
+		   rfapi_register_action action)
+{
+	return rfapi_register_inner((struct rfapi_descriptor *)handle, prefix,
+				    lifetime, options_un, options_vn, action,
+				    NULL);
+}
+
+int rfapi_register_batch(rfapi_handle handle,
+			 struct rfapi_register_batch_entry *entries, int count,
+			 int *failed)
+{
+	struct rfapi_descriptor *rfd = (struct rfapi_descriptor *)handle;
+	int adv_tunnel = 0;
+	int nfailed = 0;
+	int i;
+
+	vnc_zlog_debug_verbose("%s(rfd=%p, count=%d)", __func__, rfd, count);
+
+	for (i = 0; i < count; ++i) {
+		entries[i].rc = rfapi_register_inner(
+			rfd, &entries[i].prefix, entries[i].lifetime,
+			entries[i].options_un, entries[i].options_vn,
+			entries[i].action, &adv_tunnel);
+		if (entries[i].rc)
+			++nfailed;
+	}
+
+	/*
+	 * One tunnel route update covers every lifetime change made
+	 * by the batch. Nothing else is deferred: each entry above has
+	 * already been imported and exported on its own.
+	 */
+	if (adv_tunnel && rfd->bgp && is_valid_rfd(rfd)) {
+		vnc_zlog_debug_verbose("%s: announcing tunnel route",
+				       __func__);
+		rfapiTunnelRouteAnnounce(rfd->bgp, rfd,
+					 &rfd->max_prefix_lifetime);
+	}
+
+	if (failed)
+		*failed = nfailed;
+
+	return (nfailed == count && count) ? entries[0].rc : 0;
+}
+
 int rfapi_query(void *handle, struct rfapi_ip_addr *target,
 		struct rfapi_l2address_option *l2o, /* may be NULL */
 		struct rfapi_next_hop_entry **ppNextHopEntry)
@@ -2646,6 +2911,160 @@ int rfapi_query(void *handle, struct rfapi_ip_addr *target,
 	return rc;
 }
 
+/*
+ * Orders batch entries so that queries for the same target end up
+ * adjacent. Only the parts of l2o that rfapi_query_lookup() looks at
+ * take part in the comparison.
+ */
+static int rfapi_query_batch_cmp(const void *a, const void *b)
+{
+	const struct rfapi_query_batch_entry *qa =
+		*(const struct rfapi_query_batch_entry *const *)a;
+	const struct rfapi_query_batch_entry *qb =
+		*(const struct rfapi_query_batch_entry *const *)b;
+	bool l2a, l2b;
+	int rc;
+
+	if (qa->target.addr_family != qb->target.addr_family)
+		return qa->target.addr_family < qb->target.addr_family ? -1
+									: 1;
+	if (qa->target.addr_family == AF_INET)
+		rc = memcmp(&qa->target.addr.v4, &qb->target.addr.v4,
+			    sizeof(qa->target.addr.v4));
+	else
+		rc = memcmp(&qa->target.addr.v6, &qb->target.addr.v6,
+			    sizeof(qa->target.addr.v6));
+	if (rc)
+		return rc;
+
+	l2a = rfapi_query_l2o_used(qa->l2o);
+	l2b = rfapi_query_l2o_used(qb->l2o);
+	if (l2a != l2b)
+		return l2a ? 1 : -1;
+	if (!l2a)
+		return 0;
+
+	rc = memcmp(qa->l2o->macaddr.octet, qb->l2o->macaddr.octet,
+		    ETH_ALEN);
+	if (rc)
+		return rc;
+	if (qa->l2o->logical_net_id != qb->l2o->logical_net_id)
+		return qa->l2o->logical_net_id < qb->l2o->logical_net_id ? -1
+									  : 1;
+	if (qa->l2o->label != qb->l2o->label)
+		return qa->l2o->label < qb->l2o->label ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Copy of a next hop list for a repeated target. Option chains are
+ * interned, so the copy only takes another reference on them.
+ */
+static struct rfapi_next_hop_entry *
+rfapi_next_hop_list_dup(const struct rfapi_next_hop_entry *list)
+{
+	struct rfapi_next_hop_entry *head = NULL;
+	struct rfapi_next_hop_entry **tail = &head;
+	struct rfapi_next_hop_entry *nh;
+
+	for (; list; list = list->next) {
+		nh = XCALLOC(MTYPE_RFAPI_NEXTHOP, sizeof(*nh));
+		*nh = *list;
+		nh->next = NULL;
+		nh->un_options = rfapi_opt_chain_ref(RFAPI_OPT_UN,
+						     list->un_options);
+		nh->vn_options = rfapi_opt_chain_ref(RFAPI_OPT_VN,
+						     list->vn_options);
+		*tail = nh;
+		tail = &nh->next;
+	}
+	return head;
+}
+
+int rfapi_query_batch(rfapi_handle handle,
+		      struct rfapi_query_batch_entry *entries, int count,
+		      int *failed)
+{
+	struct rfapi_descriptor *rfd = (struct rfapi_descriptor *)handle;
+	struct bgp *bgp = rfd->bgp;
+	struct rfapi_query_batch_entry **sorted;
+	time_t now;
+	int nfailed = 0;
+	int rc;
+	int i;
+
+	if (failed)
+		*failed = 0;
+
+	for (i = 0; i < count; ++i)
+		entries[i].next_hops = NULL;
+
+	if (bgp && bgp->rfapi)
+		bgp->rfapi->stat.count_queries += count;
+
+	if (!rfd->rfg)
+		rc = ESTALE;
+	else
+		rc = rfapi_query_check(rfd);
+
+	if (rc) {
+		for (i = 0; i < count; ++i)
+			entries[i].rc = rc;
+		if (bgp && bgp->rfapi)
+			bgp->rfapi->stat.count_queries_failed += count;
+		if (failed)
+			*failed = count;
+		return rc;
+	}
+
+	vnc_zlog_debug_verbose("%s(rfd=%p, count=%d)", __func__, rfd, count);
+
+	if (count <= 0)
+		return 0;
+
+	/*
+	 * Walk the batch in target order: each distinct target is
+	 * looked up in the import table and its monitor registered
+	 * once, repeats get a copy of the first answer. Sorting also
+	 * keeps successive lookups in neighbouring parts of the table.
+	 */
+	sorted = XCALLOC(MTYPE_TMP, sizeof(*sorted) * count);
+	for (i = 0; i < count; ++i)
+		sorted[i] = &entries[i];
+	qsort(sorted, count, sizeof(*sorted), rfapi_query_batch_cmp);
+
+	now = monotime(NULL);
+	for (i = 0; i < count; ++i) {
+		struct rfapi_query_batch_entry *q = sorted[i];
+		struct rfapi_query_batch_entry *prev;
+		struct rfapi_next_hop_entry *nh;
+
+		prev = i ? sorted[i - 1] : NULL;
+		if (prev && !rfapi_query_batch_cmp(&prev, &q)) {
+			q->rc = prev->rc;
+			q->next_hops = rfapi_next_hop_list_dup(prev->next_hops);
+			/* only a successful lookup answered immediately */
+			if (!prev->rc)
+				++bgp->rfapi->response_immediate_count;
+			for (nh = q->next_hops; nh; nh = nh->next)
+				++rfd->stat_count_nh_reachable;
+		} else {
+			q->rc = rfapi_query_lookup(rfd, &q->target, q->l2o,
+						   &q->next_hops, now);
+		}
+		if (q->rc)
+			++nfailed;
+	}
+
+	XFREE(MTYPE_TMP, sorted);
+
+	bgp->rfapi->stat.count_queries_failed += nfailed;
+	if (failed)
+		*failed = nfailed;
+
+	return (nfailed == count && count) ? entries[0].rc : 0;
+}
+
 int rfapi_query_done(rfapi_handle handle, struct rfapi_ip_addr *target)
 {
 	struct prefix p;
@@ -3546,6 +3965,7 @@ DEFUN (skiplist_debug_cli,
 void rfapi_init(void)
 {
 	rfapi_rib_init();
+	rfapi_monitor_init();
 	rfapi_import_init();
 	bgp_rfapi_cfg_init();
 	vnc_debug_init();
@@ -3581,6 +4001,7 @@ void rfapi_terminate(void)
 {
 	rfapi_import_terminate();
 	rfapi_rib_terminate();
+	rfapi_monitor_terminate();
 }
 
 #ifdef DEBUG_RFAPI
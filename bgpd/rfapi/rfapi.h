@@ -177,7 +177,9 @@ typedef void *rfapi_handle;
  *			This is a linked list allocated within the
  *			rfapi. The response_cb callback function is responsible
  *			for freeing this memory via rfapi_free_next_hop_list()
- *			in order to avoid memory leaks.
+ *			in order to avoid memory leaks. The vn_options and
+ *			un_options chains of the entries may be shared with
+ *			other lists and must not be modified.
  *
  *	userdata	value (cookie) originally specified in call to
  *			rfapi_open()
@@ -313,6 +315,15 @@ struct rfapi_rfp_cfg {
 	uint8_t use_updated_response; /* default=0/no */
 	/* when use_updated_response, also generate remove responses */
 	uint8_t use_removes; /* default=0/no */
+	/*
+	 * When use_updated_response, hold updated responses for up to
+	 * this many milliseconds and deliver them as one next hop list
+	 * per NVE. Changes that cancel out within the window are not
+	 * reported. 0 means deliver each batch as soon as it is processed.
+	 */
+	uint32_t response_coalesce_msec; /* default=0/no */
+	/* when coalescing, deliver early after this many updates */
+	uint32_t response_coalesce_max; /* default=0/no limit */
 };
 
 /***********************************************************************
@@ -645,6 +656,50 @@ extern int rfapi_query(rfapi_handle rfd, struct rfapi_ip_addr *target,
 		       struct rfapi_l2address_option *l2o,
 		       struct rfapi_next_hop_entry **ppNextHopEntry);
 
+/*------------------------------------------
+ * rfapi_query_batch
+ *
+ * Equivalent to calling rfapi_query() once per entry, but the
+ * descriptor and instance checks are made once for the whole batch,
+ * and a target that appears more than once is looked up and
+ * monitored only once; its repeats get copies of the same answer.
+ * Intended for RFPs that must re-issue many queries at once, e.g.,
+ * when a controller reconnects.
+ *
+ * input:
+ *    rfd:	rfapi descriptor returned by rfapi_open
+ *    entries:	array of <count> queries. For each entry, the caller
+ *		sets target and l2o (may be NULL).
+ *    count:	number of entries
+ *
+ * output:
+ *    entries:	for each entry, rc is set to the value rfapi_query()
+ *		would have returned and next_hops to the returned list
+ *		(NULL on error). It is the caller's responsibility to
+ *		free each list via rfapi_free_next_hop_list().
+ *    failed:	number of entries with non-zero rc (may be NULL)
+ *
+ * return value:
+ *	0		At least one entry succeeded (or count is 0)
+ *	other		All entries failed; rc of the first entry. When
+ *			the batch could not be run at all, every entry
+ *			carries the same rc:
+ *	  EBADF		invalid handle
+ *	  ENXIO		BGP or VNC not configured
+ *	  ESTALE	descriptor is no longer usable; should be closed
+ *	  EDEADLK	Called from within a callback procedure
+--------------------------------------------*/
+struct rfapi_query_batch_entry {
+	struct rfapi_ip_addr target;
+	struct rfapi_l2address_option *l2o;
+	struct rfapi_next_hop_entry *next_hops;
+	int rc;
+};
+
+extern int rfapi_query_batch(rfapi_handle rfd,
+			     struct rfapi_query_batch_entry *entries,
+			     int count, int *failed);
+
 /*------------------------------------------
  * rfapi_query_done
  *
@@ -731,6 +786,47 @@ extern int rfapi_register(rfapi_handle rfd, struct rfapi_ip_prefix *prefix,
 			  struct rfapi_vn_option *options_vn,
 			  rfapi_register_action action);
 
+/*------------------------------------------
+ * rfapi_register_batch
+ *
+ * Equivalent to calling rfapi_register() once per entry, except that
+ * the NVE's tunnel route is (re)advertised at most once, after all
+ * entries have been applied, instead of once per lifetime change.
+ * That is the only work batched: each entry's VPN route is still
+ * added or withdrawn, imported into the matching import tables and
+ * exported right away, exactly as rfapi_register() would.
+ * Intended for RFPs re-registering many prefixes, e.g., after a
+ * controller restart.
+ *
+ * input:
+ *    rfd:	rfapi descriptor returned by rfapi_open
+ *    entries:	array of <count> registrations. Fields have the same
+ *		meaning as the corresponding rfapi_register() arguments.
+ *		Options are owned by the caller.
+ *    count:	number of entries
+ *
+ * output:
+ *    entries:	rc of each entry is set to the value rfapi_register()
+ *		would have returned
+ *    failed:	number of entries with non-zero rc (may be NULL)
+ *
+ * return value:
+ *	0		At least one entry succeeded (or count is 0)
+ *	other		All entries failed; rc of the first entry
+ --------------------------------------------*/
+struct rfapi_register_batch_entry {
+	struct rfapi_ip_prefix prefix;
+	uint32_t lifetime;
+	struct rfapi_un_option *options_un;
+	struct rfapi_vn_option *options_vn;
+	rfapi_register_action action;
+	int rc;
+};
+
+extern int rfapi_register_batch(rfapi_handle rfd,
+				struct rfapi_register_batch_entry *entries,
+				int count, int *failed);
+
 /***********************************************************************
  *			Helper / Utility functions
  ***********************************************************************/
@@ -814,6 +910,8 @@ extern int rfapi_compare_rfds(void *rfd1, void *rfd2);
  * rfapi_free_next_hop_list
  *
  * Frees a next_hop_list returned by a rfapi_query invocation
+ * (or passed to a response callback). Shared option chains are
+ * released rather than freed.
  *
  * input:
  *    list:   a pointer to a response list (as a
@@ -48,82 +48,47 @@
  * We maintain a list of prefixes advertised by each NVE.
  * There are two indices: by prefix and by lifetime.
  *
- * BY-PREFIX skiplist
+ * BY-PREFIX hash (ipN_by_prefix, ip0_by_ether)
  *
- *  key:	ptr to struct prefix (when storing, point to prefix that
- *		is part of rfapi_adb).
+ *  key:	rfapi_rib_key in the rfapi_adb
  *
- *  value:	ptr to struct rfapi_adb
+ * BY-LIFETIME rbtree
  *
- * BY-LIFETIME skiplist
+ *  key:	rfapi_adb lifetime (ties broken by adb pointer value), so
+ *		the min and max lifetimes are the first and last items
  *
- *  key:	ptr to struct rfapi_adb
- *  value:	ptr to struct rfapi_adb
- *
- */
-
-/*
- * Skiplist sort function that sorts first according to lifetime
- * and then according to adb pointer value. The adb pointer
- * is used to spread out the sort for adbs with the same lifetime
- * and thereby make the skip list operations more efficient.
+ * Both are intrusive, so an advertisement costs exactly one allocation
+ * (the rfapi_adb itself).
  */
-static int sl_adb_lifetime_cmp(const void *adb1, const void *adb2)
-{
-	const struct rfapi_adb *a1 = adb1;
-	const struct rfapi_adb *a2 = adb2;
-
-	if (a1->lifetime < a2->lifetime)
-		return -1;
-	if (a1->lifetime > a2->lifetime)
-		return 1;
-
-	if (a1 < a2)
-		return -1;
-	if (a1 > a2)
-		return 1;
-
-	return 0;
-}
 
 void rfapiApInit(struct rfapi_advertised_prefixes *ap)
 {
-	ap->ipN_by_prefix = skiplist_new(0, rfapi_rib_key_cmp, NULL);
-	ap->ip0_by_ether = skiplist_new(0, rfapi_rib_key_cmp, NULL);
-	ap->by_lifetime = skiplist_new(0, sl_adb_lifetime_cmp, NULL);
+	rfapi_adb_pfx_init(&ap->ipN_by_prefix);
+	rfapi_adb_pfx_init(&ap->ip0_by_ether);
+	rfapi_adb_lifetime_init(&ap->by_lifetime);
 }
 
 void rfapiApRelease(struct rfapi_advertised_prefixes *ap)
 {
 	struct rfapi_adb *adb;
 
-	/* Free ADBs and lifetime items */
-	while (0 == skiplist_first(ap->by_lifetime, NULL, (void **)&adb)) {
-		rfapiAdbFree(adb);
-		skiplist_delete_first(ap->by_lifetime);
-	}
-
-	while (0 == skiplist_delete_first(ap->ipN_by_prefix))
+	while (rfapi_adb_pfx_pop(&ap->ipN_by_prefix))
 		;
-	while (0 == skiplist_delete_first(ap->ip0_by_ether))
+	while (rfapi_adb_pfx_pop(&ap->ip0_by_ether))
 		;
 
-	/* Free lists */
-	skiplist_free(ap->ipN_by_prefix);
-	skiplist_free(ap->ip0_by_ether);
-	skiplist_free(ap->by_lifetime);
+	/* Free ADBs and lifetime items */
+	while ((adb = rfapi_adb_lifetime_pop(&ap->by_lifetime)))
+		rfapiAdbFree(adb);
 
-	ap->ipN_by_prefix = NULL;
-	ap->ip0_by_ether = NULL;
-	ap->by_lifetime = NULL;
+	rfapi_adb_pfx_fini(&ap->ipN_by_prefix);
+	rfapi_adb_pfx_fini(&ap->ip0_by_ether);
+	rfapi_adb_lifetime_fini(&ap->by_lifetime);
 }
 
 int rfapiApCount(struct rfapi_descriptor *rfd)
 {
-	if (!rfd->advertised.by_lifetime)
-		return 0;
-
-	return skiplist_count(rfd->advertised.by_lifetime);
+	return rfapi_adb_lifetime_count(&rfd->advertised.by_lifetime);
 }
 
 int rfapiApCountAll(struct bgp *bgp)
@@ -146,13 +111,8 @@ int rfapiApCountAll(struct bgp *bgp)
 void rfapiApReadvertiseAll(struct bgp *bgp, struct rfapi_descriptor *rfd)
 {
 	struct rfapi_adb *adb;
-	void *cursor = NULL;
-	int rc;
 
-	for (rc = skiplist_next(rfd->advertised.by_lifetime, NULL,
-				(void **)&adb, &cursor);
-	     rc == 0; rc = skiplist_next(rfd->advertised.by_lifetime, NULL,
-					 (void **)&adb, &cursor)) {
+	frr_each (rfapi_adb_lifetime, &rfd->advertised.by_lifetime, adb) {
 
 		struct prefix_rd prd;
 		uint32_t local_pref = rfp_cost_to_localpref(adb->cost);
@@ -179,15 +139,8 @@ void rfapiApReadvertiseAll(struct bgp *bgp, struct rfapi_descriptor *rfd)
 void rfapiApWithdrawAll(struct bgp *bgp, struct rfapi_descriptor *rfd)
 {
 	struct rfapi_adb *adb;
-	void *cursor;
-	int rc;
-
 
-	cursor = NULL;
-	for (rc = skiplist_next(rfd->advertised.by_lifetime, NULL,
-				(void **)&adb, &cursor);
-	     rc == 0; rc = skiplist_next(rfd->advertised.by_lifetime, NULL,
-					 (void **)&adb, &cursor)) {
+	frr_each (rfapi_adb_lifetime, &rfd->advertised.by_lifetime, adb) {
 
 		struct prefix pfx_vn_buf;
 		struct prefix *pfx_ip;
@@ -338,59 +291,11 @@ static int rfapiApAdjustLifetimeStats(
 		struct rfapi_adb *adb_min;
 		struct rfapi_adb *adb_max;
 
-		if (!skiplist_first(rfd->advertised.by_lifetime,
-				    (void **)&adb_min, NULL)
-		    && !skiplist_last(rfd->advertised.by_lifetime,
-				      (void **)&adb_max, NULL)) {
-
-			/*
-			 * This should always work
-			 */
+		adb_min = rfapi_adb_lifetime_first(&rfd->advertised.by_lifetime);
+		adb_max = rfapi_adb_lifetime_last(&rfd->advertised.by_lifetime);
+		if (adb_min && adb_max) {
 			min = adb_min->lifetime;
 			max = adb_max->lifetime;
-
-		} else {
-
-			void *cursor;
-			struct rfapi_rib_key rk;
-			struct rfapi_adb *adb;
-			int rc;
-
-			vnc_zlog_debug_verbose(
-				"%s: walking to find new min/max", __func__);
-
-			cursor = NULL;
-			for (rc = skiplist_next(rfd->advertised.ipN_by_prefix,
-						(void **)&rk, (void **)&adb,
-						&cursor);
-			     !rc;
-			     rc = skiplist_next(rfd->advertised.ipN_by_prefix,
-						(void **)&rk, (void **)&adb,
-						&cursor)) {
-
-				uint32_t lt = adb->lifetime;
-
-				if (lt > max)
-					max = lt;
-				if (lt < min)
-					min = lt;
-			}
-			cursor = NULL;
-			for (rc = skiplist_next(rfd->advertised.ip0_by_ether,
-						(void **)&rk, (void **)&adb,
-						&cursor);
-			     !rc;
-			     rc = skiplist_next(rfd->advertised.ip0_by_ether,
-						(void **)&rk, (void **)&adb,
-						&cursor)) {
-
-				uint32_t lt = adb->lifetime;
-
-				if (lt > max)
-					max = lt;
-				if (lt < min)
-					min = lt;
-			}
 		}
 
 		/*
@@ -422,51 +327,39 @@ int rfapiApAdd(struct bgp *bgp, struct rfapi_descriptor *rfd,
 	       struct prefix_rd *prd, uint32_t lifetime, uint8_t cost,
 	       struct rfapi_l2address_option *l2o) /* other options TBD */
 {
-	int rc;
 	struct rfapi_adb *adb;
 	uint32_t old_lifetime = 0;
-	int use_ip0 = 0;
-	struct rfapi_rib_key rk;
+	struct rfapi_adb_pfx_head *by_prefix;
+	struct rfapi_adb ref;
+	bool found;
 
-	rfapi_rib_key_init(pfx_ip, prd, pfx_eth, &rk);
+	rfapi_rib_key_init(pfx_ip, prd, pfx_eth, &ref.u.key);
 	if (RFAPI_0_PREFIX(pfx_ip) && RFAPI_HOST_PREFIX(pfx_ip)) {
-		use_ip0 = 1;
 		assert(pfx_eth);
-		rc = skiplist_search(rfd->advertised.ip0_by_ether, &rk,
-				     (void **)&adb);
-
+		by_prefix = &rfd->advertised.ip0_by_ether;
 	} else {
-
-		/* find prefix in advertised prefixes list */
-		rc = skiplist_search(rfd->advertised.ipN_by_prefix, &rk,
-				     (void **)&adb);
+		by_prefix = &rfd->advertised.ipN_by_prefix;
 	}
 
+	/* find prefix in advertised prefixes list */
+	adb = rfapi_adb_pfx_find(by_prefix, &ref);
+	found = (adb != NULL);
 
-	if (rc) {
-		/* Not found */
+	if (!found) {
 		adb = XCALLOC(MTYPE_RFAPI_ADB, sizeof(struct rfapi_adb));
 		adb->lifetime = lifetime;
-		adb->u.key = rk;
+		adb->u.key = ref.u.key;
 
-		if (use_ip0) {
-			assert(pfx_eth);
-			skiplist_insert(rfd->advertised.ip0_by_ether,
-					&adb->u.key, adb);
-		} else {
-			skiplist_insert(rfd->advertised.ipN_by_prefix,
-					&adb->u.key, adb);
-		}
-
-		skiplist_insert(rfd->advertised.by_lifetime, adb, adb);
+		rfapi_adb_pfx_add(by_prefix, adb);
+		rfapi_adb_lifetime_add(&rfd->advertised.by_lifetime, adb);
 	} else {
 		old_lifetime = adb->lifetime;
 		if (old_lifetime != lifetime) {
-			assert(!skiplist_delete(rfd->advertised.by_lifetime,
-						adb, NULL));
+			rfapi_adb_lifetime_del(&rfd->advertised.by_lifetime,
+					       adb);
 			adb->lifetime = lifetime;
-			assert(!skiplist_insert(rfd->advertised.by_lifetime,
-						adb, adb));
+			rfapi_adb_lifetime_add(&rfd->advertised.by_lifetime,
+					       adb);
 		}
 	}
 	adb->cost = cost;
@@ -475,7 +368,7 @@ int rfapiApAdd(struct bgp *bgp, struct rfapi_descriptor *rfd,
 	else
 		memset(&adb->l2o, 0, sizeof(struct rfapi_l2address_option));
 
-	if (rfapiApAdjustLifetimeStats(rfd, (rc ? NULL : &old_lifetime),
+	if (rfapiApAdjustLifetimeStats(rfd, (found ? &old_lifetime : NULL),
 				       &lifetime))
 		return 1;
 
@@ -490,46 +383,31 @@ int rfapiApDelete(struct bgp *bgp, struct rfapi_descriptor *rfd,
 		  struct prefix *pfx_ip, struct prefix *pfx_eth,
 		  struct prefix_rd *prd, int *advertise_tunnel) /* out */
 {
-	int rc;
 	struct rfapi_adb *adb;
 	uint32_t old_lifetime;
-	int use_ip0 = 0;
-	struct rfapi_rib_key rk;
+	struct rfapi_adb_pfx_head *by_prefix;
+	struct rfapi_adb ref;
 
 	if (advertise_tunnel)
 		*advertise_tunnel = 0;
 
-	rfapi_rib_key_init(pfx_ip, prd, pfx_eth, &rk);
-	/* find prefix in advertised prefixes list */
+	rfapi_rib_key_init(pfx_ip, prd, pfx_eth, &ref.u.key);
 	if (RFAPI_0_PREFIX(pfx_ip) && RFAPI_HOST_PREFIX(pfx_ip)) {
-		use_ip0 = 1;
 		assert(pfx_eth);
-
-		rc = skiplist_search(rfd->advertised.ip0_by_ether, &rk,
-				     (void **)&adb);
-
+		by_prefix = &rfd->advertised.ip0_by_ether;
 	} else {
-
-		/* find prefix in advertised prefixes list */
-		rc = skiplist_search(rfd->advertised.ipN_by_prefix, &rk,
-				     (void **)&adb);
+		by_prefix = &rfd->advertised.ipN_by_prefix;
 	}
 
-	if (rc) {
+	/* find prefix in advertised prefixes list */
+	adb = rfapi_adb_pfx_find(by_prefix, &ref);
+	if (!adb)
 		return ENOENT;
-	}
 
 	old_lifetime = adb->lifetime;
 
-	if (use_ip0) {
-		rc = skiplist_delete(rfd->advertised.ip0_by_ether, &rk, NULL);
-	} else {
-		rc = skiplist_delete(rfd->advertised.ipN_by_prefix, &rk, NULL);
-	}
-	assert(!rc);
-
-	rc = skiplist_delete(rfd->advertised.by_lifetime, adb, NULL);
-	assert(!rc);
+	rfapi_adb_pfx_del(by_prefix, adb);
+	rfapi_adb_lifetime_del(&rfd->advertised.by_lifetime, adb);
 
 	rfapiAdbFree(adb);
 
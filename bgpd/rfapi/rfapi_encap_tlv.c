@@ -144,20 +144,24 @@ rfapi_tunneltype_option_to_tlv(struct bgp *bgp, struct rfapi_ip_addr *ea,
 	return tto->type;
 }
 
-struct rfapi_un_option *rfapi_encap_tlv_to_un_option(struct attr *attr)
+/*
+ * Decode the tunnel encapsulation of attr into uo. Returns nonzero if
+ * there is none, or it can not be decoded.
+ */
+static int rfapi_encap_tlv_fill_un_option(struct attr *attr,
+					  struct rfapi_un_option *uo)
 {
-	struct rfapi_un_option *uo = NULL;
 	struct rfapi_tunneltype_option *tto;
 	int rc;
 	struct bgp_attr_encap_subtlv *stlv;
 
 	/* no tunnel encap attr stored */
 	if (!attr->encap_tunneltype)
-		return NULL;
+		return -1;
 
 	stlv = attr->encap_subtlvs;
 
-	uo = XCALLOC(MTYPE_RFAPI_UN_OPTION, sizeof(struct rfapi_un_option));
+	memset(uo, 0, sizeof(*uo));
 	uo->type = RFAPI_UN_OPTION_TYPE_TUNNELTYPE;
 	uo->v.tunnel.type = attr->encap_tunneltype;
 	tto = &uo->v.tunnel;
@@ -233,10 +237,31 @@ struct rfapi_un_option *rfapi_encap_tlv_to_un_option(struct attr *attr)
 		rc = -1;
 		break;
 	}
-	if (rc) {
-		XFREE(MTYPE_RFAPI_UN_OPTION, uo);
-	}
-	return uo;
+	return rc;
+}
+
+struct rfapi_un_option *rfapi_encap_tlv_to_un_option(struct attr *attr)
+{
+	struct rfapi_un_option uo;
+	struct rfapi_un_option *new;
+
+	if (rfapi_encap_tlv_fill_un_option(attr, &uo))
+		return NULL;
+
+	new = XCALLOC(MTYPE_RFAPI_UN_OPTION, sizeof(struct rfapi_un_option));
+	*new = uo;
+	return new;
+}
+
+/* Same, but returns a shared chain (see rfapiUnOptionsIntern()) */
+struct rfapi_un_option *rfapi_encap_tlv_to_un_option_intern(struct attr *attr)
+{
+	struct rfapi_un_option uo;
+
+	if (rfapi_encap_tlv_fill_un_option(attr, &uo))
+		return NULL;
+
+	return rfapiUnOptionsIntern(&uo);
 }
 
 /***********************************************************************
@@ -15,6 +15,9 @@ rfapi_tunneltype_option_to_tlv(struct bgp *bgp, struct rfapi_ip_addr *ea,
 
 extern struct rfapi_un_option *rfapi_encap_tlv_to_un_option(struct attr *attr);
 
+extern struct rfapi_un_option *
+rfapi_encap_tlv_to_un_option_intern(struct attr *attr);
+
 extern void rfapi_print_tunneltype_option(void *stream, int column_offset,
 					  struct rfapi_tunneltype_option *tto);
 
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ *
+ */
+
+/*
+ * File:	rfapi_expire.c
+ * Purpose:	batched one-shot expiry of rfapi RIB entries and monitors
+ */
+
+#include "lib/zebra.h"
+#include "lib/monotime.h"
+#include "lib/frrevent.h"
+#include "lib/vty.h"
+
+#include "bgpd/bgpd.h"
+
+#include "bgpd/rfapi/rfapi.h"
+#include "bgpd/rfapi/rfapi_private.h"
+#include "bgpd/rfapi/rfapi_expire.h"
+#include "bgpd/rfapi/rfapi_monitor.h"
+#include "bgpd/rfapi/rfapi_vty.h"
+#include "bgpd/rfapi/vnc_debug.h"
+
+static int rfapi_expq_cmp(const struct rfapi_expire *a,
+			  const struct rfapi_expire *b)
+{
+	if (timercmp(&a->when, &b->when, <))
+		return -1;
+	if (timercmp(&a->when, &b->when, >))
+		return 1;
+	return 0;
+}
+
+DECLARE_HEAP(rfapi_expq, struct rfapi_expire, item, rfapi_expq_cmp);
+
+static void rfapi_expire_run(struct event *t);
+
+/*
+ * Arm the queue's single event for the earliest pending deadline
+ */
+static void rfapi_expire_schedule(struct rfapi_expire_queue *q)
+{
+	struct rfapi_expire *first;
+	int64_t usec;
+
+	event_cancel(&q->timer);
+
+	first = rfapi_expq_first(&q->heap);
+	if (!first)
+		return;
+
+	usec = monotime_until(&first->when, NULL);
+	if (usec < 0)
+		usec = 0;
+
+	event_add_timer_msec(bm->master, rfapi_expire_run, q,
+			     (usec + 999) / 1000, &q->timer);
+}
+
+static void rfapi_expire_run(struct event *t)
+{
+	struct rfapi_expire_queue *q = EVENT_ARG(t);
+	struct rfapi_expire *ex;
+	struct timeval now;
+	uint32_t count = 0;
+	uint64_t usec;
+
+	monotime(&now);
+
+	q->running = true;
+	while (count < RFAPI_EXPIRE_BATCH_MAX &&
+	       (ex = rfapi_expq_first(&q->heap)) &&
+	       !timercmp(&ex->when, &now, >)) {
+		rfapi_expq_pop(&q->heap);
+		ex->armed = false;
+		++count;
+
+		/* may free ex */
+		(*ex->func)(ex);
+	}
+	q->running = false;
+
+	usec = monotime_since(&now, NULL);
+
+	q->expired += count;
+	q->batch_last = count;
+	if (count > q->batch_max)
+		q->batch_max = count;
+	q->tick_usec_last = usec;
+	if (usec > q->tick_usec_max)
+		q->tick_usec_max = usec;
+
+	vnc_zlog_debug_verbose("%s: %s: expired %u in %" PRIu64
+			       " usec, %zu pending",
+			       __func__, q->name, count, usec,
+			       rfapi_expq_count(&q->heap));
+
+	rfapi_expire_schedule(q);
+}
+
+void rfapi_expire_queue_init(struct rfapi_expire_queue *q, const char *name)
+{
+	memset(q, 0, sizeof(*q));
+	q->name = name;
+	rfapi_expq_init(&q->heap);
+}
+
+void rfapi_expire_queue_fini(struct rfapi_expire_queue *q)
+{
+	event_cancel(&q->timer);
+	rfapi_expq_fini(&q->heap);
+}
+
+size_t rfapi_expire_queue_count(const struct rfapi_expire_queue *q)
+{
+	return rfapi_expq_count(&q->heap);
+}
+
+struct rfapi_expire *rfapi_expire_queue_pop(struct rfapi_expire_queue *q)
+{
+	struct rfapi_expire *ex;
+
+	ex = rfapi_expq_pop(&q->heap);
+	if (ex)
+		ex->armed = false;
+	if (!rfapi_expq_count(&q->heap))
+		event_cancel(&q->timer);
+	return ex;
+}
+
+void rfapi_expire_start(struct rfapi_expire_queue *q, struct rfapi_expire *ex,
+			uint32_t seconds, rfapi_expire_func func)
+{
+	if (ex->armed)
+		rfapi_expq_del(&q->heap, ex);
+
+	monotime(&ex->when);
+	ex->when.tv_sec += seconds;
+	ex->func = func;
+	ex->armed = true;
+	rfapi_expq_add(&q->heap, ex);
+
+	/*
+	 * Only a new earliest deadline needs the event moved. If a pass is
+	 * in progress it reschedules when it finishes.
+	 */
+	if (!q->running && rfapi_expq_first(&q->heap) == ex)
+		rfapi_expire_schedule(q);
+}
+
+void rfapi_expire_stop(struct rfapi_expire_queue *q, struct rfapi_expire *ex)
+{
+	if (!ex->armed)
+		return;
+
+	rfapi_expq_del(&q->heap, ex);
+	ex->armed = false;
+
+	/*
+	 * If ex was the earliest entry the event may now fire early; the
+	 * pass then finds nothing due and reschedules.
+	 */
+	if (!q->running && !rfapi_expq_count(&q->heap))
+		event_cancel(&q->timer);
+}
+
+unsigned long rfapi_expire_remain_second(const struct rfapi_expire *ex)
+{
+	int64_t usec;
+
+	if (!ex->armed)
+		return 0;
+
+	usec = monotime_until(&ex->when, NULL);
+	return usec > 0 ? usec / 1000000 : 0;
+}
+
+void rfapi_expire_queue_show(void *stream, const char *label,
+			     const struct rfapi_expire_queue *q)
+{
+	int (*fp)(void *, const char *, ...);
+	struct vty *vty;
+	void *out;
+	const char *vty_newline;
+
+	if (rfapiStream2Vty(stream, &fp, &vty, &out, &vty_newline) == 0)
+		return;
+
+	fp(out, "%-24s ", label);
+	fp(out, "%-8s %-8zu ", "Pending:", rfapi_expq_count(&q->heap));
+	fp(out, "%-8s %-8" PRIu64 " ", "Expired:", q->expired);
+	fp(out, "%-8s %u/%u ", "Batch:", q->batch_last, q->batch_max);
+	fp(out, "%-8s %" PRIu64 "/%" PRIu64 " usec", "Tick:",
+	   q->tick_usec_last, q->tick_usec_max);
+	fp(out, "\n");
+}
+
+void rfapi_expire_queue_stats_clear(struct rfapi_expire_queue *q)
+{
+	q->batch_max = q->batch_last;
+	q->tick_usec_max = q->tick_usec_last;
+}
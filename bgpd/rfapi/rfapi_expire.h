@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ *
+ */
+
+/*
+ * File:	rfapi_expire.h
+ * Purpose:	batched one-shot expiry of rfapi RIB entries and monitors
+ */
+
+#ifndef _QUAGGA_BGP_RFAPI_EXPIRE_H
+#define _QUAGGA_BGP_RFAPI_EXPIRE_H
+
+#include "lib/zebra.h"
+#include "lib/typesafe.h"
+
+/*
+ * Rather than giving every RIB entry and monitor its own event timer,
+ * pending expirations are kept in a heap ordered by deadline. A single
+ * event is armed for the earliest deadline; when it fires, every entry
+ * that is due is handled in one pass (bounded by RFAPI_EXPIRE_BATCH_MAX,
+ * after which the pass reschedules itself to let other events run).
+ */
+#define RFAPI_EXPIRE_BATCH_MAX 10000
+
+PREDECL_HEAP(rfapi_expq);
+
+struct rfapi_expire;
+typedef void (*rfapi_expire_func)(struct rfapi_expire *ex);
+
+/*
+ * Embed in the object to be expired; recover the object in the
+ * callback with container_of().
+ */
+struct rfapi_expire {
+	struct rfapi_expq_item item;
+	struct timeval when; /* monotime deadline */
+	rfapi_expire_func func;
+	bool armed;
+};
+
+struct rfapi_expire_queue {
+	const char *name;
+	struct rfapi_expq_head heap;
+	struct event *timer;
+	bool running; /* inside expiry pass: defer rescheduling */
+
+	/* statistics */
+	uint64_t expired;
+	uint32_t batch_last;
+	uint32_t batch_max;
+	uint64_t tick_usec_last;
+	uint64_t tick_usec_max;
+};
+
+extern void rfapi_expire_queue_init(struct rfapi_expire_queue *q,
+				    const char *name);
+
+extern void rfapi_expire_queue_fini(struct rfapi_expire_queue *q);
+
+extern size_t rfapi_expire_queue_count(const struct rfapi_expire_queue *q);
+
+/*
+ * Remove and return the entry with the earliest deadline without running
+ * its callback. Used at teardown to reclaim pending entries.
+ */
+extern struct rfapi_expire *
+rfapi_expire_queue_pop(struct rfapi_expire_queue *q);
+
+extern void rfapi_expire_queue_show(void *stream, const char *label,
+				    const struct rfapi_expire_queue *q);
+
+extern void rfapi_expire_queue_stats_clear(struct rfapi_expire_queue *q);
+
+/*
+ * (Re)arm ex to call func after the given number of seconds. An entry
+ * that is already armed is moved to its new deadline.
+ */
+extern void rfapi_expire_start(struct rfapi_expire_queue *q,
+			       struct rfapi_expire *ex, uint32_t seconds,
+			       rfapi_expire_func func);
+
+/* no-op if ex is not armed */
+extern void rfapi_expire_stop(struct rfapi_expire_queue *q,
+			      struct rfapi_expire *ex);
+
+extern unsigned long rfapi_expire_remain_second(const struct rfapi_expire *ex);
+
+static inline bool rfapi_expire_armed(const struct rfapi_expire *ex)
+{
+	return ex->armed;
+}
+
+#endif /* _QUAGGA_BGP_RFAPI_EXPIRE_H */
@@ -18,6 +18,7 @@
 #include "frrevent.h"
 #include "lib/stream.h"
 #include "lib/lib_errors.h"
+#include "lib/jhash.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_ecommunity.h"
@@ -94,6 +95,95 @@ static uint32_t _rwcb_hash(const struct rfapi_withdraw *w)
 DECLARE_HASH(rwcb, struct rfapi_withdraw, rwcbi, _rwcb_cmp, _rwcb_hash);
 static struct rwcb_head _rwcbhash;
 
+/*
+ * Index of import tables by route target (see rfapi_private.h).
+ * An update is offered only to the import tables listed under its
+ * RTs instead of to every table in h->imports.
+ */
+struct rfapi_rt_import {
+	struct rfapi_rt_index_item item;
+	struct ecommunity_val rt;
+	struct list *tables; /* struct rfapi_import_table */
+};
+
+static int _rt_import_cmp(const struct rfapi_rt_import *a,
+			  const struct rfapi_rt_import *b)
+{
+	return memcmp(a->rt.val, b->rt.val, ECOMMUNITY_SIZE);
+}
+
+static uint32_t _rt_import_hash(const struct rfapi_rt_import *a)
+{
+	return jhash(a->rt.val, ECOMMUNITY_SIZE, 0x4d8ab1c3);
+}
+
+DECLARE_HASH(rfapi_rt_index, struct rfapi_rt_import, item, _rt_import_cmp,
+	     _rt_import_hash);
+
+/* marks import tables already offered the current update */
+static uint32_t rfapi_import_gen;
+
+static void rfapiRtIndexAdd(struct rfapi *h, struct rfapi_import_table *it)
+{
+	struct ecommunity *ecom = it->rt_import_list;
+	struct rfapi_rt_import key;
+	struct rfapi_rt_import *rti;
+	uint32_t i;
+
+	if (!ecom)
+		return;
+
+	for (i = 0; i < ecom->size; ++i) {
+		memcpy(key.rt.val, ecom->val + (i * ECOMMUNITY_SIZE),
+		       ECOMMUNITY_SIZE);
+		rti = rfapi_rt_index_find(&h->rt_index, &key);
+		if (!rti) {
+			rti = XCALLOC(MTYPE_RFAPI_RT_INDEX,
+				      sizeof(struct rfapi_rt_import));
+			rti->rt = key.rt;
+			rti->tables = list_new();
+			rfapi_rt_index_add(&h->rt_index, rti);
+		}
+		listnode_add(rti->tables, it);
+	}
+}
+
+static void rfapiRtIndexDel(struct rfapi *h, struct rfapi_import_table *it)
+{
+	struct ecommunity *ecom = it->rt_import_list;
+	struct rfapi_rt_import key;
+	struct rfapi_rt_import *rti;
+	uint32_t i;
+
+	if (!ecom)
+		return;
+
+	for (i = 0; i < ecom->size; ++i) {
+		memcpy(key.rt.val, ecom->val + (i * ECOMMUNITY_SIZE),
+		       ECOMMUNITY_SIZE);
+		rti = rfapi_rt_index_find(&h->rt_index, &key);
+		if (!rti)
+			continue;
+		listnode_delete(rti->tables, it);
+		if (!listcount(rti->tables)) {
+			rfapi_rt_index_del(&h->rt_index, rti);
+			list_delete(&rti->tables);
+			XFREE(MTYPE_RFAPI_RT_INDEX, rti);
+		}
+	}
+}
+
+static void rfapiRtIndexFree(struct rfapi *h)
+{
+	struct rfapi_rt_import *rti;
+
+	while ((rti = rfapi_rt_index_pop(&h->rt_index))) {
+		list_delete(&rti->tables);
+		XFREE(MTYPE_RFAPI_RT_INDEX, rti);
+	}
+	rfapi_rt_index_fini(&h->rt_index);
+}
+
 /*
  * DEBUG FUNCTION
  * Count remote routes and compare with actively-maintained values.
@@ -941,6 +1031,7 @@ void rfapiImportTableRefDelByIt(struct bgp *bgp,
 		} else {
 			h->imports = it->next;
 		}
+		rfapiRtIndexDel(h, it);
 		rfapiImportTableFlush(it);
 		XFREE(MTYPE_RFAPI_IMPORTTABLE, it);
 	}
@@ -984,7 +1075,7 @@ int rfapiEcommunitiesIntersect(struct ecommunity *e1, struct ecommunity *e2)
 	if (!e1 || !e2)
 		return 0;
 
-	{
+	if (VNC_DEBUG(VERBOSE)) {
 		char *s1, *s2;
 		s1 = ecommunity_ecom2str(e1, ECOMMUNITY_FORMAT_DISPLAY, 0);
 		s2 = ecommunity_ecom2str(e2, ECOMMUNITY_FORMAT_DISPLAY, 0);
@@ -1275,32 +1366,31 @@ rfapiRouteInfo2NextHopEntry(struct rfapi_ip_prefix *rprefix,
 				  RD_TYPE_VNC_ETH) {
 		/* ethernet */
 
-		struct rfapi_vn_option *vo;
-
-		vo = XCALLOC(MTYPE_RFAPI_VN_OPTION,
-			     sizeof(struct rfapi_vn_option));
+		struct rfapi_vn_option vo;
 
-		vo->type = RFAPI_VN_OPTION_TYPE_L2ADDR;
+		memset(&vo, 0, sizeof(vo));
+		vo.type = RFAPI_VN_OPTION_TYPE_L2ADDR;
 
-		memcpy(&vo->v.l2addr.macaddr, &p->u.prefix_eth.octet, ETH_ALEN);
+		memcpy(&vo.v.l2addr.macaddr, &p->u.prefix_eth.octet, ETH_ALEN);
 		/* only low 3 bytes of this are significant */
 		(void)rfapiEcommunityGetLNI(bgp_attr_get_ecommunity(bpi->attr),
-					    &vo->v.l2addr.logical_net_id);
+					    &vo.v.l2addr.logical_net_id);
 		(void)rfapiEcommunityGetEthernetTag(
 			bgp_attr_get_ecommunity(bpi->attr),
-			&vo->v.l2addr.tag_id);
+			&vo.v.l2addr.tag_id);
 
 		/* local_nve_id comes from lower byte of RD type */
-		vo->v.l2addr.local_nve_id =
+		vo.v.l2addr.local_nve_id =
 			bpi->extra->vnc->vnc.import.rd.val[1];
 
 		/* label comes from MP_REACH_NLRI label */
-		vo->v.l2addr.label =
+		vo.v.l2addr.label =
 			BGP_PATH_INFO_NUM_LABELS(bpi)
 				? decode_label(&bpi->extra->labels->label[0])
 				: MPLS_INVALID_LABEL;
 
-		new->vn_options = vo;
+		/* shared with every other list holding this route */
+		new->vn_options = rfapiVnOptionsIntern(&vo);
 
 		/*
 		 * If there is an auxiliary prefix (i.e., host IP address),
@@ -1398,7 +1488,7 @@ rfapiRouteInfo2NextHopEntry(struct rfapi_ip_prefix *rprefix,
 		}
 	}
 
-	new->un_options = rfapi_encap_tlv_to_un_option(bpi->attr);
+	new->un_options = rfapi_encap_tlv_to_un_option_intern(bpi->attr);
 
 #ifdef DEBUG_ENCAP_MONITOR
 	vnc_zlog_debug_verbose("%s: line %d: have_vnc_tunnel_un=%d", __func__,
@@ -1984,6 +2074,7 @@ static void rfapiBgpInfoAttachSorted(struct agg_node *rn,
 	if (next)
 		next->prev = info_new;
 	bgp_attr_intern(info_new->attr);
+	rfapiItNodeTouch(rn);
 }
 
 static void rfapiBgpInfoDetach(struct agg_node *rn, struct bgp_path_info *bpi)
@@ -1998,6 +2089,7 @@ static void rfapiBgpInfoDetach(struct agg_node *rn, struct bgp_path_info *bpi)
 		bpi->prev->next = bpi->next;
 	else
 		rn->info = bpi->next;
+	rfapiItNodeTouch(rn);
 }
 
 /*
@@ -2768,6 +2860,7 @@ rfapiBiStartWithdrawTimer(struct rfapi_import_table *import_table,
 	 * withdrawn routes get to hang around for a while
 	 */
 	SET_FLAG(bpi->flags, BGP_PATH_REMOVED);
+	rfapiItNodeTouch(rn);
 
 	/* set timer to remove the route later */
 	lifetime = rfapiGetHolddownFromLifetime(lifetime);
@@ -3860,8 +3953,13 @@ void rfapiProcessUpdate(struct peer *peer,
 	struct bgp *bgp;
 	struct rfapi *h;
 	struct rfapi_import_table *it;
+	struct ecommunity *ecom;
+	struct rfapi_rt_import key;
+	struct rfapi_rt_import *rti;
+	struct listnode *node;
 	int has_ip_route = 1;
 	uint32_t lni = 0;
+	uint32_t i;
 
 	bgp = bgp_get_default(); /* assume 1 instance for now */
 	assert(bgp);
@@ -3918,13 +4016,37 @@ void rfapiProcessUpdate(struct peer *peer,
 		return;
 
 	/*
-	 * Iterate over all import tables; do a filtered import
-	 * for the afi/safi combination
+	 * Do a filtered import for the afi/safi combination into each
+	 * import table whose RT list intersects the route's RTs. A table
+	 * matching several of the RTs is visited only once.
 	 */
-	for (it = h->imports; it; it = it->next) {
-		(*rfapiBgpInfoFilteredImportFunction(safi))(
-			it, FIF_ACTION_UPDATE, peer, rfd, p, /* prefix */
-			NULL, afi, prd, attr, type, sub_type, label);
+	ecom = bgp_attr_get_ecommunity(attr);
+	if (ecom) {
+		if (!++rfapi_import_gen) {
+			for (it = h->imports; it; it = it->next)
+				it->import_gen = 0;
+			rfapi_import_gen = 1;
+		}
+
+		for (i = 0; i < ecom->size; ++i) {
+			memcpy(key.rt.val, ecom->val + (i * ECOMMUNITY_SIZE),
+			       ECOMMUNITY_SIZE);
+			rti = rfapi_rt_index_find(&h->rt_index, &key);
+			if (!rti)
+				continue;
+
+			for (ALL_LIST_ELEMENTS_RO(rti->tables, node, it)) {
+				if (it->import_gen == rfapi_import_gen)
+					continue;
+				it->import_gen = rfapi_import_gen;
+
+				(*rfapiBgpInfoFilteredImportFunction(safi))(
+					it, FIF_ACTION_UPDATE, peer, rfd,
+					p, /* prefix */
+					NULL, afi, prd, attr, type, sub_type,
+					label);
+			}
+		}
 	}
 
 	if (safi == SAFI_MPLS_VPN) {
@@ -4248,6 +4370,7 @@ struct rfapi *bgp_rfapi_new(struct bgp *bgp)
 	assert(bgp->rfapi_cfg == NULL);
 
 	h = XCALLOC(MTYPE_RFAPI, sizeof(struct rfapi));
+	rfapi_rt_index_init(&h->rt_index);
 
 	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
 		h->un[afi] = agg_table_init();
@@ -4322,6 +4445,8 @@ void bgp_rfapi_destroy(struct bgp *bgp, struct rfapi *h)
 		agg_table_finish(h->un[afi]);
 	}
 
+	rfapiRtIndexFree(h);
+
 	XFREE(MTYPE_RFAPI_IMPORTTABLE, h->it_ce);
 	XFREE(MTYPE_RFAPI, h);
 }
@@ -4352,6 +4477,7 @@ rfapiImportTableRefAdd(struct bgp *bgp, struct ecommunity *rt_import_list,
 
 		it->rt_import_list = ecommunity_dup(rt_import_list);
 		it->rfg = rfg;
+		rfapiRtIndexAdd(h, it);
 		it->monitor_exterior_orphans =
 			skiplist_new(0, NULL, prefix_free_lists);
 
@@ -36,6 +36,7 @@ struct rfapi_import_table {
 	int remote_count[AFI_MAX];
 	int holddown_count[AFI_MAX];
 	int imported_count[AFI_MAX];
+	uint32_t import_gen; /* see rfapiProcessUpdate() */
 };
 
 #define RFAPI_LOCAL_BI(bpi)                                                    \
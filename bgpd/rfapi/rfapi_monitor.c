@@ -39,6 +39,11 @@
 #define DEBUG_DUP_CHECK 0
 #define DEBUG_ETH_SL 0
 
+/*
+ * Pending expirations of both VPN and ethernet monitors
+ */
+static struct rfapi_expire_queue rfapi_monitor_expq;
+
 static void rfapiMonitorTimerRestart(struct rfapi_monitor_vpn *m);
 
 static void rfapiMonitorEthTimerRestart(struct rfapi_monitor_eth *m);
@@ -246,6 +251,36 @@ void rfapiMonitorExtraFlush(safi_t safi, struct agg_node *rn)
 	agg_unlock_node(rn);
 }
 
+/*
+ * Version stamps let NVE RIBs tell whether an import table node has
+ * changed since its routes were last sent (see rfapi_rib.c). The
+ * counter is global so stamps from different import tables, or from
+ * a node that was freed and re-created, never compare equal.
+ *
+ * Nodes with routes always have an rfapi_it_extra (for the RD index).
+ * A node without one has no routes worth stamping, so don't allocate.
+ */
+static uint32_t rfapi_it_version;
+
+void rfapiItNodeTouch(struct agg_node *rn)
+{
+	struct rfapi_it_extra *hie = rn->aggregate;
+
+	if (!hie)
+		return;
+
+	if (!++rfapi_it_version)
+		++rfapi_it_version; /* skip "unknown" on wrap */
+	hie->version = rfapi_it_version;
+}
+
+uint32_t rfapiItNodeVersion(struct agg_node *rn)
+{
+	struct rfapi_it_extra *hie = rn->aggregate;
+
+	return hie ? hie->version : 0;
+}
+
 /*
  * If the child lists are empty, release the rfapi_it_extra struct
  */
@@ -621,7 +656,7 @@ void rfapiMonitorDel(struct bgp *bgp, struct rfapi_descriptor *rfd,
 		rfapiMonitorDetachImport(m);
 	}
 
-	event_cancel(&m->timer);
+	rfapi_expire_stop(&rfapi_monitor_expq, &m->timer);
 
 	/*
 	 * remove from rfd list
@@ -658,7 +693,8 @@ int rfapiMonitorDelHd(struct rfapi_descriptor *rfd)
 					rfapiMonitorDetachImport(m);
 				}
 
-				event_cancel(&m->timer);
+				rfapi_expire_stop(&rfapi_monitor_expq,
+						  &m->timer);
 
 				XFREE(MTYPE_RFAPI_MONITOR, m);
 				rn->info = NULL;
@@ -692,7 +728,7 @@ int rfapiMonitorDelHd(struct rfapi_descriptor *rfd)
 #endif
 			}
 
-			event_cancel(&mon_eth->timer);
+			rfapi_expire_stop(&rfapi_monitor_expq, &mon_eth->timer);
 
 			/*
 			 * remove from rfd list
@@ -715,6 +751,33 @@ int rfapiMonitorDelHd(struct rfapi_descriptor *rfd)
 	return count;
 }
 
+void rfapi_monitor_init(void)
+{
+	rfapi_expire_queue_init(&rfapi_monitor_expq, "monitor");
+}
+
+void rfapi_monitor_terminate(void)
+{
+	/*
+	 * Monitors are owned by their NVEs and freed when those close;
+	 * just drop any that are still pending.
+	 */
+	while (rfapi_expire_queue_pop(&rfapi_monitor_expq))
+		;
+	rfapi_expire_queue_fini(&rfapi_monitor_expq);
+}
+
+void rfapiMonitorShowExpireSummary(void *stream)
+{
+	rfapi_expire_queue_show(stream, "Queries: (Expiry)",
+				&rfapi_monitor_expq);
+}
+
+void rfapiMonitorShowExpireSummaryClear(void)
+{
+	rfapi_expire_queue_stats_clear(&rfapi_monitor_expq);
+}
+
 void rfapiMonitorResponseRemovalOff(struct bgp *bgp)
 {
 	if (bgp->rfapi_cfg->flags & BGP_VNC_CONFIG_RESPONSE_REMOVAL_DISABLE) {
@@ -732,12 +795,10 @@ void rfapiMonitorResponseRemovalOn(struct bgp *bgp)
 	bgp->rfapi_cfg->flags &= ~BGP_VNC_CONFIG_RESPONSE_REMOVAL_DISABLE;
 }
 
-static void rfapiMonitorTimerExpire(struct event *t)
+static void rfapiMonitorTimerExpire(struct rfapi_expire *ex)
 {
-	struct rfapi_monitor_vpn *m = EVENT_ARG(t);
-
-	/* forget reference to thread, it's gone */
-	m->timer = NULL;
+	struct rfapi_monitor_vpn *m =
+		container_of(ex, struct rfapi_monitor_vpn, timer);
 
 	/* delete the monitor */
 	rfapiMonitorDel(bgp_get_default(), m->rfd, &m->p);
@@ -745,7 +806,7 @@ static void rfapiMonitorTimerExpire(struct event *t)
 
 static void rfapiMonitorTimerRestart(struct rfapi_monitor_vpn *m)
 {
-	unsigned long remain = event_timer_remain_second(m->timer);
+	unsigned long remain = rfapi_expire_remain_second(&m->timer);
 
 	/* unexpected case, but avoid wraparound problems below */
 	if (remain > m->rfd->response_lifetime)
@@ -755,8 +816,6 @@ static void rfapiMonitorTimerRestart(struct rfapi_monitor_vpn *m)
 	if (m->rfd->response_lifetime - remain < 2)
 		return;
 
-	event_cancel(&m->timer);
-
 	{
 		char buf[BUFSIZ];
 
@@ -766,8 +825,8 @@ static void rfapiMonitorTimerRestart(struct rfapi_monitor_vpn *m)
 			m->rfd->response_lifetime);
 	}
 
-	event_add_timer(bm->master, rfapiMonitorTimerExpire, m,
-			m->rfd->response_lifetime, &m->timer);
+	rfapi_expire_start(&rfapi_monitor_expq, &m->timer,
+			   m->rfd->response_lifetime, rfapiMonitorTimerExpire);
 }
 
 /*
@@ -837,6 +896,8 @@ void rfapiMonitorItNodeChanged(
 	assert(bgp);
 	assert(import_table);
 
+	rfapiItNodeTouch(it_node);
+
 	nves_seen = skiplist_new(0, NULL, NULL);
 
 #if DEBUG_L2_EXTRA
@@ -1012,6 +1073,7 @@ void rfapiMonitorMovedUp(struct rfapi_import_table *import_table,
 {
 	struct bgp *bgp = bgp_get_default();
 	struct rfapi_monitor_vpn *m;
+	struct skiplist *nves_seen;
 
 	assert(new_node);
 	assert(old_node);
@@ -1029,21 +1091,31 @@ void rfapiMonitorMovedUp(struct rfapi_import_table *import_table,
 		return;
 	}
 
+	/*
+	 * An NVE often has several monitors under the old node; its RIB
+	 * only needs one pass over the new subtree.
+	 */
+	nves_seen = skiplist_new(0, NULL, NULL);
+
 	for (m = monitor_list; m; m = m->next) {
+		if (!skiplist_search(nves_seen, m->rfd, NULL))
+			continue;
+		assert(!skiplist_insert(nves_seen, m->rfd, NULL));
+
 		rfapiRibUpdatePendingNode(bgp, m->rfd, import_table, new_node,
 					  m->rfd->response_lifetime);
 		rfapiRibUpdatePendingNodeSubtree(bgp, m->rfd, import_table,
 						 new_node, old_node,
 						 m->rfd->response_lifetime);
 	}
+
+	skiplist_free(nves_seen);
 }
 
-static void rfapiMonitorEthTimerExpire(struct event *t)
+static void rfapiMonitorEthTimerExpire(struct rfapi_expire *ex)
 {
-	struct rfapi_monitor_eth *m = EVENT_ARG(t);
-
-	/* forget reference to thread, it's gone */
-	m->timer = NULL;
+	struct rfapi_monitor_eth *m =
+		container_of(ex, struct rfapi_monitor_eth, timer);
 
 	/* delete the monitor */
 	rfapiMonitorEthDel(bgp_get_default(), m->rfd, &m->macaddr,
@@ -1053,7 +1125,7 @@ static void rfapiMonitorEthTimerExpire(struct event *t)
 
 static void rfapiMonitorEthTimerRestart(struct rfapi_monitor_eth *m)
 {
-	unsigned long remain = event_timer_remain_second(m->timer);
+	unsigned long remain = rfapi_expire_remain_second(&m->timer);
 
 	/* unexpected case, but avoid wraparound problems below */
 	if (remain > m->rfd->response_lifetime)
@@ -1063,8 +1135,6 @@ static void rfapiMonitorEthTimerRestart(struct rfapi_monitor_eth *m)
 	if (m->rfd->response_lifetime - remain < 2)
 		return;
 
-	event_cancel(&m->timer);
-
 	{
 		char buf[BUFSIZ];
 
@@ -1074,8 +1144,8 @@ static void rfapiMonitorEthTimerRestart(struct rfapi_monitor_eth *m)
 			m->rfd->response_lifetime);
 	}
 
-	event_add_timer(bm->master, rfapiMonitorEthTimerExpire, m,
-			m->rfd->response_lifetime, &m->timer);
+	rfapi_expire_start(&rfapi_monitor_expq, &m->timer,
+			   m->rfd->response_lifetime, rfapiMonitorEthTimerExpire);
 }
 
 static int mon_eth_cmp(const void *a, const void *b)
@@ -1401,7 +1471,7 @@ void rfapiMonitorEthDel(struct bgp *bgp, struct rfapi_descriptor *rfd,
 		rfapiMonitorEthDetachImport(bgp, val);
 	}
 
-	event_cancel(&val->timer);
+	rfapi_expire_stop(&rfapi_monitor_expq, &val->timer);
 
 	/*
 	 * remove from rfd list
@@ -12,6 +12,8 @@
 #include "lib/prefix.h"
 #include "lib/table.h"
 
+#include "bgpd/rfapi/rfapi_expire.h"
+
 /*
  * These get attached to the nodes in an import table (using "aggregate" ptr)
  * to indicate which nves are interested in a prefix/target
@@ -25,7 +27,7 @@ struct rfapi_monitor_vpn {
 #define RFAPI_MON_FLAG_NEEDCALLBACK	0x00000001      /* deferred callback */
 
 	// int				dcount;	/* debugging counter */
-	struct event *timer;
+	struct rfapi_expire timer;
 };
 
 struct rfapi_monitor_encap {
@@ -41,7 +43,7 @@ struct rfapi_monitor_eth {
 	struct rfapi_descriptor *rfd;   /* which NVE requested the route */
 	struct ethaddr macaddr;
 	uint32_t logical_net_id;
-	struct event *timer;
+	struct rfapi_expire timer;
 };
 
 /*
@@ -79,6 +81,12 @@ struct rfapi_it_extra {
 			struct rfapi_monitor_encap *e;
 		} encap;
 	} u;
+
+	/*
+	 * Bumped whenever the routes at this node change; see
+	 * rfapiItNodeTouch(). 0 means unknown.
+	 */
+	uint32_t version;
 };
 
 #define RFAPI_IT_EXTRA_GET(rn)                                                 \
@@ -119,6 +127,18 @@ struct rfapi_it_extra {
 				    ->u.vpn.e.source,                          \
 			    NULL, NULL))
 
+extern void rfapi_monitor_init(void);
+
+extern void rfapi_monitor_terminate(void);
+
+extern void rfapiMonitorShowExpireSummary(void *stream);
+
+extern void rfapiMonitorShowExpireSummaryClear(void);
+
+extern void rfapiItNodeTouch(struct agg_node *rn);
+
+extern uint32_t rfapiItNodeVersion(struct agg_node *rn);
+
 extern void rfapiMonitorLoopCheck(struct rfapi_monitor_vpn *mchain);
 
 extern void rfapiMonitorCleanCheck(struct bgp *bgp);
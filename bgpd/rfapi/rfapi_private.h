@@ -14,6 +14,8 @@
 
 #include "lib/linklist.h"
 #include "lib/skiplist.h"
+#include "lib/typesafe.h"
+#include "lib/typerb.h"
 #include "lib/workqueue.h"
 
 #include "bgpd/bgp_attr.h"
@@ -22,15 +24,22 @@
 #include "rfapi.h"
 
 /*
- * Lists of rfapi_adb. Each rfapi_adb is referenced twice:
+ * Indices of rfapi_adb (defined in rfapi_rib.h). Each rfapi_adb is
+ * linked into two of them:
  *
- * 1. each is referenced in by_lifetime
- * 2. each is referenced by exactly one of: ipN_by_prefix, ip0_by_ether
+ * 1. each is linked into by_lifetime
+ * 2. each is linked into exactly one of: ipN_by_prefix, ip0_by_ether
  */
+PREDECL_HASH(rfapi_adb_pfx);
+PREDECL_RBTREE_NONUNIQ(rfapi_adb_lifetime);
+
+/* import tables by route target, see rfapiProcessUpdate() */
+PREDECL_HASH(rfapi_rt_index);
+
 struct rfapi_advertised_prefixes {
-	struct skiplist *ipN_by_prefix; /* all except 0/32, 0/128 */
-	struct skiplist *ip0_by_ether;  /* ip prefix 0/32, 0/128 */
-	struct skiplist *by_lifetime;   /* all */
+	struct rfapi_adb_pfx_head ipN_by_prefix; /* all except 0/32, 0/128 */
+	struct rfapi_adb_pfx_head ip0_by_ether;  /* ip prefix 0/32, 0/128 */
+	struct rfapi_adb_lifetime_head by_lifetime; /* all */
 };
 
 struct rfapi_descriptor {
@@ -75,6 +84,8 @@ struct rfapi_descriptor {
 	struct agg_table *rib[AFI_MAX];
 	struct agg_table *rib_pending[AFI_MAX];
 	struct work_queue *updated_responses_queue;
+	struct event *t_response_coalesce; /* rfp_cfg.response_coalesce_msec */
+	uint32_t response_coalesce_count;
 	struct agg_table *rsp_times[AFI_MAX];
 
 	uint32_t rsp_counter;	 /* dedup initial rsp */
@@ -160,6 +171,7 @@ struct rfapi_global_stats {
 struct rfapi {
 	struct agg_table *un[AFI_MAX];
 	struct rfapi_import_table *imports; /* IPv4, IPv6 */
+	struct rfapi_rt_index_head rt_index; /* RT -> imports */
 	struct list descriptors;	    /* debug & resolve-nve imports */
 
 	struct rfapi_global_stats stat;
@@ -303,6 +315,12 @@ extern struct rfapi_vn_option *rfapiVnOptionsDup(struct rfapi_vn_option *orig);
 
 extern struct rfapi_un_option *rfapiUnOptionsDup(struct rfapi_un_option *orig);
 
+extern struct rfapi_vn_option *
+rfapiVnOptionsIntern(const struct rfapi_vn_option *orig);
+
+extern struct rfapi_un_option *
+rfapiUnOptionsIntern(const struct rfapi_un_option *orig);
+
 extern struct bgp_tea_options *rfapiOptionsDup(struct bgp_tea_options *orig);
 
 extern int rfapi_ip_addr_cmp(struct rfapi_ip_addr *a1,
@@ -372,6 +390,7 @@ DECLARE_MTYPE(RFAPI_MONITOR_ENCAP);
 DECLARE_MTYPE(RFAPI_NEXTHOP);
 DECLARE_MTYPE(RFAPI_VN_OPTION);
 DECLARE_MTYPE(RFAPI_UN_OPTION);
+DECLARE_MTYPE(RFAPI_OPTION_CHAIN);
 DECLARE_MTYPE(RFAPI_WITHDRAW);
 DECLARE_MTYPE(RFAPI_RFG_NAME);
 DECLARE_MTYPE(RFAPI_ADB);
@@ -386,6 +405,7 @@ DECLARE_MTYPE(RFAPI_RECENT_DELETE);
 DECLARE_MTYPE(RFAPI_L2ADDR_OPT);
 DECLARE_MTYPE(RFAPI_AP);
 DECLARE_MTYPE(RFAPI_MONITOR_ETH);
+DECLARE_MTYPE(RFAPI_RT_INDEX);
 
 
 /*
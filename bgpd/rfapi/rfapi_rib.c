@@ -35,6 +35,7 @@
 #include "bgpd/rfapi/rfapi_rib.h"
 #include "bgpd/rfapi/rfapi_monitor.h"
 #include "bgpd/rfapi/rfapi_encap_tlv.h"
+#include "bgpd/rfapi/rfapi_expire.h"
 #include "bgpd/rfapi/vnc_debug.h"
 
 #define DEBUG_PROCESS_PENDING_NODE	0
@@ -213,38 +214,27 @@ static struct rfapi_info *rfapi_info_new(void)
 
 void rfapiFreeRfapiUnOptionChain(struct rfapi_un_option *p)
 {
-	while (p) {
-		struct rfapi_un_option *next;
-
-		next = p->next;
-		XFREE(MTYPE_RFAPI_UN_OPTION, p);
-		p = next;
-	}
+	rfapi_un_options_free(p);
 }
 
 void rfapiFreeRfapiVnOptionChain(struct rfapi_vn_option *p)
 {
-	while (p) {
-		struct rfapi_vn_option *next;
-
-		next = p->next;
-		XFREE(MTYPE_RFAPI_VN_OPTION, p);
-		p = next;
-	}
+	rfapi_vn_options_free(p);
 }
 
 
 /*
- * Hash to keep track of outstanding timers so we can force them to
- * expire at shutdown time, thus freeing their allocated memory.
+ * Pending expirations of recently-deleted and expired routes. Also lets
+ * us force them to expire at shutdown time, thus freeing their allocated
+ * memory.
  */
-PREDECL_HASH(rrtcb);
+static struct rfapi_expire_queue _rrtcbq;
 
 /*
  * Timer control block for recently-deleted and expired routes
  */
 struct rfapi_rib_tcb {
-	struct rrtcb_item tcbi;
+	struct rfapi_expire ex;
 
 	struct rfapi_descriptor *rfd;
 	struct skiplist *sl;
@@ -254,24 +244,26 @@ struct rfapi_rib_tcb {
 #define RFAPI_RIB_TCB_FLAG_DELETED 0x00000001
 };
 
-static int _rrtcb_cmp(const struct rfapi_rib_tcb *t1, const struct rfapi_rib_tcb *t2)
+static void rfapiRibStopTimer(struct rfapi_info *ri)
 {
-	return (t1 != t2);
-}
+	struct rfapi_rib_tcb *tcb = ri->tcb;
 
-static uint32_t _rrtcb_hash(const struct rfapi_rib_tcb *t)
-{
-	return (uintptr_t)t & 0xffffffff;
-}
+	if (!tcb)
+		return;
 
-DECLARE_HASH(rrtcb, struct rfapi_rib_tcb, tcbi, _rrtcb_cmp, _rrtcb_hash);
-static struct rrtcb_head _rrtcbhash;
+#if DEBUG_CLEANUP
+	zlog_debug("%s: ri %p, tcb %p", __func__, ri, tcb);
+#endif
+	rfapi_expire_stop(&_rrtcbq, &tcb->ex);
+	ri->tcb = NULL;
+	XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
+}
 
 static void rfapi_info_free(struct rfapi_info *goner)
 {
 	if (goner) {
 #if DEBUG_CLEANUP
-		zlog_debug("%s: ri %p, timer %p", __func__, goner, goner->timer);
+		zlog_debug("%s: ri %p, tcb %p", __func__, goner, goner->tcb);
 #endif
 		if (goner->tea_options) {
 			rfapiFreeBgpTeaOptionChain(goner->tea_options);
@@ -285,17 +277,7 @@ static void rfapi_info_free(struct rfapi_info *goner)
 			rfapiFreeRfapiVnOptionChain(goner->vn_options);
 			goner->vn_options = NULL;
 		}
-		if (goner->timer) {
-			struct rfapi_rib_tcb *tcb;
-
-			tcb = EVENT_ARG(goner->timer);
-#if DEBUG_CLEANUP
-			zlog_debug("%s: ri %p, tcb %p", __func__, goner, tcb);
-#endif
-			event_cancel(&goner->timer);
-			rrtcb_del(&_rrtcbhash, tcb);
-			XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
-		}
+		rfapiRibStopTimer(goner);
 		XFREE(MTYPE_RFAPI_INFO, goner);
 	}
 }
@@ -305,10 +287,10 @@ static void _rfapiRibExpireTimer(struct rfapi_rib_tcb *tcb)
 	RFAPI_RIB_CHECK_COUNTS(1, 0);
 
 	/*
-	 * Forget reference to thread. Otherwise rfapi_info_free() will
-	 * attempt to free thread pointer as an option chain
+	 * Forget reference to tcb. Otherwise rfapi_info_free() will
+	 * attempt to free it a second time
 	 */
-	tcb->ri->timer = NULL;
+	tcb->ri->tcb = NULL;
 
 	/* "deleted" skiplist frees ri, "active" doesn't */
 	assert(!skiplist_delete(tcb->sl, &tcb->ri->rk, NULL));
@@ -320,6 +302,18 @@ static void _rfapiRibExpireTimer(struct rfapi_rib_tcb *tcb)
 		rfapi_info_free(tcb->ri);
 	}
 
+	if (!CHECK_FLAG(tcb->flags, RFAPI_RIB_TCB_FLAG_DELETED)) {
+		struct rfapi_info *ri;
+		void *cursor = NULL;
+
+		/*
+		 * The NVE's routes at this prefix are no longer a complete
+		 * copy of any import table node version
+		 */
+		while (!skiplist_next(tcb->sl, NULL, (void **)&ri, &cursor))
+			ri->it_version = 0;
+	}
+
 	if (skiplist_empty(tcb->sl)) {
 		if (CHECK_FLAG(tcb->flags, RFAPI_RIB_TCB_FLAG_DELETED))
 			tcb->rn->aggregate = NULL;
@@ -332,7 +326,6 @@ static void _rfapiRibExpireTimer(struct rfapi_rib_tcb *tcb)
 		agg_unlock_node(tcb->rn);
 	}
 
-	rrtcb_del(&_rrtcbhash, tcb);
 	XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
 
 	RFAPI_RIB_CHECK_COUNTS(1, 0);
@@ -341,9 +334,9 @@ static void _rfapiRibExpireTimer(struct rfapi_rib_tcb *tcb)
 /*
  * remove route from rib
  */
-static void rfapiRibExpireTimer(struct event *t)
+static void rfapiRibExpireTimer(struct rfapi_expire *ex)
 {
-	struct rfapi_rib_tcb *tcb = EVENT_ARG(t);
+	struct rfapi_rib_tcb *tcb = container_of(ex, struct rfapi_rib_tcb, ex);
 
 	_rfapiRibExpireTimer(tcb);
 }
@@ -353,14 +346,12 @@ static void rfapiRibStartTimer(struct rfapi_descriptor *rfd,
 			       struct agg_node *rn, /* route node attached to */
 			       int deleted)
 {
-	struct rfapi_rib_tcb *tcb = NULL;
+	struct rfapi_rib_tcb *tcb = ri->tcb;
 
-	if (ri->timer) {
-		tcb = EVENT_ARG(ri->timer);
-		event_cancel(&ri->timer);
-	} else {
+	if (!tcb) {
 		tcb = XCALLOC(MTYPE_RFAPI_RECENT_DELETE,
 			      sizeof(struct rfapi_rib_tcb));
+		ri->tcb = tcb;
 	}
 #if DEBUG_CLEANUP
 	zlog_debug("%s: rfd %p, rn %p, ri %p, tcb %p", __func__, rfd, rn, ri,
@@ -381,10 +372,8 @@ static void rfapiRibStartTimer(struct rfapi_descriptor *rfd,
 	vnc_zlog_debug_verbose("%s: rfd %p pfx %pRN life %u", __func__, rfd, rn,
 			       ri->lifetime);
 
-	event_add_timer(bm->master, rfapiRibExpireTimer, tcb, ri->lifetime,
-			&ri->timer);
-
-	rrtcb_add(&_rrtcbhash, tcb);
+	rfapi_expire_start(&_rrtcbq, &tcb->ex, ri->lifetime,
+			   rfapiRibExpireTimer);
 }
 
 extern void rfapi_rib_key_init(struct prefix *prefix, /* may be NULL */
@@ -427,6 +416,19 @@ int rfapi_rib_key_cmp(const void *k1, const void *k2)
 	return ret;
 }
 
+/*
+ * Hashes a <struct rfapi_rib_key>; keys that rfapi_rib_key_cmp()
+ * considers equal hash to the same value
+ */
+uint32_t rfapi_rib_key_hash(const struct rfapi_rib_key *rk)
+{
+	uint32_t h;
+
+	h = vnc_prefix_hash(&rk->vn, 0);
+	h = vnc_prefix_hash(&rk->rd, h);
+	return vnc_prefix_hash(&rk->aux_prefix, h);
+}
+
 
 /*
  * Note: this function will claim that two option chains are
@@ -548,17 +550,7 @@ void rfapiRibClear(struct rfapi_descriptor *rfd)
 							    NULL,
 							    (void **)&ri)) {
 
-						if (ri->timer) {
-							struct rfapi_rib_tcb
-								*tcb;
-
-							tcb = EVENT_ARG(
-								ri->timer);
-							event_cancel(&ri->timer);
-							rrtcb_del(&_rrtcbhash, tcb);
-							XFREE(MTYPE_RFAPI_RECENT_DELETE,
-							      tcb);
-						}
+						rfapiRibStopTimer(ri);
 						rfapi_info_free(ri);
 						skiplist_delete_first(
 							(struct skiplist *)
@@ -599,6 +591,8 @@ void rfapiRibClear(struct rfapi_descriptor *rfd)
 	}
 	if (rfd->updated_responses_queue)
 		work_queue_free_and_null(&rfd->updated_responses_queue);
+	event_cancel(&rfd->t_response_coalesce);
+	rfd->response_coalesce_count = 0;
 }
 
 /*
@@ -704,7 +698,7 @@ static void rfapiRibBi2Ri(struct bgp_path_info *bpi, struct rfapi_info *ri,
 	}
 
 	rfapi_un_options_free(ri->un_options); /* maybe free old version */
-	ri->un_options = rfapi_encap_tlv_to_un_option(bpi->attr);
+	ri->un_options = rfapi_encap_tlv_to_un_option_intern(bpi->attr);
 
 	/*
 	 * VN options
@@ -713,38 +707,35 @@ static void rfapiRibBi2Ri(struct bgp_path_info *bpi, struct rfapi_info *ri,
 				  RD_TYPE_VNC_ETH) {
 		/* ethernet route */
 
-		struct rfapi_vn_option *vo;
+		struct rfapi_vn_option vo;
 
-		vo = XCALLOC(MTYPE_RFAPI_VN_OPTION,
-			     sizeof(struct rfapi_vn_option));
-		assert(vo);
-
-		vo->type = RFAPI_VN_OPTION_TYPE_L2ADDR;
+		memset(&vo, 0, sizeof(vo));
+		vo.type = RFAPI_VN_OPTION_TYPE_L2ADDR;
 
 		/* copy from RD already stored in bpi, so we don't need it_node
 		 */
-		memcpy(&vo->v.l2addr.macaddr,
+		memcpy(&vo.v.l2addr.macaddr,
 		       bpi->extra->vnc->vnc.import.rd.val + 2, ETH_ALEN);
 
 		(void)rfapiEcommunityGetLNI(bgp_attr_get_ecommunity(bpi->attr),
-					    &vo->v.l2addr.logical_net_id);
+					    &vo.v.l2addr.logical_net_id);
 		(void)rfapiEcommunityGetEthernetTag(
 			bgp_attr_get_ecommunity(bpi->attr),
-			&vo->v.l2addr.tag_id);
+			&vo.v.l2addr.tag_id);
 
 		/* local_nve_id comes from RD */
-		vo->v.l2addr.local_nve_id =
+		vo.v.l2addr.local_nve_id =
 			bpi->extra->vnc->vnc.import.rd.val[1];
 
 		/* label comes from MP_REACH_NLRI label */
-		vo->v.l2addr.label =
+		vo.v.l2addr.label =
 			BGP_PATH_INFO_NUM_LABELS(bpi)
 				? decode_label(&bpi->extra->labels->label[0])
 				: MPLS_INVALID_LABEL;
 
 		rfapi_vn_options_free(
 			ri->vn_options); /* maybe free old version */
-		ri->vn_options = vo;
+		ri->vn_options = rfapiVnOptionsIntern(&vo);
 	}
 
 	/*
@@ -819,6 +810,7 @@ int rfapiRibPreloadBi(
 		/* found: update contents of existing route in RIB */
 		ori->un = *pfx_un;
 		rfapiRibBi2Ri(bpi, ori, lifetime);
+		ori->it_version = 0;
 	} else {
 		/* not found: add new route to RIB */
 		ori = rfapi_info_new();
@@ -943,14 +935,7 @@ static void process_pending_node(struct bgp *bgp, struct rfapi_descriptor *rfd,
 				rfapiFreeBgpTeaOptionChain(ri->tea_options);
 				ri->tea_options = NULL;
 
-				if (ri->timer) {
-					struct rfapi_rib_tcb *tcb;
-
-					tcb = EVENT_ARG(ri->timer);
-					event_cancel(&ri->timer);
-					rrtcb_del(&_rrtcbhash, tcb);
-					XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
-				}
+				rfapiRibStopTimer(ri);
 
 				vnc_zlog_debug_verbose(
 					"%s:   put dl pfx=%pRN vn=%pFX un=%pFX cost=%d life=%d vn_options=%p",
@@ -1029,14 +1014,7 @@ static void process_pending_node(struct bgp *bgp, struct rfapi_descriptor *rfd,
 				listnode_add(delete_list, ori);
 				rfapiFreeBgpTeaOptionChain(ori->tea_options);
 				ori->tea_options = NULL;
-				if (ori->timer) {
-					struct rfapi_rib_tcb *tcb;
-
-					tcb = EVENT_ARG(ori->timer);
-					event_cancel(&ori->timer);
-					rrtcb_del(&_rrtcbhash, tcb);
-					XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
-				}
+				rfapiRibStopTimer(ori);
 
 #if DEBUG_PROCESS_PENDING_NODE
 				/* deleted from slRibPt below, after we're done
@@ -1122,6 +1100,7 @@ static void process_pending_node(struct bgp *bgp, struct rfapi_descriptor *rfd,
 				ori->un = ri->un;
 				ori->cost = ri->cost;
 				ori->lifetime = ri->lifetime;
+				ori->it_version = ri->it_version;
 				rfapiFreeBgpTeaOptionChain(ori->tea_options);
 				ori->tea_options =
 					rfapiOptionsDup(ri->tea_options);
@@ -1146,6 +1125,7 @@ static void process_pending_node(struct bgp *bgp, struct rfapi_descriptor *rfd,
 				ori->un = ri->un;
 				ori->cost = ri->cost;
 				ori->lifetime = ri->lifetime;
+				ori->it_version = ri->it_version;
 				ori->tea_options =
 					rfapiOptionsDup(ri->tea_options);
 				ori->last_sent_time = monotime(NULL);
@@ -1365,14 +1345,7 @@ callback:
 
 				RFAPI_RIB_CHECK_COUNTS(0, delete_list->count);
 				/* cancel normal expire timer */
-				if (ri->timer) {
-					struct rfapi_rib_tcb *tcb;
-
-					tcb = EVENT_ARG(ri->timer);
-					event_cancel(&ri->timer);
-					rrtcb_del(&_rrtcbhash, tcb);
-					XFREE(MTYPE_RFAPI_RECENT_DELETE, tcb);
-				}
+				rfapiRibStopTimer(ri);
 				RFAPI_RIB_CHECK_COUNTS(0, delete_list->count);
 
 				/*
@@ -1468,6 +1441,48 @@ callback:
 	RFAPI_RIB_CHECK_COUNTS(1, 0);
 }
 
+/*
+ * Traverse the pending RIB once, appending all changes to the
+ * next hop list
+ */
+static void rib_collect_pending(struct bgp *bgp, struct rfapi_descriptor *rfd,
+				afi_t afi, struct rfapi_next_hop_entry **head,
+				struct rfapi_next_hop_entry **tail)
+{
+	struct agg_node *rn;
+
+	if (!rfd->rib_pending[afi])
+		return;
+
+	for (rn = agg_route_top(rfd->rib_pending[afi]); rn;
+	     rn = agg_route_next(rn)) {
+		process_pending_node(bgp, rfd, afi, rn, head, tail);
+	}
+}
+
+static void rib_do_callback(struct bgp *bgp, struct rfapi_descriptor *rfd,
+			    struct rfapi_next_hop_entry *head)
+{
+	rfapi_response_cb_t *f;
+
+#if DEBUG_NHL
+	vnc_zlog_debug_verbose("%s: response callback NHL follows:", __func__);
+	rfapiPrintNhl(NULL, head);
+#endif
+
+	if (rfd->response_cb)
+		f = rfd->response_cb;
+	else
+		f = bgp->rfapi->rfp_methods.response_cb;
+
+	bgp->rfapi->flags |= RFAPI_INCALLBACK;
+	vnc_zlog_debug_verbose("%s: invoking updated response callback",
+			       __func__);
+	(*f)(head, rfd->cookie);
+	bgp->rfapi->flags &= ~RFAPI_INCALLBACK;
+	++bgp->rfapi->response_updated_count;
+}
+
 /*
  * regardless of targets, construct a single callback by doing
  * only one traversal of the pending RIB
@@ -1481,7 +1496,6 @@ static void rib_do_callback_onepass(struct rfapi_descriptor *rfd, afi_t afi)
 	struct bgp *bgp = bgp_get_default();
 	struct rfapi_next_hop_entry *head = NULL;
 	struct rfapi_next_hop_entry *tail = NULL;
-	struct agg_node *rn;
 
 #ifdef DEBUG_L2_EXTRA
 	vnc_zlog_debug_verbose("%s: rfd=%p, afi=%d", __func__, rfd, afi);
@@ -1492,32 +1506,65 @@ static void rib_do_callback_onepass(struct rfapi_descriptor *rfd, afi_t afi)
 
 	assert(bgp->rfapi);
 
-	for (rn = agg_route_top(rfd->rib_pending[afi]); rn;
-	     rn = agg_route_next(rn)) {
-		process_pending_node(bgp, rfd, afi, rn, &head, &tail);
-	}
+	rib_collect_pending(bgp, rfd, afi, &head, &tail);
 
-	if (head) {
-		rfapi_response_cb_t *f;
+	if (head)
+		rib_do_callback(bgp, rfd, head);
+}
 
-#if DEBUG_NHL
-		vnc_zlog_debug_verbose("%s: response callback NHL follows:",
-				       __func__);
-		rfapiPrintNhl(NULL, head);
-#endif
+/*
+ * Coalesced mode: the pending RIB has been accumulating updates for
+ * the configured window, so everything that is pending for the NVE,
+ * in all address families, goes out in a single callback. Updates
+ * that were superseded, or that undid each other, within the window
+ * leave no difference from the NVE's RIB and are not reported.
+ */
+static void rfapiRibCoalescedCallback(struct event *t)
+{
+	struct rfapi_descriptor *rfd = EVENT_ARG(t);
+	struct bgp *bgp = bgp_get_default();
+	struct rfapi_next_hop_entry *head = NULL;
+	struct rfapi_next_hop_entry *tail = NULL;
+	afi_t afi;
 
-		if (rfd->response_cb)
-			f = rfd->response_cb;
-		else
-			f = bgp->rfapi->rfp_methods.response_cb;
+	RFAPI_RIB_CHECK_COUNTS(1, 0);
 
-		bgp->rfapi->flags |= RFAPI_INCALLBACK;
-		vnc_zlog_debug_verbose("%s: invoking updated response callback",
-				       __func__);
-		(*f)(head, rfd->cookie);
-		bgp->rfapi->flags &= ~RFAPI_INCALLBACK;
-		++bgp->rfapi->response_updated_count;
+	vnc_zlog_debug_verbose("%s: rfd=%p, %u updates coalesced", __func__,
+			       rfd, rfd->response_coalesce_count);
+	rfd->response_coalesce_count = 0;
+
+	if (!bgp || !bgp->rfapi)
+		return;
+
+	for (afi = AFI_IP; afi < AFI_MAX; ++afi)
+		rib_collect_pending(bgp, rfd, afi, &head, &tail);
+
+	if (head)
+		rib_do_callback(bgp, rfd, head);
+
+	RFAPI_RIB_CHECK_COUNTS(1, 0);
+}
+
+static void rfapiRibCoalesceSchedule(struct bgp *bgp,
+				     struct rfapi_descriptor *rfd)
+{
+	struct rfapi_rfp_cfg *cfg = &bgp->rfapi_cfg->rfp_cfg;
+
+	++rfd->response_coalesce_count;
+
+	if (cfg->response_coalesce_max &&
+	    rfd->response_coalesce_count == cfg->response_coalesce_max) {
+		/* size threshold reached: don't wait out the window */
+		event_cancel(&rfd->t_response_coalesce);
+		event_add_event(bm->master, rfapiRibCoalescedCallback, rfd, 0,
+				&rfd->t_response_coalesce);
+		return;
 	}
+
+	/* window starts with the first update; no-op if already running */
+	event_add_timer_msec(bm->master, rfapiRibCoalescedCallback, rfd,
+			     cfg->response_coalesce_msec,
+			     &rfd->t_response_coalesce);
 }
 
 static wq_item_status rfapiRibDoQueuedCallback(struct work_queue *wq,
@@ -1590,6 +1637,7 @@ void rfapiRibUpdatePendingNode(
 	struct agg_node *pn;
 	afi_t afi;
 	uint32_t queued_flag;
+	uint32_t it_version = rfapiItNodeVersion(it_node);
 	int count = 0;
 
 	vnc_zlog_debug_verbose("%s: entry", __func__);
@@ -1702,6 +1750,7 @@ void rfapiRibUpdatePendingNode(
 		}
 
 		rfapiRibBi2Ri(bpi, ri, lifetime);
+		ri->it_version = it_version;
 
 		if (!pn->info) {
 			pn->info = list_new();
@@ -1729,7 +1778,9 @@ void rfapiRibUpdatePendingNode(
 
 	queued_flag = RFAPI_QUEUED_FLAG(afi);
 
-	if (!CHECK_FLAG(rfd->flags, queued_flag)) {
+	if (bgp->rfapi_cfg->rfp_cfg.response_coalesce_msec) {
+		rfapiRibCoalesceSchedule(bgp, rfd);
+	} else if (!CHECK_FLAG(rfd->flags, queued_flag)) {
 
 		struct rfapi_updated_responses_queue *urq;
 
@@ -1746,6 +1797,55 @@ void rfapiRibUpdatePendingNode(
 	RFAPI_RIB_CHECK_COUNTS(1, 0);
 }
 
+/*
+ * Returns true if the NVE's RIB already holds the routes of import
+ * table node it_node as of the node's current version and nothing is
+ * pending for the prefix, i.e., recomputing would not change anything.
+ */
+static bool rfapiRibNodeCurrent(struct rfapi_descriptor *rfd,
+				struct agg_node *it_node)
+{
+	uint32_t it_version = rfapiItNodeVersion(it_node);
+	const struct prefix *p = agg_node_get_prefix(it_node);
+	afi_t afi = family2afi(p->family);
+	struct agg_node *rn;
+	struct skiplist *sl;
+	struct rfapi_info *ri;
+	void *cursor = NULL;
+	bool current = true;
+
+	if (!it_version || !rfd->rib[afi])
+		return false;
+
+	if (rfd->rib_pending[afi]) {
+		rn = agg_node_lookup(rfd->rib_pending[afi], p);
+		if (rn) {
+			agg_unlock_node(rn);
+			return false;
+		}
+	}
+
+	rn = agg_node_lookup(rfd->rib[afi], p);
+	if (!rn)
+		return false;
+
+	sl = rn->info;
+	if (!sl || skiplist_empty(sl))
+		current = false;
+	while (current && !skiplist_next(sl, NULL, (void **)&ri, &cursor)) {
+		if (ri->it_version != it_version)
+			current = false;
+	}
+
+	agg_unlock_node(rn);
+	return current;
+}
+
+/*
+ * Nodes whose routes the NVE already has, unchanged, are skipped: when
+ * a covering route flaps, only the more-specifics that actually changed
+ * in the meantime are recomputed.
+ */
 void rfapiRibUpdatePendingNodeSubtree(
 	struct bgp *bgp, struct rfapi_descriptor *rfd,
 	struct rfapi_import_table *it, struct agg_node *it_node,
@@ -1756,7 +1856,8 @@ void rfapiRibUpdatePendingNodeSubtree(
 	 * hands in node->link */
 	if (agg_node_left(it_node)
 	    && (agg_node_left(it_node) != omit_subtree)) {
-		if (agg_node_left(it_node)->info)
+		if (agg_node_left(it_node)->info &&
+		    !rfapiRibNodeCurrent(rfd, agg_node_left(it_node)))
 			rfapiRibUpdatePendingNode(
 				bgp, rfd, it, agg_node_left(it_node), lifetime);
 		rfapiRibUpdatePendingNodeSubtree(bgp, rfd, it,
@@ -1766,7 +1867,8 @@ void rfapiRibUpdatePendingNodeSubtree(
 
 	if (agg_node_right(it_node)
 	    && (agg_node_right(it_node) != omit_subtree)) {
-		if (agg_node_right(it_node)->info)
+		if (agg_node_right(it_node)->info &&
+		    !rfapiRibNodeCurrent(rfd, agg_node_right(it_node)))
 			rfapiRibUpdatePendingNode(bgp, rfd, it,
 						  agg_node_right(it_node),
 						  lifetime);
@@ -2248,6 +2350,9 @@ void rfapiRibShowResponsesSummary(void *stream)
 	fp(out, "%-8s %-8u ", "Active:", nves_with_nonempty_ribs);
 	fp(out, "%-8s %-8u", "Total:", nves);
 	fp(out, "\n");
+
+	rfapi_expire_queue_show(stream, "Responses: (Expiry)", &_rrtcbq);
+	rfapiMonitorShowExpireSummary(stream);
 }
 
 void rfapiRibShowResponsesSummaryClear(void)
@@ -2256,6 +2361,9 @@ void rfapiRibShowResponsesSummaryClear(void)
 
 	bgp->rfapi->rib_prefix_count_total_max =
 		bgp->rfapi->rib_prefix_count_total;
+
+	rfapi_expire_queue_stats_clear(&_rrtcbq);
+	rfapiMonitorShowExpireSummaryClear();
 }
 
 static int print_rib_sl(int (*fp)(void *, const char *, ...), struct vty *vty,
@@ -2460,22 +2568,21 @@ void rfapiRibShowResponses(void *stream, struct prefix *pfx_match,
 
 void rfapi_rib_init(void)
 {
-	rrtcb_init(&_rrtcbhash);
+	rfapi_expire_queue_init(&_rrtcbq, "rib");
 }
 
 void rfapi_rib_terminate(void)
 {
-	struct rfapi_rib_tcb *tcb;
+	struct rfapi_expire *ex;
 
 	vnc_zlog_debug_verbose("%s: cleaning up %zu pending timers", __func__,
-			       rrtcb_count(&_rrtcbhash));
+			       rfapi_expire_queue_count(&_rrtcbq));
 
 	/*
 	 * Clean up memory allocations stored in pending timers
 	 */
-	while ((tcb = rrtcb_pop(&_rrtcbhash))) {
-		assert(tcb == EVENT_ARG(tcb->ri->timer));
-		event_cancel(&tcb->ri->timer);
-		_rfapiRibExpireTimer(tcb); /* deletes hash entry, frees tcb */
-	}
+	while ((ex = rfapi_expire_queue_pop(&_rrtcbq)))
+		rfapiRibExpireTimer(ex); /* frees tcb */
+
+	rfapi_expire_queue_fini(&_rrtcbq);
 }
@@ -31,6 +31,7 @@ struct rfapi_rib_key {
 	struct prefix aux_prefix;
 };
 #include "rfapi.h"
+#include "rfapi_private.h"
 
 /*
  * RFAPI Advertisement Data Block
@@ -38,6 +39,8 @@ struct rfapi_rib_key {
  * Holds NVE prefix advertisement information
  */
 struct rfapi_adb {
+	struct rfapi_adb_pfx_item pfx_item;	  /* ipN_by_prefix/ip0_by_ether */
+	struct rfapi_adb_lifetime_item lifetime_item; /* by_lifetime */
 	union {
 		struct {
 			struct prefix prefix_ip;
@@ -51,6 +54,31 @@ struct rfapi_adb {
 	struct rfapi_l2address_option l2o;
 };
 
+extern int rfapi_rib_key_cmp(const void *k1, const void *k2);
+extern uint32_t rfapi_rib_key_hash(const struct rfapi_rib_key *rk);
+
+static inline int rfapi_adb_pfx_cmp(const struct rfapi_adb *a1,
+				    const struct rfapi_adb *a2)
+{
+	return rfapi_rib_key_cmp(&a1->u.key, &a2->u.key);
+}
+
+static inline uint32_t rfapi_adb_pfx_hash(const struct rfapi_adb *adb)
+{
+	return rfapi_rib_key_hash(&adb->u.key);
+}
+
+static inline int rfapi_adb_lifetime_cmp(const struct rfapi_adb *a1,
+					 const struct rfapi_adb *a2)
+{
+	return numcmp(a1->lifetime, a2->lifetime);
+}
+
+DECLARE_HASH(rfapi_adb_pfx, struct rfapi_adb, pfx_item, rfapi_adb_pfx_cmp,
+	     rfapi_adb_pfx_hash);
+DECLARE_RBTREE_NONUNIQ(rfapi_adb_lifetime, struct rfapi_adb, lifetime_item,
+		       rfapi_adb_lifetime_cmp);
+
 struct rfapi_info {
 	struct rfapi_rib_key rk; /* NVE VN addr + aux addr */
 	struct prefix un;
@@ -61,7 +89,8 @@ struct rfapi_info {
 	struct bgp_tea_options *tea_options;
 	struct rfapi_un_option *un_options;
 	struct rfapi_vn_option *vn_options;
-	struct event *timer;
+	struct rfapi_rib_tcb *tcb; /* pending expiry, if any */
+	uint32_t it_version; /* import table node version, 0=unknown */
 };
 
 /*
@@ -134,8 +163,6 @@ extern void rfapi_rib_key_init(struct prefix *prefix, /* may be NULL */
 			       struct prefix *aux,    /* may be NULL */
 			       struct rfapi_rib_key *rk);
 
-extern int rfapi_rib_key_cmp(const void *k1, const void *k2);
-
 extern void rfapiAdbFree(struct rfapi_adb *adb);
 
 extern void rfapi_rib_init(void);
@@ -901,7 +901,7 @@ int rfapiShowVncQueries(void *stream, struct prefix *pfx_match)
 					fp(out, "%-15s %-15s", "", "");
 				buf_remain[0] = 0;
 				rfapiFormatSeconds(
-					event_timer_remain_second(m->timer),
+					rfapi_expire_remain_second(&m->timer),
 					buf_remain, BUFSIZ);
 				fp(out, " %-15s %-10s\n",
 				   inet_ntop(m->p.family, &m->p.u.prefix,
@@ -972,8 +972,8 @@ int rfapiShowVncQueries(void *stream, struct prefix *pfx_match)
 				} else
 					fp(out, "%-15s %-15s", "", "");
 				buf_remain[0] = 0;
-				rfapiFormatSeconds(event_timer_remain_second(
-							   mon_eth->timer),
+				rfapiFormatSeconds(rfapi_expire_remain_second(
+							   &mon_eth->timer),
 						   buf_remain, BUFSIZ);
 				fp(out, " %-17s %10d %-10s\n",
 				   rfapi_ntop(pfx_mac.family, &pfx_mac.u.prefix,
@@ -1560,6 +1560,37 @@ void rfapiPrintAdvertisedInfo(struct vty *vty, struct rfapi_descriptor *rfd,
 	}
 }
 
+static int rfapiAdbSortCmp(const void *a, const void *b)
+{
+	const struct rfapi_adb *const *adb1 = a;
+	const struct rfapi_adb *const *adb2 = b;
+
+	return rfapi_adb_pfx_cmp(*adb1, *adb2);
+}
+
+/*
+ * The advertisements in a hash, in key order so that they print the
+ * same way every time. Caller frees the array with MTYPE_TMP.
+ */
+static struct rfapi_adb **rfapiAdbSorted(struct rfapi_adb_pfx_head *head,
+					 size_t *count)
+{
+	struct rfapi_adb **sorted;
+	struct rfapi_adb *adb;
+	size_t i = 0;
+
+	*count = rfapi_adb_pfx_count(head);
+	if (!*count)
+		return NULL;
+
+	sorted = XCALLOC(MTYPE_TMP, sizeof(*sorted) * *count);
+	frr_each (rfapi_adb_pfx, head, adb)
+		sorted[i++] = adb;
+	qsort(sorted, *count, sizeof(*sorted), rfapiAdbSortCmp);
+
+	return sorted;
+}
+
 void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 {
 	/* pHD un-addr vn-addr pCB cookie rd lifetime */
@@ -1569,10 +1600,10 @@ void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 	/* dump import table */
 
 	char *s;
-	void *cursor;
-	int rc;
 	afi_t afi;
 	struct rfapi_adb *adb;
+	struct rfapi_adb **sorted;
+	size_t count, i;
 
 	vty_out(vty, "%-10p ", rfd);
 	rfapiPrintRfapiIpAddr(vty, &rfd->un_addr);
@@ -1606,6 +1637,7 @@ void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 		vty_out(vty, " Import (nil)%s", HVTYNL);
 	}
 
+	sorted = rfapiAdbSorted(&rfd->advertised.ipN_by_prefix, &count);
 	for (afi = AFI_IP; afi < AFI_MAX; ++afi) {
 		uint8_t family;
 
@@ -1613,12 +1645,8 @@ void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 		if (!family)
 			continue;
 
-		cursor = NULL;
-		for (rc = skiplist_next(rfd->advertised.ipN_by_prefix, NULL,
-					(void **)&adb, &cursor);
-		     rc == 0;
-		     rc = skiplist_next(rfd->advertised.ipN_by_prefix, NULL,
-					(void **)&adb, &cursor)) {
+		for (i = 0; i < count; ++i) {
+			adb = sorted[i];
 
 			/* group like family prefixes together in output */
 			if (family != adb->u.s.prefix_ip.family)
@@ -1630,10 +1658,11 @@ void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 						 &adb->u.s.prefix_ip);
 		}
 	}
-	for (rc = skiplist_next(rfd->advertised.ip0_by_ether, NULL,
-				(void **)&adb, &cursor);
-	     rc == 0; rc = skiplist_next(rfd->advertised.ip0_by_ether, NULL,
-					 (void **)&adb, &cursor)) {
+	XFREE(MTYPE_TMP, sorted);
+
+	sorted = rfapiAdbSorted(&rfd->advertised.ip0_by_ether, &count);
+	for (i = 0; i < count; ++i) {
+		adb = sorted[i];
 		vty_out(vty, "  Adv Pfx: %pFX%s", &adb->u.s.prefix_eth, HVTYNL);
 
 		/* TBD update the following function to print ethernet info */
@@ -1641,6 +1670,7 @@ void rfapiPrintDescriptor(struct vty *vty, struct rfapi_descriptor *rfd)
 		rfapiPrintAdvertisedInfo(vty, rfd, SAFI_MPLS_VPN,
 					 &adb->u.s.prefix_ip);
 	}
+	XFREE(MTYPE_TMP, sorted);
 	vty_out(vty, "%s", HVTYNL);
 }
 
@@ -3002,35 +3032,26 @@ static int rfapiDeleteLocalPrefixesByRFD(struct rfapi_local_reg_delete_arg *cda,
 		deleted_from_this_nve = 0;
 
 		{
-			struct skiplist *sl;
 			struct rfapi_ip_prefix rp;
-			void *cursor;
 			struct list *adb_delete_list;
 
 			/*
-			 * The advertisements are stored in a skiplist.
-			 * Withdrawing
-			 * the registration deletes the advertisement from the
-			 * skiplist, which we can't do while iterating over that
-			 * same skiplist using the current skiplist API.
+			 * The advertisements are stored in a hash.
+			 * Withdrawing the registration deletes the
+			 * advertisement from the hash, which we can't do
+			 * while iterating over that same hash.
 			 *
-			 * Strategy: iterate over the skiplist and build another
-			 * list containing only the matching ADBs. Then delete
-			 * _everything_ in that second list (which can be done
-			 * using either skiplists or quagga linklists).
+			 * Strategy: iterate over the hash and build a
+			 * list containing only the matching ADBs. Then
+			 * delete _everything_ in that list.
 			 */
 			adb_delete_list = list_new();
 
 			/*
 			 * Advertised IP prefixes (not 0/32 or 0/128)
 			 */
-			sl = rfd->advertised.ipN_by_prefix;
-
-			for (cursor = NULL,
-			    rc = skiplist_next(sl, NULL, (void **)&adb,
-					       &cursor);
-			     !rc; rc = skiplist_next(sl, NULL, (void **)&adb,
-						     &cursor)) {
+			frr_each (rfapi_adb_pfx, &rfd->advertised.ipN_by_prefix,
+				  adb) {
 
 				if (pPrefix) {
 					if (!prefix_same(pPrefix,
@@ -3159,14 +3180,8 @@ static int rfapiDeleteLocalPrefixesByRFD(struct rfapi_local_reg_delete_arg *cda,
 				 * Advertised 0/32 and 0/128 (indexed by
 				 * ethernet address)
 				 */
-				sl = rfd->advertised.ip0_by_ether;
-
-				for (cursor = NULL,
-				    rc = skiplist_next(sl, NULL, (void **)&adb,
-						       &cursor);
-				     !rc;
-				     rc = skiplist_next(sl, NULL, (void **)&adb,
-							&cursor)) {
+				frr_each (rfapi_adb_pfx,
+					  &rfd->advertised.ip0_by_ether, adb) {
 
 					if (CHECK_FLAG(cda->l2o.flags,
 						       RFAPI_L2O_MACADDR)) {
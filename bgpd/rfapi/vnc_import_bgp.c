@@ -20,6 +20,7 @@
 #include "lib/plist.h"
 #include "lib/routemap.h"
 #include "lib/lib_errors.h"
+#include "lib/jhash.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_ecommunity.h"
@@ -163,6 +164,27 @@ int vnc_prefix_cmp(const void *pfx1, const void *pfx2)
 	return 0;
 }
 
+/*
+ * Hash consistent with vnc_prefix_cmp(): only the bits covered by
+ * the prefix length contribute
+ */
+uint32_t vnc_prefix_hash(const void *pfx, uint32_t seed)
+{
+	const struct prefix *p = pfx;
+	const uint8_t *pp = (const uint8_t *)&p->u.prefix;
+	int offset = p->prefixlen / 8;
+	int shift = p->prefixlen % 8;
+	uint32_t h;
+
+	h = jhash_2words(p->family, p->prefixlen, seed);
+	if (offset)
+		h = jhash(pp, offset, h);
+	if (shift)
+		h = jhash_1word(pp[offset] & maskbit[shift], h);
+
+	return h;
+}
+
 static void prefix_bag_free(void *pb)
 {
 	XFREE(MTYPE_RFAPI_PREFIX_BAG, pb);
@@ -21,6 +21,8 @@ extern uint32_t calc_local_pref(struct attr *attr, struct peer *peer);
 
 extern int vnc_prefix_cmp(const void *pfx1, const void *pfx2);
 
+extern uint32_t vnc_prefix_hash(const void *pfx, uint32_t seed);
+
 extern void vnc_import_bgp_add_route(struct bgp *bgp,
 				     const struct prefix *prefix,
 				     struct bgp_path_info *info);
@@ -10,15 +10,25 @@
 #endif
 
 /* stub rfp */
+#include <sys/un.h>
+
 #include "rfp_internal.h"
+#include "rfp_flow.h"
 #include "bgpd/rfapi/rfapi.h"
 #include "lib/command.h"
+#include "lib/memory.h"
 
 struct rfp_instance_t {
 	struct rfapi_rfp_cfg rfapi_config;
 	struct rfapi_rfp_cb_methods rfapi_callbacks;
 	struct event_loop *master;
 	uint32_t config_var;
+
+	/* optional OpenFlow programming of received routes */
+	char *flow_switch_path;
+	struct rfp_flow_switch *flow_switch;
+	uint32_t flow_batch_size; /* 0 = default */
+	uint32_t flow_rate_limit; /* flows/second, 0 = unlimited */
 };
 
 struct rfp_instance_t
@@ -94,6 +104,209 @@ DEFUN (rfp_full_table_download,
 	return CMD_SUCCESS;
 }
 
+/*
+ * Connect to the switch (or a stand-in for one) listening on a
+ * unix stream socket. Returns -1 with errno set on failure.
+ */
+static int rfp_flow_connect(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd, err;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strlcpy(addr.sun_path, path, sizeof(addr.sun_path));
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		err = errno;
+		close(fd);
+		errno = err;
+		return -1;
+	}
+	return fd;
+}
+
+DEFUN (rfp_flow_switch,
+       rfp_flow_switch_cmd,
+       "rfp flow-switch PATH",
+       RFP_SHOW_STR
+       "Program received routes as OpenFlow flows\n"
+       "Unix socket path of the switch connection\n")
+{
+	struct rfp_instance_t *rfi;
+	int fd;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	XFREE(MTYPE_TMP, rfi->flow_switch_path);
+	rfi->flow_switch_path = XSTRDUP(MTYPE_TMP, argv[2]->arg);
+
+	fd = rfp_flow_connect(rfi->flow_switch_path);
+	if (fd < 0)
+		vty_out(vty,
+			"%% Can't connect to %s (%s), flows will be dropped\n",
+			rfi->flow_switch_path, safe_strerror(errno));
+
+	if (rfi->flow_switch)
+		rfp_flow_switch_set_fd(rfi->flow_switch, fd);
+	else
+		rfi->flow_switch =
+			rfp_flow_switch_new(rfi->master, fd,
+					    rfi->flow_batch_size,
+					    rfi->flow_rate_limit);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_rfp_flow_switch,
+       no_rfp_flow_switch_cmd,
+       "no rfp flow-switch [PATH]",
+       NO_STR
+       RFP_SHOW_STR
+       "Program received routes as OpenFlow flows\n"
+       "Unix socket path of the switch connection\n")
+{
+	struct rfp_instance_t *rfi;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	rfp_flow_switch_free(&rfi->flow_switch);
+	XFREE(MTYPE_TMP, rfi->flow_switch_path);
+	return CMD_SUCCESS;
+}
+
+DEFUN (rfp_flow_batch_size,
+       rfp_flow_batch_size_cmd,
+       "rfp flow-batch-size (1-65535)",
+       RFP_SHOW_STR
+       "Maximum FLOW_MODs per barrier-delimited batch\n"
+       "Number of FLOW_MODs\n")
+{
+	struct rfp_instance_t *rfi;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	rfi->flow_batch_size = strtoul(argv[2]->arg, NULL, 10);
+	if (rfi->flow_switch)
+		rfp_flow_switch_set_batch(rfi->flow_switch,
+					  rfi->flow_batch_size);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_rfp_flow_batch_size,
+       no_rfp_flow_batch_size_cmd,
+       "no rfp flow-batch-size [(1-65535)]",
+       NO_STR
+       RFP_SHOW_STR
+       "Maximum FLOW_MODs per barrier-delimited batch\n"
+       "Number of FLOW_MODs\n")
+{
+	struct rfp_instance_t *rfi;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	rfi->flow_batch_size = 0;
+	if (rfi->flow_switch)
+		rfp_flow_switch_set_batch(rfi->flow_switch,
+					  rfi->flow_batch_size);
+	return CMD_SUCCESS;
+}
+
+DEFUN (rfp_flow_rate_limit,
+       rfp_flow_rate_limit_cmd,
+       "rfp flow-rate-limit (0-4294967295)",
+       RFP_SHOW_STR
+       "Limit the rate of flow programming toward the switch\n"
+       "Flows per second (0 = unlimited)\n")
+{
+	struct rfp_instance_t *rfi;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	rfi->flow_rate_limit = strtoul(argv[2]->arg, NULL, 10);
+	if (rfi->flow_switch)
+		rfp_flow_switch_set_rate(rfi->flow_switch,
+					 rfi->flow_rate_limit);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_rfp_flow_rate_limit,
+       no_rfp_flow_rate_limit_cmd,
+       "no rfp flow-rate-limit [(0-4294967295)]",
+       NO_STR
+       RFP_SHOW_STR
+       "Limit the rate of flow programming toward the switch\n"
+       "Flows per second (0 = unlimited)\n")
+{
+	struct rfp_instance_t *rfi;
+
+	rfi = rfapi_get_rfp_start_val(VTY_GET_CONTEXT(bgp)); /* BGP_NODE */
+	if (!rfi) {
+		vty_out(vty, "VNC not configured\n");
+		return CMD_WARNING;
+	}
+
+	rfi->flow_rate_limit = 0;
+	if (rfi->flow_switch)
+		rfp_flow_switch_set_rate(rfi->flow_switch,
+					 rfi->flow_rate_limit);
+	return CMD_SUCCESS;
+}
+
+DEFUN (show_rfp_flow_switch,
+       show_rfp_flow_switch_cmd,
+       "show rfp flow-switch",
+       SHOW_STR
+       RFP_SHOW_STR
+       "OpenFlow programming statistics\n")
+{
+	const struct rfp_flow_stats *st;
+
+	if (!global_rfi.flow_switch) {
+		vty_out(vty, "No flow switch configured\n");
+		return CMD_SUCCESS;
+	}
+
+	st = rfp_flow_switch_stats(global_rfi.flow_switch);
+	vty_out(vty, "Switch: %s\n", global_rfi.flow_switch_path);
+	vty_out(vty, "  Flows added: %" PRIu64 ", deleted: %" PRIu64
+		     ", dropped: %" PRIu64 ", pending: %u\n",
+		st->flows_added, st->flows_deleted, st->flows_dropped,
+		rfp_flow_pending(global_rfi.flow_switch));
+	vty_out(vty, "  Batches: %" PRIu64 ", bytes: %" PRIu64
+		     ", writes: %" PRIu64 ", write errors: %" PRIu64 "\n",
+		st->batches, st->bytes, st->writes, st->write_errors);
+	vty_out(vty, "  Rate limited: %" PRIu64 "\n", st->rate_limited);
+	return CMD_SUCCESS;
+}
+
 static void rfp_vty_install(void)
 {
 	static int installed = 0;
@@ -104,6 +317,13 @@ static void rfp_vty_install(void)
 	install_element(BGP_NODE, &rfp_example_config_value_cmd);
 	install_element(BGP_NODE, &rfp_holddown_factor_cmd);
 	install_element(BGP_NODE, &rfp_full_table_download_cmd);
+	install_element(BGP_NODE, &rfp_flow_switch_cmd);
+	install_element(BGP_NODE, &no_rfp_flow_switch_cmd);
+	install_element(BGP_NODE, &rfp_flow_batch_size_cmd);
+	install_element(BGP_NODE, &no_rfp_flow_batch_size_cmd);
+	install_element(BGP_NODE, &rfp_flow_rate_limit_cmd);
+	install_element(BGP_NODE, &no_rfp_flow_rate_limit_cmd);
+	install_element(VIEW_NODE, &show_rfp_flow_switch_cmd);
 }
 
 /***********************************************************************
@@ -146,7 +366,13 @@ static void rfp_response_cb(struct rfapi_next_hop_entry *next_hops,
 	 * to RFAPI in the rfapi_open call
 	 */
 
-	/* process list of next_hops */
+	/*
+	 * process list of next_hops: program them on the switch,
+	 * using the NVE's cookie as the OpenFlow flow cookie
+	 */
+	if (global_rfi.flow_switch)
+		rfp_flow_nexthops(global_rfi.flow_switch, next_hops,
+				  (uintptr_t)userdata);
 
 	/* free next hops */
 	rfapi_free_next_hop_list(next_hops);
@@ -246,6 +472,18 @@ static int rfp_cfg_write_cb(struct vty *vty, void *rfp_start_val)
 		vty_out(vty, " rfp full-table-download on\n");
 		write++;
 	}
+	if (rfi->flow_batch_size) {
+		vty_out(vty, " rfp flow-batch-size %u\n", rfi->flow_batch_size);
+		write++;
+	}
+	if (rfi->flow_rate_limit) {
+		vty_out(vty, " rfp flow-rate-limit %u\n", rfi->flow_rate_limit);
+		write++;
+	}
+	if (rfi->flow_switch_path) {
+		vty_out(vty, " rfp flow-switch %s\n", rfi->flow_switch_path);
+		write++;
+	}
 	return write;
 }
 
@@ -286,6 +524,8 @@ void *rfp_start(struct event_loop *master, struct rfapi_rfp_cfg **cfgp,
 		0; /* default: RFAPI_RFP_CFG_DEFAULT_HOLDDOWN_FACTOR */
 	global_rfi.rfapi_config.use_updated_response = 1; /* 0=no */
 	global_rfi.rfapi_config.use_removes = 1;	  /* 0=no */
+	global_rfi.rfapi_config.response_coalesce_msec = 0; /* 0=no */
+	global_rfi.rfapi_config.response_coalesce_max = 0;  /* 0=no limit */
 
 
 	/* initilize structrfapi_rfp_cb_methods , see rfapi.h */
@@ -321,7 +561,11 @@ void *rfp_start(struct event_loop *master, struct rfapi_rfp_cfg **cfgp,
 --------------------------------------------*/
 void rfp_stop(void *rfp_start_val)
 {
+	struct rfp_instance_t *rfi = rfp_start_val;
+
 	assert(rfp_start_val != NULL);
+	rfp_flow_switch_free(&rfi->flow_switch);
+	XFREE(MTYPE_TMP, rfi->flow_switch_path);
 }
 
 /* TO BE REMOVED */
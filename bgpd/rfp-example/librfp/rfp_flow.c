@@ -0,0 +1,580 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/uio.h>
+
+#include "lib/zebra.h"
+#include "lib/memory.h"
+#include "lib/monotime.h"
+#include "lib/network.h"
+#include "lib/stream.h"
+#include "lib/log.h"
+
+#include "rfp_flow.h"
+
+DEFINE_MGROUP(RFP, "RFP example");
+DEFINE_MTYPE_STATIC(RFP, RFP_FLOW_SWITCH, "RFP flow switch");
+DEFINE_MTYPE_STATIC(RFP, RFP_FLOW_BATCH, "RFP flow batch");
+
+/* OpenFlow 1.3 constants */
+#define OFPFC_ADD 0
+#define OFPFC_DELETE_STRICT 4
+#define OFP_NO_BUFFER 0xffffffff
+#define OFPP_ANY 0xffffffff
+#define OFPG_ANY 0xffffffff
+#define OFPCML_NO_BUFFER 0xffff
+#define OFPMT_OXM 1
+#define OFPIT_APPLY_ACTIONS 4
+#define OFPAT_OUTPUT 0
+#define OFPAT_SET_FIELD 25
+
+#define OFPXMC_OPENFLOW_BASIC 0x8000
+#define OFPXMT_OFB_ETH_TYPE 5
+#define OFPXMT_OFB_IPV4_DST 12
+#define OFPXMT_OFB_IPV6_DST 27
+#define OFPXMT_OFB_TUNNEL_ID 38
+
+#define RFP_ETHERTYPE_IP 0x0800
+#define RFP_ETHERTYPE_IPV6 0x86dd
+
+#define OXM_HEADER(field, hasmask, len)                                        \
+	((OFPXMC_OPENFLOW_BASIC << 16) | ((field) << 9) | ((hasmask) << 8) |   \
+	 (len))
+
+/* batches kept for reuse rather than freed */
+#define RFP_FLOW_BATCH_POOL 16
+
+/* batches handed to a single writev() */
+#define RFP_FLOW_IOV_MAX 64
+
+/*
+ * A batch is a run of FLOW_MODs closed by a BARRIER_REQUEST. The
+ * messages are encoded directly into the batch's stream, and the
+ * stream is written to the switch from there.
+ */
+struct rfp_flow_batch {
+	struct rfp_flow_batch *next;
+	struct stream *s;
+	uint32_t flows;
+};
+
+struct rfp_flow_batch_queue {
+	struct rfp_flow_batch *head;
+	struct rfp_flow_batch *tail;
+	uint32_t count;
+};
+
+struct rfp_flow_switch {
+	struct event_loop *master;
+	int fd;
+	uint32_t batch_size;
+	uint32_t rate; /* flows/second, 0 = unlimited */
+	uint32_t xid;
+
+	struct rfp_flow_batch *open; /* being filled */
+	struct rfp_flow_batch_queue ready; /* closed, waiting for tokens */
+	struct rfp_flow_batch_queue out;   /* being written */
+	struct rfp_flow_batch_queue pool;
+	uint32_t pending; /* flows not yet written */
+
+	/* token bucket for the flow rate limit */
+	uint64_t tokens;
+	struct timeval refilled;
+
+	struct event *t_flush;
+	struct event *t_write;
+	struct event *t_refill;
+
+	struct rfp_flow_stats stats;
+};
+
+static void rfp_flow_write(struct event *t);
+static void rfp_flow_refill(struct event *t);
+
+static void batchq_push(struct rfp_flow_batch_queue *q, struct rfp_flow_batch *b)
+{
+	b->next = NULL;
+	if (q->tail)
+		q->tail->next = b;
+	else
+		q->head = b;
+	q->tail = b;
+	q->count++;
+}
+
+static struct rfp_flow_batch *batchq_pop(struct rfp_flow_batch_queue *q)
+{
+	struct rfp_flow_batch *b = q->head;
+
+	if (!b)
+		return NULL;
+	q->head = b->next;
+	if (!q->head)
+		q->tail = NULL;
+	q->count--;
+	b->next = NULL;
+	return b;
+}
+
+static size_t rfp_flow_batch_bytes(uint32_t batch_size)
+{
+	/* HELLO or BARRIER_REQUEST framing plus the FLOW_MODs */
+	return 2 * RFP_OFP_HEADER_LEN + (size_t)batch_size * RFP_FLOW_MOD_MAX;
+}
+
+static struct rfp_flow_batch *rfp_flow_batch_get(struct rfp_flow_switch *sw)
+{
+	size_t size = rfp_flow_batch_bytes(sw->batch_size);
+	struct rfp_flow_batch *b;
+
+	while ((b = batchq_pop(&sw->pool))) {
+		if (b->s->size >= size) {
+			stream_reset(b->s);
+			b->flows = 0;
+			return b;
+		}
+		/* batch size was raised since this one was allocated */
+		stream_free(b->s);
+		XFREE(MTYPE_RFP_FLOW_BATCH, b);
+	}
+
+	b = XCALLOC(MTYPE_RFP_FLOW_BATCH, sizeof(*b));
+	b->s = stream_new(size);
+	return b;
+}
+
+static void rfp_flow_batch_put(struct rfp_flow_switch *sw,
+			       struct rfp_flow_batch *b)
+{
+	sw->pending -= b->flows;
+
+	if (sw->pool.count < RFP_FLOW_BATCH_POOL) {
+		batchq_push(&sw->pool, b);
+		return;
+	}
+	stream_free(b->s);
+	XFREE(MTYPE_RFP_FLOW_BATCH, b);
+}
+
+static void rfp_flow_put_header(struct rfp_flow_switch *sw, struct stream *s,
+				uint8_t type)
+{
+	stream_putc(s, RFP_OFP_VERSION);
+	stream_putc(s, type);
+	stream_putw(s, RFP_OFP_HEADER_LEN); /* fixed up by caller if longer */
+	stream_putl(s, sw->xid++);
+}
+
+static void rfp_flow_drop(struct rfp_flow_switch *sw,
+			  struct rfp_flow_batch_queue *q)
+{
+	struct rfp_flow_batch *b;
+
+	while ((b = batchq_pop(q))) {
+		sw->stats.flows_dropped += b->flows;
+		rfp_flow_batch_put(sw, b);
+	}
+}
+
+/*
+ * Move closed batches to the output queue as far as the rate limit
+ * allows, and make sure the writer is scheduled.
+ */
+static void rfp_flow_release(struct rfp_flow_switch *sw)
+{
+	struct rfp_flow_batch *b;
+
+	if (sw->fd < 0) {
+		rfp_flow_drop(sw, &sw->ready);
+		return;
+	}
+
+	if (sw->rate && sw->ready.head) {
+		uint64_t burst = MAX(sw->rate, sw->batch_size);
+		int64_t usec = monotime_since(&sw->refilled, NULL);
+
+		sw->tokens += (uint64_t)usec * sw->rate / 1000000;
+		if (sw->tokens > burst)
+			sw->tokens = burst;
+		monotime(&sw->refilled);
+	}
+
+	while ((b = sw->ready.head)) {
+		if (sw->rate) {
+			if (sw->tokens < b->flows)
+				break;
+			sw->tokens -= b->flows;
+		}
+		batchq_push(&sw->out, batchq_pop(&sw->ready));
+	}
+
+	if (sw->ready.head && !sw->t_refill) {
+		uint64_t need = sw->ready.head->flows - sw->tokens;
+
+		sw->stats.rate_limited++;
+		event_add_timer_msec(sw->master, rfp_flow_refill, sw,
+				     MAX(1, need * 1000 / sw->rate),
+				     &sw->t_refill);
+	}
+
+	if (sw->out.head)
+		event_add_write(sw->master, rfp_flow_write, sw, sw->fd,
+				&sw->t_write);
+}
+
+static void rfp_flow_refill(struct event *t)
+{
+	rfp_flow_release(EVENT_ARG(t));
+}
+
+static void rfp_flow_close_batch(struct rfp_flow_switch *sw)
+{
+	struct rfp_flow_batch *b = sw->open;
+
+	if (!b || !b->flows)
+		return;
+	sw->open = NULL;
+
+	rfp_flow_put_header(sw, b->s, RFP_OFPT_BARRIER_REQUEST);
+	sw->stats.batches++;
+	batchq_push(&sw->ready, b);
+}
+
+static void rfp_flow_flush_event(struct event *t)
+{
+	struct rfp_flow_switch *sw = EVENT_ARG(t);
+
+	rfp_flow_close_batch(sw);
+	rfp_flow_release(sw);
+}
+
+void rfp_flow_flush(struct rfp_flow_switch *sw)
+{
+	event_cancel(&sw->t_flush);
+	rfp_flow_close_batch(sw);
+	rfp_flow_release(sw);
+}
+
+static void rfp_flow_write(struct event *t)
+{
+	struct rfp_flow_switch *sw = EVENT_ARG(t);
+	struct iovec iov[RFP_FLOW_IOV_MAX];
+	struct rfp_flow_batch *b;
+	ssize_t nwrite;
+	int iovcnt = 0;
+
+	for (b = sw->out.head; b && iovcnt < RFP_FLOW_IOV_MAX; b = b->next) {
+		iov[iovcnt].iov_base = stream_pnt(b->s);
+		iov[iovcnt].iov_len = STREAM_READABLE(b->s);
+		iovcnt++;
+	}
+	if (!iovcnt)
+		return;
+
+	nwrite = writev(sw->fd, iov, iovcnt);
+	sw->stats.writes++;
+
+	if (nwrite < 0) {
+		if (ERRNO_IO_RETRY(errno)) {
+			event_add_write(sw->master, rfp_flow_write, sw, sw->fd,
+					&sw->t_write);
+			return;
+		}
+		zlog_warn("%s: write to switch failed: %s", __func__,
+			  safe_strerror(errno));
+		sw->stats.write_errors++;
+		rfp_flow_switch_set_fd(sw, -1);
+		return;
+	}
+
+	sw->stats.bytes += nwrite;
+
+	while (nwrite > 0 && (b = sw->out.head)) {
+		size_t len = STREAM_READABLE(b->s);
+
+		if ((size_t)nwrite < len) {
+			stream_forward_getp(b->s, nwrite);
+			break;
+		}
+		nwrite -= len;
+		rfp_flow_batch_put(sw, batchq_pop(&sw->out));
+	}
+
+	/* the next batches may have been waiting only for this one */
+	rfp_flow_release(sw);
+}
+
+/*
+ * Encode one FLOW_MOD: match on the destination prefix, and for adds
+ * set the tunnel id to the NVE's UN address and send it to the tunnel
+ * port. Returns false if the entry can't be expressed.
+ */
+static bool rfp_flow_encode(struct rfp_flow_switch *sw, struct stream *s,
+			    const struct rfapi_next_hop_entry *nh,
+			    uint64_t cookie)
+{
+	const struct rfapi_ip_addr *pfx = &nh->prefix.prefix;
+	bool del = (nh->lifetime == RFAPI_REMOVE_RESPONSE_LIFETIME);
+	size_t start = stream_get_endp(s);
+	size_t match_start;
+	uint16_t hard_timeout = 0;
+	uint64_t tunnel_id = 0;
+	uint8_t mask[IPV6_MAX_BYTELEN];
+	uint8_t addrlen;
+	uint8_t field;
+	uint16_t ethertype;
+	int i;
+
+	switch (pfx->addr_family) {
+	case AF_INET:
+		addrlen = IPV4_MAX_BYTELEN;
+		field = OFPXMT_OFB_IPV4_DST;
+		ethertype = RFP_ETHERTYPE_IP;
+		break;
+	case AF_INET6:
+		addrlen = IPV6_MAX_BYTELEN;
+		field = OFPXMT_OFB_IPV6_DST;
+		ethertype = RFP_ETHERTYPE_IPV6;
+		break;
+	default:
+		return false;
+	}
+	if (nh->prefix.length > addrlen * 8)
+		return false;
+
+	if (!del && nh->lifetime != RFAPI_INFINITE_LIFETIME)
+		hard_timeout = MIN(nh->lifetime, UINT16_MAX);
+
+	switch (nh->un_address.addr_family) {
+	case AF_INET:
+		tunnel_id = ntohl(nh->un_address.addr.v4.s_addr);
+		break;
+	case AF_INET6:
+		/* interface identifier half of the address */
+		for (i = 8; i < IPV6_MAX_BYTELEN; i++)
+			tunnel_id = (tunnel_id << 8) |
+				    nh->un_address.addr.v6.s6_addr[i];
+		break;
+	}
+
+	/* struct ofp_flow_mod */
+	rfp_flow_put_header(sw, s, RFP_OFPT_FLOW_MOD);
+	stream_putq(s, cookie);
+	stream_putq(s, 0); /* cookie_mask */
+	stream_putc(s, 0); /* table_id */
+	stream_putc(s, del ? OFPFC_DELETE_STRICT : OFPFC_ADD);
+	stream_putw(s, 0); /* idle_timeout */
+	stream_putw(s, hard_timeout);
+	stream_putw(s, nh->prefix.length); /* priority: longest match */
+	stream_putl(s, OFP_NO_BUFFER);
+	stream_putl(s, OFPP_ANY);
+	stream_putl(s, OFPG_ANY);
+	stream_putw(s, 0); /* flags */
+	stream_putw(s, 0); /* pad */
+
+	/* struct ofp_match */
+	match_start = stream_get_endp(s);
+	stream_putw(s, OFPMT_OXM);
+	stream_putw(s, 0); /* length, below */
+	stream_putl(s, OXM_HEADER(OFPXMT_OFB_ETH_TYPE, 0, 2));
+	stream_putw(s, ethertype);
+	if (nh->prefix.length == addrlen * 8) {
+		stream_putl(s, OXM_HEADER(field, 0, addrlen));
+		stream_put(s, &pfx->addr, addrlen);
+	} else if (nh->prefix.length) {
+		if (pfx->addr_family == AF_INET)
+			masklen2ip(nh->prefix.length, (struct in_addr *)mask);
+		else
+			masklen2ip6(nh->prefix.length, (struct in6_addr *)mask);
+
+		stream_putl(s, OXM_HEADER(field, 1, 2 * addrlen));
+		stream_put(s, &pfx->addr, addrlen);
+		stream_put(s, mask, addrlen);
+	}
+	stream_putw_at(s, match_start + 2, stream_get_endp(s) - match_start);
+	while ((stream_get_endp(s) - match_start) % 8)
+		stream_putc(s, 0);
+
+	if (!del) {
+		size_t insn_start = stream_get_endp(s);
+
+		/* struct ofp_instruction_actions */
+		stream_putw(s, OFPIT_APPLY_ACTIONS);
+		stream_putw(s, 0); /* length, below */
+		stream_putl(s, 0); /* pad */
+
+		/* struct ofp_action_set_field */
+		stream_putw(s, OFPAT_SET_FIELD);
+		stream_putw(s, 16);
+		stream_putl(s, OXM_HEADER(OFPXMT_OFB_TUNNEL_ID, 0, 8));
+		stream_putq(s, tunnel_id);
+
+		/* struct ofp_action_output */
+		stream_putw(s, OFPAT_OUTPUT);
+		stream_putw(s, 16);
+		stream_putl(s, RFP_FLOW_TUNNEL_PORT);
+		stream_putw(s, OFPCML_NO_BUFFER);
+		stream_putw(s, 0); /* pad */
+		stream_putl(s, 0); /* pad */
+
+		stream_putw_at(s, insn_start + 2,
+			       stream_get_endp(s) - insn_start);
+	}
+
+	stream_putw_at(s, start + 2, stream_get_endp(s) - start);
+	return true;
+}
+
+uint32_t rfp_flow_nexthops(struct rfp_flow_switch *sw,
+			   const struct rfapi_next_hop_entry *nhl,
+			   uint64_t cookie)
+{
+	const struct rfapi_next_hop_entry *nh;
+	uint32_t count = 0;
+
+	for (nh = nhl; nh; nh = nh->next) {
+		if (!sw->open)
+			sw->open = rfp_flow_batch_get(sw);
+
+		if (!rfp_flow_encode(sw, sw->open->s, nh, cookie))
+			continue;
+
+		if (nh->lifetime == RFAPI_REMOVE_RESPONSE_LIFETIME)
+			sw->stats.flows_deleted++;
+		else
+			sw->stats.flows_added++;
+		sw->open->flows++;
+		sw->pending++;
+		count++;
+
+		if (sw->open->flows >= sw->batch_size) {
+			rfp_flow_close_batch(sw);
+			rfp_flow_release(sw);
+		}
+	}
+
+	/*
+	 * Let other callbacks run in this pass of the event loop add to
+	 * the batch before it is closed
+	 */
+	if (sw->open && sw->open->flows)
+		event_add_event(sw->master, rfp_flow_flush_event, sw, 0,
+				&sw->t_flush);
+
+	return count;
+}
+
+uint32_t rfp_flow_pending(const struct rfp_flow_switch *sw)
+{
+	return sw->pending;
+}
+
+void rfp_flow_switch_set_fd(struct rfp_flow_switch *sw, int fd)
+{
+	struct rfp_flow_batch *b;
+
+	event_cancel(&sw->t_write);
+	if (sw->fd >= 0) {
+		close(sw->fd);
+		sw->fd = -1;
+		rfp_flow_drop(sw, &sw->out);
+	}
+	if (fd < 0) {
+		rfp_flow_release(sw); /* drops whatever is waiting */
+		return;
+	}
+
+	set_nonblocking(fd);
+	sw->fd = fd;
+
+	/* start with a HELLO; it bypasses the rate limit */
+	b = rfp_flow_batch_get(sw);
+	rfp_flow_put_header(sw, b->s, RFP_OFPT_HELLO);
+	batchq_push(&sw->out, b);
+
+	rfp_flow_release(sw);
+}
+
+void rfp_flow_switch_set_batch(struct rfp_flow_switch *sw, uint32_t batch_size)
+{
+	if (!batch_size || batch_size > RFP_FLOW_BATCH_MAX)
+		batch_size = RFP_FLOW_BATCH_DEFAULT;
+	/* the open batch's stream is only as large as the old size needs */
+	if (sw->open && batch_size != sw->batch_size) {
+		if (sw->open->flows)
+			rfp_flow_flush(sw);
+		else {
+			rfp_flow_batch_put(sw, sw->open);
+			sw->open = NULL;
+		}
+	}
+	sw->batch_size = batch_size;
+}
+
+void rfp_flow_switch_set_rate(struct rfp_flow_switch *sw, uint32_t rate)
+{
+	sw->rate = rate;
+	sw->tokens = MAX(rate, sw->batch_size);
+	monotime(&sw->refilled);
+	event_cancel(&sw->t_refill);
+	rfp_flow_release(sw);
+}
+
+struct rfp_flow_switch *rfp_flow_switch_new(struct event_loop *master, int fd,
+					    uint32_t batch_size, uint32_t rate)
+{
+	struct rfp_flow_switch *sw;
+
+	sw = XCALLOC(MTYPE_RFP_FLOW_SWITCH, sizeof(*sw));
+	sw->master = master;
+	sw->fd = -1;
+	rfp_flow_switch_set_batch(sw, batch_size);
+	rfp_flow_switch_set_rate(sw, rate);
+	rfp_flow_switch_set_fd(sw, fd);
+	return sw;
+}
+
+void rfp_flow_switch_free(struct rfp_flow_switch **swp)
+{
+	struct rfp_flow_switch *sw = *swp;
+	struct rfp_flow_batch *b;
+
+	if (!sw)
+		return;
+
+	event_cancel(&sw->t_flush);
+	event_cancel(&sw->t_refill);
+	rfp_flow_switch_set_fd(sw, -1);
+
+	if (sw->open) {
+		sw->pending -= sw->open->flows;
+		stream_free(sw->open->s);
+		XFREE(MTYPE_RFP_FLOW_BATCH, sw->open);
+	}
+	while ((b = batchq_pop(&sw->pool))) {
+		stream_free(b->s);
+		XFREE(MTYPE_RFP_FLOW_BATCH, b);
+	}
+
+	XFREE(MTYPE_RFP_FLOW_SWITCH, sw);
+	*swp = NULL;
+}
+
+const struct rfp_flow_stats *
+rfp_flow_switch_stats(const struct rfp_flow_switch *sw)
+{
+	return &sw->stats;
+}
+
+void rfp_flow_switch_stats_clear(struct rfp_flow_switch *sw)
+{
+	memset(&sw->stats, 0, sizeof(sw->stats));
+}
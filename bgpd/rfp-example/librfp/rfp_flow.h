@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ *
+ */
+
+/*
+ * Reference flow programming for the example RFP: next hop lists
+ * delivered by rfapi callbacks are translated to OpenFlow 1.3
+ * FLOW_MOD messages and written, in batches, to a switch connection.
+ *
+ * This file only depends on libfrr so that it can also be driven
+ * directly by rfptest.
+ */
+#ifndef _RFP_FLOW_H
+#define _RFP_FLOW_H
+
+#include "lib/zebra.h"
+#include "lib/frrevent.h"
+#include "bgpd/rfapi/rfapi.h"
+
+/* OpenFlow 1.3 (wire protocol 0x04) message types used here */
+#define RFP_OFP_VERSION 0x04
+#define RFP_OFPT_HELLO 0
+#define RFP_OFPT_FLOW_MOD 14
+#define RFP_OFPT_BARRIER_REQUEST 20
+#define RFP_OFP_HEADER_LEN 8
+
+/* largest FLOW_MOD that rfp_flow encodes (IPv6 masked match) */
+#define RFP_FLOW_MOD_MAX 144
+
+#define RFP_FLOW_BATCH_DEFAULT 256
+#define RFP_FLOW_BATCH_MAX 65535
+
+/* output port used for all tunnel flows */
+#define RFP_FLOW_TUNNEL_PORT 1
+
+struct rfp_flow_stats {
+	uint64_t flows_added;
+	uint64_t flows_deleted;
+	uint64_t flows_dropped; /* no switch connection */
+	uint64_t batches;
+	uint64_t bytes;
+	uint64_t writes;	/* write syscalls */
+	uint64_t rate_limited;	/* times a batch waited for tokens */
+	uint64_t write_errors;
+};
+
+struct rfp_flow_switch;
+
+/*
+ * fd is a connected stream socket (it is made non-blocking and owned by
+ * the switch from then on), or -1 to encode and count flows without
+ * sending them. rate is in flows per second, 0 = unlimited.
+ */
+extern struct rfp_flow_switch *rfp_flow_switch_new(struct event_loop *master,
+						   int fd, uint32_t batch_size,
+						   uint32_t rate);
+extern void rfp_flow_switch_free(struct rfp_flow_switch **swp);
+
+extern void rfp_flow_switch_set_fd(struct rfp_flow_switch *sw, int fd);
+extern void rfp_flow_switch_set_batch(struct rfp_flow_switch *sw,
+				      uint32_t batch_size);
+extern void rfp_flow_switch_set_rate(struct rfp_flow_switch *sw,
+				     uint32_t rate);
+
+/*
+ * Translate a next hop list to FLOW_MODs: an add (or modify) for each
+ * entry with a non-zero lifetime, a strict delete for each removal.
+ * The list is not retained; the caller still frees it. All FLOW_MODs
+ * carry the given OpenFlow cookie.
+ *
+ * Returns the number of flows queued.
+ */
+extern uint32_t rfp_flow_nexthops(struct rfp_flow_switch *sw,
+				  const struct rfapi_next_hop_entry *nhl,
+				  uint64_t cookie);
+
+/* close the open batch and start writing it without waiting */
+extern void rfp_flow_flush(struct rfp_flow_switch *sw);
+
+/* flows encoded but not yet written to the switch */
+extern uint32_t rfp_flow_pending(const struct rfp_flow_switch *sw);
+
+extern const struct rfp_flow_stats *
+rfp_flow_switch_stats(const struct rfp_flow_switch *sw);
+
+extern void rfp_flow_switch_stats_clear(struct rfp_flow_switch *sw);
+
+#endif /* _RFP_FLOW_H */
@@ -9,12 +9,805 @@
 #include "config.h"
 #endif
 
-/* dummy test program */
 #include <stdio.h>
 #include <stdlib.h>
+#include <getopt.h>
+
+#include "lib/zebra.h"
+#include "lib/command.h"
+#include "lib/debug.h"
+#include "lib/frr_pthread.h"
+#include "lib/frrevent.h"
+#include "lib/memory.h"
+#include "lib/monotime.h"
+#include "lib/network.h"
+#include "lib/northbound.h"
+#include "lib/privs.h"
+#include "lib/vrf.h"
+#include "lib/vty.h"
+#include "lib/zlog.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/rfapi/rfapi.h"
+#include "bgpd/rfapi/rfapi_private.h"
+#include "bgpd/rfp-example/librfp/rfp_flow.h"
+
 #include "rfptest.h"
-int main(void)
+
+/* Satisfy link requirements from bgpd */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/*
+ * flow: measure routes-to-flows latency of the example RFP's OpenFlow
+ * programming. Next hop lists are fed to rfp_flow as if they had come
+ * from updated-response callbacks; an in-process switch stand-in reads
+ * the FLOW_MODs from the other end of a socketpair and timestamps them.
+ */
+
+#define FLOW_ROUTES_DEFAULT 100000
+#define FLOW_ROUTES_PER_UPDATE 16
+#define FLOW_UPDATES_PER_PASS 64
+
+struct flow_bench {
+	struct event_loop *master;
+	struct rfp_flow_switch *sw;
+	int fd; /* switch stand-in end */
+
+	uint32_t routes;
+	uint32_t updates;
+	uint32_t submitted; /* updates */
+	uint32_t received;  /* FLOW_MODs */
+	struct timeval *submit_time; /* per update */
+	uint32_t *latency_usec;	     /* per route */
+
+	uint8_t buf[65536];
+	size_t buflen;
+
+	struct event *t_submit;
+	struct event *t_read;
+};
+
+static void flow_bench_submit(struct event *t)
+{
+	struct flow_bench *fb = EVENT_ARG(t);
+	struct rfapi_next_hop_entry nh[FLOW_ROUTES_PER_UPDATE];
+	uint32_t pass;
+	uint32_t i;
+
+	for (pass = 0; pass < FLOW_UPDATES_PER_PASS &&
+		       fb->submitted < fb->updates;
+	     pass++, fb->submitted++) {
+		uint32_t base = fb->submitted * FLOW_ROUTES_PER_UPDATE;
+		uint32_t n = MIN(FLOW_ROUTES_PER_UPDATE, fb->routes - base);
+
+		memset(nh, 0, sizeof(nh));
+		for (i = 0; i < n; i++) {
+			nh[i].next = (i + 1 < n) ? &nh[i + 1] : NULL;
+			nh[i].prefix.length = IPV4_MAX_BITLEN;
+			nh[i].prefix.prefix.addr_family = AF_INET;
+			nh[i].prefix.prefix.addr.v4.s_addr =
+				htonl(0x0a000000 + base + i);
+			nh[i].lifetime = 3600;
+			nh[i].un_address.addr_family = AF_INET;
+			nh[i].un_address.addr.v4.s_addr =
+				htonl(0xc0000200 + (base + i) % 254 + 1);
+			nh[i].vn_address = nh[i].un_address;
+		}
+
+		monotime(&fb->submit_time[fb->submitted]);
+		rfp_flow_nexthops(fb->sw, nh, fb->submitted);
+	}
+
+	if (fb->submitted < fb->updates)
+		event_add_event(fb->master, flow_bench_submit, fb, 0,
+				&fb->t_submit);
+}
+
+static void flow_bench_read(struct event *t)
+{
+	struct flow_bench *fb = EVENT_ARG(t);
+	struct timeval now;
+	ssize_t nread;
+	size_t off = 0;
+
+	nread = read(fb->fd, fb->buf + fb->buflen,
+		     sizeof(fb->buf) - fb->buflen);
+	if (nread <= 0) {
+		if (nread < 0 && ERRNO_IO_RETRY(errno))
+			event_add_read(fb->master, flow_bench_read, fb, fb->fd,
+				       &fb->t_read);
+		return;
+	}
+	fb->buflen += nread;
+	monotime(&now);
+
+	while (fb->buflen - off >= RFP_OFP_HEADER_LEN) {
+		uint8_t *msg = fb->buf + off;
+		uint16_t len = (msg[2] << 8) | msg[3];
+
+		assert(len >= RFP_OFP_HEADER_LEN);
+		if (fb->buflen - off < len)
+			break;
+
+		if (msg[1] == RFP_OFPT_FLOW_MOD) {
+			uint64_t cookie = 0;
+			int i;
+
+			for (i = 0; i < 8; i++)
+				cookie = (cookie << 8) | msg[8 + i];
+			assert(cookie < fb->submitted);
+			fb->latency_usec[fb->received++] = monotime_since(
+				&fb->submit_time[cookie], &now);
+		}
+		off += len;
+	}
+	memmove(fb->buf, fb->buf + off, fb->buflen - off);
+	fb->buflen -= off;
+
+	if (fb->received < fb->routes)
+		event_add_read(fb->master, flow_bench_read, fb, fb->fd,
+			       &fb->t_read);
+}
+
+static int usec_cmp(const void *a, const void *b)
+{
+	uint32_t ua = *(const uint32_t *)a;
+	uint32_t ub = *(const uint32_t *)b;
+
+	return (ua > ub) - (ua < ub);
+}
+
+static int flow_bench(int argc, char **argv)
+{
+	struct flow_bench fb = {};
+	const struct rfp_flow_stats *st;
+	struct timeval start;
+	struct event ev;
+	uint32_t batch = 0;
+	uint32_t rate = 0;
+	uint64_t elapsed;
+	int sv[2];
+
+	fb.routes = FLOW_ROUTES_DEFAULT;
+	if (argc > 0)
+		fb.routes = strtoul(argv[0], NULL, 10);
+	if (argc > 1)
+		batch = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		rate = strtoul(argv[2], NULL, 10);
+	if (!fb.routes)
+		return 1;
+
+	fb.updates = (fb.routes + FLOW_ROUTES_PER_UPDATE - 1) /
+		     FLOW_ROUTES_PER_UPDATE;
+	fb.submit_time = calloc(fb.updates, sizeof(*fb.submit_time));
+	fb.latency_usec = calloc(fb.routes, sizeof(*fb.latency_usec));
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+		perror("socketpair");
+		return 1;
+	}
+
+	fb.master = event_master_create("rfptest");
+	fb.fd = sv[1];
+	set_nonblocking(fb.fd);
+	fb.sw = rfp_flow_switch_new(fb.master, sv[0], batch, rate);
+
+	monotime(&start);
+	event_add_event(fb.master, flow_bench_submit, &fb, 0, &fb.t_submit);
+	event_add_read(fb.master, flow_bench_read, &fb, fb.fd, &fb.t_read);
+
+	while (fb.received < fb.routes && event_fetch(fb.master, &ev))
+		event_call(&ev);
+
+	elapsed = monotime_since(&start, NULL);
+	st = rfp_flow_switch_stats(fb.sw);
+
+	if (fb.received < fb.routes) {
+		fprintf(stderr, "only %u of %u flows received\n", fb.received,
+			fb.routes);
+		return 1;
+	}
+
+	qsort(fb.latency_usec, fb.received, sizeof(uint32_t), usec_cmp);
+
+	printf("%u routes in %u updates, batch size %u, rate limit %u/s\n",
+	       fb.routes, fb.updates, batch ? batch : RFP_FLOW_BATCH_DEFAULT,
+	       rate);
+	printf("elapsed %" PRIu64 " usec, %.0f flows/s\n", elapsed,
+	       elapsed ? (double)fb.received * 1000000 / elapsed : 0.0);
+	printf("latency usec: p50 %u p90 %u p99 %u max %u\n",
+	       fb.latency_usec[fb.received / 2],
+	       fb.latency_usec[fb.received * 9 / 10],
+	       fb.latency_usec[fb.received * 99 / 100],
+	       fb.latency_usec[fb.received - 1]);
+	printf("batches %" PRIu64 ", writes %" PRIu64 ", bytes %" PRIu64
+	       ", rate limited %" PRIu64 "\n",
+	       st->batches, st->writes, st->bytes, st->rate_limited);
+
+	rfp_flow_switch_free(&fb.sw);
+	close(fb.fd);
+	event_master_free(fb.master);
+	free(fb.submit_time);
+	free(fb.latency_usec);
+
+	return 0;
+}
+
+/*
+ * load: open NVEs with rfapi_open() against an in-process bgp instance,
+ * register and query a prefix distribution, then churn some of the
+ * prefixes. Reports latency histograms for each rfapi operation, the
+ * delay before the resulting updated responses reach the querying
+ * NVEs, and the memory accounted in the MTYPE counters.
+ *
+ * The bgp/VNC configuration is read from -f FILE, which uses the
+ * normal bgpd.conf syntax. Without -f, load_default_config is used.
+ * Every random choice is derived from -s SEED, so the same arguments
+ * reproduce the same workload.
+ */
+
+#define LOAD_NVES_DEFAULT 100
+#define LOAD_PREFIXES_DEFAULT 100 /* per NVE */
+#define LOAD_QUERIES_DEFAULT 10	  /* per NVE */
+#define LOAD_CHURN_DEFAULT 100	  /* prefixes per round */
+#define LOAD_ROUNDS_DEFAULT 10
+#define LOAD_LIFETIME 3600
+
+/* NVE VN and UN addresses are taken from 172.16.0.0/12 */
+#define LOAD_NVE_BASE 0xac100000
+#define LOAD_NVE_MAX ((1 << 20) - 2)
+/* registered prefixes are taken from 10.0.0.0/8 */
+#define LOAD_PREFIX_BASE 0x0a000000
+
+static const char load_default_config[] =
+	"router bgp 64512\n"
+	" bgp router-id 192.0.2.1\n"
+	" vnc nve-group rfptest\n"
+	"  prefix vn 172.16.0.0/12\n"
+	"  prefix un 172.16.0.0/12\n"
+	"  rd 64512:1\n"
+	"  rt both 64512:1\n"
+	" exit-vnc\n"
+	"exit\n";
+
+/* log2 histogram: bucket b counts samples below 2^b usec */
+#define LOAD_HIST_BUCKETS 33
+
+struct load_hist {
+	const char *name;
+	uint64_t count;
+	uint64_t sum;
+	uint32_t max;
+	uint64_t bucket[LOAD_HIST_BUCKETS];
+};
+
+struct load_prefix {
+	uint32_t addr; /* host byte order */
+	uint32_t owner;
+	bool registered;
+	struct timeval changed; /* last churn operation */
+};
+
+struct load_bench;
+
+struct load_nve {
+	struct load_bench *lb;
+	rfapi_handle rfd;
+	struct rfapi_ip_addr addr; /* both VN and UN */
+};
+
+struct load_bench {
+	struct event_loop *master;
+
+	uint32_t nves;
+	uint32_t prefixes; /* per NVE */
+	uint8_t prefixlen;
+	uint32_t queries; /* per NVE */
+	uint32_t churn;
+	uint32_t rounds;
+	bool random;
+	bool verbose;
+
+	struct load_nve *nve;
+	struct load_prefix *prefix;
+	struct load_prefix **sorted; /* by address */
+	uint32_t nprefix;
+
+	uint64_t callbacks;
+	uint64_t nh_entries;
+	uint64_t nh_unmatched;
+	uint64_t errors;
+	size_t mem_peak;
+
+	struct load_hist h_open;
+	struct load_hist h_register;
+	struct load_hist h_query;
+	struct load_hist h_withdraw;
+	struct load_hist h_callback;
+	struct load_hist h_close;
+};
+
+static void load_hist_add(struct load_hist *h, uint32_t usec)
+{
+	unsigned int b = usec ? 32 - __builtin_clz(usec) : 0;
+
+	h->bucket[b]++;
+	h->count++;
+	h->sum += usec;
+	if (usec > h->max)
+		h->max = usec;
+}
+
+/* upper bound of the bucket holding the pct'th percentile sample */
+static uint64_t load_hist_pct(const struct load_hist *h, unsigned int pct)
+{
+	uint64_t want = (h->count * pct + 99) / 100;
+	uint64_t seen = 0;
+	unsigned int b;
+
+	for (b = 0; b < LOAD_HIST_BUCKETS - 1; b++) {
+		seen += h->bucket[b];
+		if (seen >= want)
+			break;
+	}
+	return MIN(b ? (1ULL << b) - 1 : 0, h->max);
+}
+
+static void load_hist_print(const struct load_hist *h, bool verbose)
+{
+	unsigned int b;
+
+	if (!h->count) {
+		printf("%-9s no samples\n", h->name);
+		return;
+	}
+
+	printf("%-9s %9" PRIu64 " ops, usec: avg %" PRIu64 " p50 %" PRIu64
+	       " p90 %" PRIu64 " p99 %" PRIu64 " max %u\n",
+	       h->name, h->count, h->sum / h->count, load_hist_pct(h, 50),
+	       load_hist_pct(h, 90), load_hist_pct(h, 99), h->max);
+
+	if (!verbose)
+		return;
+	for (b = 0; b < LOAD_HIST_BUCKETS; b++)
+		if (h->bucket[b])
+			printf("          < %10llu usec: %" PRIu64 "\n",
+			       1ULL << b, h->bucket[b]);
+}
+
+struct load_mem {
+	size_t bytes;
+	size_t allocs;
+};
+
+static int load_mem_walk(void *arg, struct memgroup *mg, struct memtype *mt)
+{
+	struct load_mem *m = arg;
+	size_t n;
+
+	if (!mt)
+		return 0;
+
+	n = atomic_load_explicit(&mt->n_alloc, memory_order_relaxed);
+	m->allocs += n;
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	m->bytes += atomic_load_explicit(&mt->total, memory_order_relaxed);
+#else
+	if (mt->size != SIZE_VAR)
+		m->bytes += n * mt->size;
+#endif
+	return 0;
+}
+
+static void load_mem_sample(struct load_bench *lb, struct load_mem *m)
 {
-	printf("Your test code goes here.\n");
+	memset(m, 0, sizeof(*m));
+	qmem_walk(load_mem_walk, m);
+	if (m->bytes > lb->mem_peak)
+		lb->mem_peak = m->bytes;
+}
+
+static void load_mem_report(struct load_bench *lb, const char *phase)
+{
+	struct load_mem m;
+
+	load_mem_sample(lb, &m);
+	printf("%-9s mem %zu KiB in %zu allocations\n", phase, m.bytes / 1024,
+	       m.allocs);
+}
+
+static int load_prefix_cmp(const void *a, const void *b)
+{
+	const struct load_prefix *pa = *(const struct load_prefix *const *)a;
+	const struct load_prefix *pb = *(const struct load_prefix *const *)b;
+
+	return (pa->addr > pb->addr) - (pa->addr < pb->addr);
+}
+
+static struct load_prefix *load_prefix_find(struct load_bench *lb,
+					    uint32_t addr)
+{
+	struct load_prefix key = { .addr = addr };
+	const struct load_prefix *kp = &key;
+	struct load_prefix **lpp;
+
+	lpp = bsearch(&kp, lb->sorted, lb->nprefix, sizeof(*lb->sorted),
+		      load_prefix_cmp);
+	return lpp ? *lpp : NULL;
+}
+
+static void load_response_cb(struct rfapi_next_hop_entry *nhl, void *userdata)
+{
+	struct load_nve *nve = userdata;
+	struct load_bench *lb = nve->lb;
+	struct rfapi_next_hop_entry *nh;
+	struct load_prefix *lp;
+	struct timeval now;
+
+	monotime(&now);
+	lb->callbacks++;
+
+	for (nh = nhl; nh; nh = nh->next) {
+		lb->nh_entries++;
+		lp = NULL;
+		if (nh->prefix.prefix.addr_family == AF_INET)
+			lp = load_prefix_find(
+				lb, ntohl(nh->prefix.prefix.addr.v4.s_addr));
+		if (!lp || !timerisset(&lp->changed)) {
+			lb->nh_unmatched++;
+			continue;
+		}
+		load_hist_add(&lb->h_callback,
+			      monotime_since(&lp->changed, &now));
+	}
+	rfapi_free_next_hop_list(nhl);
+}
+
+/* run the event loop until no NVE has updated responses outstanding */
+static void load_drain(struct load_bench *lb)
+{
+	struct rfapi_descriptor *rfd;
+	struct event ev;
+	uint32_t i = 0;
+
+	while (i < lb->nves) {
+		rfd = lb->nve[i].rfd;
+		if (!CHECK_FLAG(rfd->flags, RFAPI_QUEUED_FLAG(AFI_IP)) &&
+		    !rfd->t_response_coalesce) {
+			i++;
+			continue;
+		}
+		if (!event_fetch(lb->master, &ev))
+			break;
+		event_call(&ev);
+	}
+}
+
+static void load_register(struct load_bench *lb, struct load_prefix *lp,
+			  rfapi_register_action action, struct load_hist *h,
+			  bool churn)
+{
+	struct rfapi_ip_prefix pfx = {};
+	struct timeval start;
+	int rc;
+
+	pfx.length = lb->prefixlen;
+	pfx.prefix.addr_family = AF_INET;
+	pfx.prefix.addr.v4.s_addr = htonl(lp->addr);
+
+	monotime(&start);
+	rc = rfapi_register(lb->nve[lp->owner].rfd, &pfx, LOAD_LIFETIME, NULL,
+			    NULL, action);
+	load_hist_add(h, monotime_since(&start, NULL));
+
+	if (rc) {
+		lb->errors++;
+		return;
+	}
+	lp->registered = (action == RFAPI_REGISTER_ADD);
+	if (churn)
+		lp->changed = start;
+}
+
+static int load_setup(struct load_bench *lb, const char *config)
+{
+	struct rfapi_rfp_cb_methods cbm = {
+		.response_cb = load_response_cb,
+	};
+	FILE *fp;
+
+	cmd_init(1);
+	debug_init();
+	zlog_aux_init("NONE: ", LOG_WARNING);
+	zprivs_preinit(&bgpd_privs);
+	zprivs_init(&bgpd_privs);
+
+	lb->master = master = event_master_create("rfptest");
+	nb_init(master, NULL, 0, false, false);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_option_set(BGP_OPT_NO_FIB);
+	vrf_init(NULL, NULL, NULL, NULL);
+	frr_pthread_init();
+	bgp_init(0);
+
+	if (config)
+		fp = fopen(config, "r");
+	else
+		fp = fmemopen((void *)load_default_config,
+			      strlen(load_default_config), "r");
+	if (!fp) {
+		perror(config ? config : "fmemopen");
+		return -1;
+	}
+	vty_read_file(NULL, fp);
+	fclose(fp);
+
+	if (rfapi_is_vnc_configured(NULL)) {
+		fprintf(stderr,
+			"VNC is not configured on the default bgp instance\n");
+		return -1;
+	}
+	rfapi_rfp_set_cb_methods(NULL, &cbm);
+
+	return 0;
+}
+
+static void load_prefixes_init(struct load_bench *lb)
+{
+	uint32_t space = 1U << (lb->prefixlen - 8);
+	uint32_t mult = random() | 1;
+	uint32_t off = random();
+	uint32_t slot;
+	uint32_t i;
+
+	/*
+	 * "random" scatters the prefixes over 10/8 with an odd multiplier,
+	 * which is a permutation modulo the (power of two) slot count, so
+	 * no prefix is generated twice.
+	 */
+	for (i = 0; i < lb->nprefix; i++) {
+		slot = lb->random ? (i * mult + off) & (space - 1) : i;
+		lb->prefix[i].addr = LOAD_PREFIX_BASE +
+				     (slot << (IPV4_MAX_BITLEN - lb->prefixlen));
+		lb->prefix[i].owner = i / lb->prefixes;
+		lb->sorted[i] = &lb->prefix[i];
+	}
+	qsort(lb->sorted, lb->nprefix, sizeof(*lb->sorted), load_prefix_cmp);
+}
+
+static int load_run(struct load_bench *lb)
+{
+	struct rfapi_next_hop_entry *nhl;
+	struct load_prefix **picked;
+	struct load_prefix *lp;
+	struct load_mem m;
+	struct rfapi_ip_addr target;
+	struct timeval start;
+	uint32_t npicked;
+	uint32_t i, j;
+	int rc;
+
+	load_mem_report(lb, "start");
+
+	for (i = 0; i < lb->nves; i++) {
+		struct load_nve *nve = &lb->nve[i];
+
+		nve->lb = lb;
+		nve->addr.addr_family = AF_INET;
+		nve->addr.addr.v4.s_addr = htonl(LOAD_NVE_BASE + i + 1);
+
+		monotime(&start);
+		rc = rfapi_open(NULL, &nve->addr, &nve->addr, NULL, NULL, nve,
+				&nve->rfd);
+		load_hist_add(&lb->h_open, monotime_since(&start, NULL));
+		if (rc) {
+			fprintf(stderr, "rfapi_open of NVE %u failed: %s\n", i,
+				rfapi_error_str(rc));
+			return -1;
+		}
+	}
+	load_mem_report(lb, "open");
+
+	for (i = 0; i < lb->nprefix; i++)
+		load_register(lb, &lb->prefix[i], RFAPI_REGISTER_ADD,
+			      &lb->h_register, false);
+	load_drain(lb);
+	load_mem_report(lb, "register");
+
+	memset(&target, 0, sizeof(target));
+	target.addr_family = AF_INET;
+	for (i = 0; i < lb->nves; i++) {
+		for (j = 0; j < lb->queries; j++) {
+			lp = &lb->prefix[random() % lb->nprefix];
+			target.addr.v4.s_addr = htonl(lp->addr);
+
+			monotime(&start);
+			rc = rfapi_query(lb->nve[i].rfd, &target, NULL, &nhl);
+			load_hist_add(&lb->h_query,
+				      monotime_since(&start, NULL));
+			if (rc && rc != ENOENT)
+				lb->errors++;
+			rfapi_free_next_hop_list(nhl);
+		}
+	}
+	load_drain(lb);
+	load_mem_report(lb, "query");
+
+	/*
+	 * Each churn round kills a random subset of the prefixes and adds
+	 * them back, letting the updated responses drain after each step
+	 */
+	picked = calloc(lb->churn, sizeof(*picked));
+	for (i = 0; i < lb->rounds; i++) {
+		npicked = 0;
+		for (j = 0; j < lb->churn; j++) {
+			lp = &lb->prefix[random() % lb->nprefix];
+			if (!lp->registered)
+				continue;
+			load_register(lb, lp, RFAPI_REGISTER_KILL,
+				      &lb->h_withdraw, true);
+			picked[npicked++] = lp;
+		}
+		load_drain(lb);
+
+		for (j = 0; j < npicked; j++)
+			load_register(lb, picked[j], RFAPI_REGISTER_ADD,
+				      &lb->h_register, true);
+		load_drain(lb);
+
+		load_mem_sample(lb, &m);
+	}
+	free(picked);
+	load_mem_report(lb, "churned");
+
+	for (i = 0; i < lb->nves; i++) {
+		monotime(&start);
+		rc = rfapi_close(lb->nve[i].rfd);
+		load_hist_add(&lb->h_close, monotime_since(&start, NULL));
+		if (rc)
+			lb->errors++;
+	}
+	load_mem_report(lb, "close");
+
+	return 0;
+}
+
+static int load_bench(int argc, char **argv)
+{
+	struct load_bench lb = {};
+	const char *config = NULL;
+	unsigned long seed = 1;
+	int opt;
+	int rc;
+
+	lb.nves = LOAD_NVES_DEFAULT;
+	lb.prefixes = LOAD_PREFIXES_DEFAULT;
+	lb.prefixlen = IPV4_MAX_BITLEN;
+	lb.queries = LOAD_QUERIES_DEFAULT;
+	lb.churn = LOAD_CHURN_DEFAULT;
+	lb.rounds = LOAD_ROUNDS_DEFAULT;
+
+	while ((opt = getopt(argc, argv, "f:n:p:l:q:c:r:d:s:v")) != -1) {
+		switch (opt) {
+		case 'f':
+			config = optarg;
+			break;
+		case 'n':
+			lb.nves = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			lb.prefixes = strtoul(optarg, NULL, 10);
+			break;
+		case 'l':
+			lb.prefixlen = strtoul(optarg, NULL, 10);
+			break;
+		case 'q':
+			lb.queries = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			lb.churn = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+			lb.rounds = strtoul(optarg, NULL, 10);
+			break;
+		case 'd':
+			if (!strcmp(optarg, "random"))
+				lb.random = true;
+			else if (strcmp(optarg, "seq"))
+				return -1;
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		case 'v':
+			lb.verbose = true;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if (!lb.nves || lb.nves > LOAD_NVE_MAX || !lb.prefixes ||
+	    lb.prefixlen <= 8 || lb.prefixlen > IPV4_MAX_BITLEN ||
+	    (uint64_t)lb.nves * lb.prefixes > 1ULL << (lb.prefixlen - 8)) {
+		fprintf(stderr,
+			"%u NVEs with %u /%u prefixes each do not fit in 10.0.0.0/8\n",
+			lb.nves, lb.prefixes, lb.prefixlen);
+		return 1;
+	}
+
+	srandom(seed);
+	lb.nprefix = lb.nves * lb.prefixes;
+	lb.nve = calloc(lb.nves, sizeof(*lb.nve));
+	lb.prefix = calloc(lb.nprefix, sizeof(*lb.prefix));
+	lb.sorted = calloc(lb.nprefix, sizeof(*lb.sorted));
+	load_prefixes_init(&lb);
+
+	lb.h_open.name = "open";
+	lb.h_register.name = "register";
+	lb.h_query.name = "query";
+	lb.h_withdraw.name = "withdraw";
+	lb.h_callback.name = "callback";
+	lb.h_close.name = "close";
+
+	printf("%u NVEs, %u %s /%u prefixes each, %u queries each, %u rounds of %u churn, seed %lu\n",
+	       lb.nves, lb.prefixes, lb.random ? "random" : "sequential",
+	       lb.prefixlen, lb.queries, lb.rounds, lb.churn, seed);
+
+	rc = load_setup(&lb, config);
+	if (!rc)
+		rc = load_run(&lb);
+
+	if (!rc) {
+		load_hist_print(&lb.h_open, lb.verbose);
+		load_hist_print(&lb.h_register, lb.verbose);
+		load_hist_print(&lb.h_query, lb.verbose);
+		load_hist_print(&lb.h_withdraw, lb.verbose);
+		load_hist_print(&lb.h_callback, lb.verbose);
+		load_hist_print(&lb.h_close, lb.verbose);
+		printf("callbacks %" PRIu64 ", next hops %" PRIu64
+		       " (%" PRIu64 " not from churn), errors %" PRIu64 "\n",
+		       lb.callbacks, lb.nh_entries, lb.nh_unmatched, lb.errors);
+		printf("peak mem %zu KiB\n", lb.mem_peak / 1024);
+	}
+
+	free(lb.nve);
+	free(lb.prefix);
+	free(lb.sorted);
+
+	return rc ? 1 : 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: rfptest flow [ROUTES [BATCH-SIZE [RATE]]]\n"
+		"       rfptest load [-f CONFIG] [-n NVES] [-p PREFIXES-PER-NVE]\n"
+		"                    [-l PREFIX-LENGTH] [-q QUERIES-PER-NVE]\n"
+		"                    [-c CHURN-PER-ROUND] [-r ROUNDS]\n"
+		"                    [-d seq|random] [-s SEED] [-v]\n");
 	exit(1);
 }
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		usage();
+
+	if (!strcmp(argv[1], "flow"))
+		return flow_bench(argc - 2, argv + 2);
+	if (!strcmp(argv[1], "load")) {
+		int rc = load_bench(argc - 1, argv + 1);
+
+		if (rc < 0)
+			usage();
+		return rc;
+	}
+
+	usage();
+	return 1;
+}
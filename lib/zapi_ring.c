@@ -0,0 +1,402 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Shared-memory ring for ZAPI messages.
+ */
+#include <zebra.h>
+
+#include "frratomic.h"
+#include "memory.h"
+#include "network.h"
+#include "zapi_ring.h"
+
+#if defined(HAVE_MEMFD_CREATE) && defined(HAVE_EVENTFD)
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+DEFINE_MTYPE_STATIC(LIB, ZAPI_RING, "ZAPI shared-memory ring");
+
+#define ZAPI_RING_MAGIC 0x5a524e47 /* "ZRNG" */
+#define ZAPI_RING_VERSION 1
+
+/*
+ * Layout of the mapping.  Positions only ever grow; each sits on its own
+ * cache line so the two processes don't fight over the line the other
+ * one keeps writing.
+ */
+struct zapi_ring_shared {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+
+	_Alignas(64) _Atomic uint64_t head;
+	/* consumer is asleep, producer rings the doorbell */
+	_Atomic uint32_t consumer_wait;
+
+	_Alignas(64) _Atomic uint64_t tail;
+	/* producer is waiting for space, consumer rings the space doorbell */
+	_Atomic uint32_t producer_wait;
+
+	_Alignas(64) uint8_t data[];
+};
+
+#if defined(HAVE_MEMFD_CREATE) && defined(HAVE_EVENTFD)
+
+static void zapi_ring_doorbell_ring(int fd)
+{
+	uint64_t one = 1;
+
+	/* only fails if the counter is about to overflow: already rung */
+	if (write(fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+void zapi_ring_doorbell_clear(int fd)
+{
+	uint64_t count;
+
+	if (read(fd, &count, sizeof(count)) < 0)
+		return;
+}
+
+static struct zapi_ring *zapi_ring_map(int memfd, int doorbell, int spacebell,
+				       size_t maplen)
+{
+	struct zapi_ring *ring;
+	void *mem;
+
+	mem = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+	if (mem == MAP_FAILED)
+		return NULL;
+
+	ring = XCALLOC(MTYPE_ZAPI_RING, sizeof(*ring));
+	ring->shared = mem;
+	ring->maplen = maplen;
+	ring->memfd = memfd;
+	ring->doorbell = doorbell;
+	ring->spacebell = spacebell;
+
+	return ring;
+}
+
+struct zapi_ring *zapi_ring_new(size_t size)
+{
+	struct zapi_ring *ring;
+	size_t maplen, ringsize = ZAPI_RING_MIN_SIZE;
+	int memfd, doorbell = -1, spacebell = -1;
+
+	while (ringsize < size && ringsize < ZAPI_RING_MAX_SIZE)
+		ringsize <<= 1;
+	maplen = sizeof(struct zapi_ring_shared) + ringsize;
+
+	memfd = memfd_create("frr-zapi-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (memfd < 0)
+		return NULL;
+
+	if (ftruncate(memfd, maplen) < 0)
+		goto fail;
+#ifdef F_SEAL_SHRINK
+	/* the consumer must not be able to get SIGBUS'd by a shrink */
+	if (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+		goto fail;
+#endif
+
+	doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	spacebell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (doorbell < 0 || spacebell < 0)
+		goto fail;
+
+	ring = zapi_ring_map(memfd, doorbell, spacebell, maplen);
+	if (!ring)
+		goto fail;
+
+	ring->size = ringsize;
+	ring->shared->magic = ZAPI_RING_MAGIC;
+	ring->shared->version = ZAPI_RING_VERSION;
+	ring->shared->size = ringsize;
+
+	return ring;
+
+fail:
+	if (spacebell >= 0)
+		close(spacebell);
+	if (doorbell >= 0)
+		close(doorbell);
+	close(memfd);
+	return NULL;
+}
+
+/*
+ * A mapping the client could still shrink would get us SIGBUS'd; only a
+ * memfd sealed against that, for good, is safe.  Anything else, e.g. a
+ * plain file, has F_GET_SEALS fail.
+ */
+static bool zapi_ring_is_sealed(int memfd)
+{
+#ifdef F_SEAL_SHRINK
+	int seals = fcntl(memfd, F_GET_SEALS);
+
+	return seals >= 0 && CHECK_FLAG(seals, F_SEAL_SHRINK) &&
+	       CHECK_FLAG(seals, F_SEAL_SEAL);
+#else
+	return false;
+#endif
+}
+
+/* The doorbells are used as 8 byte counters; nothing else will do */
+static bool zapi_ring_is_eventfd(int fd)
+{
+	struct stat st;
+#ifdef __linux__
+	char path[32], target[32];
+	ssize_t len;
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+	len = readlink(path, target, sizeof(target) - 1);
+	if (len >= 0) {
+		target[len] = '\0';
+		return !strcmp(target, "anon_inode:[eventfd]");
+	}
+#endif
+	if (fstat(fd, &st) < 0)
+		return false;
+
+	/* no /proc: at least it mustn't be a file, pipe, socket, ... */
+	return (st.st_mode & S_IFMT) == 0;
+}
+
+struct zapi_ring *zapi_ring_attach(int memfd, int doorbell, int spacebell)
+{
+	struct zapi_ring *ring;
+	struct stat st;
+	size_t ringsize;
+
+	if (fstat(memfd, &st) < 0 || !S_ISREG(st.st_mode) ||
+	    st.st_size <= (off_t)sizeof(struct zapi_ring_shared))
+		goto fail;
+
+	if (!zapi_ring_is_sealed(memfd) || !zapi_ring_is_eventfd(doorbell) ||
+	    !zapi_ring_is_eventfd(spacebell))
+		goto fail;
+
+	ringsize = st.st_size - sizeof(struct zapi_ring_shared);
+	if (ringsize < ZAPI_RING_MIN_SIZE || ringsize > ZAPI_RING_MAX_SIZE ||
+	    (ringsize & (ringsize - 1)))
+		goto fail;
+
+	ring = zapi_ring_map(memfd, doorbell, spacebell, st.st_size);
+	if (!ring)
+		goto fail;
+
+	if (ring->shared->magic != ZAPI_RING_MAGIC ||
+	    ring->shared->version != ZAPI_RING_VERSION ||
+	    ring->shared->size != ringsize) {
+		zapi_ring_del(&ring);
+		return NULL;
+	}
+
+	ring->size = ringsize;
+	ring->pos = atomic_load_explicit(&ring->shared->tail,
+					 memory_order_acquire);
+
+	/* the consumer's fds are polled from an event loop */
+	set_nonblocking(doorbell);
+	set_nonblocking(spacebell);
+
+	return ring;
+
+fail:
+	close(memfd);
+	close(doorbell);
+	close(spacebell);
+	return NULL;
+}
+
+void zapi_ring_del(struct zapi_ring **ringp)
+{
+	struct zapi_ring *ring = *ringp;
+
+	if (!ring)
+		return;
+
+	munmap(ring->shared, ring->maplen);
+	close(ring->memfd);
+	close(ring->doorbell);
+	close(ring->spacebell);
+
+	XFREE(MTYPE_ZAPI_RING, *ringp);
+}
+
+size_t zapi_ring_space(struct zapi_ring *ring)
+{
+	uint64_t tail = atomic_load_explicit(&ring->shared->tail,
+					     memory_order_acquire);
+
+	/* consumer claims to have read what was never written */
+	if (ring->pos - tail > ring->size)
+		return 0;
+
+	return ring->size - (ring->pos - tail);
+}
+
+size_t zapi_ring_put(struct zapi_ring *ring, const void *data, size_t size)
+{
+	struct zapi_ring_shared *shared = ring->shared;
+	const uint8_t *dp = data;
+	size_t off = ring->pos & (ring->size - 1);
+	size_t copysize = MIN(size, zapi_ring_space(ring));
+	size_t first = MIN(copysize, ring->size - off);
+
+	if (!copysize)
+		return 0;
+
+	memcpy(shared->data + off, dp, first);
+	memcpy(shared->data, dp + first, copysize - first);
+
+	ring->pos += copysize;
+	atomic_store_explicit(&shared->head, ring->pos, memory_order_release);
+
+	/* pairs with the fence in zapi_ring_wait_data() */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(&shared->consumer_wait, memory_order_relaxed) &&
+	    atomic_exchange_explicit(&shared->consumer_wait, 0,
+				     memory_order_relaxed))
+		zapi_ring_doorbell_ring(ring->doorbell);
+
+	return copysize;
+}
+
+bool zapi_ring_wait_space(struct zapi_ring *ring, size_t size)
+{
+	atomic_store_explicit(&ring->shared->producer_wait, 1,
+			      memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	return zapi_ring_space(ring) < size;
+}
+
+size_t zapi_ring_remain(struct zapi_ring *ring)
+{
+	uint64_t head = atomic_load_explicit(&ring->shared->head,
+					     memory_order_acquire);
+
+	if (head - ring->pos > ring->size)
+		return SIZE_MAX;
+
+	return head - ring->pos;
+}
+
+size_t zapi_ring_peek(struct zapi_ring *ring, size_t offset, void *data,
+		      size_t size)
+{
+	const uint8_t *src = ring->shared->data;
+	uint8_t *dp = data;
+	size_t remain = zapi_ring_remain(ring);
+	size_t off, copysize, first;
+
+	if (remain == SIZE_MAX || offset >= remain)
+		return 0;
+
+	copysize = MIN(size, remain - offset);
+	off = (ring->pos + offset) & (ring->size - 1);
+	first = MIN(copysize, ring->size - off);
+
+	memcpy(dp, src + off, first);
+	memcpy(dp + first, src, copysize - first);
+
+	return copysize;
+}
+
+size_t zapi_ring_get(struct zapi_ring *ring, void *data, size_t size)
+{
+	struct zapi_ring_shared *shared = ring->shared;
+	size_t copysize = zapi_ring_peek(ring, 0, data, size);
+
+	if (!copysize)
+		return 0;
+
+	ring->pos += copysize;
+	atomic_store_explicit(&shared->tail, ring->pos, memory_order_release);
+
+	/* pairs with the fence in zapi_ring_wait_space() */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(&shared->producer_wait, memory_order_relaxed) &&
+	    atomic_exchange_explicit(&shared->producer_wait, 0,
+				     memory_order_relaxed))
+		zapi_ring_doorbell_ring(ring->spacebell);
+
+	return copysize;
+}
+
+bool zapi_ring_wait_data(struct zapi_ring *ring, size_t size)
+{
+	atomic_store_explicit(&ring->shared->consumer_wait, 1,
+			      memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	return zapi_ring_remain(ring) < size;
+}
+
+#else /* !(HAVE_MEMFD_CREATE && HAVE_EVENTFD) */
+
+struct zapi_ring *zapi_ring_new(size_t size)
+{
+	return NULL;
+}
+
+struct zapi_ring *zapi_ring_attach(int memfd, int doorbell, int spacebell)
+{
+	close(memfd);
+	close(doorbell);
+	close(spacebell);
+	return NULL;
+}
+
+void zapi_ring_del(struct zapi_ring **ringp)
+{
+	XFREE(MTYPE_ZAPI_RING, *ringp);
+}
+
+size_t zapi_ring_space(struct zapi_ring *ring)
+{
+	return 0;
+}
+
+size_t zapi_ring_put(struct zapi_ring *ring, const void *data, size_t size)
+{
+	return 0;
+}
+
+bool zapi_ring_wait_space(struct zapi_ring *ring, size_t size)
+{
+	return true;
+}
+
+size_t zapi_ring_remain(struct zapi_ring *ring)
+{
+	return 0;
+}
+
+size_t zapi_ring_peek(struct zapi_ring *ring, size_t offset, void *data,
+		      size_t size)
+{
+	return 0;
+}
+
+size_t zapi_ring_get(struct zapi_ring *ring, void *data, size_t size)
+{
+	return 0;
+}
+
+bool zapi_ring_wait_data(struct zapi_ring *ring, size_t size)
+{
+	return true;
+}
+
+void zapi_ring_doorbell_clear(int fd)
+{
+}
+
+#endif /* HAVE_MEMFD_CREATE && HAVE_EVENTFD */
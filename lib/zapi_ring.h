@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Shared-memory ring for ZAPI messages.
+ *
+ * A single-producer, single-consumer byte ring living in a memfd that a
+ * zclient maps together with zebra, plus two eventfd doorbells: one rung
+ * by the producer when data is added while the consumer sleeps, one rung
+ * by the consumer when space is freed while the producer waits.  The
+ * ring carries ZAPI messages exactly as they would be written to the
+ * socket.
+ *
+ * Semantics follow lib/ringbuf.c; each side only ever trusts its own
+ * position and bounds whatever the other side published.
+ */
+#ifndef _FRR_ZAPI_RING_H_
+#define _FRR_ZAPI_RING_H_
+
+#include <zebra.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default and limits for the size of the data area, in bytes */
+#define ZAPI_RING_DEFAULT_SIZE (4 * 1024 * 1024)
+#define ZAPI_RING_MIN_SIZE     (64 * 1024)
+#define ZAPI_RING_MAX_SIZE     (256 * 1024 * 1024)
+
+struct zapi_ring_shared;
+
+struct zapi_ring {
+	struct zapi_ring_shared *shared;
+	size_t maplen;
+
+	/* size of the data area, a power of two */
+	size_t size;
+
+	/* bytes this side has written (producer) or read (consumer) */
+	uint64_t pos;
+
+	int memfd;
+	/* producer -> consumer: data added */
+	int doorbell;
+	/* consumer -> producer: space freed */
+	int spacebell;
+};
+
+/*
+ * Creates a new ring, for the producer side.
+ *
+ * @param size	data area size, rounded up to a power of two
+ * @return the newly created ring, NULL if shared memory or eventfds are
+ * not available
+ */
+struct zapi_ring *zapi_ring_new(size_t size);
+
+/*
+ * Maps a ring created by another process, for the consumer side.  Takes
+ * ownership of the file descriptors, also on failure.
+ *
+ * @return the ring, NULL if the memory is not a valid ring
+ */
+struct zapi_ring *zapi_ring_attach(int memfd, int doorbell, int spacebell);
+
+/*
+ * Unmaps a ring, closes its file descriptors and frees it.
+ */
+void zapi_ring_del(struct zapi_ring **ring);
+
+/*
+ * Producer: amount of space left to write, in bytes.
+ */
+size_t zapi_ring_space(struct zapi_ring *ring);
+
+/*
+ * Producer: put data into the ring, ringing the doorbell if the consumer
+ * is waiting.
+ *
+ * @return number of bytes written; less than size if there was not enough
+ * space
+ */
+size_t zapi_ring_put(struct zapi_ring *ring, const void *data, size_t size);
+
+/*
+ * Producer: arm the space doorbell.
+ *
+ * @return true if fewer than size bytes are free, and the caller should
+ * wait for the space doorbell; false if the space is already there
+ */
+bool zapi_ring_wait_space(struct zapi_ring *ring, size_t size);
+
+/*
+ * Consumer: amount of data left to read, in bytes.
+ *
+ * @return number of readable bytes; SIZE_MAX if the producer published a
+ * position that can't be right
+ */
+size_t zapi_ring_remain(struct zapi_ring *ring);
+
+/*
+ * Consumer: peek data without consuming it.
+ *
+ * @return number of bytes copied; less than size if there was not enough
+ * data to read
+ */
+size_t zapi_ring_peek(struct zapi_ring *ring, size_t offset, void *data,
+		      size_t size);
+
+/*
+ * Consumer: get data from the ring, ringing the space doorbell if the
+ * producer is waiting.
+ *
+ * @return number of bytes read into data; less than size if there was
+ * not enough data to read
+ */
+size_t zapi_ring_get(struct zapi_ring *ring, void *data, size_t size);
+
+/*
+ * Consumer: arm the data doorbell.
+ *
+ * @return true if fewer than size bytes are readable, and the caller
+ * should wait for the doorbell; false if the data is already there
+ */
+bool zapi_ring_wait_data(struct zapi_ring *ring, size_t size);
+
+/*
+ * Clear a doorbell after it polled readable.
+ */
+void zapi_ring_doorbell_clear(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_ZAPI_RING_H_ */
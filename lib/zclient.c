@@ -28,6 +28,7 @@
 #include "srte.h"
 #include "printfrr.h"
 #include "srv6.h"
+#include "zapi_ring.h"
 
 DEFINE_MTYPE_STATIC(LIB, ZCLIENT, "Zclient");
 DEFINE_MTYPE_STATIC(LIB, REDIST_INST, "Redistribution instance IDs");
@@ -101,6 +102,9 @@ void zclient_free(struct zclient *zclient)
 		stream_free(zclient->obuf);
 	if (zclient->wb)
 		buffer_free(zclient->wb);
+	if (zclient->ring_pending)
+		stream_fifo_free(zclient->ring_pending);
+	zapi_ring_del(&zclient->ring);
 
 	XFREE(MTYPE_ZCLIENT, zclient);
 }
@@ -260,6 +264,7 @@ void zclient_stop(struct zclient *zclient)
 	event_cancel(&zclient->t_read);
 	event_cancel(&zclient->t_connect);
 	event_cancel(&zclient->t_write);
+	event_cancel(&zclient->t_ring);
 
 	/* Reset streams. */
 	stream_reset(zclient->ibuf);
@@ -268,6 +273,16 @@ void zclient_stop(struct zclient *zclient)
 	/* Empty the write buffer. */
 	buffer_reset(zclient->wb);
 
+	/* Drop the ring; a new one is offered on reconnect */
+	if (zclient->ring_pending)
+		stream_fifo_free(zclient->ring_pending);
+	zclient->ring_pending = NULL;
+	zclient->ring_started = false;
+	zapi_ring_del(&zclient->ring);
+
+	/* Whoever we reconnect to tells us again */
+	zclient->route_add_bulk = false;
+
 	/* Close socket. */
 	if (zclient->sock >= 0) {
 		close(zclient->sock);
@@ -374,6 +389,69 @@ static void zclient_flush_data(struct event *event)
 	}
 }
 
+static void zclient_ring_flush(struct event *event);
+
+/* Flush pending messages once zebra has made room on the ring */
+static void zclient_ring_wait(struct zclient *zclient)
+{
+	if (zapi_ring_wait_space(zclient->ring, 1))
+		event_add_read(zclient->master, zclient_ring_flush, zclient,
+			       zclient->ring->spacebell, &zclient->t_ring);
+	else
+		event_add_event(zclient->master, zclient_ring_flush, zclient, 0,
+				&zclient->t_ring);
+}
+
+static void zclient_ring_flush(struct event *event)
+{
+	struct zclient *zclient = EVENT_ARG(event);
+	struct stream *s;
+
+	zapi_ring_doorbell_clear(zclient->ring->spacebell);
+
+	while ((s = stream_fifo_head(zclient->ring_pending))) {
+		stream_forward_getp(s, zapi_ring_put(zclient->ring,
+						     stream_pnt(s),
+						     STREAM_READABLE(s)));
+		if (STREAM_READABLE(s)) {
+			zclient_ring_wait(zclient);
+			return;
+		}
+
+		stream_free(stream_fifo_pop(zclient->ring_pending));
+	}
+
+	/* Currently only Sharpd and Bgpd has callbacks defined */
+	if (zclient->zebra_buffer_write_ready)
+		(*zclient->zebra_buffer_write_ready)();
+}
+
+/*
+ * Put the message in obuf on the ring.  Messages may be split anywhere,
+ * zebra puts them back together from their headers just like it does
+ * for the socket.
+ */
+static enum zclient_send_status zclient_ring_send(struct zclient *zclient)
+{
+	struct stream *s = zclient->obuf;
+	size_t len = stream_get_endp(s), done = 0;
+
+	if (!stream_fifo_head(zclient->ring_pending)) {
+		done = zapi_ring_put(zclient->ring, STREAM_DATA(s), len);
+		if (done == len)
+			return ZCLIENT_SEND_SUCCESS;
+	}
+
+	s = stream_dup(s);
+	stream_set_getp(s, done);
+	stream_fifo_push(zclient->ring_pending, s);
+
+	if (!zclient->t_ring)
+		zclient_ring_wait(zclient);
+
+	return ZCLIENT_SEND_BUFFERED;
+}
+
 /*
  * Returns:
  * ZCLIENT_SEND_FAILED   - is a failure
@@ -384,6 +462,8 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (zclient->ring_started)
+		return zclient_ring_send(zclient);
 	switch (buffer_write(zclient->wb, zclient->sock,
 			     STREAM_DATA(zclient->obuf),
 			     stream_get_endp(zclient->obuf))) {
@@ -823,6 +903,113 @@ zclient_send_interface_protodown(struct zclient *zclient, vrf_id_t vrf_id,
 	return zclient_send_message(zclient);
 }
 
+/*
+ * Offer zebra a shared-memory ring for our messages.  The ring and its
+ * doorbells travel with the OFFER as SCM_RIGHTS, so this only works over
+ * a UNIX socket; it is sent before anything else, while the socket
+ * buffer is empty.
+ */
+static void zclient_ring_offer(struct zclient *zclient)
+{
+	struct zapi_ring *ring;
+	struct stream *s = zclient->obuf;
+	int fds[3];
+	union {
+		char buf[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr align;
+	} cmsgbuf = {};
+	struct iovec iov;
+	struct msghdr msg = {};
+	struct cmsghdr *cmsg;
+
+	if (zclient_addr.ss_family != AF_UNIX || zclient->auxiliary)
+		return;
+
+	ring = zapi_ring_new(zclient->ring_size);
+	if (!ring) {
+		if (zclient_debug)
+			zlog_debug("%s: shared memory ring not available",
+				   __func__);
+		return;
+	}
+
+	stream_reset(s);
+	zclient_create_header(s, ZEBRA_ZAPI_RING, VRF_DEFAULT);
+	stream_putc(s, ZAPI_RING_OFFER);
+	stream_putl(s, ring->size);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	fds[0] = ring->memfd;
+	fds[1] = ring->doorbell;
+	fds[2] = ring->spacebell;
+
+	iov.iov_base = STREAM_DATA(s);
+	iov.iov_len = stream_get_endp(s);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	if (sendmsg(zclient->sock, &msg, 0) != (ssize_t)iov.iov_len) {
+		flog_err(EC_LIB_ZAPI_SOCKET,
+			 "%s: could not offer a shared memory ring on zclient fd %d: %s",
+			 __func__, zclient->sock, safe_strerror(errno));
+		zapi_ring_del(&ring);
+		return;
+	}
+
+	zclient->ring = ring;
+}
+
+static int zclient_zapi_ring(ZAPI_CALLBACK_ARGS)
+{
+	struct stream *s;
+	uint8_t op;
+
+	STREAM_GETC(zclient->ibuf, op);
+
+	if (!zclient->ring || zclient->ring_started)
+		return 0;
+
+	if (op != ZAPI_RING_ACCEPT) {
+		if (zclient_debug)
+			zlog_debug("%s: zebra declined the shared memory ring",
+				   __func__);
+		zapi_ring_del(&zclient->ring);
+		return 0;
+	}
+
+	/*
+	 * Zebra starts reading the ring once it gets to START, so whatever
+	 * is still queued for the socket goes first.
+	 */
+	s = zclient->obuf;
+	stream_reset(s);
+	zclient_create_header(s, ZEBRA_ZAPI_RING, VRF_DEFAULT);
+	stream_putc(s, ZAPI_RING_START);
+	stream_putw_at(s, 0, stream_get_endp(s));
+	if (zclient_send_message(zclient) == ZCLIENT_SEND_FAILURE)
+		return -1;
+
+	zclient->ring_pending = stream_fifo_new();
+	zclient->ring_started = true;
+
+	if (zclient_debug)
+		zlog_debug("zclient %p sending to zebra over a %zu byte ring",
+			   zclient, zclient->ring->size);
+
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
 /* Make connection to zebra daemon. */
 int zclient_start(struct zclient *zclient)
 {
@@ -855,6 +1042,9 @@ int zclient_start(struct zclient *zclient)
 		zlog_debug("zclient connect success with socket [%d]",
 			   zclient->sock);
 
+	if (zclient->ring_size)
+		zclient_ring_offer(zclient);
+
 	/* Create read thread. */
 	zclient_event(ZCLIENT_READ, zclient);
 
@@ -979,6 +1169,37 @@ zclient_route_send(uint8_t cmd, struct zclient *zclient, struct zapi_route *api)
 	return zclient_send_message(zclient);
 }
 
+enum zclient_send_status
+zclient_route_bulk_send(struct zclient *zclient, struct zapi_route_bulk *bulk)
+{
+	enum zclient_send_status ret = ZCLIENT_SEND_SUCCESS, status;
+	uint16_t sent = 0;
+	int n;
+
+	while (sent < bulk->count) {
+		n = zapi_route_bulk_encode(zclient->obuf, &bulk->api,
+					   bulk->prefixes + sent,
+					   bulk->count - sent);
+		if (n < 0) {
+			ret = ZCLIENT_SEND_FAILURE;
+			break;
+		}
+
+		status = zclient_send_message(zclient);
+		if (status == ZCLIENT_SEND_FAILURE) {
+			ret = ZCLIENT_SEND_FAILURE;
+			break;
+		}
+		if (status == ZCLIENT_SEND_BUFFERED)
+			ret = ZCLIENT_SEND_BUFFERED;
+
+		sent += n;
+	}
+
+	bulk->count = 0;
+	return ret;
+}
+
 static int zapi_nexthop_labels_cmp(const struct zapi_nexthop *next1,
 				   const struct zapi_nexthop *next2)
 {
@@ -1561,6 +1782,146 @@ int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
 	return 0;
 }
 
+static bool zapi_route_bulk_nexthops_match(const struct zapi_nexthop *nh1,
+					   const struct zapi_nexthop *nh2,
+					   uint16_t nexthop_num)
+{
+	int i;
+
+	for (i = 0; i < nexthop_num; i++) {
+		/* zapi_nexthop_cmp() leaves out what doesn't sort */
+		if (zapi_nexthop_cmp(&nh1[i], &nh2[i]) ||
+		    nh1[i].flags != nh2[i].flags ||
+		    memcmp(&nh1[i].rmac, &nh2[i].rmac, sizeof(nh1[i].rmac)))
+			return false;
+	}
+
+	return true;
+}
+
+/* Do two routes differ in nothing that is encoded but their prefix? */
+static bool zapi_route_bulk_match(const struct zapi_route *api1,
+				  const struct zapi_route *api2)
+{
+	if (api1->vrf_id != api2->vrf_id || api1->type != api2->type ||
+	    api1->instance != api2->instance || api1->flags != api2->flags ||
+	    api1->message != api2->message || api1->safi != api2->safi ||
+	    api1->prefix.family != api2->prefix.family)
+		return false;
+
+	if (CHECK_FLAG(api1->message, ZAPI_MESSAGE_SRCPFX) &&
+	    !prefix_same((const struct prefix *)&api1->src_prefix,
+			 (const struct prefix *)&api2->src_prefix))
+		return false;
+
+	if (api1->nhgid != api2->nhgid || api1->distance != api2->distance ||
+	    api1->metric != api2->metric || api1->tag != api2->tag ||
+	    api1->mtu != api2->mtu || api1->tableid != api2->tableid)
+		return false;
+
+	if (api1->nexthop_num != api2->nexthop_num ||
+	    api1->backup_nexthop_num != api2->backup_nexthop_num)
+		return false;
+
+	if (CHECK_FLAG(api1->message, ZAPI_MESSAGE_NEXTHOP) &&
+	    !zapi_route_bulk_nexthops_match(api1->nexthops, api2->nexthops,
+					    api1->nexthop_num))
+		return false;
+
+	if (CHECK_FLAG(api1->message, ZAPI_MESSAGE_BACKUP_NEXTHOPS) &&
+	    !zapi_route_bulk_nexthops_match(api1->backup_nexthops,
+					    api2->backup_nexthops,
+					    api1->backup_nexthop_num))
+		return false;
+
+	if (CHECK_FLAG(api1->message, ZAPI_MESSAGE_OPAQUE) &&
+	    (api1->opaque.length != api2->opaque.length ||
+	     memcmp(api1->opaque.data, api2->opaque.data,
+		    MIN(api1->opaque.length, ZAPI_MESSAGE_OPAQUE_LENGTH))))
+		return false;
+
+	return true;
+}
+
+bool zapi_route_bulk_add(struct zapi_route_bulk *bulk, struct zapi_route *api)
+{
+	struct zapi_route *first = &bulk->api;
+
+	if (bulk->count == ZAPI_ROUTE_BULK_MAX)
+		return false;
+
+	/* same order as zapi_route_encode() puts them in, to compare */
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP) &&
+	    api->nexthop_num <= MULTIPATH_NUM)
+		zapi_nexthop_group_sort(api->nexthops, api->nexthop_num);
+
+	if (bulk->count) {
+		if (!zapi_route_bulk_match(first, api))
+			return false;
+
+		bulk->prefixes[bulk->count++] = api->prefix;
+		return true;
+	}
+
+	/*
+	 * Like zapi_route_init(), don't copy the whole struct: only what is
+	 * in use of the large arrays at its end.
+	 */
+	memcpy(first, api, offsetof(struct zapi_route, nexthop_num));
+	first->nexthop_num = api->nexthop_num;
+	memcpy(first->nexthops, api->nexthops,
+	       MIN(api->nexthop_num, MULTIPATH_NUM) * sizeof(api->nexthops[0]));
+	first->backup_nexthop_num = api->backup_nexthop_num;
+	memcpy(first->backup_nexthops, api->backup_nexthops,
+	       MIN(api->backup_nexthop_num, MULTIPATH_NUM) *
+		       sizeof(api->backup_nexthops[0]));
+	first->opaque.length = api->opaque.length;
+	memcpy(first->opaque.data, api->opaque.data,
+	       MIN(api->opaque.length, ZAPI_MESSAGE_OPAQUE_LENGTH));
+
+	bulk->prefixes[bulk->count++] = api->prefix;
+	return true;
+}
+
+int zapi_route_bulk_encode(struct stream *s, struct zapi_route *api,
+			   const struct prefix *prefixes, uint16_t count)
+{
+	size_t countp;
+	uint16_t i;
+	int psize;
+
+	if (!count)
+		return -1;
+
+	api->prefix = prefixes[0];
+	if (zapi_route_encode(ZEBRA_ROUTE_ADD_BULK, s, api) < 0)
+		return -1;
+
+	countp = stream_get_endp(s);
+	stream_putw(s, 0);
+
+	for (i = 1; i < count; i++) {
+		if (prefixes[i].family != api->prefix.family) {
+			flog_err(EC_LIB_ZAPI_ENCODE,
+				 "%s: prefix %pFX: family differs from %pFX",
+				 __func__, &prefixes[i], &api->prefix);
+			return -1;
+		}
+
+		psize = PSIZE(prefixes[i].prefixlen);
+		if (STREAM_WRITEABLE(s) < (size_t)psize + 1)
+			break;
+
+		stream_putc(s, prefixes[i].prefixlen);
+		stream_write(s, &prefixes[i].u.prefix, psize);
+	}
+
+	stream_putw_at(s, countp, i - 1);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	return i;
+}
+
 /*
  * Decode a single zapi nexthop object
  */
@@ -1818,6 +2179,37 @@ stream_failure:
 	return -1;
 }
 
+int zapi_route_bulk_decode(struct stream *s, struct zapi_route *api,
+			   uint16_t *count)
+{
+	if (zapi_route_decode(s, api) < 0)
+		return -1;
+
+	STREAM_GETW(s, *count);
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
+int zapi_route_bulk_decode_prefix(struct stream *s, struct prefix *p)
+{
+	STREAM_GETC(s, p->prefixlen);
+	if (p->prefixlen > prefix_blen(p) * 8) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: prefixlen %u is too large for family %d",
+			 __func__, p->prefixlen, p->family);
+		return -1;
+	}
+
+	memset(&p->u, 0, sizeof(p->u));
+	STREAM_GET(&p->u.prefix, s, PSIZE(p->prefixlen));
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
 static void zapi_encode_prefix(struct stream *s, struct prefix *p,
 			       uint8_t family)
 {
@@ -4459,6 +4851,12 @@ static int zclient_capability_decode(ZAPI_CALLBACK_ARGS)
 	STREAM_GETL(s, cap.ecmp);
 	STREAM_GETC(s, cap.role);
 	STREAM_GETC(s, cap.v6_with_v4_nexthop);
+	/* graceful restart, which only zebra itself cares about */
+	if (STREAM_READABLE(s))
+		stream_forward_getp(s, 1);
+	if (STREAM_READABLE(s))
+		STREAM_GETC(s, cap.route_add_bulk);
+	zclient->route_add_bulk = cap.route_add_bulk;
 
 	if (zclient->zebra_capabilities)
 		(*zclient->zebra_capabilities)(&cap);
@@ -4758,6 +5156,7 @@ static zclient_handler *const lib_handlers[] = {
 	/* fundamentals */
 	[ZEBRA_CAPABILITIES] = zclient_capability_decode,
 	[ZEBRA_ERROR] = zclient_handle_error,
+	[ZEBRA_ZAPI_RING] = zclient_zapi_ring,
 
 	/* VRF & interface code is shared in lib */
 	[ZEBRA_VRF_ADD] = zclient_vrf_add,
@@ -238,6 +238,8 @@ typedef enum {
 	ZEBRA_TC_FILTER_DELETE,
 	ZEBRA_OPAQUE_NOTIFY,
 	ZEBRA_SRV6_SID_NOTIFY,
+	ZEBRA_ZAPI_RING,
+	ZEBRA_ROUTE_ADD_BULK,
 } zebra_message_types_t;
 /* Zebra message types. Please update the corresponding
  * command_types array with any changes!
@@ -288,6 +290,7 @@ struct zclient_capabilities {
 	bool mpls_enabled;
 	enum mlag_role role;
 	bool v6_with_v4_nexthop;
+	bool route_add_bulk;
 };
 
 /* Graceful Restart Capabilities message */
@@ -310,6 +313,25 @@ typedef int (zclient_handler)(ZAPI_CALLBACK_ARGS);
 struct zapi_route;
 
 /* Structure for the zebra client. */
+/*
+ * ZEBRA_ZAPI_RING operations, for moving a client's messages to zebra
+ * from the socket to a shared-memory ring (lib/zapi_ring.h):
+ *
+ * OFFER:  client -> zebra, with the ring and its doorbells attached
+ * ACCEPT: zebra -> client, the ring is mapped
+ * REJECT: zebra -> client, keep using the socket
+ * START:  client -> zebra, last message on the socket; everything after
+ *         it is on the ring
+ */
+enum zapi_ring_op {
+	ZAPI_RING_OFFER = 1,
+	ZAPI_RING_ACCEPT,
+	ZAPI_RING_REJECT,
+	ZAPI_RING_START,
+};
+
+struct zapi_ring;
+
 struct zclient {
 	/* The thread master we schedule ourselves on */
 	struct event_loop *master;
@@ -353,6 +375,20 @@ struct zclient {
 	/* Thread to write buffered data to zebra. */
 	struct event *t_write;
 
+	/*
+	 * Shared-memory ring for messages to zebra, offered on connect if
+	 * ring_size is set.  Messages go over the socket until zebra has
+	 * accepted it; those that don't fit wait on ring_pending.
+	 */
+	size_t ring_size;
+	struct zapi_ring *ring;
+	bool ring_started;
+	struct stream_fifo *ring_pending;
+	struct event *t_ring;
+
+	/* Zebra takes ZEBRA_ROUTE_ADD_BULK, from its capabilities */
+	bool route_add_bulk;
+
 	/* Redistribute information. */
 	uint8_t redist_default; /* clients protocol */
 	unsigned short instance;
@@ -643,6 +679,22 @@ struct zapi_route {
 
 extern char *zclient_dump_route_flags(uint32_t flags, char *buf, size_t len);
 
+/*
+ * Routes for ZEBRA_ROUTE_ADD_BULK.  The message is a ZEBRA_ROUTE_ADD for
+ * the first prefix, followed by a count and further prefixes (length and
+ * address only) of the same family, which share the nexthops and every
+ * other attribute of the first one.
+ */
+#define ZAPI_ROUTE_BULK_MAX 256
+
+struct zapi_route_bulk {
+	/* all but the prefix is shared by the routes */
+	struct zapi_route api;
+
+	uint16_t count;
+	struct prefix prefixes[ZAPI_ROUTE_BULK_MAX];
+};
+
 struct zapi_labels {
 	uint8_t message;
 #define ZAPI_LABELS_FTN           0x01
@@ -1185,6 +1237,38 @@ void zapi_nexthop_init(struct zapi_nexthop *znh);
 
 extern int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api);
 extern int zapi_route_decode(struct stream *s, struct zapi_route *api);
+
+/*
+ * Add a route to a bulk.
+ *
+ * @return false if the bulk is full, or the route differs from the others
+ * in more than its prefix; the caller should send the bulk and try again
+ */
+extern bool zapi_route_bulk_add(struct zapi_route_bulk *bulk,
+				struct zapi_route *api);
+
+/*
+ * Encode as many of the prefixes as fit into one message.
+ *
+ * @return number of prefixes encoded, -1 on error
+ */
+extern int zapi_route_bulk_encode(struct stream *s, struct zapi_route *api,
+				  const struct prefix *prefixes,
+				  uint16_t count);
+
+/*
+ * Decode a ZEBRA_ROUTE_ADD_BULK up to its first prefix, and the number of
+ * prefixes that follow it; read those with zapi_route_bulk_decode_prefix().
+ */
+extern int zapi_route_bulk_decode(struct stream *s, struct zapi_route *api,
+				  uint16_t *count);
+extern int zapi_route_bulk_decode_prefix(struct stream *s, struct prefix *p);
+
+/*
+ * Send the routes of a bulk in as few messages as possible, and empty it.
+ */
+extern enum zclient_send_status
+zclient_route_bulk_send(struct zclient *zclient, struct zapi_route_bulk *bulk);
 extern int zapi_nexthop_decode(struct stream *s, struct zapi_nexthop *api_nh,
 			       uint32_t api_flags, uint32_t api_message);
 bool zapi_nhg_notify_decode(struct stream *s, uint32_t *id,
@@ -78,6 +78,14 @@ static struct static_nht_hash_head static_nht_hash[1];
 struct zclient *static_zclient;
 uint32_t zebra_ecmp_count = MULTIPATH_NUM;
 
+/*
+ * Routes to install in bulk, if zebra takes them that way: a nexthop
+ * coming up brings up all routes through it at once.  Sent once the event
+ * loop gets to it, or before a route message that must not overtake them.
+ */
+static struct zapi_route_bulk static_route_bulk;
+static struct event *t_static_route_bulk;
+
 /* Interface addition message from zebra. */
 static int static_ifp_create(struct interface *ifp)
 {
@@ -408,6 +416,18 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 		nhtd->registered = true;
 }
 
+static void static_zebra_route_bulk_send(struct event *event)
+{
+	if (static_route_bulk.count)
+		zclient_route_bulk_send(static_zclient, &static_route_bulk);
+}
+
+static void static_zebra_route_bulk_flush(void)
+{
+	event_cancel(&t_static_route_bulk);
+	static_zebra_route_bulk_send(NULL);
+}
+
 extern void static_zebra_route_add(struct static_path *pn, bool install)
 {
 	struct route_node *rn = pn->rn;
@@ -556,6 +576,18 @@ extern void static_zebra_route_add(struct static_path *pn, bool install)
 	if (!nh_num && install)
 		install = false;
 
+	if (install && static_zclient->route_add_bulk) {
+		if (!zapi_route_bulk_add(&static_route_bulk, &api)) {
+			zclient_route_bulk_send(static_zclient,
+						&static_route_bulk);
+			zapi_route_bulk_add(&static_route_bulk, &api);
+		}
+		event_add_event(master, static_zebra_route_bulk_send, NULL, 0,
+				&t_static_route_bulk);
+		return;
+	}
+
+	static_zebra_route_bulk_flush();
 	zclient_route_send(install ?
 			   ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
 			   static_zclient, &api);
@@ -1624,6 +1656,9 @@ void static_zebra_stop(void)
 	static_nht_hash_clear();
 	static_nht_hash_fini(static_nht_hash);
 
+	event_cancel(&t_static_route_bulk);
+	static_route_bulk.count = 0;
+
 	if (!static_zclient)
 		return;
 	zclient_stop(static_zclient);
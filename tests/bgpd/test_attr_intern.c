@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the throughput of interning a large
+ * number of unique BGP attributes, and the longest single stall while
+ * the attribute tables grow.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "monotime.h"
+#include "frrevent.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_network.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/* small enough for make check; pass a count on the command line to benchmark */
+#define DEFAULT_PATHS 50000
+#define ASPATHS 4096
+#define COMMUNITIES 256
+
+static struct aspath *aspaths[ASPATHS];
+static struct community *communities[COMMUNITIES];
+
+static void make_attr(uint32_t i, struct attr *attr)
+{
+	memset(attr, 0, sizeof(*attr));
+
+	attr->origin = BGP_ORIGIN_IGP;
+	bgp_attr_set(attr, BGP_ATTR_ORIGIN);
+	attr->aspath = aspaths[i % ASPATHS];
+	bgp_attr_set(attr, BGP_ATTR_AS_PATH);
+	attr->nexthop.s_addr = htonl(0xc0000200 + (i % 251));
+	bgp_attr_set(attr, BGP_ATTR_NEXT_HOP);
+	attr->med = i;
+	bgp_attr_set(attr, BGP_ATTR_MULTI_EXIT_DISC);
+	bgp_attr_set_community(attr, communities[i % COMMUNITIES]);
+	attr->label_index = BGP_INVALID_LABEL_INDEX;
+	attr->label = MPLS_INVALID_LABEL;
+}
+
+int main(int argc, char **argv)
+{
+	struct attr **interned;
+	struct attr attr;
+	struct timeval start, op;
+	uint32_t count = DEFAULT_PATHS;
+	int64_t elapsed, worst = 0, us;
+	char buf[64];
+	uint32_t i;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	qobj_init();
+	master = event_master_create("test attr intern");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+
+	for (i = 0; i < ASPATHS; i++) {
+		snprintf(buf, sizeof(buf), "%u %u %u", 64512 + (i % 512),
+			 65000 + i, 4200000000U + i);
+		aspaths[i] = aspath_intern(
+			aspath_str2aspath(buf, ASNOTATION_PLAIN));
+	}
+	for (i = 0; i < COMMUNITIES; i++) {
+		snprintf(buf, sizeof(buf), "64512:%u", i);
+		communities[i] = community_intern(community_str2com(buf));
+	}
+
+	interned = calloc(count, sizeof(*interned));
+	assert(interned);
+
+	/* every attribute is new, so the tables keep growing */
+	monotime(&start);
+	for (i = 0; i < count; i++) {
+		make_attr(i, &attr);
+
+		monotime(&op);
+		interned[i] = bgp_attr_intern(&attr);
+		us = monotime_since(&op, NULL);
+		if (us > worst)
+			worst = us;
+	}
+	elapsed = monotime_since(&start, NULL);
+
+	printf("Interning %u unique attributes took %" PRId64
+	       " msec (%.0f/sec), longest single intern %" PRId64 " usec.\n",
+	       count, elapsed / 1000,
+	       elapsed ? (double)count * 1000000 / elapsed : 0.0, worst);
+
+	if (attr_count() != count) {
+		printf("Expected %u attributes, found %lu.\n", count,
+		       attr_count());
+		return 1;
+	}
+
+	/* and every lookup finds an existing one */
+	monotime(&start);
+	for (i = 0; i < count; i++) {
+		struct attr *found;
+
+		make_attr(i, &attr);
+		found = bgp_attr_intern(&attr);
+		if (found != interned[i]) {
+			printf("Attribute %u interned twice.\n", i);
+			return 1;
+		}
+		bgp_attr_unintern(&found);
+	}
+	elapsed = monotime_since(&start, NULL);
+
+	printf("Looking up %u attributes took %" PRId64 " msec (%.0f/sec).\n",
+	       count, elapsed / 1000,
+	       elapsed ? (double)count * 1000000 / elapsed : 0.0);
+
+	monotime(&start);
+	for (i = 0; i < count; i++)
+		bgp_attr_unintern(&interned[i]);
+	elapsed = monotime_since(&start, NULL);
+
+	printf("Releasing %u attributes took %" PRId64 " msec.\n", count,
+	       elapsed / 1000);
+
+	free(interned);
+	for (i = 0; i < ASPATHS; i++)
+		aspath_unintern(&aspaths[i]);
+	for (i = 0; i < COMMUNITIES; i++)
+		community_unintern(&communities[i]);
+
+	fflush(stdout);
+
+	return attr_count() != 0;
+}
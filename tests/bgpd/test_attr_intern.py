@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestAttrIntern(frrtest.TestMultiOut):
+    program = "./test_attr_intern"
+
+
+TestAttrIntern.exit_cleanly()
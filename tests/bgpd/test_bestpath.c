@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures bestpath selection over synthetic
+ * destinations, each carrying a full set of iBGP paths that differ only
+ * late in the decision process, so every comparison goes deep and every
+ * path ends up in the multipath set.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "vrf.h"
+#include "monotime.h"
+#include "frrevent.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_table.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/*
+ * small enough for make check; pass destination and run counts on the
+ * command line to benchmark
+ */
+#define DEFAULT_DESTS 1000
+#define DEFAULT_RUNS 3
+#define PATHS 32
+
+int main(int argc, char **argv)
+{
+	struct bgp *bgp = NULL;
+	struct peer *peers[PATHS];
+	struct attr *attrs[PATHS];
+	struct bgp_dest **dests;
+	struct bgp_path_info *pi;
+	struct bgp_path_info_pair result;
+	struct bgp_maxpaths_cfg *mpath_cfg;
+	struct aspath *aspath;
+	struct prefix p = { .family = AF_INET, .prefixlen = 24 };
+	struct attr attr;
+	struct timeval start;
+	uint32_t dest_count = DEFAULT_DESTS, runs = DEFAULT_RUNS;
+	uint64_t runs_before;
+	int64_t elapsed;
+	as_t asn = 65000;
+	uint32_t i, j, run, mpaths;
+
+	if (argc > 1)
+		dest_count = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		runs = strtoul(argv[2], NULL, 10);
+
+	qobj_init();
+	master = event_master_create("test bestpath");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT, NULL,
+		    ASNOTATION_PLAIN) < 0)
+		return 1;
+
+	mpath_cfg = &bgp->maxpaths[AFI_IP][SAFI_UNICAST];
+	mpath_cfg->maxpaths_ibgp = PATHS;
+
+	aspath = aspath_intern(aspath_str2aspath("65001 65002 65003",
+						 ASNOTATION_PLAIN));
+
+	for (i = 0; i < PATHS; i++) {
+		peers[i] = peer_create_accept(bgp, NULL);
+		peers[i]->as = asn;
+		peers[i]->sort = BGP_PEER_IBGP;
+		peers[i]->remote_id.s_addr = htonl(0x0a000001 + i);
+		peers[i]->connection->status = Established;
+
+		bgp_attr_default_set(&attr, bgp, BGP_ORIGIN_IGP);
+		attr.aspath = aspath;
+		attr.nexthop.s_addr = htonl(0xc0000201 + i);
+		bgp_attr_set(&attr, BGP_ATTR_NEXT_HOP);
+		attr.local_pref = 100;
+		bgp_attr_set(&attr, BGP_ATTR_LOCAL_PREF);
+		attrs[i] = bgp_attr_intern(&attr);
+	}
+
+	dests = calloc(dest_count, sizeof(*dests));
+	assert(dests);
+
+	for (i = 0; i < dest_count; i++) {
+		p.u.prefix4.s_addr = htonl(0x0a000000 + (i << 8));
+		dests[i] = bgp_node_get(bgp->rib[AFI_IP][SAFI_UNICAST], &p);
+
+		for (j = 0; j < PATHS; j++) {
+			pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0,
+				       peers[j], bgp_attr_intern(attrs[j]),
+				       dests[i]);
+			bgp_path_info_set_flag(dests[i], pi, BGP_PATH_VALID);
+			bgp_path_info_add(dests[i], pi);
+		}
+	}
+
+	/* every run sorts all paths of every destination from scratch */
+	runs_before = bgp->bestpath_runs;
+	monotime(&start);
+	for (run = 0; run < runs; run++) {
+		for (i = 0; i < dest_count; i++) {
+			for (pi = bgp_dest_get_bgp_path_info(dests[i]); pi;
+			     pi = pi->next)
+				SET_FLAG(pi->flags, BGP_PATH_UNSORTED);
+
+			bgp_best_selection(bgp, dests[i], mpath_cfg, &result,
+					   AFI_IP, SAFI_UNICAST);
+		}
+	}
+	elapsed = monotime_since(&start, NULL);
+
+	printf("Selecting among %u paths on %u destinations %u times took %" PRId64
+	       " msec (%.0f selections/sec, %.1f nsec per comparison).\n",
+	       PATHS, dest_count, runs, elapsed / 1000,
+	       elapsed ? (double)dest_count * runs * 1000000 / elapsed : 0.0,
+	       bgp->bestpath_runs > runs_before
+		       ? (double)elapsed * 1000 /
+				 (bgp->bestpath_runs - runs_before)
+		       : 0.0);
+
+	/*
+	 * All paths are equal up to the router-id: the lowest one wins and
+	 * all others are multipaths.
+	 */
+	for (i = 0; i < dest_count; i++) {
+		pi = bgp_dest_get_bgp_path_info(dests[i]);
+		if (!pi || pi->peer != peers[0]) {
+			printf("Destination %u has the wrong bestpath.\n", i);
+			return 1;
+		}
+
+		mpaths = 0;
+		for (; pi; pi = pi->next)
+			if (CHECK_FLAG(pi->flags, BGP_PATH_MULTIPATH))
+				mpaths++;
+
+		if (mpaths != PATHS - 1) {
+			printf("Destination %u has %u multipaths, expected %u.\n",
+			       i, mpaths, PATHS - 1);
+			return 1;
+		}
+	}
+
+	free(dests);
+	fflush(stdout);
+
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestBestpath(frrtest.TestMultiOut):
+    program = "./test_bestpath"
+
+
+TestBestpath.exit_cleanly()
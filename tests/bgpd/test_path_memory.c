@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the memory taken by the RIB of full
+ * tables: synthetic IPv4 prefixes, each learned from a number of iBGP
+ * peers whose next hops resolve with an IGP metric, as on a route
+ * reflector.
+ */
+
+#include <zebra.h>
+/* malloc.h is generally obsolete, however GNU Libc mallinfo wants it. */
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#ifdef HAVE_MALLOC_MALLOC_H
+#include <malloc/malloc.h>
+#endif
+
+#include <stdio.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "vrf.h"
+#include "monotime.h"
+#include "frrevent.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_memory.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_table.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/*
+ * small enough for make check; pass destination and peer counts on the
+ * command line to benchmark
+ */
+#define DEFAULT_DESTS 20000
+#define DEFAULT_PEERS 3
+#define ASPATHS 4096
+
+/* bytes handed out by malloc, 0 if that can't be told */
+static size_t heap_used(void)
+{
+#if defined(HAVE_MALLINFO2)
+	struct mallinfo2 minfo = mallinfo2();
+
+	return minfo.uordblks + minfo.hblkhd;
+#elif defined(HAVE_MALLINFO)
+	struct mallinfo minfo = mallinfo();
+
+	return (size_t)(unsigned int)minfo.uordblks +
+	       (size_t)(unsigned int)minfo.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	struct bgp *bgp = NULL;
+	struct peer **peers;
+	struct attr **attrs;
+	struct aspath *aspaths[ASPATHS];
+	struct bgp_dest *dest;
+	struct bgp_path_info *pi;
+	struct prefix p = { .family = AF_INET, .prefixlen = 24 };
+	struct attr attr;
+	struct timeval start;
+	uint32_t dest_count = DEFAULT_DESTS, peer_count = DEFAULT_PEERS;
+	uint64_t paths;
+	size_t before, first = 0, after;
+	double per_path = 0;
+	int64_t elapsed;
+	as_t asn = 65000;
+	char buf[64];
+	uint32_t i, j;
+
+	if (argc > 1)
+		dest_count = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		peer_count = strtoul(argv[2], NULL, 10);
+	if (!dest_count || !peer_count)
+		return 1;
+
+	qobj_init();
+	master = event_master_create("test path memory");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT, NULL,
+		    ASNOTATION_PLAIN) < 0)
+		return 1;
+
+	for (i = 0; i < ASPATHS; i++) {
+		snprintf(buf, sizeof(buf), "%u %u", 64512 + (i % 512),
+			 4200000000U + i);
+		aspaths[i] = aspath_intern(
+			aspath_str2aspath(buf, ASNOTATION_PLAIN));
+	}
+
+	/* attributes are shared by many prefixes, as in real tables */
+	peers = calloc(peer_count, sizeof(*peers));
+	attrs = calloc((size_t)peer_count * ASPATHS, sizeof(*attrs));
+	assert(peers && attrs);
+
+	for (i = 0; i < peer_count; i++) {
+		peers[i] = peer_create_accept(bgp, NULL);
+		peers[i]->as = asn;
+		peers[i]->sort = BGP_PEER_IBGP;
+		peers[i]->remote_id.s_addr = htonl(0x0a000001 + i);
+		peers[i]->connection->status = Established;
+
+		for (j = 0; j < ASPATHS; j++) {
+			bgp_attr_default_set(&attr, bgp, BGP_ORIGIN_IGP);
+			attr.aspath = aspaths[j];
+			attr.nexthop.s_addr = htonl(0xc0000201 + i);
+			bgp_attr_set(&attr, BGP_ATTR_NEXT_HOP);
+			attr.local_pref = 100;
+			bgp_attr_set(&attr, BGP_ATTR_LOCAL_PREF);
+			attrs[i * ASPATHS + j] = bgp_attr_intern(&attr);
+		}
+	}
+
+	/*
+	 * One peer at a time, so that once the first one is loaded the
+	 * destinations exist and the heap only grows by the paths.
+	 */
+	before = heap_used();
+	monotime(&start);
+	for (j = 0; j < peer_count; j++) {
+		if (j == 1)
+			first = heap_used();
+
+		for (i = 0; i < dest_count; i++) {
+			p.u.prefix4.s_addr = htonl(0x01000000 + (i << 8));
+			dest = bgp_node_get(bgp->rib[AFI_IP][SAFI_UNICAST], &p);
+
+			pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0,
+				       peers[j],
+				       bgp_attr_intern(
+					       attrs[j * ASPATHS + i % ASPATHS]),
+				       dest);
+			bgp_path_info_set_flag(dest, pi, BGP_PATH_VALID);
+			/* what next hop tracking stores for iBGP next hops */
+			pi->igpmetric = 10 + j;
+			bgp_path_info_add(dest, pi);
+
+			bgp_dest_unlock_node(dest);
+		}
+	}
+	elapsed = monotime_since(&start, NULL);
+	after = heap_used();
+
+	paths = (uint64_t)dest_count * peer_count;
+
+	printf("Loading %u destinations from %u peers took %" PRId64
+	       " msec.\n",
+	       dest_count, peer_count, elapsed / 1000);
+	printf("struct bgp_path_info %zu bytes, struct bgp_dest %zu bytes, struct bgp_path_info_extra %zu bytes.\n",
+	       sizeof(struct bgp_path_info), sizeof(struct bgp_dest),
+	       sizeof(struct bgp_path_info_extra));
+	printf("%zu paths, %zu destinations, %zu path extras allocated.\n",
+	       mtype_stats_alloc(MTYPE_BGP_ROUTE),
+	       mtype_stats_alloc(MTYPE_BGP_NODE),
+	       mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA));
+
+	if (after > before) {
+		printf("Heap grew by %zu bytes, %.1f bytes per path.\n",
+		       after - before, (double)(after - before) / paths);
+		if (peer_count > 1 && after > first) {
+			per_path = (double)(after - first) /
+				   ((uint64_t)dest_count * (peer_count - 1));
+			printf("Each path from another peer took %.1f bytes.\n",
+			       per_path);
+		}
+	} else
+		printf("Heap usage is not available on this platform.\n");
+
+	if (mtype_stats_alloc(MTYPE_BGP_ROUTE) != paths) {
+		printf("Expected %" PRIu64 " paths.\n", paths);
+		return 1;
+	}
+
+	/* plain unicast paths must not need their ancillary information */
+	if (mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA)) {
+		printf("Unexpected ancillary route information.\n");
+		return 1;
+	}
+
+	/*
+	 * An iBGP path used to cost itself plus an extra for its IGP metric;
+	 * it must now come in under that even with malloc overhead.
+	 */
+	if (per_path >= sizeof(struct bgp_path_info) +
+				sizeof(struct bgp_path_info_extra)) {
+		printf("A path takes %.1f bytes, no less than a path with ancillary information (%zu bytes).\n",
+		       per_path,
+		       sizeof(struct bgp_path_info) +
+			       sizeof(struct bgp_path_info_extra));
+		return 1;
+	}
+
+	free(attrs);
+	free(peers);
+	fflush(stdout);
+
+	return 0;
+}
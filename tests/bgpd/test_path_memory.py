@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestPathMemory(frrtest.TestMultiOut):
+    program = "./test_path_memory"
+
+
+TestPathMemory.exit_cleanly()
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the time it takes to add, update and
+ * remove prefixes in the per-NVE advertised-prefix tables.
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "prefix.h"
+#include "monotime.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/rfapi/rfapi_private.h"
+#include "bgpd/rfapi/rfapi_rib.h"
+#include "bgpd/rfapi/rfapi_ap.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/* small enough for make check; pass a count on the command line to benchmark */
+#define DEFAULT_PREFIXES 10000
+
+static void make_prefix(uint32_t i, struct prefix *p)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = IPV4_MAX_BITLEN;
+	p->u.prefix4.s_addr = htonl(0x0a000000 + i);
+}
+
+static unsigned long elapsed_msec(struct timeval *start, struct timeval *stop)
+{
+	return 1000 * (stop->tv_sec - start->tv_sec) +
+	       (stop->tv_usec - start->tv_usec) / 1000;
+}
+
+static void report(const char *what, uint32_t count, unsigned long msec)
+{
+	printf("%s %u prefixes took %lu.%03lu seconds (%.0f/s).\n", what,
+	       count, msec / 1000, msec % 1000,
+	       msec ? (double)count * 1000 / msec : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+	struct rfapi_descriptor *rfd;
+	struct prefix_rd prd;
+	struct prefix p;
+	struct timeval tv_start, tv_stop;
+	uint32_t count = DEFAULT_PREFIXES;
+	uint32_t i;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	rfd = calloc(1, sizeof(*rfd));
+	rfd->min_prefix_lifetime = UINT32_MAX;
+	rfapiApInit(&rfd->advertised);
+
+	memset(&prd, 0, sizeof(prd));
+	prd.family = AF_UNSPEC;
+	prd.prefixlen = 64;
+
+	monotime(&tv_start);
+	for (i = 0; i < count; i++) {
+		make_prefix(i, &p);
+		rfapiApAdd(NULL, rfd, &p, NULL, &prd, 3600, 0, NULL);
+	}
+	monotime(&tv_stop);
+	report("Registering", count, elapsed_msec(&tv_start, &tv_stop));
+	assert(rfapiApCount(rfd) == (int)count);
+
+	/* re-registration with a new lifetime moves each entry */
+	monotime(&tv_start);
+	for (i = 0; i < count; i++) {
+		make_prefix(i, &p);
+		rfapiApAdd(NULL, rfd, &p, NULL, &prd, 3600 + (i & 0xff), 0,
+			   NULL);
+	}
+	monotime(&tv_stop);
+	report("Updating", count, elapsed_msec(&tv_start, &tv_stop));
+	assert(rfapiApCount(rfd) == (int)count);
+
+	monotime(&tv_start);
+	for (i = 0; i < count; i++) {
+		make_prefix(i, &p);
+		assert(!rfapiApDelete(NULL, rfd, &p, NULL, &prd, NULL));
+	}
+	monotime(&tv_stop);
+	report("Deregistering", count, elapsed_msec(&tv_start, &tv_stop));
+	assert(rfapiApCount(rfd) == 0);
+
+	rfapiApRelease(&rfd->advertised);
+	free(rfd);
+	fflush(stdout);
+
+	return 0;
+}
@@ -0,0 +1,17 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+import pytest
+
+if 'S["ENABLE_BGP_VNC_TRUE"]=""\n' not in open("../config.status").readlines():
+
+    class TestRfapiAp:
+        @pytest.mark.skipif(True, reason="VNC not enabled")
+        def test_exit_cleanly(self):
+            pass
+
+else:
+
+    class TestRfapiAp(frrtest.TestMultiOut):
+        program = "./test_rfapi_ap"
+
+    TestRfapiAp.exit_cleanly()
@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the cost of a covering route flap on an
+ * NVE whose monitors fall back to a less-specific import table node
+ * with a large number of more-specific routes below it.
+ *
+ * Copyright 2026, LabN Consulting, L.L.C.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "prefix.h"
+#include "monotime.h"
+#include "frrevent.h"
+#include "agg_table.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_label.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_rd.h"
+#include "bgpd/rfapi/rfapi.h"
+#include "bgpd/rfapi/rfapi_private.h"
+#include "bgpd/rfapi/rfapi_import.h"
+#include "bgpd/rfapi/rfapi_monitor.h"
+#include "bgpd/rfapi/rfapi_rib.h"
+#include "bgpd/rfapi/bgp_rfapi_cfg.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+/* small enough for make check; pass a count on the command line to benchmark */
+#define DEFAULT_PREFIXES 5000
+#define MONITORS 16
+#define FLAPS 5
+
+static struct bgp *bgp;
+static as_t asn = 64512;
+static uint32_t responses;
+
+static void response_cb(struct rfapi_next_hop_entry *next_hops, void *cookie)
+{
+	struct rfapi_next_hop_entry *nh;
+
+	for (nh = next_hops; nh; nh = nh->next)
+		++responses;
+	rfapi_free_next_hop_list(next_hops);
+}
+
+static void make_prefix(uint32_t addr, uint8_t len, struct prefix *p)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = len;
+	p->u.prefix4.s_addr = htonl(addr);
+}
+
+static void import(struct rfapi_import_table *it, int action,
+		   const struct prefix *p, struct attr *attr,
+		   struct prefix_rd *prd)
+{
+	uint32_t label = MPLS_INVALID_LABEL;
+
+	rfapiBgpInfoFilteredImportVPN(it, action, bgp->peer_self, NULL, p,
+				      NULL, AFI_IP, prd, attr, ZEBRA_ROUTE_BGP,
+				      BGP_ROUTE_NORMAL, &label);
+}
+
+/*
+ * Run the event loop until the NVE's pending updates have been
+ * delivered through its response callback
+ */
+static void drain(struct rfapi_descriptor *rfd)
+{
+	struct event ev;
+
+	while (CHECK_FLAG(rfd->flags, RFAPI_QUEUED_FLAG(AFI_IP)) &&
+	       event_fetch(bm->master, &ev))
+		event_call(&ev);
+}
+
+static unsigned long elapsed_msec(struct timeval *start, struct timeval *stop)
+{
+	return 1000 * (stop->tv_sec - start->tv_sec) +
+	       (stop->tv_usec - start->tv_usec) / 1000;
+}
+
+int main(int argc, char **argv)
+{
+	struct rfapi_import_table *it;
+	struct rfapi_descriptor *rfd;
+	struct ecommunity *ecom;
+	struct prefix_rd prd;
+	struct prefix p8;
+	struct prefix p;
+	struct attr attr;
+	struct timeval tv_start, tv_stop;
+	uint32_t count = DEFAULT_PREFIXES;
+	uint32_t i;
+	afi_t afi;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	qobj_init();
+	cmd_init(0);
+	master = event_master_create("test rfapi subtree");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_attr_init();
+	bgp_labels_init();
+	rfapi_rib_init();
+	rfapi_monitor_init();
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT, NULL,
+		    ASNOTATION_PLAIN) < 0)
+		return -1;
+
+	/* updated responses are off by default */
+	bgp->rfapi_cfg->flags &= ~BGP_VNC_CONFIG_CALLBACK_DISABLE;
+
+	ecom = ecommunity_str2com("64512:1", ECOMMUNITY_ROUTE_TARGET, 0);
+	assert(ecom);
+	it = rfapiImportTableRefAdd(bgp, ecom, NULL);
+
+	memset(&prd, 0, sizeof(prd));
+	prd.family = AF_UNSPEC;
+	prd.prefixlen = 64;
+	prd.val[1] = RD_TYPE_AS;
+	prd.val[7] = 1;
+
+	memset(&attr, 0, sizeof(attr));
+	bgp_attr_default_set(&attr, bgp, BGP_ORIGIN_IGP);
+	attr.mp_nexthop_len = BGP_ATTR_NHLEN_IPV4;
+	inet_pton(AF_INET, "192.0.2.254", &attr.mp_nexthop_global_in);
+	bgp_attr_set_ecommunity(&attr, ecom);
+
+	/*
+	 * The /32s are more-specifics of 0/0. When 10/8 is withdrawn the
+	 * monitors move up to 0/0 and the NVE's RIB is brought up to date
+	 * with everything below it.
+	 */
+	make_prefix(0, 0, &p);
+	import(it, FIF_ACTION_UPDATE, &p, &attr, &prd);
+
+	monotime(&tv_start);
+	for (i = 0; i < count; i++) {
+		make_prefix(0x14000000 + i, IPV4_MAX_BITLEN, &p);
+		import(it, FIF_ACTION_UPDATE, &p, &attr, &prd);
+	}
+	monotime(&tv_stop);
+	printf("Importing %u prefixes took %lu msec.\n", count,
+	       elapsed_msec(&tv_start, &tv_stop));
+
+	make_prefix(0x0a000000, 8, &p8);
+	import(it, FIF_ACTION_UPDATE, &p8, &attr, &prd);
+
+	rfd = calloc(1, sizeof(*rfd));
+	rfd->bgp = bgp;
+	rfd->import_table = it;
+	rfd->response_lifetime = 3600;
+	rfd->response_cb = response_cb;
+	rfd->vn_addr.addr_family = AF_INET;
+	inet_pton(AF_INET, "192.0.2.1", &rfd->vn_addr.addr.v4);
+	rfd->un_addr = rfd->vn_addr;
+	/* not in the NVE descriptor lookup tables */
+	SET_FLAG(rfd->flags, RFAPI_HD_FLAG_IS_VRF);
+	for (afi = AFI_IP; afi <= AFI_L2VPN; afi++) {
+		rfd->rib[afi] = agg_table_init();
+		agg_set_table_info(rfd->rib[afi], rfd);
+		rfd->rib_pending[afi] = agg_table_init();
+		agg_set_table_info(rfd->rib_pending[afi], rfd);
+		rfd->rsp_times[afi] = agg_table_init();
+		agg_set_table_info(rfd->rsp_times[afi], rfd);
+	}
+
+	for (i = 0; i < MONITORS; i++) {
+		make_prefix(0x0a010000 + i, IPV4_MAX_BITLEN, &p);
+		rfapiMonitorAdd(bgp, rfd, &p);
+	}
+
+	/*
+	 * The first flap sends the NVE all of the /32s. Later flaps
+	 * should only have to look at nodes that changed in between.
+	 */
+	for (i = 0; i < FLAPS; i++) {
+		uint32_t before = responses;
+
+		monotime(&tv_start);
+		import(it, FIF_ACTION_KILL, &p8, &attr, &prd);
+		drain(rfd);
+		import(it, FIF_ACTION_UPDATE, &p8, &attr, &prd);
+		drain(rfd);
+		monotime(&tv_stop);
+
+		printf("Flap %u over %u prefixes took %lu msec, %u responses.\n",
+		       i + 1, count, elapsed_msec(&tv_start, &tv_stop),
+		       responses - before);
+	}
+
+	fflush(stdout);
+
+	return 0;
+}
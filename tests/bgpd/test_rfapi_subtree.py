@@ -0,0 +1,17 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+import pytest
+
+if 'S["ENABLE_BGP_VNC_TRUE"]=""\n' not in open("../config.status").readlines():
+
+    class TestRfapiSubtree:
+        @pytest.mark.skipif(True, reason="VNC not enabled")
+        def test_exit_cleanly(self):
+            pass
+
+else:
+
+    class TestRfapiSubtree(frrtest.TestMultiOut):
+        program = "./test_rfapi_subtree"
+
+    TestRfapiSubtree.exit_cleanly()
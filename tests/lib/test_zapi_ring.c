@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * ZAPI shared-memory ring tests.
+ */
+#include <zebra.h>
+
+#include "zapi_ring.h"
+
+static bool rung(int fd)
+{
+	uint64_t count;
+
+	return read(fd, &count, sizeof(count)) == sizeof(count);
+}
+
+int main(int argc, char **argv)
+{
+	struct zapi_ring *prod, *cons;
+	static uint8_t in[ZAPI_RING_MIN_SIZE], out[ZAPI_RING_MIN_SIZE];
+	size_t size, i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i * 7;
+
+	prod = zapi_ring_new(1);
+	if (!prod) {
+		printf("Shared memory rings are not available, skipping.\n");
+		return 0;
+	}
+
+	/* both sides of the ring, in one process */
+	cons = zapi_ring_attach(dup(prod->memfd), dup(prod->doorbell),
+				dup(prod->spacebell));
+	assert(cons);
+
+	size = prod->size;
+	assert(size == ZAPI_RING_MIN_SIZE);
+	assert(cons->size == size);
+	assert(zapi_ring_space(prod) == size);
+	assert(zapi_ring_remain(cons) == 0);
+
+	printf("Validating doorbell...\n");
+	assert(zapi_ring_wait_data(cons, 1));
+	assert(zapi_ring_put(prod, in, 10) == 10);
+	assert(rung(cons->doorbell));
+	assert(zapi_ring_remain(cons) == 10);
+	/* nobody waits now, so nobody is woken */
+	assert(zapi_ring_put(prod, in + 10, 10) == 10);
+	assert(!rung(cons->doorbell));
+	assert(!zapi_ring_wait_data(cons, 20));
+	assert(zapi_ring_wait_data(cons, 21));
+
+	printf("Validating peek and read...\n");
+	assert(zapi_ring_peek(cons, 5, out, 100) == 15);
+	assert(!memcmp(out, in + 5, 15));
+	assert(zapi_ring_peek(cons, 20, out, 1) == 0);
+	assert(zapi_ring_get(cons, out, 100) == 20);
+	assert(!memcmp(out, in, 20));
+	assert(zapi_ring_remain(cons) == 0);
+	assert(zapi_ring_space(prod) == size);
+
+	printf("Validating size limits...\n");
+	assert(zapi_ring_put(prod, in, size - 5) == size - 5);
+	assert(zapi_ring_put(prod, in, 15) == 5);
+	assert(zapi_ring_space(prod) == 0);
+	assert(zapi_ring_remain(cons) == size);
+
+	printf("Validating space doorbell...\n");
+	assert(zapi_ring_wait_space(prod, 1));
+	assert(zapi_ring_get(cons, out, size - 5) == size - 5);
+	assert(!memcmp(out, in, size - 5));
+	assert(rung(prod->spacebell));
+	assert(zapi_ring_get(cons, out, 5) == 5);
+	assert(!memcmp(out, in, 5));
+	assert(!rung(prod->spacebell));
+
+	printf("Validating wraparound...\n");
+	for (i = 0; i < 4; i++) {
+		assert(zapi_ring_put(prod, in, size / 3) == size / 3);
+		assert(zapi_ring_remain(cons) == size / 3);
+		assert(zapi_ring_get(cons, out, size) == size / 3);
+		assert(!memcmp(out, in, size / 3));
+	}
+
+	zapi_ring_del(&cons);
+	zapi_ring_del(&prod);
+	assert(!cons && !prod);
+
+	printf("Done.\n");
+	return 0;
+}
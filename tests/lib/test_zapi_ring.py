@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestZapiRing(frrtest.TestMultiOut):
+    program = "./test_zapi_ring"
+
+
+TestZapiRing.exit_cleanly()
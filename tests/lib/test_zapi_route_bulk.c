@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * ZEBRA_ROUTE_ADD_BULK encoding tests.
+ */
+#include <zebra.h>
+
+#include "prefix.h"
+#include "stream.h"
+#include "zclient.h"
+
+static struct zapi_route_bulk bulk;
+
+static void route_make(struct zapi_route *api, const char *prefix,
+		       const char *gate)
+{
+	struct zapi_nexthop *api_nh;
+
+	zapi_route_init(api);
+	api->vrf_id = VRF_DEFAULT;
+	api->type = ZEBRA_ROUTE_BGP;
+	api->safi = SAFI_UNICAST;
+	str2prefix(prefix, &api->prefix);
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP);
+	api_nh = &api->nexthops[api->nexthop_num++];
+	zapi_nexthop_init(api_nh);
+	api_nh->vrf_id = VRF_DEFAULT;
+	api_nh->type = NEXTHOP_TYPE_IPV4;
+	inet_pton(AF_INET, gate, &api_nh->gate.ipv4);
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_METRIC);
+	api->metric = 10;
+}
+
+static void prefix_make(struct prefix *p, uint32_t i)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = 24;
+	p->u.prefix4.s_addr = htonl(0x0a000000 + (i << 8));
+}
+
+int main(int argc, char **argv)
+{
+	static struct zapi_route api, out;
+	struct stream *s;
+	uint16_t count, i;
+	int n, total;
+
+	printf("Validating bulk collection...\n");
+	route_make(&api, "10.0.0.0/24", "192.0.2.1");
+	assert(zapi_route_bulk_add(&bulk, &api));
+	route_make(&api, "10.0.1.0/24", "192.0.2.1");
+	assert(zapi_route_bulk_add(&bulk, &api));
+	assert(bulk.count == 2);
+
+	/* another nexthop, another bulk */
+	route_make(&api, "10.0.2.0/24", "192.0.2.2");
+	assert(!zapi_route_bulk_add(&bulk, &api));
+	route_make(&api, "10.0.2.0/24", "192.0.2.1");
+	api.metric = 20;
+	assert(!zapi_route_bulk_add(&bulk, &api));
+	route_make(&api, "2001:db8::/64", "192.0.2.1");
+	assert(!zapi_route_bulk_add(&bulk, &api));
+	assert(bulk.count == 2);
+
+	route_make(&api, "10.0.0.0/24", "192.0.2.1");
+	bulk.count = 0;
+	for (i = 0; i < ZAPI_ROUTE_BULK_MAX; i++) {
+		prefix_make(&api.prefix, i);
+		assert(zapi_route_bulk_add(&bulk, &api));
+	}
+	assert(!zapi_route_bulk_add(&bulk, &api));
+
+	printf("Validating encoding and decoding...\n");
+	s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	n = zapi_route_bulk_encode(s, &bulk.api, bulk.prefixes, bulk.count);
+	assert(n == bulk.count);
+	assert(stream_getw(s) == stream_get_endp(s));
+	stream_forward_getp(s, ZEBRA_HEADER_SIZE - 2);
+
+	assert(zapi_route_bulk_decode(s, &out, &count) == 0);
+	assert(count == bulk.count - 1);
+	assert(prefix_same(&out.prefix, &bulk.prefixes[0]));
+	assert(out.nexthop_num == 1 && out.metric == 10);
+	assert(IPV4_ADDR_SAME(&out.nexthops[0].gate.ipv4,
+			      &api.nexthops[0].gate.ipv4));
+	for (i = 1; i <= count; i++) {
+		assert(zapi_route_bulk_decode_prefix(s, &out.prefix) == 0);
+		assert(prefix_same(&out.prefix, &bulk.prefixes[i]));
+	}
+	assert(STREAM_READABLE(s) == 0);
+	stream_free(s);
+
+	printf("Validating message splitting...\n");
+	s = stream_new(256);
+	total = 0;
+	while (total < bulk.count) {
+		stream_reset(s);
+		n = zapi_route_bulk_encode(s, &bulk.api, bulk.prefixes + total,
+					   bulk.count - total);
+		assert(n > 0 && n < bulk.count);
+
+		stream_forward_getp(s, ZEBRA_HEADER_SIZE);
+		assert(zapi_route_bulk_decode(s, &out, &count) == 0);
+		assert(count == n - 1);
+		assert(prefix_same(&out.prefix, &bulk.prefixes[total]));
+		for (i = 1; i <= count; i++) {
+			assert(zapi_route_bulk_decode_prefix(s, &out.prefix) == 0);
+			assert(prefix_same(&out.prefix,
+					   &bulk.prefixes[total + i]));
+		}
+		assert(STREAM_READABLE(s) == 0);
+		total += n;
+	}
+	assert(total == bulk.count);
+	stream_free(s);
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestZapiRouteBulk(frrtest.TestMultiOut):
+    program = "./test_zapi_route_bulk"
+
+
+TestZapiRouteBulk.exit_cleanly()
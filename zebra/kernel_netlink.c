@@ -10,6 +10,9 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <linux/filter.h>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
 
 #include "linklist.h"
 #include "if.h"
@@ -26,6 +29,7 @@
 #include "mpls.h"
 #include "lib_errors.h"
 #include "hash.h"
+#include "monotime.h"
 #include "lib/netlink_parser.h"
 
 #include "zebra/zebra_router.h"
@@ -72,6 +76,23 @@
  */
 #define NL_DEFAULT_BATCH_SEND_THRESHOLD (15 * NL_PKT_BUF_SIZE)
 
+/* Batches kept in flight through io_uring, if that is turned on */
+#define NL_DEFAULT_BATCH_URING_DEPTH 8
+
+/*
+ * Unless a send threshold is configured, it adapts between the default and
+ * this: it grows while updates queue up in the dataplane faster than
+ * batches drain them, as long as the kernel gets through a batch within
+ * the target time, and it shrinks back when the queue empties or the
+ * kernel takes too long.
+ */
+#define NL_BATCH_MAX_SEND_THRESHOLD (4 * NL_DEFAULT_BATCH_SEND_THRESHOLD)
+#define NL_BATCH_ACK_TARGET_USEC 5000
+
+/* Histogram of batch ack latencies, in powers of two from 64 usec up */
+#define NL_BATCH_ACK_HIST_MIN_USEC 64
+#define NL_BATCH_ACK_HIST_BUCKETS 12
+
 static const struct message nlmsg_str[] = {
 	{ RTM_NEWROUTE, "RTM_NEWROUTE" },
 	{ RTM_DELROUTE, "RTM_DELROUTE" },
@@ -162,6 +183,9 @@ extern struct event_loop *master;
 extern struct zebra_privs_t zserv_privs;
 
 DEFINE_MTYPE_STATIC(ZEBRA, NL_BUF, "Zebra Netlink buffers");
+#ifdef HAVE_LIBURING
+DEFINE_MTYPE_STATIC(ZEBRA, NL_URING, "Zebra Netlink io_uring");
+#endif
 
 /* Hashtable and mutex to allow lookup of nlsock structs by socket/fd value.
  * We have both the main and dplane pthreads using these structs, so we have
@@ -174,11 +198,62 @@ pthread_mutex_t nlsock_mutex;
 #define NLSOCK_LOCK() pthread_mutex_lock(&nlsock_mutex)
 #define NLSOCK_UNLOCK() pthread_mutex_unlock(&nlsock_mutex)
 
-size_t nl_batch_tx_bufsize;
-char *nl_batch_tx_buf;
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/* Every pthread batching updates into the kernel has its own buffer */
+static thread_local size_t nl_batch_tx_bufsize;
+static thread_local char *nl_batch_tx_buf;
 
 _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
 _Atomic uint32_t nl_batch_send_threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
+#ifdef HAVE_LIBURING
+/* 0 unless batches are to be sent through io_uring */
+_Atomic uint32_t nl_batch_uring_depth;
+#endif
+
+/* Adaptive sizing, used unless batch-tx-buf is configured */
+static atomic_bool nl_batch_fixed;
+static _Atomic uint32_t nl_batch_adaptive_threshold =
+	NL_DEFAULT_BATCH_SEND_THRESHOLD;
+/* Moving averages, updated on every send */
+static _Atomic uint32_t nl_batch_avg_msglen;
+static _Atomic uint32_t nl_batch_avg_ack_usec;
+static _Atomic uint64_t nl_batch_ack_hist[NL_BATCH_ACK_HIST_BUCKETS];
+
+#ifdef HAVE_LIBURING
+/* A batch handed to io_uring, waiting for its send to complete */
+struct nl_uring_slot {
+	char *buf;
+
+	struct iovec iov;
+	struct sockaddr_nl snl;
+	struct msghdr msg;
+	int res;
+
+	struct dplane_ctx_list_head ctx_list;
+};
+
+struct nl_uring {
+	struct io_uring ring;
+	uint32_t depth;
+	size_t bufsiz;
+
+	/* Batches in flight, oldest first; all on the same socket */
+	uint32_t head;
+	uint32_t count;
+	size_t msgcnt;
+	struct nlsock *nl;
+	const struct zebra_dplane_info *zns;
+
+	struct nl_uring_slot slots[];
+};
+
+static thread_local struct nl_uring *nl_uring;
+/* Set once io_uring turned out to be unusable on this pthread */
+static thread_local bool nl_uring_unavailable;
+#endif
 
 struct nl_batch {
 	void *buf;
@@ -198,6 +273,11 @@ struct nl_batch {
 	 * towards the dataplane module.
 	 */
 	struct dplane_ctx_list_head *ctx_out_q;
+
+#ifdef HAVE_LIBURING
+	/* Set if batches go through io_uring */
+	struct nl_uring *uring;
+#endif
 };
 
 int netlink_config_write_helper(struct vty *vty)
@@ -206,6 +286,9 @@ int netlink_config_write_helper(struct vty *vty)
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
 	uint32_t threshold = atomic_load_explicit(&nl_batch_send_threshold,
 						  memory_order_relaxed);
+#ifdef HAVE_LIBURING
+	uint32_t depth;
+#endif
 
 	if (size != NL_DEFAULT_BATCH_BUFSIZE
 	    || threshold != NL_DEFAULT_BATCH_SEND_THRESHOLD)
@@ -216,9 +299,31 @@ int netlink_config_write_helper(struct vty *vty)
 		vty_out(vty, "zebra protodown reason-bit %u\n",
 			if_netlink_get_frr_protodown_r_bit());
 
+#ifdef HAVE_LIBURING
+	depth = atomic_load_explicit(&nl_batch_uring_depth,
+				     memory_order_relaxed);
+	if (depth == NL_DEFAULT_BATCH_URING_DEPTH)
+		vty_out(vty, "zebra kernel netlink io-uring\n");
+	else if (depth)
+		vty_out(vty, "zebra kernel netlink io-uring %u\n", depth);
+#endif
+
 	return 0;
 }
 
+#ifdef HAVE_LIBURING
+void netlink_set_batch_uring(uint32_t depth, bool set)
+{
+	if (!set)
+		depth = 0;
+	else if (!depth)
+		depth = NL_DEFAULT_BATCH_URING_DEPTH;
+
+	atomic_store_explicit(&nl_batch_uring_depth, depth,
+			      memory_order_relaxed);
+}
+#endif /* HAVE_LIBURING */
+
 void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold, bool set)
 {
 	if (!set) {
@@ -229,6 +334,112 @@ void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold, bool set)
 	atomic_store_explicit(&nl_batch_bufsize, size, memory_order_relaxed);
 	atomic_store_explicit(&nl_batch_send_threshold, threshold,
 			      memory_order_relaxed);
+	atomic_store_explicit(&nl_batch_fixed, set, memory_order_relaxed);
+}
+
+/*
+ * Account for a batch of 'msgcnt' messages in 'len' bytes, which took the
+ * kernel 'usec' to handle. Several pthreads may be sending; the averages
+ * only need to be roughly right.
+ */
+static void nl_batch_account(size_t len, size_t msgcnt, int64_t usec)
+{
+	uint32_t avg, bucket;
+
+	if (!msgcnt)
+		return;
+
+	avg = atomic_load_explicit(&nl_batch_avg_msglen, memory_order_relaxed);
+	avg = avg ? (avg * 7 + len / msgcnt) / 8 : len / msgcnt;
+	atomic_store_explicit(&nl_batch_avg_msglen, avg, memory_order_relaxed);
+
+	if (usec < 0)
+		usec = 0;
+
+	avg = atomic_load_explicit(&nl_batch_avg_ack_usec,
+				   memory_order_relaxed);
+	avg = (avg * 7 + MIN(usec, UINT32_MAX)) / 8;
+	atomic_store_explicit(&nl_batch_avg_ack_usec, avg,
+			      memory_order_relaxed);
+
+	for (bucket = 0; bucket < NL_BATCH_ACK_HIST_BUCKETS - 1; bucket++)
+		if (usec < (NL_BATCH_ACK_HIST_MIN_USEC << bucket))
+			break;
+	atomic_fetch_add_explicit(&nl_batch_ack_hist[bucket], 1,
+				  memory_order_relaxed);
+}
+
+/*
+ * Send threshold for a list of 'pending' updates.  What is waiting in the
+ * dataplane counts too: a single list is capped by the provider's work
+ * limit, and would never tell that there is more to come.
+ */
+static size_t nl_batch_threshold(uint32_t pending)
+{
+	uint32_t threshold, msglen, ack_usec;
+	size_t backlog;
+
+	if (atomic_load_explicit(&nl_batch_fixed, memory_order_relaxed))
+		return atomic_load_explicit(&nl_batch_send_threshold,
+					    memory_order_relaxed);
+
+	threshold = atomic_load_explicit(&nl_batch_adaptive_threshold,
+					 memory_order_relaxed);
+	msglen = atomic_load_explicit(&nl_batch_avg_msglen,
+				      memory_order_relaxed);
+	ack_usec = atomic_load_explicit(&nl_batch_avg_ack_usec,
+					memory_order_relaxed);
+
+	backlog = ((size_t)dplane_get_in_queue_len() + pending) *
+		  (msglen ? msglen : 128);
+
+	if (ack_usec > 2 * NL_BATCH_ACK_TARGET_USEC ||
+	    backlog < threshold / 2)
+		threshold /= 2;
+	else if (backlog > 2 * (size_t)threshold &&
+		 ack_usec < NL_BATCH_ACK_TARGET_USEC)
+		threshold *= 2;
+
+	threshold = MAX(threshold, NL_DEFAULT_BATCH_SEND_THRESHOLD);
+	threshold = MIN(threshold, NL_BATCH_MAX_SEND_THRESHOLD);
+
+	atomic_store_explicit(&nl_batch_adaptive_threshold, threshold,
+			      memory_order_relaxed);
+
+	return threshold;
+}
+
+void netlink_batch_show(struct vty *vty)
+{
+	uint64_t count;
+	uint32_t i;
+
+	if (atomic_load_explicit(&nl_batch_fixed, memory_order_relaxed))
+		vty_out(vty, "Netlink batch threshold:  %u (configured)\n",
+			atomic_load_explicit(&nl_batch_send_threshold,
+					     memory_order_relaxed));
+	else
+		vty_out(vty, "Netlink batch threshold:  %u (adaptive)\n",
+			atomic_load_explicit(&nl_batch_adaptive_threshold,
+					     memory_order_relaxed));
+
+	vty_out(vty, "Netlink batch msg size:   %u\n",
+		atomic_load_explicit(&nl_batch_avg_msglen,
+				     memory_order_relaxed));
+	vty_out(vty, "Netlink batch ack usecs:  %u\n",
+		atomic_load_explicit(&nl_batch_avg_ack_usec,
+				     memory_order_relaxed));
+
+	for (i = 0; i < NL_BATCH_ACK_HIST_BUCKETS; i++) {
+		count = atomic_load_explicit(&nl_batch_ack_hist[i],
+					     memory_order_relaxed);
+		if (i < NL_BATCH_ACK_HIST_BUCKETS - 1)
+			vty_out(vty, "  < %-7u usecs:        %" PRIu64 "\n",
+				NL_BATCH_ACK_HIST_MIN_USEC << i, count);
+		else
+			vty_out(vty, "  >= %-6u usecs:        %" PRIu64 "\n",
+				NL_BATCH_ACK_HIST_MIN_USEC << (i - 1), count);
+	}
 }
 
 int netlink_talk_filter(struct nlmsghdr *h, ns_id_t ns_id, int startup)
@@ -534,7 +745,18 @@ int kernel_dplane_read(struct zebra_dplane_info *info)
  * so that we only have to write one way to handle incoming
  * address add/delete and xxxNETCONF changes.
  */
-static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
+/* Our own sockets whose notifications the inbound sockets filter out */
+#define NL_FILTER_PIDS_MAX (2 + ZEBRA_DPLANE_WORKERS_MAX)
+/* load pid, one compare per pid, load type, 4 type compares, 2 returns */
+#define NL_FILTER_INSNS(npids) ((npids) + 8)
+
+/* pid compares jump over the later ones with an 8 bit offset */
+_Static_assert(NL_FILTER_PIDS_MAX <= 256, "too many pids for BPF jumps");
+_Static_assert(NL_FILTER_INSNS(NL_FILTER_PIDS_MAX) <= BPF_MAXINSNS,
+	       "netlink socket filter too long");
+
+static void netlink_install_filter(int sock, const uint32_t *pids,
+				   unsigned int count)
 {
 	/*
 	 * BPF_JUMP instructions and where you jump to are based upon
@@ -542,70 +764,82 @@ static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
 	 * this down because every time I look at this I have to
 	 * re-remember it.
 	 */
-	struct sock_filter filter[] = {
-		/*
-		 * Logic:
-		 *   if (nlmsg_pid == pid ||
-		 *       nlmsg_pid == dplane_pid) {
-		 *       if (the incoming nlmsg_type ==
-		 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
-		 *           RTM_DELNETCONF)
-		 *           keep this message
-		 *       else
-		 *           skip this message
-		 *   } else
-		 *       keep this netlink message
-		 */
-		/*
-		 * 0: Load the nlmsg_pid into the BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_W,
-			 offsetof(struct nlmsghdr, nlmsg_pid)),
-		/*
-		 * 1: Compare to pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(pid), 1, 0),
-		/*
-		 * 2: Compare to dplane pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(dplane_pid), 0, 6),
-		/*
-		 * 3: Load the nlmsg_type into BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_H,
-			 offsetof(struct nlmsghdr, nlmsg_type)),
-		/*
-		 * 4: Compare to RTM_NEWADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 4, 0),
-		/*
-		 * 5: Compare to RTM_DELADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 3, 0),
-		/*
-		 * 6: Compare to RTM_NEWNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWNETCONF), 2,
-			 0),
-		/*
-		 * 7: Compare to RTM_DELNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELNETCONF), 1,
-			 0),
-		/*
-		 * 8: This is the end state of we want to skip the
-		 *    message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0),
-		/* 9: This is the end state of we want to keep
-		 *     the message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0xffff),
-	};
+	struct sock_filter filter[NL_FILTER_INSNS(NL_FILTER_PIDS_MAX)];
+	struct sock_fprog prog = { .filter = filter };
+	unsigned int i, len = 0;
 
-	struct sock_fprog prog = {
-		.len = array_size(filter), .filter = filter,
-	};
+	assert(count > 0 && count <= NL_FILTER_PIDS_MAX);
+
+	/*
+	 * Logic:
+	 *   if (nlmsg_pid == pids[0] || ... ||
+	 *       nlmsg_pid == pids[count - 1]) {
+	 *       if (the incoming nlmsg_type ==
+	 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
+	 *           RTM_DELNETCONF)
+	 *           keep this message
+	 *       else
+	 *           skip this message
+	 *   } else
+	 *       keep this netlink message
+	 */
+	/*
+	 * 0: Load the nlmsg_pid into the BPF register
+	 */
+	filter[len++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_W, offsetof(struct nlmsghdr, nlmsg_pid));
+	/*
+	 * 1 .. count: Compare to each pid; a match continues at the type
+	 * checks right behind the last comparison, and no match at all
+	 * keeps the message.
+	 */
+	for (i = 0; i < count; i++) {
+		if (i < count - 1)
+			filter[len++] = (struct sock_filter)BPF_JUMP(
+				BPF_JMP | BPF_JEQ | BPF_K, htonl(pids[i]),
+				count - 1 - i, 0);
+		else
+			filter[len++] = (struct sock_filter)BPF_JUMP(
+				BPF_JMP | BPF_JEQ | BPF_K, htonl(pids[i]), 0, 6);
+	}
+	/*
+	 * count + 1: Load the nlmsg_type into BPF register
+	 */
+	filter[len++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_H, offsetof(struct nlmsghdr, nlmsg_type));
+	/*
+	 * count + 2: Compare to RTM_NEWADDR
+	 */
+	filter[len++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 4, 0);
+	/*
+	 * count + 3: Compare to RTM_DELADDR
+	 */
+	filter[len++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 3, 0);
+	/*
+	 * count + 4: Compare to RTM_NEWNETCONF
+	 */
+	filter[len++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWNETCONF), 2, 0);
+	/*
+	 * count + 5: Compare to RTM_DELNETCONF
+	 */
+	filter[len++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELNETCONF), 1, 0);
+	/*
+	 * count + 6: This is the end state of we want to skip the
+	 *            message
+	 */
+	filter[len++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+	/*
+	 * count + 7: This is the end state of we want to keep
+	 *            the message
+	 */
+	filter[len++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffff);
+
+	assert(len == NL_FILTER_INSNS(count));
+	prog.len = len;
 
 	if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))
 	    < 0)
@@ -1288,8 +1522,250 @@ static void nl_batch_reset(struct nl_batch *bth)
 	dplane_ctx_q_init(&(bth->ctx_list));
 }
 
-static void nl_batch_init(struct nl_batch *bth,
+#ifdef HAVE_LIBURING
+/*
+ * The acks of the batches in flight pile up in the socket's receive
+ * buffer; keep them well within it. An ack takes up to about this much.
+ */
+#define NL_URING_ACK_TRUESIZE 1024
+
+static void nl_uring_fini(void)
+{
+	uint32_t i;
+
+	if (!nl_uring)
+		return;
+
+	assert(!nl_uring->count);
+
+	io_uring_queue_exit(&nl_uring->ring);
+	for (i = 0; i < nl_uring->depth; i++)
+		XFREE(MTYPE_NL_URING, nl_uring->slots[i].buf);
+	XFREE(MTYPE_NL_URING, nl_uring);
+}
+
+/*
+ * The calling pthread's io_uring, set up for the current configuration;
+ * NULL if batches are to be sent without it. Once io_uring fails on a
+ * pthread, that pthread does without it from then on.
+ */
+static struct nl_uring *nl_uring_get(size_t bufsize)
+{
+	uint32_t depth = atomic_load_explicit(&nl_batch_uring_depth,
+					      memory_order_relaxed);
+	struct nl_uring *nlu = nl_uring;
+	uint32_t i;
+	int ret;
+
+	if (nlu && (nl_uring_unavailable || nlu->depth != depth ||
+		    nlu->bufsiz != bufsize))
+		nl_uring_fini();
+
+	if (!depth || nl_uring_unavailable)
+		return NULL;
+
+	if (nl_uring)
+		return nl_uring;
+
+	nlu = XCALLOC(MTYPE_NL_URING,
+		      sizeof(*nlu) + depth * sizeof(nlu->slots[0]));
+
+	ret = io_uring_queue_init(depth, &nlu->ring, 0);
+	if (ret < 0) {
+		zlog_warn("%s: io_uring is not available: %s, sending netlink batches without it",
+			  __func__, safe_strerror(-ret));
+		XFREE(MTYPE_NL_URING, nlu);
+		nl_uring_unavailable = true;
+		return NULL;
+	}
+
+	nlu->depth = depth;
+	nlu->bufsiz = bufsize;
+	for (i = 0; i < depth; i++) {
+		nlu->slots[i].buf = XCALLOC(MTYPE_NL_URING, bufsize);
+		dplane_ctx_q_init(&nlu->slots[i].ctx_list);
+	}
+
+	nl_uring = nlu;
+
+	return nlu;
+}
+
+/* Buffer for the batch after those in flight */
+static void *nl_uring_next_buf(const struct nl_uring *nlu)
+{
+	return nlu->slots[(nlu->head + nlu->count) % nlu->depth].buf;
+}
+
+/*
+ * Wait for the batches in flight to be sent, then read the responses to
+ * all of them in one pass.
+ */
+static void nl_uring_reap(struct nl_uring *nlu,
 			  struct dplane_ctx_list_head *ctx_out_q)
+{
+	struct nl_uring_slot *slot;
+	struct io_uring_cqe *cqe;
+	struct zebra_dplane_ctx *ctx;
+	struct nl_batch bth = {};
+	uint32_t i;
+	int ret;
+
+	if (!nlu->count)
+		return;
+
+	for (i = 0; i < nlu->count; i++) {
+		do {
+			ret = io_uring_wait_cqe(&nlu->ring, &cqe);
+		} while (ret == -EINTR);
+
+		if (ret < 0) {
+			flog_err_sys(EC_LIB_SOCKET, "%s: %s io_uring error: %s",
+				     __func__, nlu->nl->name,
+				     safe_strerror(-ret));
+			/* Completions are out of step with the ring now */
+			nl_uring_unavailable = true;
+			break;
+		}
+
+		slot = io_uring_cqe_get_data(cqe);
+		slot->res = cqe->res;
+		io_uring_cqe_seen(&nlu->ring, cqe);
+	}
+
+	bth.zns = nlu->zns;
+	bth.ctx_out_q = ctx_out_q;
+	dplane_ctx_q_init(&bth.ctx_list);
+
+	for (i = 0; i < nlu->count; i++) {
+		slot = &nlu->slots[(nlu->head + i) % nlu->depth];
+
+		if (!nl_uring_unavailable &&
+		    slot->res == (int)slot->iov.iov_len) {
+			dplane_ctx_list_append(&bth.ctx_list, &slot->ctx_list);
+			continue;
+		}
+
+		if (!nl_uring_unavailable)
+			flog_err_sys(EC_LIB_SOCKET, "%s: %s error: %s",
+				     __func__, nlu->nl->name,
+				     slot->res < 0 ? safe_strerror(-slot->res)
+						   : "short send");
+
+		while ((ctx = dplane_ctx_dequeue(&slot->ctx_list)) != NULL) {
+			dplane_ctx_set_status(ctx,
+					      ZEBRA_DPLANE_REQUEST_FAILURE);
+			dplane_ctx_enqueue_tail(ctx_out_q, ctx);
+		}
+	}
+
+	nlu->head = (nlu->head + nlu->count) % nlu->depth;
+	nlu->count = 0;
+	nlu->msgcnt = 0;
+
+	/* This moves every context on to ctx_out_q */
+	if (dplane_ctx_queue_count(&bth.ctx_list))
+		nl_batch_read_resp(&bth, nlu->nl);
+}
+
+/*
+ * Hand a batch to io_uring; its responses are read once more batches are
+ * in flight. Returns false if the batch is to be sent the plain way.
+ */
+static bool nl_uring_send(struct nl_batch *bth, struct nlsock *nl)
+{
+	struct nl_uring *nlu = bth->uring;
+	struct nl_uring_slot *slot;
+	struct io_uring_sqe *sqe;
+	struct timeval start;
+	size_t ack_max;
+	int ret;
+
+	/* Responses are read per socket */
+	if (nlu->count && nlu->nl != nl) {
+		nl_uring_reap(nlu, bth->ctx_out_q);
+		if (nl_uring_unavailable)
+			return false;
+	}
+
+	slot = &nlu->slots[(nlu->head + nlu->count) % nlu->depth];
+	assert(slot->buf == bth->buf);
+
+	memset(&slot->snl, 0, sizeof(slot->snl));
+	slot->snl.nl_family = AF_NETLINK;
+	slot->iov.iov_base = bth->buf;
+	slot->iov.iov_len = bth->curlen;
+	memset(&slot->msg, 0, sizeof(slot->msg));
+	slot->msg.msg_name = &slot->snl;
+	slot->msg.msg_namelen = sizeof(slot->snl);
+	slot->msg.msg_iov = &slot->iov;
+	slot->msg.msg_iovlen = 1;
+
+	/* Every batch is submitted right away, so there's always room */
+	sqe = io_uring_get_sqe(&nlu->ring);
+	assert(sqe);
+	io_uring_prep_sendmsg(sqe, nl->sock, &slot->msg, 0);
+	io_uring_sqe_set_data(sqe, slot);
+
+	/*
+	 * The kernel carries out netlink requests within the send and checks
+	 * the sender's capabilities. A send on a non-blocking socket is
+	 * issued right from the submission, so raise privileges around it
+	 * as around a plain sendmsg().
+	 */
+	monotime(&start);
+	frr_with_privs (&zserv_privs) {
+		ret = io_uring_submit(&nlu->ring);
+	}
+
+	if (ret < 0) {
+		flog_err_sys(EC_LIB_SOCKET, "%s: %s io_uring submit error: %s",
+			     __func__, nl->name, safe_strerror(-ret));
+
+		/* Finish the batches in flight; this one goes the plain way */
+		nl_uring_reap(nlu, bth->ctx_out_q);
+		nl_uring_unavailable = true;
+		return false;
+	}
+
+	if (IS_ZEBRA_DEBUG_KERNEL_MSGDUMP_SEND) {
+		zlog_debug("%s: >> netlink message dump [sent]", __func__);
+#ifdef NETLINK_DEBUG
+		nl_dump(bth->buf, bth->curlen);
+#else
+		zlog_hexdump(bth->buf, bth->curlen);
+#endif /* NETLINK_DEBUG */
+	}
+
+	/* The kernel went through the batch within the submission */
+	nl_batch_account(bth->curlen, bth->msgcnt, monotime_since(&start, NULL));
+
+	dplane_ctx_list_append(&slot->ctx_list, &bth->ctx_list);
+	nlu->nl = nl;
+	nlu->zns = bth->zns;
+	nlu->count++;
+	nlu->msgcnt += bth->msgcnt;
+
+	/* Configured receive buffer size; the kernel grants twice that */
+	ack_max = (rcvbufsize ? rcvbufsize : NL_RCV_PKT_BUF_SIZE) /
+		  NL_URING_ACK_TRUESIZE;
+
+	if (nlu->count == nlu->depth || nlu->msgcnt >= ack_max)
+		nl_uring_reap(nlu, bth->ctx_out_q);
+
+	/* If the ring broke, the slot buffer lives on until the next init */
+	if (!nl_uring_unavailable)
+		bth->buf = nl_uring_next_buf(nlu);
+
+	nl_batch_reset(bth);
+
+	return true;
+}
+#endif /* HAVE_LIBURING */
+
+static void nl_batch_init(struct nl_batch *bth,
+			  struct dplane_ctx_list_head *ctx_out_q,
+			  uint32_t pending)
 {
 	/*
 	 * If the size of the buffer has changed, free and then allocate a new
@@ -1297,6 +1773,17 @@ static void nl_batch_init(struct nl_batch *bth,
 	 */
 	size_t bufsize =
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
+	size_t limit = nl_batch_threshold(pending);
+
+	/*
+	 * An adaptive threshold takes the buffer along, leaving room for one
+	 * more message.  That buffer only grows, so a threshold going back
+	 * and forth doesn't reallocate it every time.
+	 */
+	if (!atomic_load_explicit(&nl_batch_fixed, memory_order_relaxed))
+		bufsize = MAX(bufsize, MAX(limit + NL_PKT_BUF_SIZE,
+					   nl_batch_tx_bufsize));
+
 	if (bufsize != nl_batch_tx_bufsize) {
 		if (nl_batch_tx_buf)
 			XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
@@ -1307,8 +1794,13 @@ static void nl_batch_init(struct nl_batch *bth,
 
 	bth->buf = nl_batch_tx_buf;
 	bth->bufsiz = bufsize;
-	bth->limit = atomic_load_explicit(&nl_batch_send_threshold,
-					  memory_order_relaxed);
+	bth->limit = limit;
+
+#ifdef HAVE_LIBURING
+	bth->uring = nl_uring_get(bufsize);
+	if (bth->uring)
+		bth->buf = nl_uring_next_buf(bth->uring);
+#endif
 
 	bth->ctx_out_q = ctx_out_q;
 
@@ -1318,6 +1810,7 @@ static void nl_batch_init(struct nl_batch *bth,
 static void nl_batch_send(struct nl_batch *bth)
 {
 	struct zebra_dplane_ctx *ctx;
+	struct timeval start;
 	bool err = false;
 
 	if (bth->curlen != 0 && bth->zns != NULL) {
@@ -1329,6 +1822,14 @@ static void nl_batch_send(struct nl_batch *bth)
 				   __func__, nl->name, bth->curlen,
 				   bth->msgcnt);
 
+#ifdef HAVE_LIBURING
+		if (bth->uring && !nl_uring_unavailable &&
+		    nl_uring_send(bth, nl))
+			return;
+#endif
+
+		monotime(&start);
+
 		if (netlink_send_msg(nl, bth->buf, bth->curlen) == -1)
 			err = true;
 
@@ -1336,6 +1837,9 @@ static void nl_batch_send(struct nl_batch *bth)
 			if (nl_batch_read_resp(bth, nl) == -1)
 				err = true;
 		}
+
+		nl_batch_account(bth->curlen, bth->msgcnt,
+				 monotime_since(&start, NULL));
 	}
 
 	/* Move remaining contexts to the outbound queue. */
@@ -1509,6 +2013,16 @@ static enum netlink_msg_status nl_put_msg(struct nl_batch *bth,
 	return FRR_NETLINK_ERROR;
 }
 
+void kernel_update_multi_fini(void)
+{
+	XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
+	nl_batch_tx_bufsize = 0;
+
+#ifdef HAVE_LIBURING
+	nl_uring_fini();
+#endif
+}
+
 void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 {
 	struct nl_batch batch;
@@ -1517,7 +2031,7 @@ void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 	enum netlink_msg_status res;
 
 	dplane_ctx_q_init(&handled_list);
-	nl_batch_init(&batch, &handled_list);
+	nl_batch_init(&batch, &handled_list, dplane_ctx_queue_count(ctx_list));
 
 	while (true) {
 		ctx = dplane_ctx_dequeue(ctx_list);
@@ -1547,6 +2061,12 @@ void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 
 	nl_batch_send(&batch);
 
+#ifdef HAVE_LIBURING
+	/* Collect the responses to the batches still in flight */
+	if (batch.uring)
+		nl_uring_reap(batch.uring, batch.ctx_out_q);
+#endif
+
 	dplane_ctx_q_init(ctx_list);
 	dplane_ctx_list_append(ctx_list, &handled_list);
 }
@@ -1600,9 +2120,18 @@ static bool kernel_netlink_nlsock_hash_equal(const void *arg1, const void *arg2)
 
 /* Exported interface function.  This function simply calls
    netlink_socket (). */
+/* Outgoing sockets for the kernel dplane provider's workers, if any */
+static unsigned int kernel_dplane_workers(void)
+{
+	return zrouter.dplane_workers > 1 ? zrouter.dplane_workers : 0;
+}
+
 void kernel_init(struct zebra_ns *zns)
 {
 	uint32_t groups, dplane_groups, ext_groups;
+	uint32_t pids[NL_FILTER_PIDS_MAX];
+	unsigned int i, npids = 0;
+	struct nlsock *nls;
 #if defined SOL_NETLINK
 	int one, ret, grp;
 #endif
@@ -1683,6 +2212,24 @@ void kernel_init(struct zebra_ns *zns)
 
 	kernel_netlink_nlsock_insert(&zns->netlink_dplane_in);
 
+	/* Outbound sockets of the dplane workers, one each */
+	for (i = 0; i < ZEBRA_DPLANE_WORKERS_MAX; i++) {
+		nls = &zns->netlink_dplane_worker[i];
+		nls->sock = -1;
+		if (i >= kernel_dplane_workers())
+			continue;
+
+		snprintf(nls->name, sizeof(nls->name), "netlink-dp-w%u (NS %u)",
+			 i, zns->ns_id);
+		if (netlink_socket(nls, 0, 0, 0, zns->ns_id, NETLINK_ROUTE) < 0) {
+			flog_err(EC_LIB_SOCKET, "Failure to create %s socket",
+				 nls->name);
+			frr_exit_with_buffer_flush(-1);
+		}
+
+		kernel_netlink_nlsock_insert(nls);
+	}
+
 	/* Generic Netlink socket. */
 	snprintf(zns->ge_netlink_cmd.name, sizeof(zns->ge_netlink_cmd.name),
 		 "generic-netlink-cmd (NS %u)", zns->ns_id);
@@ -1734,6 +2281,15 @@ void kernel_init(struct zebra_ns *zns)
 		zlog_notice("Registration for extended dp ACK failed : %d %s",
 			    errno, safe_strerror(errno));
 
+	for (i = 0; i < kernel_dplane_workers(); i++) {
+		one = 1;
+		ret = setsockopt(zns->netlink_dplane_worker[i].sock, SOL_NETLINK,
+				 NETLINK_EXT_ACK, &one, sizeof(one));
+		if (ret < 0)
+			zlog_notice("Registration for extended dp worker ACK failed : %d %s",
+				    errno, safe_strerror(errno));
+	}
+
 	if (zns->ge_netlink_cmd.sock >= 0) {
 		one = 1;
 		ret = setsockopt(zns->ge_netlink_cmd.sock, SOL_NETLINK,
@@ -1755,6 +2311,12 @@ void kernel_init(struct zebra_ns *zns)
 	if (ret < 0)
 		zlog_notice(
 			"Registration for reduced ACK packet size failed, probably running an early kernel");
+
+	for (i = 0; i < kernel_dplane_workers(); i++) {
+		one = 1;
+		setsockopt(zns->netlink_dplane_worker[i].sock, SOL_NETLINK,
+			   NETLINK_CAP_ACK, &one, sizeof(one));
+	}
 #endif
 
 	/* Register kernel socket. */
@@ -1774,6 +2336,13 @@ void kernel_init(struct zebra_ns *zns)
 		flog_err(EC_LIB_SOCKET, "Can't set %s socket error: %s(%d)",
 			 zns->netlink_dplane_in.name, safe_strerror(errno), errno);
 
+	for (i = 0; i < kernel_dplane_workers(); i++) {
+		nls = &zns->netlink_dplane_worker[i];
+		if (fcntl(nls->sock, F_SETFL, O_NONBLOCK) < 0)
+			flog_err(EC_LIB_SOCKET, "Can't set %s socket error: %s(%d)",
+				 nls->name, safe_strerror(errno), errno);
+	}
+
 	if (zns->ge_netlink_cmd.sock >= 0) {
 		if (fcntl(zns->ge_netlink_cmd.sock, F_SETFL, O_NONBLOCK) < 0)
 			flog_err(EC_LIB_SOCKET, "Can't set %s socket error: %s(%d)",
@@ -1787,6 +2356,10 @@ void kernel_init(struct zebra_ns *zns)
 		netlink_recvbuf(&zns->netlink_dplane_out, rcvbufsize);
 		netlink_recvbuf(&zns->netlink_dplane_in, rcvbufsize);
 
+		for (i = 0; i < kernel_dplane_workers(); i++)
+			netlink_recvbuf(&zns->netlink_dplane_worker[i],
+					rcvbufsize);
+
 		if (zns->ge_netlink_cmd.sock >= 0)
 			netlink_recvbuf(&zns->ge_netlink_cmd, rcvbufsize);
 	}
@@ -1794,12 +2367,14 @@ void kernel_init(struct zebra_ns *zns)
 	/* Set filter for inbound sockets, to exclude events we've generated
 	 * ourselves.
 	 */
-	netlink_install_filter(zns->netlink.sock, zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	pids[npids++] = zns->netlink_cmd.snl.nl_pid;
+	pids[npids++] = zns->netlink_dplane_out.snl.nl_pid;
+	for (i = 0; i < kernel_dplane_workers(); i++)
+		pids[npids++] = zns->netlink_dplane_worker[i].snl.nl_pid;
+
+	netlink_install_filter(zns->netlink.sock, pids, npids);
 
-	netlink_install_filter(zns->netlink_dplane_in.sock,
-			       zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	netlink_install_filter(zns->netlink_dplane_in.sock, pids, npids);
 
 	zns->t_netlink = NULL;
 
@@ -1825,6 +2400,8 @@ static void kernel_nlsock_fini(struct nlsock *nls)
 
 void kernel_terminate(struct zebra_ns *zns, bool complete)
 {
+	unsigned int i;
+
 	event_cancel(&zns->t_netlink);
 
 	kernel_nlsock_fini(&zns->netlink);
@@ -1838,8 +2415,12 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
 	/* During zebra shutdown, we need to leave the dataplane socket
 	 * around until all work is done.
 	 */
-	if (complete)
+	if (complete) {
 		kernel_nlsock_fini(&zns->netlink_dplane_out);
+
+		for (i = 0; i < ZEBRA_DPLANE_WORKERS_MAX; i++)
+			kernel_nlsock_fini(&zns->netlink_dplane_worker[i]);
+	}
 }
 
 /*
@@ -1859,8 +2440,6 @@ void kernel_router_init(void)
  */
 void kernel_router_terminate(void)
 {
-	XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
-
 	pthread_mutex_destroy(&nlsock_mutex);
 
 	hash_free(nlsock_hash);
@@ -94,6 +94,17 @@ extern int netlink_config_write_helper(struct vty *vty);
 extern void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold,
 					  bool set);
 
+#ifdef HAVE_LIBURING
+/*
+ * Send batches through io_uring, keeping up to 'depth' of them in flight,
+ * or 0 for the default. If 'unset', batches are sent one at a time.
+ */
+extern void netlink_set_batch_uring(uint32_t depth, bool set);
+#endif
+
+/* Batch sizing and kernel ack latency, for "show zebra dplane" */
+extern void netlink_batch_show(struct vty *vty);
+
 extern struct nlsock *kernel_netlink_nlsock_lookup(int sock);
 
 #ifdef __cplusplus
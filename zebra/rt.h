@@ -113,6 +113,12 @@ extern int kernel_del_mac_nhg(uint32_t nhg_id);
  */
 extern void kernel_update_multi(struct dplane_ctx_list_head *ctx_list);
 
+/*
+ * Release what kernel_update_multi() keeps around for the calling pthread;
+ * called by each pthread that used it, before it exits.
+ */
+extern void kernel_update_multi_fini(void);
+
 /*
  * Called by the dplane pthread to read incoming OS messages and dispatch them.
  */
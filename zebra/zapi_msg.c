@@ -2140,6 +2140,25 @@ static void zread_nhg_add(ZAPI_HANDLER_ARGS)
 		client->nhg_add_cnt++;
 }
 
+static void zread_route_add_stats(struct zserv *client, uint8_t family,
+				  int ret)
+{
+	switch (family) {
+	case AF_INET:
+		if (ret == 0)
+			client->v4_route_add_cnt++;
+		else if (ret == 1)
+			client->v4_route_upd8_cnt++;
+		break;
+	case AF_INET6:
+		if (ret == 0)
+			client->v6_route_add_cnt++;
+		else if (ret == 1)
+			client->v6_route_upd8_cnt++;
+		break;
+	}
+}
+
 static void zread_route_add(ZAPI_HANDLER_ARGS)
 {
 	struct stream *s;
@@ -2276,21 +2295,129 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	if (bnhg)
 		zebra_nhg_backup_free(&bnhg);
 
-	/* Stats */
-	switch (api.prefix.family) {
-	case AF_INET:
-		if (ret == 0)
-			client->v4_route_add_cnt++;
-		else if (ret == 1)
-			client->v4_route_upd8_cnt++;
-		break;
-	case AF_INET6:
-		if (ret == 0)
-			client->v6_route_add_cnt++;
-		else if (ret == 1)
-			client->v6_route_upd8_cnt++;
-		break;
+	zread_route_add_stats(client, api.prefix.family, ret);
+}
+
+/*
+ * Many prefixes with one set of nexthops and attributes: decode and
+ * resolve the nexthops once, and only copy them for each route.
+ */
+static void zread_route_add_bulk(ZAPI_HANDLER_ARGS)
+{
+	struct stream *s;
+	struct zapi_route api;
+	afi_t afi;
+	struct prefix_ipv6 *src_p = NULL;
+	struct route_entry *re;
+	struct nexthop_group *ng = NULL;
+	struct nhg_backup_info *bnhg = NULL;
+	int ret;
+	vrf_id_t vrf_id;
+	struct nhg_hash_entry nhe, *n;
+	uint16_t count;
+	uint32_t i;
+
+	s = msg;
+	if (zapi_route_bulk_decode(s, &api, &count) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route sent",
+				   __func__);
+		return;
 	}
+
+	vrf_id = zvrf_id(zvrf);
+
+	if (IS_ZEBRA_DEBUG_RECV)
+		zlog_debug("%s: p=(%s:%u)%pFX and %u more, msg flags=0x%x, flags=0x%x",
+			   __func__, zvrf_name(zvrf), api.tableid, &api.prefix,
+			   count, (int)api.message, api.flags);
+
+	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NHG)
+	    && (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP)
+		|| api.nexthop_num == 0)) {
+		flog_warn(EC_ZEBRA_RX_ROUTE_NO_NEXTHOPS,
+			  "%s: received routes without nexthops for prefix (%s:%u)%pFX and %u more from client %s",
+			  __func__, zvrf_name(zvrf), api.tableid, &api.prefix,
+			  count, zebra_route_string(client->proto));
+		return;
+	}
+
+	afi = family2afi(api.prefix.family);
+	if (afi != AFI_IP6 && CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX)) {
+		flog_warn(EC_ZEBRA_RX_SRCDEST_WRONG_AFI,
+			  "%s: Received SRC Prefix but afi is not v6",
+			  __func__);
+		return;
+	}
+	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX))
+		src_p = &api.src_prefix;
+
+	if (api.safi != SAFI_UNICAST && api.safi != SAFI_MULTICAST) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: Received safi: %d but we can only accept UNICAST or MULTICAST",
+			  __func__, api.safi);
+		return;
+	}
+
+	/* as re->nhe_id below */
+	if (!api.nhgid
+	    && (!zapi_read_nexthops(client, &api.prefix, api.nexthops,
+				    api.flags, api.message, api.nexthop_num,
+				    api.backup_nexthop_num, &ng, NULL)
+		|| !zapi_read_nexthops(client, &api.prefix, api.backup_nexthops,
+				       api.flags, api.message,
+				       api.backup_nexthop_num,
+				       api.backup_nexthop_num, NULL, &bnhg))) {
+		nexthop_group_delete(&ng);
+		zebra_nhg_backup_free(&bnhg);
+		return;
+	}
+
+	for (i = 0; i <= count; i++) {
+		if (i && zapi_route_bulk_decode_prefix(s, &api.prefix) < 0) {
+			if (IS_ZEBRA_DEBUG_RECV)
+				zlog_debug("%s: Unable to decode prefix %u of %u",
+					   __func__, i, count);
+			break;
+		}
+
+		re = zebra_rib_route_entry_new(vrf_id, api.type, api.instance,
+					       api.flags, api.nhgid,
+					       api.tableid ? api.tableid
+							   : zvrf->table_id,
+					       api.metric, api.mtu,
+					       api.distance, api.tag);
+
+		if (CHECK_FLAG(api.message, ZAPI_MESSAGE_OPAQUE)) {
+			re->opaque = XMALLOC(MTYPE_RE_OPAQUE,
+					     sizeof(struct re_opaque) +
+						     api.opaque.length);
+			re->opaque->length = api.opaque.length;
+			memcpy(re->opaque->data, api.opaque.data,
+			       re->opaque->length);
+		}
+
+		/* each route owns its copy, as in zread_route_add() */
+		n = NULL;
+		if (!re->nhe_id) {
+			zebra_nhe_init(&nhe, afi, ng->nexthop);
+			nhe.nhg.nexthop = ng->nexthop;
+			nhe.backup_info = bnhg;
+			n = zebra_nhe_copy(&nhe, 0);
+		}
+		ret = rib_add_multipath_nhe(afi, api.safi, &api.prefix, src_p,
+					    re, n, false, true);
+		if (ret == -1) {
+			client->error_cnt++;
+			zebra_rib_route_entry_free(re);
+		}
+
+		zread_route_add_stats(client, api.prefix.family, ret);
+	}
+
+	nexthop_group_delete(&ng);
+	if (bnhg)
+		zebra_nhg_backup_free(&bnhg);
 }
 
 void zapi_re_opaque_free(struct route_entry *re)
@@ -2454,6 +2581,8 @@ static void zsend_capabilities(struct zserv *client, struct zebra_vrf *zvrf)
 	stream_putc(s, zebra_mlag_get_role());
 	stream_putc(s, zrouter.zav.v6_with_v4_nexthop);
 	stream_putc(s, zrouter.graceful_restart);
+	/* ZEBRA_ROUTE_ADD_BULK is understood */
+	stream_putc(s, 1);
 	stream_putw_at(s, 0, stream_get_endp(s));
 	zserv_send_message(client, s);
 }
@@ -2515,6 +2644,27 @@ stream_failure:
 	return;
 }
 
+/* Move the client's messages from the socket to a shared-memory ring */
+static void zread_zapi_ring(ZAPI_HANDLER_ARGS)
+{
+	uint8_t op;
+
+	STREAM_GETC(msg, op);
+
+	switch (op) {
+	case ZAPI_RING_OFFER:
+		zserv_ring_offer(client);
+		break;
+	case ZAPI_RING_START:
+		zserv_ring_start(client);
+		break;
+	default:
+		break;
+	}
+stream_failure:
+	return;
+}
+
 /*
  * Validate incoming zapi mpls lsp / labels message
  */
@@ -4159,6 +4309,7 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_INTERFACE_DELETE] = zread_interface_delete,
 	[ZEBRA_INTERFACE_SET_PROTODOWN] = zread_interface_set_protodown,
 	[ZEBRA_ROUTE_ADD] = zread_route_add,
+	[ZEBRA_ROUTE_ADD_BULK] = zread_route_add_bulk,
 	[ZEBRA_ROUTE_DELETE] = zread_route_del,
 	[ZEBRA_REDISTRIBUTE_ADD] = zebra_redistribute_add,
 	[ZEBRA_REDISTRIBUTE_DELETE] = zebra_redistribute_delete,
@@ -4166,6 +4317,7 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_REDISTRIBUTE_DEFAULT_DELETE] = zebra_redistribute_default_delete,
 	[ZEBRA_NEXTHOP_LOOKUP] = zread_nexthop_lookup,
 	[ZEBRA_HELLO] = zread_hello,
+	[ZEBRA_ZAPI_RING] = zread_zapi_ring,
 	[ZEBRA_NEXTHOP_REGISTER] = zread_rnh_register,
 	[ZEBRA_NEXTHOP_UNREGISTER] = zread_rnh_unregister,
 	[ZEBRA_BFD_DEST_UPDATE] = zebra_ptm_bfd_dst_register,
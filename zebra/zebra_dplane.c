@@ -15,9 +15,11 @@
 #include "lib/lib_errors.h"
 #include "lib/frratomic.h"
 #include "lib/frr_pthread.h"
+#include "lib/jhash.h"
 #include "lib/memory.h"
 #include "lib/zebra.h"
 #include "zebra/netconf_netlink.h"
+#include "zebra/kernel_netlink.h"
 #include "zebra/zebra_router.h"
 #include "zebra/zebra_dplane.h"
 #include "zebra/zebra_vxlan_private.h"
@@ -539,9 +541,19 @@ DECLARE_DLIST(dplane_prov_list, struct zebra_dplane_provider, dp_link);
 /* Declare types for list of zns info objects */
 PREDECL_DLIST(zns_info_list);
 
+/* Outbound sockets of a zns, as used by the kernel provider's workers */
+struct dplane_kernel_ns {
+	ns_id_t ns_id;
+	int out_sock;
+	int sock[ZEBRA_DPLANE_WORKERS_MAX];
+};
+
 struct dplane_zns_info {
 	struct zebra_dplane_info info;
 
+	/* Sockets for route updates */
+	struct dplane_kernel_ns kernel;
+
 	/* Request data from the OS */
 	struct event *t_request;
 
@@ -574,9 +586,16 @@ static struct zebra_dplane_globals {
 	/* Ordered list of providers */
 	struct dplane_prov_list_head dg_providers;
 
-	/* List of info about each zns */
+	/* List of info about each zns; main pthread only */
 	struct zns_info_list_head dg_zns_list;
 
+	/*
+	 * Copy of the zns sockets kept up to date by the main pthread, for
+	 * the kernel provider's workers; protected by dg_mutex
+	 */
+	struct dplane_kernel_ns *dg_kernel_ns;
+	uint32_t dg_kernel_ns_count;
+
 	/* Counter used to assign internal ids to providers */
 	uint32_t dg_provider_id;
 
@@ -684,6 +703,7 @@ DECLARE_DLIST(zns_info_list, struct dplane_zns_info, link);
 
 /* Prototypes */
 static void dplane_thread_loop(struct event *event);
+static void dplane_kernel_pool_show(struct vty *vty);
 static enum zebra_dplane_result lsp_update_internal(struct zebra_lsp *lsp,
 						    enum dplane_op_e op);
 static enum zebra_dplane_result pw_update_internal(struct zebra_pw *pw,
@@ -6340,6 +6360,10 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 	vty_out(vty, "Route update queue max:   %"PRIu64"\n", queue_max);
 	vty_out(vty, "Route updates skipped:    %" PRIu64 "\n", kernels_skipped);
 	vty_out(vty, "Dplane update yields:     %"PRIu64"\n", yields);
+	dplane_kernel_pool_show(vty);
+#if defined(HAVE_NETLINK)
+	netlink_batch_show(vty);
+#endif
 
 	incoming = atomic_load_explicit(&zdplane_info.dg_lsps_in,
 					memory_order_relaxed);
@@ -6747,6 +6771,31 @@ static void dplane_kernel_info_request(struct dplane_zns_info *zi)
 
 #endif /* HAVE_NETLINK */
 
+/*
+ * Main pthread: publish the zns sockets for the kernel provider's workers,
+ * which must not walk dg_zns_list themselves.
+ */
+static void dplane_kernel_ns_publish(void)
+{
+	struct dplane_kernel_ns *kns;
+	struct dplane_zns_info *zi;
+	uint32_t count = 0;
+
+	kns = XCALLOC(MTYPE_DP_NS,
+		      (zns_info_list_count(&zdplane_info.dg_zns_list) + 1) *
+			      sizeof(*kns));
+	frr_each (zns_info_list, &zdplane_info.dg_zns_list, zi)
+		kns[count++] = zi->kernel;
+
+	DPLANE_LOCK();
+	{
+		XFREE(MTYPE_DP_NS, zdplane_info.dg_kernel_ns);
+		zdplane_info.dg_kernel_ns = kns;
+		zdplane_info.dg_kernel_ns_count = count;
+	}
+	DPLANE_UNLOCK();
+}
+
 /*
  * Notify dplane when namespaces are enabled and disabled. The dplane
  * needs to start and stop reading incoming events from the zns. In the
@@ -6758,6 +6807,9 @@ static void dplane_kernel_info_request(struct dplane_zns_info *zi)
 void zebra_dplane_ns_enable(struct zebra_ns *zns, bool enabled)
 {
 	struct dplane_zns_info *zi;
+#if defined(HAVE_NETLINK)
+	unsigned int i;
+#endif
 
 	if (IS_ZEBRA_DEBUG_DPLANE)
 		zlog_debug("%s: %s for nsid %u", __func__,
@@ -6788,6 +6840,11 @@ void zebra_dplane_ns_enable(struct zebra_ns *zns, bool enabled)
 		zi->info.is_cmd = false;
 		zi->info.sock = zns->netlink_dplane_in.sock;
 
+		zi->kernel.ns_id = zns->ns_id;
+		zi->kernel.out_sock = zns->netlink_dplane_out.sock;
+		for (i = 0; i < ZEBRA_DPLANE_WORKERS_MAX; i++)
+			zi->kernel.sock[i] = zns->netlink_dplane_worker[i].sock;
+
 		/* Initiate requests for existing info from the OS, and
 		 * begin reading from the netlink socket.
 		 */
@@ -6812,6 +6869,8 @@ void zebra_dplane_ns_enable(struct zebra_ns *zns, bool enabled)
 
 		XFREE(MTYPE_DP_NS, zi);
 	}
+
+	dplane_kernel_ns_publish();
 }
 
 /*
@@ -7249,6 +7308,362 @@ kernel_dplane_process_ipset_entry(struct zebra_dplane_provider *prov,
 	dplane_provider_enqueue_out_ctx(prov, ctx);
 }
 
+/*
+ * Kernel provider workers. With more than one configured, runs of route
+ * updates are spread over a pool of pthreads, each of which has its own
+ * outbound netlink socket in every zns. Updates are sharded by zns, table
+ * and prefix, so all updates to one route are made in order by a single
+ * worker. Every other kind of update is a barrier: it is only handled, on
+ * the dplane pthread, once the route updates before it are done.
+ */
+
+/* Shards per worker; the spares are there for idle workers to steal */
+#define DPLANE_KERNEL_SHARDS_PER_WORKER 4
+
+/* Shorter runs are not worth handing out */
+#define DPLANE_KERNEL_PARALLEL_MIN 64
+
+struct dplane_kernel_shard {
+	struct dplane_ctx_list_head ctx_list;
+
+	/* Set by the worker that takes the shard */
+	atomic_bool taken;
+};
+
+struct dplane_kernel_worker {
+	struct frr_pthread *pthread;
+	uint32_t id;
+
+	/* Counters */
+	_Atomic uint32_t updates;
+	_Atomic uint32_t shards;
+	_Atomic uint32_t steals;
+};
+
+static struct dplane_kernel_pool {
+	uint32_t count;
+	struct dplane_kernel_worker workers[ZEBRA_DPLANE_WORKERS_MAX];
+
+	uint32_t shard_count;
+	struct dplane_kernel_shard shards[ZEBRA_DPLANE_WORKERS_MAX *
+					  DPLANE_KERNEL_SHARDS_PER_WORKER];
+
+	/* Copy of the zns sockets, stable while a run is out */
+	struct dplane_kernel_ns *ns;
+	uint32_t ns_count;
+	uint32_t ns_size;
+
+	/* Number of workers still busy with the current run */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	uint32_t busy;
+
+	_Atomic uint32_t runs;
+} dplane_kernel_pool;
+
+/* Wraps the pthread loop of the dplane pthread and of the workers */
+static void *dplane_pthread_start(void *arg)
+{
+	void *ret = frr_pthread_attr_default.start(arg);
+
+	kernel_update_multi_fini();
+
+	return ret;
+}
+
+static void dplane_kernel_pool_start(void)
+{
+	struct dplane_kernel_pool *pool = &dplane_kernel_pool;
+	struct frr_pthread_attr pattr = {
+		.start = dplane_pthread_start,
+		.stop = frr_pthread_attr_default.stop
+	};
+	char name[32], os_name[OS_THREAD_NAMELEN];
+	uint32_t i;
+
+	if (zrouter.dplane_workers < 2)
+		return;
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+
+	for (i = 0; i < zrouter.dplane_workers; i++) {
+		snprintf(name, sizeof(name), "Zebra dplane worker %u", i);
+		snprintf(os_name, sizeof(os_name), "zebra_dp_w%u", i);
+
+		pool->workers[i].id = i;
+		pool->workers[i].pthread = frr_pthread_new(&pattr, name,
+							   os_name);
+		frr_pthread_run(pool->workers[i].pthread, NULL);
+		frr_pthread_wait_running(pool->workers[i].pthread);
+	}
+
+	pool->shard_count = i * DPLANE_KERNEL_SHARDS_PER_WORKER;
+	for (i = 0; i < pool->shard_count; i++)
+		dplane_ctx_list_init(&pool->shards[i].ctx_list);
+
+	pool->count = zrouter.dplane_workers;
+}
+
+static void dplane_kernel_pool_stop(void)
+{
+	struct dplane_kernel_pool *pool = &dplane_kernel_pool;
+	uint32_t i;
+
+	if (!pool->count)
+		return;
+
+	for (i = 0; i < pool->count; i++) {
+		frr_pthread_stop(pool->workers[i].pthread, NULL);
+		frr_pthread_destroy(pool->workers[i].pthread);
+		pool->workers[i].pthread = NULL;
+	}
+	pool->count = 0;
+
+	XFREE(MTYPE_DP_NS, pool->ns);
+	pool->ns_count = 0;
+	pool->ns_size = 0;
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->mutex);
+}
+
+static void dplane_kernel_pool_show(struct vty *vty)
+{
+	struct dplane_kernel_worker *worker;
+	uint32_t i;
+
+	if (!dplane_kernel_pool.count)
+		return;
+
+	vty_out(vty, "Kernel workers:           %u\n", dplane_kernel_pool.count);
+	vty_out(vty, "Kernel parallel runs:     %u\n",
+		atomic_load_explicit(&dplane_kernel_pool.runs,
+				     memory_order_relaxed));
+
+	for (i = 0; i < dplane_kernel_pool.count; i++) {
+		worker = &dplane_kernel_pool.workers[i];
+		vty_out(vty, "  Worker %-2u updates: %u, shards: %u, stolen: %u\n",
+			i,
+			atomic_load_explicit(&worker->updates,
+					     memory_order_relaxed),
+			atomic_load_explicit(&worker->shards,
+					     memory_order_relaxed),
+			atomic_load_explicit(&worker->steals,
+					     memory_order_relaxed));
+	}
+}
+
+/*
+ * Take a copy of the zns sockets published by the main pthread for the
+ * workers; dplane pthread only
+ */
+static void dplane_kernel_ns_refresh(void)
+{
+	struct dplane_kernel_pool *pool = &dplane_kernel_pool;
+
+	DPLANE_LOCK();
+	{
+		if (zdplane_info.dg_kernel_ns_count > pool->ns_size) {
+			pool->ns = XREALLOC(MTYPE_DP_NS, pool->ns,
+					    zdplane_info.dg_kernel_ns_count *
+						    sizeof(*pool->ns));
+			pool->ns_size = zdplane_info.dg_kernel_ns_count;
+		}
+
+		pool->ns_count = zdplane_info.dg_kernel_ns_count;
+		if (pool->ns_count)
+			memcpy(pool->ns, zdplane_info.dg_kernel_ns,
+			       pool->ns_count * sizeof(*pool->ns));
+	}
+	DPLANE_UNLOCK();
+}
+
+static const struct dplane_kernel_ns *dplane_kernel_ns_find(ns_id_t ns_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < dplane_kernel_pool.ns_count; i++)
+		if (dplane_kernel_pool.ns[i].ns_id == ns_id)
+			return &dplane_kernel_pool.ns[i];
+
+	return NULL;
+}
+
+static bool dplane_kernel_ctx_is_route(const struct zebra_dplane_ctx *ctx)
+{
+	return ctx->zd_op == DPLANE_OP_ROUTE_INSTALL ||
+	       ctx->zd_op == DPLANE_OP_ROUTE_UPDATE ||
+	       ctx->zd_op == DPLANE_OP_ROUTE_DELETE;
+}
+
+static uint32_t dplane_kernel_ctx_shard(const struct zebra_dplane_ctx *ctx)
+{
+	uint32_t key;
+
+	key = jhash_2words(prefix_hash_key(&ctx->u.rinfo.zd_dest),
+			   ctx->zd_table_id, ctx->zd_ns_info.ns_id);
+
+	return key % dplane_kernel_pool.shard_count;
+}
+
+/* Worker pthread: send one shard through this worker's sockets */
+static void dplane_kernel_worker_update(struct dplane_kernel_worker *worker,
+					struct dplane_ctx_list_head *ctx_list)
+{
+	const struct dplane_kernel_ns *kns;
+	struct zebra_dplane_ctx *ctx;
+	uint32_t count = 0;
+
+	frr_each (dplane_ctx_list, ctx_list, ctx) {
+		kns = dplane_kernel_ns_find(ctx->zd_ns_info.ns_id);
+		ctx->zd_ns_info.sock = kns->sock[worker->id];
+		count++;
+	}
+
+	kernel_update_multi(ctx_list);
+
+	frr_each (dplane_ctx_list, ctx_list, ctx) {
+		kns = dplane_kernel_ns_find(ctx->zd_ns_info.ns_id);
+		ctx->zd_ns_info.sock = kns->out_sock;
+	}
+
+	atomic_fetch_add_explicit(&worker->updates, count,
+				  memory_order_relaxed);
+}
+
+/* Worker pthread: take part in the current run */
+static void dplane_kernel_worker_run(struct event *event)
+{
+	struct dplane_kernel_worker *worker = EVENT_ARG(event);
+	struct dplane_kernel_pool *pool = &dplane_kernel_pool;
+	struct dplane_kernel_shard *shard;
+	uint32_t i, first;
+
+	/* Own shards first, then those the other workers haven't got to */
+	first = worker->id * DPLANE_KERNEL_SHARDS_PER_WORKER;
+	for (i = 0; i < pool->shard_count; i++) {
+		shard = &pool->shards[(first + i) % pool->shard_count];
+
+		if (dplane_ctx_list_count(&shard->ctx_list) == 0)
+			continue;
+		if (atomic_exchange_explicit(&shard->taken, true,
+					     memory_order_acq_rel))
+			continue;
+
+		dplane_kernel_worker_update(worker, &shard->ctx_list);
+
+		atomic_fetch_add_explicit(&worker->shards, 1,
+					  memory_order_relaxed);
+		if (i >= DPLANE_KERNEL_SHARDS_PER_WORKER)
+			atomic_fetch_add_explicit(&worker->steals, 1,
+						  memory_order_relaxed);
+	}
+
+	frr_with_mutex (&pool->mutex) {
+		if (--pool->busy == 0)
+			pthread_cond_signal(&pool->cond);
+	}
+}
+
+/*
+ * Dplane pthread: have the workers send a run of route updates, and wait
+ * for them. The handled contexts are appended to 'done', shard by shard.
+ */
+static void dplane_kernel_update_run(struct dplane_ctx_list_head *run,
+				     struct dplane_ctx_list_head *done)
+{
+	struct dplane_kernel_pool *pool = &dplane_kernel_pool;
+	const struct dplane_kernel_ns *kns;
+	struct zebra_dplane_ctx *ctx;
+	uint32_t i;
+
+	if (dplane_ctx_list_count(run) < DPLANE_KERNEL_PARALLEL_MIN)
+		goto serial;
+
+	dplane_kernel_ns_refresh();
+
+	frr_each (dplane_ctx_list, run, ctx) {
+		kns = dplane_kernel_ns_find(ctx->zd_ns_info.ns_id);
+		if (!kns || kns->sock[pool->count - 1] < 0)
+			goto serial;
+	}
+
+	while ((ctx = dplane_ctx_list_pop(run)) != NULL) {
+		i = dplane_kernel_ctx_shard(ctx);
+		dplane_ctx_list_add_tail(&pool->shards[i].ctx_list, ctx);
+	}
+
+	frr_with_mutex (&pool->mutex) {
+		pool->busy = pool->count;
+	}
+
+	for (i = 0; i < pool->count; i++)
+		event_add_event(pool->workers[i].pthread->master,
+				dplane_kernel_worker_run, &pool->workers[i], 0,
+				NULL);
+
+	frr_with_mutex (&pool->mutex) {
+		while (pool->busy)
+			pthread_cond_wait(&pool->cond, &pool->mutex);
+	}
+
+	for (i = 0; i < pool->shard_count; i++) {
+		dplane_ctx_list_append(done, &pool->shards[i].ctx_list);
+		atomic_store_explicit(&pool->shards[i].taken, false,
+				      memory_order_relaxed);
+	}
+
+	atomic_fetch_add_explicit(&pool->runs, 1, memory_order_relaxed);
+	return;
+
+serial:
+	kernel_update_multi(run);
+	dplane_ctx_list_append(done, run);
+}
+
+/*
+ * Send a list of updates to the kernel, in parallel where possible. The
+ * handled contexts are returned on the same list.
+ */
+static void dplane_kernel_update(struct dplane_ctx_list_head *ctx_list)
+{
+	struct dplane_ctx_list_head run, serial, done;
+	struct zebra_dplane_ctx *ctx;
+
+	if (!dplane_kernel_pool.count) {
+		kernel_update_multi(ctx_list);
+		return;
+	}
+
+	dplane_ctx_list_init(&run);
+	dplane_ctx_list_init(&serial);
+	dplane_ctx_list_init(&done);
+
+	while ((ctx = dplane_ctx_list_pop(ctx_list)) != NULL) {
+		if (dplane_kernel_ctx_is_route(ctx)) {
+			if (dplane_ctx_list_count(&serial)) {
+				kernel_update_multi(&serial);
+				dplane_ctx_list_append(&done, &serial);
+			}
+			dplane_ctx_list_add_tail(&run, ctx);
+		} else {
+			if (dplane_ctx_list_count(&run))
+				dplane_kernel_update_run(&run, &done);
+			dplane_ctx_list_add_tail(&serial, ctx);
+		}
+	}
+
+	if (dplane_ctx_list_count(&serial)) {
+		kernel_update_multi(&serial);
+		dplane_ctx_list_append(&done, &serial);
+	}
+	if (dplane_ctx_list_count(&run))
+		dplane_kernel_update_run(&run, &done);
+
+	dplane_ctx_list_append(ctx_list, &done);
+}
+
 /*
  * Kernel provider callback
  */
@@ -7260,7 +7675,9 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 
 	dplane_ctx_list_init(&work_list);
 
-	limit = dplane_provider_get_work_limit(prov);
+	/* Workers get through correspondingly more per cycle */
+	limit = dplane_provider_get_work_limit(prov) *
+		MAX(dplane_kernel_pool.count, 1U);
 
 	if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
 		zlog_debug("dplane provider '%s': processing",
@@ -7311,7 +7728,7 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 			dplane_ctx_list_add_tail(&work_list, ctx);
 	}
 
-	kernel_update_multi(&work_list);
+	dplane_kernel_update(&work_list);
 
 	while ((ctx = dplane_ctx_list_pop(&work_list)) != NULL) {
 		kernel_dplane_handle_result(ctx);
@@ -7933,6 +8350,8 @@ void zebra_dplane_shutdown(void)
 	zdplane_info.dg_pthread = NULL;
 	zdplane_info.dg_master = NULL;
 
+	dplane_kernel_pool_stop();
+
 	/* Notify provider(s) of final shutdown.
 	 * Note that this call is in the main pthread, so providers must
 	 * be prepared for that.
@@ -7961,6 +8380,8 @@ void zebra_dplane_shutdown(void)
 		XFREE(MTYPE_DP_NS, zi);
 		zi = zns_info_list_first(&zdplane_info.dg_zns_list);
 	}
+	XFREE(MTYPE_DP_NS, zdplane_info.dg_kernel_ns);
+	zdplane_info.dg_kernel_ns_count = 0;
 
 	/* TODO -- Clean queue(s), free memory */
 	DPLANE_LOCK();
@@ -8029,10 +8450,13 @@ void zebra_dplane_start(void)
 	struct dplane_zns_info *zi;
 	struct zebra_dplane_provider *prov;
 	struct frr_pthread_attr pattr = {
-		.start = frr_pthread_attr_default.start,
+		.start = dplane_pthread_start,
 		.stop = frr_pthread_attr_default.stop
 	};
 
+	/* Start the kernel provider's workers, if any */
+	dplane_kernel_pool_start();
+
 	/* Start dataplane pthread */
 
 	zdplane_info.dg_pthread = frr_pthread_new(&pattr, "Zebra dplane thread",
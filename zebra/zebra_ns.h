@@ -21,6 +21,9 @@ extern "C" {
 
 struct zebra_dplane_ctx;
 
+/* Upper bound for the kernel dplane provider's worker pthreads */
+#define ZEBRA_DPLANE_WORKERS_MAX 16
+
 #ifdef HAVE_NETLINK
 #include <linux/netlink.h>
 
@@ -68,6 +71,9 @@ struct zebra_ns {
 	struct nlsock netlink_dplane_in;
 	struct event *t_netlink;
 
+	/* outgoing channels of the kernel dplane provider's workers, if any */
+	struct nlsock netlink_dplane_worker[ZEBRA_DPLANE_WORKERS_MAX];
+
 	struct nlsock ge_netlink_cmd; /* command channel for generic netlink */
 #endif
 
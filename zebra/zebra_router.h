@@ -235,6 +235,9 @@ struct zebra_router {
 	/* Should we allow non FRR processes to delete our routes */
 	bool allow_delete;
 
+	/* Pthreads the kernel dplane provider spreads route updates over */
+	uint32_t dplane_workers;
+
 	uint8_t protodown_r_bit;
 
 	uint64_t nexthop_weight_scale_value;
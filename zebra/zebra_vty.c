@@ -4402,6 +4402,23 @@ DEFUN_HIDDEN(no_zebra_kernel_netlink_batch_tx_buf,
 	return CMD_SUCCESS;
 }
 
+#ifdef HAVE_LIBURING
+DEFPY (zebra_kernel_netlink_io_uring,
+       zebra_kernel_netlink_io_uring_cmd,
+       "[no] zebra kernel netlink io-uring [(1-64)$depth]",
+       NO_STR
+       ZEBRA_STR
+       "Zebra kernel interface\n"
+       "Set Netlink parameters\n"
+       "Send route update batches through io_uring\n"
+       "Number of batches in flight\n")
+{
+	netlink_set_batch_uring(depth, !no);
+
+	return CMD_SUCCESS;
+}
+#endif /* HAVE_LIBURING */
+
 DEFPY (zebra_protodown_bit,
        zebra_protodown_bit_cmd,
        "zebra protodown reason-bit (0-31)$bit",
@@ -4577,6 +4594,9 @@ void zebra_vty_init(void)
 #ifdef HAVE_NETLINK
 	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_tx_buf_cmd);
 	install_element(CONFIG_NODE, &no_zebra_kernel_netlink_batch_tx_buf_cmd);
+#ifdef HAVE_LIBURING
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_io_uring_cmd);
+#endif
 	install_element(CONFIG_NODE, &zebra_protodown_bit_cmd);
 	install_element(CONFIG_NODE, &no_zebra_protodown_bit_cmd);
 #endif /* HAVE_NETLINK */
@@ -197,6 +197,7 @@ static void zserv_client_fail(struct zserv *client)
 
 	event_cancel(&client->t_read);
 	event_cancel(&client->t_write);
+	event_cancel(&client->t_ring);
 	zserv_event(client, ZSERV_HANDLE_CLIENT_FAIL);
 }
 
@@ -291,6 +292,85 @@ zwrite_fail:
 	zserv_client_fail(client);
 }
 
+/*
+ * Keep the file descriptors a client attached to a ZEBRA_ZAPI_RING offer
+ * for the main pthread, or close them if there is no use for them.
+ */
+static void zserv_ring_fds_take(struct zserv *client, const int *fds, int nfds)
+{
+	bool keep = false;
+	int i;
+
+	frr_with_mutex (&client->ibuf_mtx) {
+		if (nfds == array_size(client->ring_fds) &&
+		    client->ring_fds[0] < 0) {
+			memcpy(client->ring_fds, fds, sizeof(client->ring_fds));
+			keep = true;
+		}
+	}
+
+	if (keep)
+		return;
+
+	for (i = 0; i < nfds; i++)
+		close(fds[i]);
+}
+
+/*
+ * stream_read_try() into the client's working buffer, also picking up any
+ * file descriptors passed along.  The kernel never returns data sent with
+ * descriptors in the same read as data sent before it, so this is only
+ * needed at the start of a message.
+ */
+static ssize_t zserv_read_try(struct zserv *client, int sock, size_t size)
+{
+	struct stream *s = client->ibuf_work;
+	union {
+		char buf[CMSG_SPACE(sizeof(client->ring_fds))];
+		struct cmsghdr align;
+	} cmsgbuf;
+	struct iovec iov;
+	struct msghdr mh = {};
+	struct cmsghdr *cmsg;
+	ssize_t nbytes;
+	int flags = 0;
+
+	if (STREAM_WRITEABLE(s) < size)
+		return -1;
+
+	iov.iov_base = STREAM_DATA(s) + stream_get_endp(s);
+	iov.iov_len = size;
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = cmsgbuf.buf;
+	mh.msg_controllen = sizeof(cmsgbuf.buf);
+#ifdef MSG_CMSG_CLOEXEC
+	flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+	nbytes = recvmsg(sock, &mh, flags);
+	if (nbytes < 0) {
+		if (ERRNO_IO_RETRY(errno))
+			return -2;
+		flog_err(EC_LIB_SOCKET, "%s: read failed on fd %d: %s",
+			 __func__, sock, safe_strerror(errno));
+		return -1;
+	}
+	stream_forward_endp(s, nbytes);
+
+	for (cmsg = CMSG_FIRSTHDR(&mh); cmsg; cmsg = CMSG_NXTHDR(&mh, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+		    cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		zserv_ring_fds_take(client, (const int *)CMSG_DATA(cmsg),
+				    (cmsg->cmsg_len - CMSG_LEN(0)) /
+					    sizeof(int));
+	}
+
+	return nbytes;
+}
+
 /*
  * Read and process data from a client socket.
  *
@@ -357,8 +437,8 @@ static void zserv_read(struct event *event)
 
 		/* Read length and command (if we don't have it already). */
 		if (already < ZEBRA_HEADER_SIZE) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     ZEBRA_HEADER_SIZE - already);
+			nb = zserv_read_try(client, sock,
+					    ZEBRA_HEADER_SIZE - already);
 			if ((nb == 0 || nb == -1)) {
 				if (IS_ZEBRA_DEBUG_EVENT)
 					zlog_debug("connection closed socket [%d]",
@@ -488,6 +568,137 @@ zread_fail:
 	zserv_client_fail(client);
 }
 
+/*
+ * Read messages from a client's shared-memory ring.
+ *
+ * The counterpart of zserv_read() for clients that STARTed sending on a
+ * ring: messages are put back together from their headers and queued the
+ * same way, up to the same limit.  Everything the client sent on the
+ * socket before START was queued before START itself, and this only runs
+ * once the main pthread has processed START, so the order is kept.
+ *
+ * The doorbell is only armed when the ring doesn't hold a whole message;
+ * while zebra keeps up with the client, neither side makes a syscall.
+ */
+static void zserv_ring_read(struct event *event)
+{
+	struct zserv *client = EVENT_ARG(event);
+	struct zapi_ring *ring = client->ring;
+	struct stream_fifo *cache;
+	struct stream *hs, *msg;
+	struct zmsghdr hdr = {};
+	size_t remain, need = ZEBRA_HEADER_SIZE;
+	uint32_t p2p, p2p_orig;
+	int p2p_avail;
+	size_t client_ibuf_fifo_cnt = stream_fifo_count_safe(client->ibuf_fifo);
+
+	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
+					memory_order_relaxed);
+	p2p_avail = p2p_orig - client_ibuf_fifo_cnt;
+
+	/* zserv_process_messages() gets us going again */
+	if (p2p_avail <= 0)
+		return;
+
+	zapi_ring_doorbell_clear(ring->doorbell);
+
+	p2p = p2p_avail;
+	cache = stream_fifo_new();
+	hs = stream_new(ZEBRA_HEADER_SIZE);
+
+	while (p2p) {
+		remain = zapi_ring_remain(ring);
+		if (remain == SIZE_MAX) {
+			flog_warn(EC_ZEBRA_CLIENT_IO_ERROR,
+				  "%s: client %s published a bogus ring position",
+				  __func__, zebra_route_string(client->proto));
+			goto zread_fail;
+		}
+		if (remain < ZEBRA_HEADER_SIZE) {
+			need = ZEBRA_HEADER_SIZE;
+			break;
+		}
+
+		stream_reset(hs);
+		zapi_ring_peek(ring, 0, STREAM_DATA(hs), ZEBRA_HEADER_SIZE);
+		stream_set_endp(hs, ZEBRA_HEADER_SIZE);
+
+		if (!zapi_parse_header(hs, &hdr) ||
+		    hdr.marker != ZEBRA_HEADER_MARKER ||
+		    hdr.version != ZSERV_VERSION ||
+		    hdr.length < ZEBRA_HEADER_SIZE ||
+		    hdr.length > STREAM_SIZE(client->ibuf_work)) {
+			zserv_log_message("Ring message has corrupt header", hs,
+					  &hdr);
+			goto zread_fail;
+		}
+
+		if (remain < hdr.length) {
+			need = hdr.length;
+			break;
+		}
+
+		msg = stream_new(hdr.length);
+		zapi_ring_get(ring, STREAM_DATA(msg), hdr.length);
+		/*
+		 * The client can still write the ring; what gets processed
+		 * must carry the header that was checked, length included.
+		 */
+		memcpy(STREAM_DATA(msg), STREAM_DATA(hs), ZEBRA_HEADER_SIZE);
+		stream_set_endp(msg, hdr.length);
+
+		if (IS_ZEBRA_DEBUG_PACKET) {
+			struct vrf *vrf = vrf_lookup_by_id(hdr.vrf_id);
+
+			zlog_debug("zebra message[%s:%s:%u] comes from ring of %s",
+				   zserv_command_string(hdr.command),
+				   VRF_LOGNAME(vrf), hdr.length,
+				   zebra_route_string(client->proto));
+		}
+
+		stream_fifo_push(cache, msg);
+		p2p--;
+	}
+
+	if (p2p < (uint32_t)p2p_avail) {
+		uint64_t time_now = monotime(NULL);
+
+		frr_with_mutex (&client->stats_mtx) {
+			client->last_read_time = time_now;
+			client->last_read_cmd = hdr.command;
+		}
+
+		frr_with_mutex (&client->ibuf_mtx) {
+			while (cache->head)
+				stream_fifo_push(client->ibuf_fifo,
+						 stream_fifo_pop(cache));
+			client_ibuf_fifo_cnt =
+				stream_fifo_count_safe(client->ibuf_fifo);
+		}
+
+		zserv_event(client, ZSERV_PROCESS_MESSAGES);
+	}
+
+	if (client_ibuf_fifo_cnt < p2p_orig) {
+		if (zapi_ring_wait_data(ring, need))
+			event_add_read(client->pthread->master, zserv_ring_read,
+				       client, ring->doorbell, &client->t_ring);
+		else
+			event_add_event(client->pthread->master,
+					zserv_ring_read, client, 0,
+					&client->t_ring);
+	}
+
+	stream_free(hs);
+	stream_fifo_free(cache);
+	return;
+
+zread_fail:
+	stream_free(hs);
+	stream_fifo_free(cache);
+	zserv_client_fail(client);
+}
+
 static void zserv_client_event(struct zserv *client,
 			       enum zserv_client_event event)
 {
@@ -499,6 +710,12 @@ static void zserv_client_event(struct zserv *client,
 	case ZSERV_CLIENT_READ:
 		event_add_read(client->pthread->master, zserv_read, client,
 			       client->sock, &client->t_read);
+		/* the socket still tells us when the client goes away */
+		if (atomic_load_explicit(&client->ring_started,
+					 memory_order_acquire))
+			event_add_event(client->pthread->master,
+					zserv_ring_read, client, 0,
+					&client->t_ring);
 		break;
 	case ZSERV_CLIENT_WRITE:
 		event_add_write(client->pthread->master, zserv_write, client,
@@ -621,6 +838,50 @@ int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo)
 	return 0;
 }
 
+void zserv_ring_offer(struct zserv *client)
+{
+	int fds[array_size(client->ring_fds)];
+	struct stream *s;
+	size_t i;
+
+	frr_with_mutex (&client->ibuf_mtx) {
+		memcpy(fds, client->ring_fds, sizeof(fds));
+		for (i = 0; i < array_size(client->ring_fds); i++)
+			client->ring_fds[i] = -1;
+	}
+
+	if (fds[0] >= 0) {
+		if (!client->ring)
+			client->ring = zapi_ring_attach(fds[0], fds[1], fds[2]);
+		else
+			for (i = 0; i < array_size(fds); i++)
+				close(fds[i]);
+	}
+
+	if (IS_ZEBRA_DEBUG_EVENT)
+		zlog_debug("%s: client %s offered a shared memory ring, %s",
+			   __func__, zebra_route_string(client->proto),
+			   client->ring ? "accepted" : "rejected");
+
+	s = stream_new(ZEBRA_SMALL_PACKET_SIZE);
+	zclient_create_header(s, ZEBRA_ZAPI_RING, VRF_DEFAULT);
+	stream_putc(s, client->ring ? ZAPI_RING_ACCEPT : ZAPI_RING_REJECT);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	zserv_send_message(client, s);
+}
+
+void zserv_ring_start(struct zserv *client)
+{
+	if (!client->ring ||
+	    atomic_load_explicit(&client->ring_started, memory_order_relaxed))
+		return;
+
+	atomic_store_explicit(&client->ring_started, true,
+			      memory_order_release);
+	zserv_client_event(client, ZSERV_CLIENT_READ);
+}
+
 /* Hooks for client connect / disconnect */
 DEFINE_HOOK(zserv_client_connect, (struct zserv *client), (client));
 DEFINE_KOOH(zserv_client_close, (struct zserv *client), (client));
@@ -687,6 +948,12 @@ static void zserv_client_free(struct zserv *client)
 	if (client->wb)
 		buffer_free(client->wb);
 
+	/* Unmap the ring, close what came for it */
+	zapi_ring_del(&client->ring);
+	for (size_t i = 0; i < array_size(client->ring_fds); i++)
+		if (client->ring_fds[i] >= 0)
+			close(client->ring_fds[i]);
+
 	/* Free buffer mutexes */
 	pthread_mutex_destroy(&client->stats_mtx);
 	pthread_mutex_destroy(&client->obuf_mtx);
@@ -817,6 +1084,8 @@ static struct zserv *zserv_client_create(int sock)
 	pthread_mutex_init(&client->obuf_mtx, NULL);
 	pthread_mutex_init(&client->stats_mtx, NULL);
 	client->wb = buffer_new(0);
+	for (i = 0; i < (int)array_size(client->ring_fds); i++)
+		client->ring_fds[i] = -1;
 	TAILQ_INIT(&(client->gr_info_queue));
 
 	/* Initialize flags */
@@ -1128,6 +1397,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 		json_object_int_add(json_client, "sessionId", client->session_id);
 		json_object_int_add(json_client, "fileDescriptor", client->sock);
 		json_object_boolean_add(json_client, "asynchronous", !client->synchronous);
+		if (atomic_load_explicit(&client->ring_started, memory_order_relaxed))
+			json_object_int_add(json_client, "ringSize", client->ring->size);
 
 		/* Time information */
 		json_object_string_add(json_client, "connectTime",
@@ -1359,6 +1630,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 
 		vty_out(vty, "------------------------ \n");
 		vty_out(vty, "FD: %d \n", client->sock);
+		if (atomic_load_explicit(&client->ring_started, memory_order_relaxed))
+			vty_out(vty, "Shared Memory Ring: %zu bytes \n", client->ring->size);
 
 		vty_out(vty, "Connect Time: %s \n",
 			zserv_time_buf(&connect_time, cbuf, ZEBRA_TIME_BUF));
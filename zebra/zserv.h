@@ -23,6 +23,8 @@
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
 #include "lib/hook.h"         /* for DECLARE_HOOK, DECLARE_KOOH */
+#include "lib/frratomic.h"    /* for atomic_bool */
+#include "lib/zapi_ring.h"    /* for zapi_ring */
 /* clang-format on */
 
 #ifdef __cplusplus
@@ -113,6 +115,17 @@ struct zserv {
 	struct event *t_read;
 	struct event *t_write;
 
+	/*
+	 * Shared-memory ring the client sends its messages on once it has
+	 * been STARTed; the memfd, doorbell and space doorbell that came
+	 * with an OFFER wait in ring_fds until the main pthread gets to it.
+	 * ring_fds is covered by ibuf_mtx.
+	 */
+	int ring_fds[3];
+	struct zapi_ring *ring;
+	atomic_bool ring_started;
+	struct event *t_ring;
+
 	/* Event for message processing, for the main pthread */
 	struct event *t_process;
 
@@ -314,6 +327,18 @@ extern int zserv_send_message(struct zserv *client, struct stream *msg);
  */
 extern int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo);
 
+/*
+ * Handle a client's ZAPI_RING_OFFER: map the ring that came with it and
+ * tell the client whether it can use it.
+ */
+extern void zserv_ring_offer(struct zserv *client);
+
+/*
+ * Handle a client's ZAPI_RING_START: from here on, the client's messages
+ * are read from its ring.
+ */
+extern void zserv_ring_start(struct zserv *client);
+
 /*
  * Retrieve a client by its protocol and instance number.
  *